@@ -36,6 +36,140 @@ void DataManager::StartTraining(const MODEL_DESTINATION modelDestination, const
 
 	//std::map<std::string, SingleModelResult> tests_summarize;
 
+	const auto training_jobs = CreateTrainingJobs(trainingParameters);
+
+	if (training_jobs.empty())
+	{
+		return;
+	}
+
+	const int hardware_threads_number = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	const int jobs_number = static_cast<int>(training_jobs.size());
+
+	int workers_number = trainingParameters.numberOfWorkers > 0 ? trainingParameters.numberOfWorkers : hardware_threads_number;
+	workers_number = std::max(1, std::min(workers_number, jobs_number));
+
+	const int threads_per_worker = std::max(1, hardware_threads_number / workers_number);
+
+	std::vector<TrainingJobResult> job_results(training_jobs.size());
+	std::mutex job_results_mutex;
+	std::condition_variable job_results_condition;
+	std::atomic<size_t> next_job_index{ 0 };
+	std::atomic<bool> stop_workers{ false };
+	std::exception_ptr worker_error;
+
+	std::vector<std::thread> workers;
+
+	// Workers are stopped and joined on every exit path, a joinable thread left behind would terminate the program
+	struct WorkersJoiner
+	{
+		std::vector<std::thread>& workers;
+		std::atomic<bool>& stopWorkers;
+
+		~WorkersJoiner()
+		{
+			stopWorkers = true;
+
+			for (auto& worker : workers)
+			{
+				if (worker.joinable())
+				{
+					worker.join();
+				}
+			}
+		}
+	} workers_joiner{ workers, stop_workers };
+
+	for (int worker_index = 0; worker_index < workers_number; ++worker_index)
+	{
+		workers.emplace_back([&]()
+			{
+				try
+				{
+					// OpenMP regions of this worker use its share of the threads, Eigen work runs on the shared OpenNN pool
+					ThreadRuntime::get_instance().set_thread_budget(threads_per_worker);
+
+					// Training scales the data set in place, so every worker trains on its own copy
+					DataSet worker_data_set;
+					worker_data_set.set(m_dataSet);
+					worker_data_set.set_threads_number(threads_per_worker);
+
+					for (size_t job_index = next_job_index++; !stop_workers && job_index < training_jobs.size(); job_index = next_job_index++)
+					{
+						auto accepted_networks = RunTrainingJob(training_jobs.at(job_index), trainingParameters, worker_data_set, threads_per_worker, input_variables_number, target_variables_number, expected_results);
+
+						{
+							std::lock_guard<std::mutex> lock(job_results_mutex);
+							job_results.at(job_index).acceptedNetworks = std::move(accepted_networks);
+							job_results.at(job_index).done = true;
+						}
+
+						job_results_condition.notify_all();
+					}
+				}
+				catch (...)
+				{
+					// The first failure is rethrown by the saving loop, which would otherwise wait for the job forever
+					{
+						std::lock_guard<std::mutex> lock(job_results_mutex);
+
+						if (!worker_error)
+						{
+							worker_error = std::current_exception();
+						}
+					}
+
+					stop_workers = true;
+
+					job_results_condition.notify_all();
+				}
+			});
+	}
+
+	// Jobs are saved in the serial order, so file names and write order do not depend on the workers number
+	for (size_t job_index = 0; job_index < training_jobs.size(); ++job_index)
+	{
+		std::vector<std::shared_ptr<NeuralNetwork>> accepted_networks;
+
+		{
+			std::unique_lock<std::mutex> lock(job_results_mutex);
+			job_results_condition.wait(lock, [&]() { return job_results.at(job_index).done || worker_error; });
+
+			if (worker_error)
+			{
+				std::rethrow_exception(worker_error);
+			}
+
+			accepted_networks = std::move(job_results.at(job_index).acceptedNetworks);
+		}
+
+		for (size_t rep_index = 0; rep_index < accepted_networks.size(); ++rep_index)
+		{
+			std::string try_name = training_jobs.at(job_index).shortsName + "_" + std::to_string(order_models_folder_number) + "_" + std::to_string(rep_index + 1);
+
+			//tests_summarize[try_name] = test_result;
+
+			std::string file_name = folder_for_models_name + "/ " + file_sufix + "_" + try_name + ".xml";
+
+			accepted_networks.at(rep_index)->save(file_name);
+
+			if (trainingParameters.saveBinaryModels)
+			{
+				accepted_networks.at(rep_index)->save_binary(folder_for_models_name + "/ " + file_sufix + "_" + try_name + ".bin");
+			}
+		}
+	}
+
+	int o = 0;
+}
+//----------------------------------------------------------
+std::vector<TrainingJob> DataManager::CreateTrainingJobs(const TrainingParameters& trainingParameters)
+{
+	std::vector<TrainingJob> response;
+
+	std::seed_seq jobs_seed_sequence{ trainingParameters.randomSeed };
+	std::mt19937 jobs_seeds_engine(jobs_seed_sequence);
+
 	for (const auto& project_type : trainingParameters.projectTypes)
 	{
 		for (const auto& optimization_method : trainingParameters.optimizationMethods)
@@ -67,35 +201,50 @@ void DataManager::StartTraining(const MODEL_DESTINATION modelDestination, const
 					}
 				}
 
-				int repeate_counter = 0;
-				const std::string shorts_combination_name = GetShortsOfAlgorithms(project_type, optimization_method, loss_method);
-
-				while (repeate_counter < trainingParameters.numberOfReps)
+				// Levenberg-Marquardt only works with sums of squared errors, other losses would be rejected on every attempt
+				if (optimization_method == opennn::TrainingStrategy::OptimizationMethod::LEVENBERG_MARQUARDT_ALGORITHM)
 				{
-					auto neural_network = GetTrainedNeuralNetwork(project_type, trainingParameters.hiddenNeuronsNumber, optimization_method, loss_method, input_variables_number, target_variables_number);
-
-					if (neural_network)
+					if (loss_method == opennn::TrainingStrategy::LossMethod::WEIGHTED_SQUARED_ERROR ||
+						loss_method == opennn::TrainingStrategy::LossMethod::CROSS_ENTROPY_ERROR ||
+						loss_method == opennn::TrainingStrategy::LossMethod::MINKOWSKI_ERROR)
 					{
-						auto test_result = CollectResult(neural_network, optimization_method, loss_method, expected_results);
+						continue;
+					}
+				}
 
-						if (IsFulfillExpectations(test_result, trainingParameters.expectations))
-						{
-							repeate_counter++;
-							std::string try_name = shorts_combination_name + "_" + std::to_string(order_models_folder_number) + "_" + std::to_string(repeate_counter);
+				response.push_back({ project_type, optimization_method, loss_method, GetShortsOfAlgorithms(project_type, optimization_method, loss_method), static_cast<unsigned int>(jobs_seeds_engine()) });
+			}
+		}
+	}
+
+	return response;
+}
+//----------------------------------------------------------
+std::vector<std::shared_ptr<NeuralNetwork>> DataManager::RunTrainingJob(const TrainingJob& trainingJob, const TrainingParameters& trainingParameters, DataSet& dataSet, const int& threadsNumber, const Index& inputVariablesNumber, const Index& targetVariablesNumber, const std::vector<int>& expectedResults)
+{
+	std::vector<std::shared_ptr<NeuralNetwork>> response;
 
-							//tests_summarize[try_name] = test_result;
+	// Every attempt gets a new seed, so rejected attempts do not repeat the same initialisation
+	std::mt19937 attempts_seeds_engine(trainingJob.randomSeed);
 
-							std::string file_name = folder_for_models_name + "/ " + file_sufix + "_" + try_name + ".xml";
+	while (static_cast<int>(response.size()) < trainingParameters.numberOfReps)
+	{
+		const auto attempt_seed = static_cast<unsigned int>(attempts_seeds_engine());
 
-							neural_network->save(file_name);
-						}
-					}
-				}
+		auto neural_network = GetTrainedNeuralNetwork(trainingJob.projectType, trainingParameters.hiddenNeuronsNumber, trainingJob.optimizationMethod, trainingJob.lossMethod, inputVariablesNumber, targetVariablesNumber, dataSet, threadsNumber, attempt_seed, expectedResults, trainingParameters.earlyRejectionPeriod, trainingParameters.earlyRejectionExpectations, trainingParameters.jacobianChunkSize);
+
+		if (neural_network)
+		{
+			auto test_result = CollectResult(neural_network, trainingJob.optimizationMethod, trainingJob.lossMethod, expectedResults);
+
+			if (IsFulfillExpectations(test_result, trainingParameters.expectations))
+			{
+				response.push_back(neural_network);
 			}
 		}
 	}
 
-	int o = 0;
+	return response;
 }
 //----------------------------------------------------------
 std::vector<std::string> DataManager::GetAllNamesFromLocation(const std::string& location)
@@ -463,19 +612,45 @@ std::string DataManager::GetShortsOfAlgorithms(const NeuralNetwork::ProjectType&
 	return response;
 }
 //----------------------------------------------------------
-std::shared_ptr<NeuralNetwork> DataManager::GetTrainedNeuralNetwork(const NeuralNetwork::ProjectType& projectType, const Index& hiddenNeuronsNumber, const TrainingStrategy::OptimizationMethod& optimizationMethod, const TrainingStrategy::LossMethod& lossMethod, const Index& inputVariablesNumber, const Index& targetVariablesNumber)
+std::shared_ptr<NeuralNetwork> DataManager::GetTrainedNeuralNetwork(const NeuralNetwork::ProjectType& projectType, const Index& hiddenNeuronsNumber, const TrainingStrategy::OptimizationMethod& optimizationMethod, const TrainingStrategy::LossMethod& lossMethod, const Index& inputVariablesNumber, const Index& targetVariablesNumber, DataSet& dataSet, const int& threadsNumber, const unsigned int& randomSeed, const std::vector<int>& expectedResults, const int& earlyRejectionPeriod, const TrainingExpectations& earlyRejectionExpectations, const Index& jacobianChunkSize)
 {
 	try
 	{
-		srand(static_cast<unsigned>(time(nullptr)));
-
 		std::shared_ptr<NeuralNetwork> neural_network(new NeuralNetwork(projectType, { inputVariablesNumber, hiddenNeuronsNumber, targetVariablesNumber }));
+		neural_network->set_threads_number(threadsNumber);
+
+		TrainingStrategy training_strategy(neural_network.get(), &dataSet);
 
-		TrainingStrategy training_strategy(neural_network.get(), &m_dataSet);
+		training_strategy.set_random_seed(randomSeed);
+		neural_network->set_parameters_random();
 
+		// Optimizers update one contiguous parameters vector in place instead of copying it into every layer
+		neural_network->set_parameters_arena(true);
+
+		training_strategy.set_threads_number(threadsNumber);
 		training_strategy.set_loss_method(lossMethod);
 		training_strategy.set_optimization_method(optimizationMethod);
-		training_strategy.perform_training();
+
+		// Levenberg-Marquardt accumulates the squared errors Jacobian in chunks instead of storing it for all the training samples
+		training_strategy.get_Levenberg_Marquardt_algorithm_pointer()->set_jacobian_chunk_size(jacobianChunkSize);
+
+		if (earlyRejectionPeriod > 0)
+		{
+			// Hopeless runs are stopped at the first intermediate evaluation which does not reach the minimal results
+			training_strategy.set_evaluation_callback([&, neural_network](const Index&)
+				{
+					auto intermediate_result = CollectResult(neural_network, optimizationMethod, lossMethod, expectedResults);
+
+					return IsFulfillExpectations(intermediate_result, earlyRejectionExpectations);
+				}, earlyRejectionPeriod);
+		}
+
+		auto training_results = training_strategy.perform_training();
+
+		if (training_results.stopping_condition == OptimizationAlgorithm::StoppingCondition::EvaluationRejection)
+		{
+			return nullptr;
+		}
 
 		return neural_network;
 	}
@@ -569,11 +744,10 @@ Tensor<type, 2> DataManager::TestWithData(std::shared_ptr<NeuralNetwork> neuralN
 	Tensor<type, 2> outputs(m_testData.size(), neuralNetwork->get_outputs_number());
 
 	Tensor<Index, 1> inputs_dimensions = get_dimensions(inputs);
-	Tensor<Index, 1> outputs_dimensions = get_dimensions(outputs);
 
 	inputs.setValues(m_testData);
 
-	outputs = neuralNetwork->calculate_outputs(inputs.data(), inputs_dimensions);
+	neuralNetwork->calculate_outputs(inputs.data(), inputs_dimensions, outputs.data(), neuralNetwork->get_inference_context());
 
 	return outputs;
 }
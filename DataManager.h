@@ -24,7 +24,9 @@ private:
 	void LoadTestInputData(const std::string& inputDataLocation);
 	std::vector<int> LoadTestExpectedResults(const MODEL_DESTINATION modelDestination, const std::string& inputDataLocation);
 	std::string GetShortsOfAlgorithms(const NeuralNetwork::ProjectType& projectType, const TrainingStrategy::OptimizationMethod& optimizationMethod, const TrainingStrategy::LossMethod& lossMethod);
-	std::shared_ptr<NeuralNetwork> GetTrainedNeuralNetwork(const NeuralNetwork::ProjectType& projectType, const Index& hiddenNeuronsNumber, const TrainingStrategy::OptimizationMethod& optimizationMethod, const TrainingStrategy::LossMethod& lossMethod, const Index& inputVariablesNumber, const Index& targetVariablesNumber);
+	std::vector<TrainingJob> CreateTrainingJobs(const TrainingParameters& trainingParameters);
+	std::vector<std::shared_ptr<NeuralNetwork>> RunTrainingJob(const TrainingJob& trainingJob, const TrainingParameters& trainingParameters, DataSet& dataSet, const int& threadsNumber, const Index& inputVariablesNumber, const Index& targetVariablesNumber, const std::vector<int>& expectedResults);
+	std::shared_ptr<NeuralNetwork> GetTrainedNeuralNetwork(const NeuralNetwork::ProjectType& projectType, const Index& hiddenNeuronsNumber, const TrainingStrategy::OptimizationMethod& optimizationMethod, const TrainingStrategy::LossMethod& lossMethod, const Index& inputVariablesNumber, const Index& targetVariablesNumber, DataSet& dataSet, const int& threadsNumber, const unsigned int& randomSeed, const std::vector<int>& expectedResults, const int& earlyRejectionPeriod, const TrainingExpectations& earlyRejectionExpectations, const Index& jacobianChunkSize);
 	SingleModelResult CollectResult(std::shared_ptr<NeuralNetwork> neuralNetwork, const TrainingStrategy::OptimizationMethod& optimizationMethod, const TrainingStrategy::LossMethod& lossMethod, const std::vector<int>& expectedResults);
 	Tensor<type, 2> TestWithData(std::shared_ptr<NeuralNetwork> neuralNetwork);
 	opennn::type GetBorderTopValue(const std::vector<float>& singleResults, const std::vector<float>& orderedResults);
@@ -1,10 +1,16 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <random>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "includes/opennn/opennn.h"
@@ -91,6 +97,27 @@ struct TrainingParameters
 	std::vector<TrainingStrategy::OptimizationMethod> optimizationMethods;
 	std::vector<TrainingStrategy::LossMethod> lossMethods;
 	TrainingExpectations expectations;
+	int earlyRejectionPeriod{ 0 }; // epochs between intermediate evaluations, 0 - train every run to the end
+	TrainingExpectations earlyRejectionExpectations{}; // minimal results of an intermediate evaluation to continue the run
+	int numberOfWorkers{ 0 }; // 0 - one worker per hardware thread, 1 - serial training
+	unsigned int randomSeed{ 0 }; // base seed, every job and every attempt gets its own seed derived from it
+	Index jacobianChunkSize{ 256 }; // Levenberg-Marquardt samples per chunk of the squared errors Jacobian, 0 - whole training batch
+	bool saveBinaryModels{ false }; // true - every accepted network is also saved as a binary .bin model next to its .xml one
+};
+
+struct TrainingJob
+{
+	NeuralNetwork::ProjectType projectType;
+	TrainingStrategy::OptimizationMethod optimizationMethod;
+	TrainingStrategy::LossMethod lossMethod;
+	std::string shortsName;
+	unsigned int randomSeed;
+};
+
+struct TrainingJobResult
+{
+	std::vector<std::shared_ptr<NeuralNetwork>> acceptedNetworks;
+	bool done{ false };
 };
 
 struct SingleTestResultPair
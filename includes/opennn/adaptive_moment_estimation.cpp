@@ -49,6 +49,14 @@ Index AdaptiveMomentEstimation::get_batch_samples_number() const
 }
 
 
+/// Returns the number of batches filled ahead while the current one is propagated.
+
+const Index& AdaptiveMomentEstimation::get_batch_prefetch_depth() const
+{
+    return batch_prefetch_depth;
+}
+
+
 /// Returns beta 1.
 
 const type& AdaptiveMomentEstimation::get_beta_1() const
@@ -107,6 +115,16 @@ void AdaptiveMomentEstimation::set_batch_samples_number(const Index& new_batch_s
 }
 
 
+/// Sets the number of batches filled ahead in a background thread while the current one is propagated.
+/// A value lower than 2 fills every batch synchronously. Default 2.
+/// @param new_batch_prefetch_depth New queue depth.
+
+void AdaptiveMomentEstimation::set_batch_prefetch_depth(const Index& new_batch_prefetch_depth)
+{
+    batch_prefetch_depth = new_batch_prefetch_depth;
+}
+
+
 /// Sets beta 1 generally close to 1.
 /// @param new_beta_1 New value for beta 1.
 
@@ -277,8 +295,8 @@ TrainingResults AdaptiveMomentEstimation::perform_training()
             : batch_size_selection = batch_samples_number;   
 
 
-    DataSetBatch batch_training(batch_size_training, data_set_pointer);
-    DataSetBatch batch_selection(batch_size_selection, data_set_pointer);
+    DataSetBatchPrefetcher training_batches_prefetcher(batch_size_training, data_set_pointer, batch_prefetch_depth);
+    DataSetBatchPrefetcher selection_batches_prefetcher(batch_size_selection, data_set_pointer, batch_prefetch_depth);
 
     const Index training_batches_number = training_samples_number/batch_size_training;
     const Index selection_batches_number = selection_samples_number/batch_size_selection;
@@ -293,6 +311,11 @@ TrainingResults AdaptiveMomentEstimation::perform_training()
     neural_network_pointer->set_inputs_names(inputs_names);
     neural_network_pointer->set_outputs_names(targets_names);
 
+    // Mostly zero inputs, such as word bags, are carried as sparse batches to the first perceptron layer
+
+    training_batches_prefetcher.set_sparse_inputs(neural_network_pointer->has_sparse_inputs_layer());
+    selection_batches_prefetcher.set_sparse_inputs(neural_network_pointer->has_sparse_inputs_layer());
+
     if(neural_network_pointer->has_scaling_layer())
     {
         ScalingLayer* scaling_layer_pointer = neural_network_pointer->get_scaling_layer_pointer();
@@ -337,7 +360,9 @@ TrainingResults AdaptiveMomentEstimation::perform_training()
     time(&beginning_time);
     type elapsed_time = type(0);
 
-    bool shuffle = false;
+    // In streaming mode the batches are shuffled by windows of consecutive samples
+
+    bool shuffle = data_set_pointer->get_streaming();
 
     if(neural_network_pointer->has_long_short_term_memory_layer()
     || neural_network_pointer->has_recurrent_layer())
@@ -353,6 +378,8 @@ TrainingResults AdaptiveMomentEstimation::perform_training()
 
         const Index batches_number = training_batches.dimension(0);
 
+        training_batches_prefetcher.start(training_batches, input_variables_indices, target_variables_indices);
+
         training_loss = type(0);
         training_error = type(0);
 
@@ -362,7 +389,7 @@ TrainingResults AdaptiveMomentEstimation::perform_training()
         {
 
             // Data set
-            batch_training.fill(training_batches.chip(iteration, 0), input_variables_indices, target_variables_indices);
+            DataSetBatch& batch_training = training_batches_prefetcher.next();
 
             // Neural network
             neural_network_pointer->forward_propagate(batch_training, training_forward_propagation, switch_train);
@@ -388,13 +415,15 @@ TrainingResults AdaptiveMomentEstimation::perform_training()
         {
             selection_batches = data_set_pointer->get_batches(selection_samples_indices, batch_size_selection, shuffle);
 
+            selection_batches_prefetcher.start(selection_batches, input_variables_indices, target_variables_indices);
+
             selection_error = type(0);
 
             for(Index iteration = 0; iteration < selection_batches_number; iteration++)
             {
                 // Data set
 
-                batch_selection.fill(selection_batches.chip(iteration,0), input_variables_indices, target_variables_indices);
+                DataSetBatch& batch_selection = selection_batches_prefetcher.next();
 
                 // Neural network
 
@@ -466,6 +495,15 @@ TrainingResults AdaptiveMomentEstimation::perform_training()
             results.stopping_condition = StoppingCondition::MaximumSelectionErrorIncreases;
         }
 
+        if(!stop_training && check_evaluation_rejection(epoch))
+        {
+            if(display) cout << "Epoch " << epoch << endl << "Training run rejected by the evaluation callback." << endl;
+
+            stop_training = true;
+
+            results.stopping_condition = StoppingCondition::EvaluationRejection;
+        }
+
         if(stop_training)
         {
             results.loss = training_back_propagation.loss;
@@ -615,14 +653,22 @@ void AdaptiveMomentEstimation::update_parameters(LossIndexBackPropagation& back_
         = back_propagation.gradient * back_propagation.gradient * (type(1) - beta_2)
         + optimization_data.square_gradient_exponential_decay * beta_2;
 
-    back_propagation.parameters.device(*thread_pool_device)
+    // With a parameters arena the layers see the update in place
+
+    NeuralNetwork* neural_network_pointer = back_propagation.loss_index_pointer->get_neural_network_pointer();
+
+    Tensor<type, 1>& parameters = neural_network_pointer->has_parameters_arena()
+            ? neural_network_pointer->get_parameters_arena()
+            : back_propagation.parameters;
+
+    parameters.device(*thread_pool_device)
         -= learning_rate * optimization_data.gradient_exponential_decay / (optimization_data.square_gradient_exponential_decay.sqrt() + epsilon);
         
     optimization_data.iteration++;
 
     // Update parameters
 
-    back_propagation.loss_index_pointer->get_neural_network_pointer()->set_parameters(back_propagation.parameters);
+    neural_network_pointer->set_parameters(parameters);
 }
 
 
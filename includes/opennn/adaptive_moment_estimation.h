@@ -80,12 +80,16 @@ public:
 
    void set_batch_samples_number(const Index& new_batch_samples_number);
 
+   void set_batch_prefetch_depth(const Index&);
+
    void set_default() final;
 
    // Get methods
 
    Index get_batch_samples_number() const;
 
+   const Index& get_batch_prefetch_depth() const;
+
    // Training operators
 
    void set_initial_learning_rate(const type&);
@@ -166,6 +170,10 @@ private:
 
    Index batch_samples_number = 1000;
 
+   /// Number of batches filled ahead in a background thread. Lower than 2 fills them synchronously.
+
+   Index batch_prefetch_depth = 2;
+
 
 #ifdef OPENNN_CUDA
     #include "../../opennn-cuda/opennn-cuda/adaptive_moment_estimation_cuda.h"
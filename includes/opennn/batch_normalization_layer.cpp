@@ -43,7 +43,7 @@ void BatchNormalizationLayer::set_parameters_random()
 
     for(Index i = 0; i < synaptic_weights.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
         synaptic_weights(i) = minimum + (maximum - minimum)*random;
     }
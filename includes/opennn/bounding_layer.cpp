@@ -423,27 +423,31 @@ void BoundingLayer::forward_propagate(type* inputs_data, const Tensor<Index, 1>&
         const Index rows_number = inputs_dimensions(0);
         const Index columns_number = inputs_dimensions(1);
 
-        for(Index i = 0; i < rows_number; i++)
+        // Element by element, so that the outputs can be the inputs themselves
+
+        for(Index j = 0; j < columns_number; j++)
+        {
+            const type lower_bound = lower_bounds(j);
+            const type upper_bound = upper_bounds(j);
+
+            for(Index i = 0; i < rows_number; i++)
+            {
+                if(inputs(i,j) < lower_bound)
                 {
-                    for(Index j = 0; j < columns_number; j++)
-                    {
-                        if(inputs(i,j) < lower_bounds(j))
-                        {
-                            outputs(i,j) = lower_bounds(j);
-                        }
-                        else if(inputs(i,j) > upper_bounds(j))
-                        {
-                            outputs(i,j) = upper_bounds(j);
-                        }
-                        else
-                        {
-                            outputs(i,j) = inputs(i,j);
-                        }
-                    }
+                    outputs(i,j) = lower_bound;
                 }
-
+                else if(inputs(i,j) > upper_bound)
+                {
+                    outputs(i,j) = upper_bound;
+                }
+                else
+                {
+                    outputs(i,j) = inputs(i,j);
+                }
+            }
+        }
     }
-    else
+    else if(inputs_data != bounding_layer_forward_propagation->outputs_data)
     {
         Tensor<Index, 0> inputs_size = inputs_dimensions.prod();
         copy(inputs_data, inputs_data + inputs_size(0), bounding_layer_forward_propagation->outputs_data);
@@ -33,6 +33,7 @@
 #include "tinyxml2.h"
 #include "../eigen/unsupported/Eigen/CXX11/Tensor"
 #include "../eigen/unsupported/Eigen/CXX11/ThreadPool"
+#include "../eigen/Eigen/SparseCore"
 //#pragma warning(pop)
 
 #ifdef OPENNN_CUDA
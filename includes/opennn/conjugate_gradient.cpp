@@ -475,6 +475,14 @@ const type& ConjugateGradient::get_maximum_time() const
 }
 
 
+/// Returns the number of shards of the training batch whose gradients are calculated concurrently.
+
+const Index& ConjugateGradient::get_shards_number() const
+{
+    return shards_number;
+}
+
+
 /// Returns the minimum loss improvement during training.
 
 const type& ConjugateGradient::get_minimum_loss_decrease() const
@@ -535,6 +543,8 @@ void ConjugateGradient::set_default()
     maximum_epochs_number = 1000;
     maximum_time = type(3600.0);
 
+    shards_number = 1;
+
     // UTILITIES
 
     display_period = 10;
@@ -651,6 +661,30 @@ void ConjugateGradient::set_maximum_time(const type& new_maximum_time)
 }
 
 
+/// Sets the number of shards of the training batch whose gradients are calculated concurrently.
+/// Each shard has its own batch, forward propagation and back-propagation,
+/// and the shards gradients are added into the training gradient.
+/// This only gives the same results as the whole batch for error terms that are sums over the samples,
+/// and it is not available for recurrent, long short-term memory or batch normalization layers.
+/// @param new_shards_number Number of shards. If it is one the whole training batch is back-propagated at once.
+
+void ConjugateGradient::set_shards_number(const Index& new_shards_number)
+{
+    if(new_shards_number < 1)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: ConjugateGradient class.\n"
+               << "void set_shards_number(const Index&) method.\n"
+               << "Number of shards must be greater than 0.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    shards_number = new_shards_number;
+}
+
+
 /// Sets a new minimum loss improvement during training.
 /// @param new_minimum_loss_decrease Minimum improvement in the loss between two iterations.
 
@@ -764,6 +798,13 @@ TrainingResults ConjugateGradient::perform_training()
     LossIndexBackPropagation training_back_propagation(training_samples_number, loss_index_pointer);
     LossIndexBackPropagation selection_back_propagation(selection_samples_number, loss_index_pointer);
 
+    LossIndexShardedBackPropagation training_sharded_back_propagation;
+
+    if(shards_number > 1)
+    {
+        training_sharded_back_propagation.set(shards_number, training_samples_indices, loss_index_pointer);
+    }
+
     // Optimization algorithm
 
     type old_loss = type(0);
@@ -783,13 +824,18 @@ TrainingResults ConjugateGradient::perform_training()
 
         optimization_data.epoch = epoch;
 
-        // Neural network
-
-        neural_network_pointer->forward_propagate(training_batch, training_forward_propagation, switch_train);
+        // Neural network and loss index
 
-        // Loss index
+        if(shards_number > 1)
+        {
+            loss_index_pointer->back_propagate(training_sharded_back_propagation, training_back_propagation);
+        }
+        else
+        {
+            neural_network_pointer->forward_propagate(training_batch, training_forward_propagation, switch_train);
 
-        loss_index_pointer->back_propagate(training_batch, training_forward_propagation, training_back_propagation);
+            loss_index_pointer->back_propagate(training_batch, training_forward_propagation, training_back_propagation);
+        }
         results.training_error_history(epoch) = training_back_propagation.error;
 
         // Update parameters
@@ -872,6 +918,15 @@ TrainingResults ConjugateGradient::perform_training()
 
         old_loss = training_back_propagation.loss;
 
+        if(!stop_training && check_evaluation_rejection(epoch))
+        {
+            if(display) cout << "Epoch " << epoch << endl << "Training run rejected by the evaluation callback." << endl;
+
+            stop_training = true;
+
+            results.stopping_condition = StoppingCondition::EvaluationRejection;
+        }
+
         if(stop_training)
         {
             results.loss = training_back_propagation.loss;
@@ -1188,6 +1243,17 @@ void ConjugateGradient::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     file_stream.CloseElement();
 
+    // Shards number
+
+    file_stream.OpenElement("ShardsNumber");
+
+    buffer.str("");
+    buffer << shards_number;
+
+    file_stream.PushText(buffer.str().c_str());
+
+    file_stream.CloseElement();
+
     // Hardware use
 
     file_stream.OpenElement("HardwareUse");
@@ -1427,6 +1493,25 @@ void ConjugateGradient::from_XML(const tinyxml2::XMLDocument& document)
     }
 
 
+    // Shards number
+
+    element = root_element->FirstChildElement("ShardsNumber");
+
+    if(element)
+    {
+        const Index new_shards_number = static_cast<Index>(atoi(element->GetText()));
+
+        try
+        {
+            set_shards_number(new_shards_number);
+        }
+        catch(const invalid_argument& e)
+        {
+            cerr << e.what() << endl;
+        }
+    }
+
+
     // Hardware use
 
     element = root_element->FirstChildElement("HardwareUse");
@@ -81,6 +81,8 @@ public:
    const Index& get_maximum_epochs_number() const;
    const type& get_maximum_time() const;
 
+   const Index& get_shards_number() const;
+
    // Set methods
 
    void set_default() final;
@@ -104,6 +106,8 @@ public:
    void set_maximum_epochs_number(const Index&);
    void set_maximum_time(const type&);
 
+   void set_shards_number(const Index&);
+
    // Utilities
 
    virtual void set_save_period(const Index&);
@@ -177,6 +181,11 @@ private:
    /// Maximum training time. It is a stopping criterion.
 
    type maximum_time;
+
+   /// Number of shards of the training batch whose gradients are calculated concurrently.
+   /// If it is one the whole training batch is back-propagated at once.
+
+   Index shards_number = 1;
 };
 
 
@@ -111,79 +111,148 @@ void ConvolutionalLayer::insert_padding(const Tensor<type, 4>& inputs, Tensor<ty
 }
 
 
-/// Calculate convolutions
+/// Copies the receptive field of each output position of a batch of images into a row of the image patches matrix (im2col).
+/// The rows are ordered by image and then by output position.
+/// The columns follow the memory order of a kernel, so that the kernels tensor is used as a matrix without reordering.
+/// @param inputs Batch of images, with dimensions rows, columns, channels and images.
+/// @param image_patches_data Pointer to a matrix with images*outputs rows and kernel size columns.
 
-void ConvolutionalLayer::calculate_convolutions(const Tensor<type, 4>& inputs,
-                                                type* combinations) const
+void ConvolutionalLayer::calculate_image_patches(const Tensor<type, 4>& inputs, type* image_patches_data) const
 {
     const Index inputs_rows_number = inputs.dimension(0);
     const Index inputs_columns_number = inputs.dimension(1);
     const Index inputs_channels_number = inputs.dimension(2);
     const Index images_number = inputs.dimension(3);
 
-    const Index kernels_rows_number = synaptic_weights.dimension(0);
-    const Index kernels_columns_number = synaptic_weights.dimension(1);
-    const Index kernels_channels_number = synaptic_weights.dimension(2);
-    const Index kernels_number = synaptic_weights.dimension(3);
+    const Index kernels_rows_number = get_kernels_rows_number();
+    const Index kernels_columns_number = get_kernels_columns_number();
+
+    const Index outputs_rows_number = inputs_rows_number - kernels_rows_number + 1;
+    const Index outputs_columns_number = inputs_columns_number - kernels_columns_number + 1;
+    const Index outputs_size = outputs_rows_number*outputs_columns_number;
 
-#ifdef OPENNN_DEBUG
+    const Index patches_rows_number = images_number*outputs_size;
+
+    const Index next_channel = inputs_rows_number*inputs_columns_number;
+    const Index next_image = next_channel*inputs_channels_number;
 
-    const Index output_channel_number = combinations.dimension(2);
-    const Index output_images_number = combinations.dimension(3);
+    const type* inputs_data = inputs.data();
 
-    if(output_channel_number != kernels_number)
+#pragma omp parallel for
+    for(Index image_index = 0; image_index < images_number; image_index++)
     {
-        ostringstream buffer;
-        buffer << "OpenNN Exception: ConvolutionalLayer class.\n"
-               << "ConvolutionalLayer::calculate_convolutions.\n"
-               << "output_channel_number" <<output_channel_number <<"must me equal to" << kernels_number<<".\n";
+        for(Index channel_index = 0; channel_index < inputs_channels_number; channel_index++)
+        {
+            for(Index kernel_column = 0; kernel_column < kernels_columns_number; kernel_column++)
+            {
+                for(Index kernel_row = 0; kernel_row < kernels_rows_number; kernel_row++)
+                {
+                    const Index patch_column = kernel_row + kernels_rows_number*(kernel_column + kernels_columns_number*channel_index);
 
-        throw invalid_argument(buffer.str());
+                    const type* image_data = inputs_data + image_index*next_image + channel_index*next_channel
+                                           + kernel_column*inputs_rows_number + kernel_row;
+
+                    type* patch_data = image_patches_data + patch_column*patches_rows_number + image_index*outputs_size;
+
+                    for(Index output_column = 0; output_column < outputs_columns_number; output_column++)
+                    {
+                        copy(image_data + output_column*inputs_rows_number,
+                             image_data + output_column*inputs_rows_number + outputs_rows_number,
+                             patch_data + output_column*outputs_rows_number);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/// Calculates the combinations of a batch as a single product of the image patches and the kernels matrix.
+/// The product is then scattered to the combinations, which are laid out image by image.
+/// @param image_patches_data Image patches of the batch, as computed by calculate_image_patches.
+/// @param biases_data Biases, one per kernel.
+/// @param synaptic_weights_data Kernels, with dimensions rows, columns, channels and kernels.
+/// @param convolutions_data Pointer to a matrix with one row per output position and one column per kernel.
+/// @param combinations_data Pointer to the combinations.
+/// @param combinations_dimensions Dimensions of the combinations (rows, columns, kernels and images).
+
+void ConvolutionalLayer::calculate_convolutions(const type* image_patches_data,
+                                                const type* biases_data,
+                                                const type* synaptic_weights_data,
+                                                type* convolutions_data,
+                                                type* combinations_data,
+                                                const Tensor<Index, 1>& combinations_dimensions) const
+{
+    const Index outputs_size = combinations_dimensions(0)*combinations_dimensions(1);
+    const Index kernels_number = combinations_dimensions(2);
+    const Index images_number = combinations_dimensions(3);
+
+    const Index kernel_size = get_kernels_rows_number()*get_kernels_columns_number()*get_kernels_channels_number();
+
+    const Index patches_rows_number = images_number*outputs_size;
+
+    calculate_fused_combinations(image_patches_data, patches_rows_number, kernel_size,
+                                 synaptic_weights_data, kernels_number,
+                                 biases_data,
+                                 convolutions_data,
+                                 nullptr, nullptr);
+
+#pragma omp parallel for
+    for(Index image_index = 0; image_index < images_number; image_index++)
+    {
+        for(Index kernel_index = 0; kernel_index < kernels_number; kernel_index++)
+        {
+            const type* convolution_data = convolutions_data + kernel_index*patches_rows_number + image_index*outputs_size;
+
+            copy(convolution_data,
+                 convolution_data + outputs_size,
+                 combinations_data + (image_index*kernels_number + kernel_index)*outputs_size);
+        }
     }
+}
+
+
+/// Calculate convolutions
+
+void ConvolutionalLayer::calculate_convolutions(const Tensor<type, 4>& inputs,
+                                                type* combinations) const
+{
+    const Index kernels_number = get_kernels_number();
+
+    const Index outputs_rows_number = inputs.dimension(0) - get_kernels_rows_number() + 1;
+    const Index outputs_columns_number = inputs.dimension(1) - get_kernels_columns_number() + 1;
+    const Index images_number = inputs.dimension(3);
+
+#ifdef OPENNN_DEBUG
 
-    if(output_images_number != images_number)
+    if(inputs.dimension(2) != get_kernels_channels_number())
     {
         ostringstream buffer;
         buffer << "OpenNN Exception: ConvolutionalLayer class.\n"
                << "ConvolutionalLayer::calculate_convolutions.\n"
-               << "output_images_number" <<output_images_number <<"must me equal to" << images_number<<".\n";
+               << "Inputs channels number (" << inputs.dimension(2) << ") must be equal to kernels channels number (" << get_kernels_channels_number() << ").\n";
 
         throw invalid_argument(buffer.str());
     }
 
 #endif
 
-    const Index next_image = inputs_rows_number*inputs_columns_number*kernels_channels_number;
-    const Index next_kernel = kernels_rows_number*kernels_columns_number*kernels_channels_number;
-
-    const Index output_size_rows_columns = ((inputs_rows_number-kernels_rows_number)+1)*((inputs_columns_number-kernels_columns_number)+1);
+    const Index patches_rows_number = images_number*outputs_rows_number*outputs_columns_number;
 
-    const Eigen::array<ptrdiff_t, 3> dims = {0, 1, 2};
+    Tensor<type, 2> image_patches(patches_rows_number, get_kernels_rows_number()*get_kernels_columns_number()*get_kernels_channels_number());
+    Tensor<type, 2> convolutions(patches_rows_number, kernels_number);
 
-    Tensor<type, 4> inputs_pointer = inputs;
-    Tensor<type, 4> synaptic_weights_pointer = synaptic_weights; // ??
+    Tensor<Index, 1> combinations_dimensions(4);
+    combinations_dimensions.setValues({outputs_rows_number, outputs_columns_number, kernels_number, images_number});
 
-#pragma omp parallel for
-    for(int i = 0; i < images_number ;i++)
-    {
-        const TensorMap<Tensor<type, 3>> single_image(inputs_pointer.data()+i*next_image,
-                                                      inputs_rows_number,
-                                                      inputs_columns_number,
-                                                      inputs_channels_number);
-
-        for(int j = 0; j<kernels_number; j++)
-        {
-            const TensorMap<Tensor<type, 3>> single_kernel(synaptic_weights_pointer.data()+j*next_kernel,
-                                                           kernels_rows_number,
-                                                           kernels_columns_number,
-                                                           kernels_channels_number);
+    calculate_image_patches(inputs, image_patches.data());
 
-            Tensor<type, 3> tmp_result = single_image.convolve(single_kernel, dims) + biases(j);
-
-            memcpy(combinations +j*output_size_rows_columns +i*output_size_rows_columns*kernels_number,
-                   tmp_result.data(), static_cast<size_t>(output_size_rows_columns)*sizeof(float));
-        }
-    }
+    calculate_convolutions(image_patches.data(),
+                           biases.data(),
+                           synaptic_weights.data(),
+                           convolutions.data(),
+                           combinations,
+                           combinations_dimensions);
 }
 
 
@@ -192,46 +261,26 @@ void ConvolutionalLayer::calculate_convolutions(const Tensor<type, 4>& inputs,
                                                 const Tensor<type, 4>& potential_synaptic_weights,
                                                 Tensor<type, 4>& convolutions) const // old version
 {
-    const Index inputs_rows_number = inputs.dimension(0);
-    const Index inputs_columns_number = inputs.dimension(1);
-    const Index inputs_channels_number = inputs.dimension(2);
-    const Index images_number = inputs.dimension(3);
-
-    const Index kernels_rows_number = potential_synaptic_weights.dimension(0);
-    const Index kernels_columns_number = potential_synaptic_weights.dimension(1);
-    const Index kernels_channels_number = potential_synaptic_weights.dimension(2);
     const Index kernels_number = potential_synaptic_weights.dimension(3);
 
-    const Index next_image = inputs_rows_number*inputs_columns_number*inputs_channels_number;
-    const Index next_kernel = kernels_rows_number*kernels_columns_number*kernels_channels_number;
-
-    const Index output_size_rows_columns = ((inputs_rows_number-kernels_rows_number)+1)*((inputs_columns_number-kernels_columns_number)+1);
-
-    const Eigen::array<ptrdiff_t, 3> dims = {0, 1, 2};
+    const Index outputs_rows_number = inputs.dimension(0) - potential_synaptic_weights.dimension(0) + 1;
+    const Index outputs_columns_number = inputs.dimension(1) - potential_synaptic_weights.dimension(1) + 1;
+    const Index images_number = inputs.dimension(3);
 
-    Tensor<type, 4> inputs_pointer = inputs;
-    Tensor<type, 4> synaptic_weights_pointer = potential_synaptic_weights; // ??
+    const Index patches_rows_number = images_number*outputs_rows_number*outputs_columns_number;
 
-#pragma omp parallel for
-    for(int i = 0; i < images_number ;i++)
-    {
-        const TensorMap<Tensor<type, 3>> single_image(inputs_pointer.data()+i*next_image,
-                                                      inputs_rows_number,
-                                                      inputs_columns_number,
-                                                      inputs_channels_number);
-        for(int j = 0; j<kernels_number; j++)
-        {
-            const TensorMap<Tensor<type, 3>> single_kernel(synaptic_weights_pointer.data()+j*next_kernel,
-                                                           kernels_rows_number,
-                                                           kernels_columns_number,
-                                                           kernels_channels_number);
+    Tensor<type, 2> image_patches(patches_rows_number,
+                                  potential_synaptic_weights.dimension(0)*potential_synaptic_weights.dimension(1)*potential_synaptic_weights.dimension(2));
+    Tensor<type, 2> patches_convolutions(patches_rows_number, kernels_number);
 
-            Tensor<type, 3> tmp_result = single_image.convolve(single_kernel, dims) + potential_biases(j,0);
+    calculate_image_patches(inputs, image_patches.data());
 
-            memcpy(convolutions.data() +j*output_size_rows_columns +i*output_size_rows_columns*kernels_number,
-                   tmp_result.data(), static_cast<size_t>(output_size_rows_columns)*sizeof(float));
-        }
-    }
+    calculate_convolutions(image_patches.data(),
+                           potential_biases.data(),
+                           potential_synaptic_weights.data(),
+                           patches_convolutions.data(),
+                           convolutions.data(),
+                           get_dimensions(convolutions));
 }
 
 
@@ -321,10 +370,16 @@ void ConvolutionalLayer::forward_propagate(type* inputs_data,
     const TensorMap<Tensor<type, 4>> inputs(inputs_data, inputs_dimensions(0), inputs_dimensions(1), inputs_dimensions(2), inputs_dimensions(3));
     type* combinations_data = convolutional_layer_forward_propagation->get_combinations_data();
 
-    calculate_convolutions(inputs,
-                           combinations_data);
-
     const Tensor<Index, 1> combinations_dimensions = get_dimensions(convolutional_layer_forward_propagation->combinations);
+
+    calculate_image_patches(inputs, convolutional_layer_forward_propagation->image_patches.data());
+
+    calculate_convolutions(convolutional_layer_forward_propagation->image_patches.data(),
+                           biases.data(),
+                           synaptic_weights.data(),
+                           convolutional_layer_forward_propagation->convolutions.data(),
+                           combinations_data,
+                           combinations_dimensions);
     const Tensor<Index, 1> outputs_dimensions = convolutional_layer_forward_propagation->outputs_dimensions;
 
     if(switch_train) // Perform training
@@ -402,21 +457,24 @@ void ConvolutionalLayer::calculate_hidden_delta(PerceptronLayerForwardPropagatio
 }
 
 
-void ConvolutionalLayer::calculate_error_gradient(type* input_data,
+/// Calculates the biases and synaptic weights derivatives with the image patches of the forward propagation.
+/// The deltas are laid out as the combinations.
+/// They are gathered as the convolutions, so that the synaptic weights derivatives are a single matrix product.
+/// The inputs of the batch are not read, as the forward propagation already lowered them to image patches.
+/// @param forward_propagation Forward propagation of the layer, with the image patches.
+/// @param back_propagation Back propagation of the layer, with the deltas and the derivatives.
+
+void ConvolutionalLayer::calculate_error_gradient(type*,
                                                   LayerForwardPropagation* forward_propagation,
                                                   LayerBackPropagation* back_propagation) const
 {
-    const Index inputs_rows_number = get_inputs_rows_number();
-    const Index inputs_columns_number = get_inputs_columns_number();
-    const Index inputs_channels_number = get_inputs_channels_number();
-    const Index batch_samples_number =back_propagation->batch_samples_number;
-
-    const Index biases_number = get_biases_number();
+    const Index batch_samples_number = back_propagation->batch_samples_number;
 
-    const Index kernels_rows_number = get_kernels_rows_number();
-    const Index kernels_columns_number = get_kernels_columns_number();
-//    const Index kernels_channels_number = get_kernels_channels_number();
     const Index kernels_number = get_kernels_number();
+    const Index kernel_size = get_kernels_rows_number()*get_kernels_columns_number()*get_kernels_channels_number();
+
+    const Index outputs_size = get_outputs_rows_number()*get_outputs_columns_number();
+    const Index patches_rows_number = batch_samples_number*outputs_size;
 
     const ConvolutionalLayerForwardPropagation* convolutional_layer_forward_propagation =
             static_cast<ConvolutionalLayerForwardPropagation*>(forward_propagation);
@@ -424,64 +482,40 @@ void ConvolutionalLayer::calculate_error_gradient(type* input_data,
     ConvolutionalLayerBackPropagation* convolutional_layer_back_propagation =
             static_cast<ConvolutionalLayerBackPropagation*>(back_propagation);
 
-    TensorMap<Tensor<type,4>> inputs(input_data, inputs_rows_number, inputs_columns_number, inputs_channels_number, batch_samples_number);
-
-    Tensor<type,3> partial_gradient;
+    const type* deltas_data = back_propagation->deltas_data;
+    const type* activations_derivatives_data = convolutional_layer_forward_propagation->activations_derivatives.data();
 
-    Tensor<type,1> convolutional_gradient(biases_number+get_synaptic_weights_number());
-    convolutional_gradient.setZero();
-
-    const Index delta_slice_dimensions = (inputs_rows_number-kernels_rows_number+1)*(inputs_columns_number-kernels_columns_number+1);
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
-
-    const Tensor<type, 2> deltas_times_derivatives = deltas * convolutional_layer_forward_propagation->activations_derivatives;
-
-    // Biases gradient
+    type* convolutions_deltas_data = convolutional_layer_back_propagation->convolutions_deltas.data();
 
-    for(Index kernel_index = 0; kernel_index < kernels_number; kernel_index++)
+#pragma omp parallel for
+    for(Index image_index = 0; image_index < batch_samples_number; image_index++)
     {
-        Eigen::array<Eigen::Index, 2> offsets = {kernel_index, delta_slice_dimensions*kernel_index};
-        Eigen::array<Eigen::Index, 2> extents = {2, delta_slice_dimensions};
-
-        Tensor<type, 2> delta_slice = deltas_times_derivatives.slice(offsets, extents);
-
-        const Tensor<type, 0> current_sum = delta_slice.sum();
+        for(Index kernel_index = 0; kernel_index < kernels_number; kernel_index++)
+        {
+            const Index combinations_index = (image_index*kernels_number + kernel_index)*outputs_size;
+            const Index convolutions_index = kernel_index*patches_rows_number + image_index*outputs_size;
 
-        convolutional_layer_back_propagation->biases_derivatives(kernel_index) = current_sum();
+            for(Index i = 0; i < outputs_size; i++)
+            {
+                convolutions_deltas_data[convolutions_index + i]
+                        = deltas_data[combinations_index + i]*activations_derivatives_data[combinations_index + i];
+            }
+        }
     }
 
-    // Weights gradient
-
-    const Index next_image = inputs_rows_number*inputs_columns_number*inputs_channels_number;
-    const Eigen::array<ptrdiff_t, 3> dims = {0, 1, 2};
-
-    for(Index kernel_index = 0; kernel_index < kernels_number; kernel_index++)
-    {
-        for(Index image_index = 0; image_index < batch_samples_number; image_index++)
-        {
-            Eigen::array<Eigen::Index, 2> offsets = {image_index, delta_slice_dimensions*kernel_index};
-            Eigen::array<Eigen::Index, 2> extents = {1, delta_slice_dimensions};
+    // Biases gradient
 
-            Tensor<type, 2> delta_slice = deltas_times_derivatives.slice(offsets, extents);
+    convolutional_layer_back_propagation->biases_derivatives.device(*thread_pool_device) =
+            convolutional_layer_back_propagation->convolutions_deltas.sum(Eigen::array<Index, 1>({0}));
 
-            const TensorMap<Tensor<type, 3>> single_image(inputs.data()+image_index*next_image,
-                                                          inputs_rows_number,
-                                                          inputs_columns_number,
-                                                          inputs_channels_number);
+    // Weights gradient
 
-            TensorMap<Tensor<type,3>>delta_reshape(delta_slice.data(),
-                                                   inputs_rows_number - kernels_rows_number + 1,
-                                                   inputs_columns_number - kernels_columns_number + 1,
-                                                   1);
+    TensorMap<Tensor<type, 2>> synaptic_weights_derivatives(convolutional_layer_back_propagation->synaptic_weights_derivatives.data(),
+                                                            kernel_size,
+                                                            kernels_number);
 
-            if(image_index == 0) partial_gradient = single_image.convolve(delta_reshape,dims);
-            else partial_gradient += single_image.convolve(delta_reshape,dims);
-        }
-
-        memcpy(convolutional_layer_back_propagation->synaptic_weights_derivatives.data()+partial_gradient.size()*kernel_index,
-               partial_gradient.data(),
-               static_cast<size_t>(partial_gradient.size())*sizeof(float));
-    }
+    synaptic_weights_derivatives.device(*thread_pool_device) =
+            convolutional_layer_forward_propagation->image_patches.contract(convolutional_layer_back_propagation->convolutions_deltas, AT_B);
 }
 
 
@@ -817,10 +851,18 @@ void ConvolutionalLayer::set(const Tensor<Index, 1>& new_inputs_dimensions, cons
     const Index kernels_rows_number = new_kernels_dimensions[0];
 
     biases.resize(kernels_number);
-    biases.setRandom();
+
+    for(Index i = 0; i < biases.size(); i++)
+    {
+        biases(i) = calculate_random_uniform();
+    }
 
     synaptic_weights.resize(kernels_rows_number, kernels_columns_number, kernels_channels_number, kernels_number);
-    synaptic_weights.setRandom();
+
+    for(Index i = 0; i < synaptic_weights.size(); i++)
+    {
+        synaptic_weights(i) = calculate_random_uniform();
+    }
 
     input_variables_dimensions = new_inputs_dimensions;
 }
@@ -899,13 +941,22 @@ void ConvolutionalLayer::set_parameters_constant(const type& value)
 }
 
 
-/// Sets the parameters to random numbers using Eigen's setRandom.
+/// Sets the parameters to random numbers between -1 and +1, drawn from the random engine of the layer.
 
 void ConvolutionalLayer::set_parameters_random()
 {
-    biases.setRandom();
+    const type minimum = type(-1);
+    const type maximum = type(1);
+
+    for(Index i = 0; i < biases.size(); i++)
+    {
+        biases(i) = calculate_random_uniform(minimum, maximum);
+    }
 
-    synaptic_weights.setRandom();
+    for(Index i = 0; i < synaptic_weights.size(); i++)
+    {
+        synaptic_weights(i) = calculate_random_uniform(minimum, maximum);
+    }
 }
 
 
@@ -1169,6 +1220,15 @@ void ConvolutionalLayer::to_2d(const Tensor<type, 4>& input_4d, Tensor<type, 2>&
 /// See the OpenNN manual for more information about the format of this document.
 
 void ConvolutionalLayer::write_XML(tinyxml2::XMLPrinter& file_stream) const
+{
+    write_XML(file_stream, true);
+}
+
+
+/// Serializes the convolutional layer, leaving the parameters element empty if the parameters are written apart.
+/// @param write_parameters True to write the values of the parameters, false otherwise.
+
+void ConvolutionalLayer::write_XML(tinyxml2::XMLPrinter& file_stream, const bool& write_parameters) const
 {
     ostringstream buffer;
 
@@ -1242,10 +1302,13 @@ void ConvolutionalLayer::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     file_stream.OpenElement("Parameters");
 
-    buffer.str("");
-    buffer << get_parameters();
+    if(write_parameters)
+    {
+        buffer.str("");
+        buffer << get_parameters();
 
-    file_stream.PushText(buffer.str().c_str());
+        file_stream.PushText(buffer.str().c_str());
+    }
 
     file_stream.CloseElement();
 
@@ -151,6 +151,11 @@ public:
 
     // Combinations
 
+    void calculate_image_patches(const Tensor<type, 4>&, type*) const;
+
+    void calculate_convolutions(const type*, const type*, const type*,
+                                type*, type*, const Tensor<Index, 1>&) const;
+
     void calculate_convolutions(const Tensor<type, 4>&, type*) const; //change
 
     void calculate_convolutions(const Tensor<type, 4>&,
@@ -212,6 +217,7 @@ public:
 
    void from_XML(const tinyxml2::XMLDocument&) final;
    void write_XML(tinyxml2::XMLPrinter&) const final;
+   void write_XML(tinyxml2::XMLPrinter&, const bool&) const final;
 
 protected:
 
@@ -271,6 +277,14 @@ struct ConvolutionalLayerForwardPropagation : LayerForwardPropagation
 
         batch_samples_number = new_batch_samples_number;
 
+        const Index outputs_size = outputs_rows_number*outputs_columns_number;
+        const Index kernel_size = static_cast<ConvolutionalLayer*>(layer_pointer)->get_kernels_rows_number()
+                                * static_cast<ConvolutionalLayer*>(layer_pointer)->get_kernels_columns_number()
+                                * static_cast<ConvolutionalLayer*>(layer_pointer)->get_kernels_channels_number();
+
+        image_patches.resize(batch_samples_number*outputs_size, kernel_size);
+        convolutions.resize(batch_samples_number*outputs_size, kernels_number);
+
         combinations.resize(outputs_rows_number, outputs_columns_number, kernels_number, batch_samples_number);
         outputs.resize(outputs_rows_number, outputs_columns_number, kernels_number, batch_samples_number);
         activations_derivatives.resize(outputs_rows_number, outputs_columns_number, kernels_number, batch_samples_number);
@@ -305,6 +319,14 @@ struct ConvolutionalLayerForwardPropagation : LayerForwardPropagation
         return activations_derivatives.data();
     }
 
+    /// Receptive fields of all the output positions of the batch, one row per position (im2col).
+
+    Tensor<type, 2> image_patches;
+
+    /// Product of the image patches and the kernels, one row per output position and one column per kernel.
+
+    Tensor<type, 2> convolutions;
+
     Tensor<type, 4> combinations;
     Tensor<type, 4> outputs;
     Tensor<type, 4> activations_derivatives;
@@ -346,6 +368,8 @@ struct ConvolutionalLayerBackPropagation : LayerBackPropagation
 
         convolutional_delta.resize(outputs_rows_number, outputs_columns_number, kernels_number, batch_samples_number);
 
+        convolutions_deltas.resize(batch_samples_number*outputs_rows_number*outputs_columns_number, kernels_number);
+
         biases_derivatives.resize(kernels_number);
 
         synaptic_weights_derivatives.resize(kernels_number+synaptic_weights_number);
@@ -368,6 +392,10 @@ struct ConvolutionalLayerBackPropagation : LayerBackPropagation
     Tensor<type, 2> delta; // --> delete?
     Tensor<type, 4> convolutional_delta; // --> delete?
 
+    /// Deltas times activations derivatives, laid out as the convolutions of the forward propagation.
+
+    Tensor<type, 2> convolutions_deltas;
+
     Tensor<type, 1> biases_derivatives;
     Tensor<type, 1> synaptic_weights_derivatives;
 };
@@ -247,6 +247,15 @@ void CrossEntropyError::calculate_multiple_output_delta(const DataSetBatch& batc
 }
 
 
+/// Returns the coefficient of the cross-entropy error for a given number of samples.
+/// @param samples_number Number of samples in the sum of cross-entropies.
+
+type CrossEntropyError::calculate_error_coefficient(const Index& samples_number) const
+{
+    return type(1)/static_cast<type>(samples_number);
+}
+
+
 /// Returns a string with the name of the cross-entropy error loss type, "CROSS_ENTROPY_ERROR".
 
 string CrossEntropyError::get_error_type() const
@@ -60,6 +60,8 @@ public:
                                NeuralNetworkForwardPropagation&,
                                LossIndexBackPropagation&) const final;
 
+   type calculate_error_coefficient(const Index&) const final;
+
    void calculate_binary_output_delta(const DataSetBatch&,
                                       NeuralNetworkForwardPropagation&,
                                       LossIndexBackPropagation&) const;
@@ -9,6 +9,18 @@
 #include "data_set.h"
 #include "opennn_images.h"
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace  opennn;
 using namespace std;
 using namespace fs;
@@ -82,8 +94,9 @@ namespace opennn
 
 	DataSet::~DataSet()
 	{
-		delete thread_pool;
 		delete thread_pool_device;
+
+		release_mapped_data();
 	}
 
 	/// Returns true if messages from this class can be displayed on the screen,
@@ -94,6 +107,29 @@ namespace opennn
 		return display;
 	}
 
+	/// Returns true if the data set is in streaming mode, and false otherwise.
+	/// In streaming mode the data matrix is never scaled in place, and shuffled batches are drawn from windows of consecutive samples.
+
+	const bool& DataSet::get_streaming() const
+	{
+		return streaming;
+	}
+
+	/// Returns the number of consecutive samples in each shuffling window of the streaming mode.
+
+	const Index& DataSet::get_streaming_window_samples_number() const
+	{
+		return streaming_window_samples_number;
+	}
+
+	/// Returns true if the data set is in sparse inputs mode, and false otherwise.
+	/// In sparse inputs mode, the batches which request it carry their inputs as compressed sparse rows.
+
+	const bool& DataSet::get_sparse_inputs() const
+	{
+		return sparse_inputs;
+	}
+
 	/// Column default constructor
 
 	DataSet::Column::Column()
@@ -938,7 +974,7 @@ namespace opennn
 
 		time_series_data = data;
 
-		data.resize(new_samples_number, new_variables_number);
+		set_data_dimensions(new_samples_number, new_variables_number);
 
 		Index index = 0;
 
@@ -1029,7 +1065,7 @@ namespace opennn
 
 		associative_data = data;
 
-		data.resize(samples_number, new_variables_number);
+		set_data_dimensions(samples_number, new_variables_number);
 
 		// Duplicate data
 
@@ -1364,8 +1400,7 @@ namespace opennn
 	{
 		if (!shuffle) return split_samples(samples_indices, batch_samples_number);
 
-		std::random_device rng;
-		std::mt19937 urng(rng());
+		if (streaming) return get_streaming_batches(samples_indices, batch_samples_number);
 
 		const Index samples_number = samples_indices.size();
 
@@ -1394,7 +1429,7 @@ namespace opennn
 
 			// Shuffle
 
-			std::shuffle(samples_copy.data(), samples_copy.data() + samples_copy.size(), urng);
+			std::shuffle(samples_copy.data(), samples_copy.data() + samples_copy.size(), random_engine);
 
 			for (Index i = 0; i > batch_size; i++)
 			{
@@ -1449,7 +1484,7 @@ namespace opennn
 
 				for (Index j = 0; j < batch_size; j++)
 				{
-					random_index = static_cast<Index>(rand() % buffer_size);
+					random_index = uniform_int_distribution<Index>(0, buffer_size - 1)(random_engine);
 
 					batches(i, j) = buffer(random_index);
 
@@ -1471,7 +1506,7 @@ namespace opennn
 
 				if (i == batches_number - 1)
 				{
-					std::shuffle(buffer.data(), buffer.data() + buffer.size(), urng);
+					std::shuffle(buffer.data(), buffer.data() + buffer.size(), random_engine);
 
 					if (batch_size <= buffer_size)
 					{
@@ -1502,7 +1537,7 @@ namespace opennn
 
 				for (Index j = 0; j < batch_size; j++)
 				{
-					random_index = static_cast<Index>(rand() % buffer_size);
+					random_index = uniform_int_distribution<Index>(0, buffer_size - 1)(random_engine);
 
 					batches(i, j) = buffer(random_index);
 
@@ -1516,6 +1551,64 @@ namespace opennn
 		}
 	}
 
+	/// Returns a matrix with the shuffled samples of each batch in its rows, for the streaming mode.
+	/// The samples are sorted and split into windows of consecutive samples.
+	/// The order of the windows and the samples within each window are shuffled,
+	/// so that the batches of an epoch read the data file one window at a time.
+	/// @param samples_indices Indices of the samples to be split into batches.
+	/// @param batch_samples_number Number of samples in each batch.
+
+	Tensor<Index, 2> DataSet::get_streaming_batches(const Tensor<Index, 1>& samples_indices, const Index& batch_samples_number) const
+	{
+		const Index samples_number = samples_indices.size();
+
+		const Index batch_size = min(batch_samples_number, samples_number);
+
+		const Index batches_number = batch_size == 0 ? 0 : samples_number / batch_size;
+
+		Tensor<Index, 1> sorted_samples_indices(samples_indices);
+
+		sort(sorted_samples_indices.data(), sorted_samples_indices.data() + samples_number);
+
+		const Index windows_number = (samples_number + streaming_window_samples_number - 1) / streaming_window_samples_number;
+
+		vector<Index> windows(windows_number);
+
+		iota(windows.begin(), windows.end(), Index(0));
+
+		std::shuffle(windows.begin(), windows.end(), random_engine);
+
+		Tensor<Index, 1> shuffled_samples_indices(samples_number);
+
+		Index shuffled_index = 0;
+
+		for (const Index window : windows)
+		{
+			const Index window_begin = window * streaming_window_samples_number;
+			const Index window_end = min(window_begin + streaming_window_samples_number, samples_number);
+
+			Index* window_data = shuffled_samples_indices.data() + shuffled_index;
+
+			copy(sorted_samples_indices.data() + window_begin, sorted_samples_indices.data() + window_end, window_data);
+
+			std::shuffle(window_data, window_data + window_end - window_begin, random_engine);
+
+			shuffled_index += window_end - window_begin;
+		}
+
+		Tensor<Index, 2> batches(batches_number, batch_size);
+
+		for (Index i = 0; i < batches_number; i++)
+		{
+			for (Index j = 0; j < batch_size; j++)
+			{
+				batches(i, j) = shuffled_samples_indices(i * batch_size + j);
+			}
+		}
+
+		return batches;
+	}
+
 	/// Returns the number of samples in the data set which will be used for training.
 
 	Index DataSet::get_training_samples_number() const
@@ -1620,8 +1713,6 @@ namespace opennn
 
 	void DataSet::set_auto_associative_samples_uses()
 	{
-		std::random_device rng;
-		std::mt19937 urng(rng());
 
 		const Index used_samples_number = get_used_samples_number();
 
@@ -1656,7 +1747,7 @@ namespace opennn
 
 		initialize_sequential(indices, 0, 1, samples_number - 1);
 
-		std::shuffle(indices.data(), indices.data() + indices.size(), urng);
+		std::shuffle(indices.data(), indices.data() + indices.size(), random_engine);
 
 		Index count = 0;
 
@@ -1956,8 +2047,6 @@ namespace opennn
 		const type& selection_samples_ratio,
 		const type& testing_samples_ratio)
 	{
-		std::random_device rng;
-		std::mt19937 urng(rng());
 
 		const Index used_samples_number = get_used_samples_number();
 
@@ -1990,7 +2079,7 @@ namespace opennn
 
 		initialize_sequential(indices, 0, 1, samples_number - 1);
 
-		std::shuffle(indices.data(), indices.data() + indices.size(), urng);
+		std::shuffle(indices.data(), indices.data() + indices.size(), random_engine);
 
 		Index count = 0;
 
@@ -4031,12 +4120,12 @@ namespace opennn
 	/// The number of rows is equal to the number of samples.
 	/// The number of columns is equal to the number of variables.
 
-	const Tensor<type, 2>& DataSet::get_data() const
+	const TensorMap<Tensor<type, 2>>& DataSet::get_data() const
 	{
 		return data;
 	}
 
-	Tensor<type, 2>* DataSet::get_data_pointer()
+	TensorMap<Tensor<type, 2>>* DataSet::get_data_pointer()
 	{
 		return &data;
 	}
@@ -4980,7 +5069,7 @@ namespace opennn
 		Index row_index;
 		Index variable_index;
 
-		const Tensor<type, 2>& data = get_data();
+		const TensorMap<Tensor<type, 2>>& data = get_data();
 
 		for (Index i = 0; i < rows_number; i++)
 		{
@@ -4994,6 +5083,8 @@ namespace opennn
 			}
 		}
 
+		scale_batch_variables(subtensor.data(), rows_number, variables_indices);
+
 		return subtensor;
 	}
 
@@ -5004,7 +5095,7 @@ namespace opennn
 		ThreadPool* thread_pool = nullptr;
 		ThreadPoolDevice* thread_pool_device = nullptr;
 
-		data.resize(0, 0);
+		set_data_dimensions(0, 0);
 
 		samples_uses.resize(0);
 
@@ -5107,7 +5198,7 @@ namespace opennn
 
 #endif
 
-		data.resize(new_samples_number, new_variables_number);
+		set_data_dimensions(new_samples_number, new_variables_number);
 
 		columns.resize(new_variables_number);
 
@@ -5142,7 +5233,7 @@ namespace opennn
 
 		// @todo check for 4d data
 
-		data.resize(new_samples_number, new_variables_number);
+		set_data_dimensions(new_samples_number, new_variables_number);
 
 		columns.resize(new_variables_number);
 
@@ -5169,22 +5260,71 @@ namespace opennn
 	}
 
 	/// Sets the members of this data set object with those from another data set object.
+	/// The thread pool is not shared, so the copy can be used from a different thread than the original.
 	/// @param other_data_set Data set object to be copied.
 
 	void DataSet::set(const DataSet& other_data_set)
 	{
+		project_type = other_data_set.project_type;
+
 		data_file_name = other_data_set.data_file_name;
 
 		has_columns_names = other_data_set.has_columns_names;
+		has_rows_labels = other_data_set.has_rows_labels;
 
 		separator = other_data_set.separator;
+		codification = other_data_set.codification;
 
 		missing_values_label = other_data_set.missing_values_label;
+		missing_values_method = other_data_set.missing_values_method;
+		missing_values_number = other_data_set.missing_values_number;
+		columns_missing_values_number = other_data_set.columns_missing_values_number;
+		rows_missing_values_number = other_data_set.rows_missing_values_number;
+
+		set_data_dimensions(other_data_set.data.dimension(0), other_data_set.data.dimension(1));
 
 		data = other_data_set.data;
 
+		samples_uses = other_data_set.samples_uses;
+		rows_labels = other_data_set.rows_labels;
+
 		columns = other_data_set.columns;
 
+		input_variables_dimensions = other_data_set.input_variables_dimensions;
+
+		streaming = other_data_set.streaming;
+		streaming_window_samples_number = other_data_set.streaming_window_samples_number;
+		streaming_variables_scalers = other_data_set.streaming_variables_scalers;
+		streaming_variables_descriptives = other_data_set.streaming_variables_descriptives;
+
+		// Time series and auto association
+
+		time_column = other_data_set.time_column;
+		lags_number = other_data_set.lags_number;
+		steps_ahead = other_data_set.steps_ahead;
+		gmt = other_data_set.gmt;
+
+		time_series_data = other_data_set.time_series_data;
+		time_series_columns = other_data_set.time_series_columns;
+
+		associative_data = other_data_set.associative_data;
+		associative_columns = other_data_set.associative_columns;
+
+		// Text and images
+
+		text_separator = other_data_set.text_separator;
+		short_words_length = other_data_set.short_words_length;
+		long_words_length = other_data_set.long_words_length;
+		words_frequencies = other_data_set.words_frequencies;
+
+		convolutional_model = other_data_set.convolutional_model;
+		categories_number = other_data_set.categories_number;
+		images_number = other_data_set.images_number;
+		channels_number = other_data_set.channels_number;
+		image_width = other_data_set.image_width;
+		image_height = other_data_set.image_height;
+		padding = other_data_set.padding;
+
 		display = other_data_set.display;
 	}
 
@@ -5216,6 +5356,54 @@ namespace opennn
 		display = new_display;
 	}
 
+	/// Sets the streaming mode, meant for memory-mapped data sets larger than the main memory.
+	/// In streaming mode, scale_input_variables and scale_target_variables do not modify the data matrix.
+	/// They only compute the descriptives, and the scaling is applied to each batch when it is filled.
+	/// Shuffled batches are drawn from windows of consecutive samples, so that each part of the data file is read once per epoch.
+	/// @param new_streaming True to set the streaming mode, false otherwise.
+
+	void DataSet::set_streaming(const bool& new_streaming)
+	{
+		streaming = new_streaming;
+
+		streaming_variables_scalers.resize(0);
+		streaming_variables_descriptives.resize(0);
+	}
+
+	/// Sets the number of consecutive samples in each shuffling window of the streaming mode.
+	/// It bounds the part of the data which is read at the same time during an epoch.
+	/// @param new_streaming_window_samples_number Number of samples in each window.
+
+	void DataSet::set_streaming_window_samples_number(const Index& new_streaming_window_samples_number)
+	{
+		if (new_streaming_window_samples_number < 1)
+		{
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSet class.\n"
+				<< "void set_streaming_window_samples_number(const Index&) method.\n"
+				<< "Number of samples in each window (" << new_streaming_window_samples_number << ") must be greater than 0.\n";
+
+			throw invalid_argument(buffer.str());
+		}
+
+		streaming_window_samples_number = new_streaming_window_samples_number;
+	}
+
+	/// Sets the sparse inputs mode, meant for data sets whose inputs are mostly zero, such as word bags.
+	/// The batches which request it carry their inputs in compressed sparse row format,
+	/// built from the rows of the data matrix, and the first perceptron layer multiplies only the non zero inputs.
+	/// This saves the operations of the first layer and the memory of the batches, but not the memory of the data set,
+	/// which keeps the dense data matrix, as its columns, statistics and scaling are indexed by variable.
+	/// The input scalers must keep the zeros, such as the standard deviation one. read_txt() sets it on the word columns
+	/// if this mode is set before, and the mode is saved in the data set XML.
+	/// @param new_sparse_inputs True to set the sparse inputs mode, false otherwise.
+
+	void DataSet::set_sparse_inputs(const bool& new_sparse_inputs)
+	{
+		sparse_inputs = new_sparse_inputs;
+	}
+
 	/// Sets the default member values:
 	/// <ul>
 	/// <li> Display: True.
@@ -5223,12 +5411,9 @@ namespace opennn
 
 	void DataSet::set_default()
 	{
-		delete thread_pool;
 		delete thread_pool_device;
 
-		const int n = omp_get_max_threads();
-		thread_pool = new ThreadPool(n);
-		thread_pool_device = new ThreadPoolDevice(thread_pool, n);
+		thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device();
 
 		has_columns_names = false;
 
@@ -5650,11 +5835,17 @@ namespace opennn
 
 	void DataSet::set_threads_number(const int& new_threads_number)
 	{
-		if (thread_pool != nullptr) delete thread_pool;
 		if (thread_pool_device != nullptr) delete thread_pool_device;
 
-		thread_pool = new ThreadPool(new_threads_number);
-		thread_pool_device = new ThreadPoolDevice(thread_pool, new_threads_number);
+		thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device(new_threads_number);
+	}
+
+	/// Seeds the random engine used for batches shuffling and random samples splitting.
+	/// @param new_random_seed Seed for the random engine.
+
+	void DataSet::set_random_seed(const unsigned& new_random_seed)
+	{
+		random_engine.seed(new_random_seed);
 	}
 
 	/// Sets a new number of samples in the data set.
@@ -5708,7 +5899,10 @@ namespace opennn
 	}
 
 	/// Removes the training, selection and testing indices of that samples which are repeated in the data matrix.
+	/// Every sample equal to a previous one is set as unused, and the first sample of each group of equal samples is kept.
+	/// The rows are hashed in parallel and only the samples with the same hash are compared, so that the run time is near linear.
 	/// It might change the size of the vectors containing the training, selection and testing indices.
+	/// Returns the indices of the samples set as unused, grouped by the first sample which they repeat.
 
 	Tensor<Index, 1> DataSet::unuse_repeated_samples()
 	{
@@ -5729,29 +5923,134 @@ namespace opennn
 
 #endif
 
-		Tensor<Index, 1> repeated_samples(0);
+		const TensorMap<Tensor<type, 2>>& data = get_data();
+
+		const Index variables_number = data.dimension(1);
+
+		// Hash the rows column by column. Negative zero is hashed as zero, because both compare equal.
+		// Rows with NAN values are never equal to other rows, so they are not hashed.
+
+		vector<uint64_t> rows_hashes(static_cast<size_t>(samples_number), 14695981039346656037ULL);
+		vector<char> rows_have_nan(static_cast<size_t>(samples_number), 0);
+
+		for (Index j = 0; j < variables_number; j++)
+		{
+			const type* column_data = data.data() + j * samples_number;
+
+#pragma omp parallel for
+			for (Index i = 0; i < samples_number; i++)
+			{
+				const type value = column_data[i] + type(0);
+
+				if (isnan(value))
+				{
+					rows_have_nan[i] = 1;
+
+					continue;
+				}
+
+				uint64_t bits = 0;
+				memcpy(&bits, &value, sizeof(type));
 
-		Tensor<type, 1> sample_i;
-		Tensor<type, 1> sample_j;
+				rows_hashes[i] = (rows_hashes[i] ^ bits) * 1099511628211ULL;
+			}
+		}
+
+		// Bucket the rows by sorting them by hash
+
+		vector<Index> sorted_samples;
+		sorted_samples.reserve(static_cast<size_t>(samples_number));
 
 		for (Index i = 0; i < samples_number; i++)
 		{
-			sample_i = get_sample_data(i);
+			if (!rows_have_nan[i]) sorted_samples.push_back(i);
+		}
+
+		sort(sorted_samples.begin(), sorted_samples.end(), [&](const Index& a, const Index& b)
+			{
+				return rows_hashes[a] != rows_hashes[b] ? rows_hashes[a] < rows_hashes[b] : a < b;
+			});
+
+		vector<Index> buckets_begins;
+
+		for (size_t k = 0; k < sorted_samples.size(); k++)
+		{
+			if (k == 0 || rows_hashes[sorted_samples[k]] != rows_hashes[sorted_samples[k - 1]]) buckets_begins.push_back(static_cast<Index>(k));
+		}
+
+		buckets_begins.push_back(static_cast<Index>(sorted_samples.size()));
+
+		// Compare exactly the rows inside each bucket. Each row is matched with the first equal row, if any.
+
+		const auto rows_equal = [&](const Index& a, const Index& b)
+		{
+			for (Index j = 0; j < variables_number; j++)
+			{
+				if (data(a, j) != data(b, j)) return false;
+			}
+
+			return true;
+		};
+
+		vector<Index> first_equal_samples(static_cast<size_t>(samples_number), -1);
+
+		const Index buckets_number = static_cast<Index>(buckets_begins.size()) - 1;
+
+#pragma omp parallel for schedule(dynamic)
+		for (Index bucket = 0; bucket < buckets_number; bucket++)
+		{
+			const Index bucket_begin = buckets_begins[bucket];
+			const Index bucket_end = buckets_begins[bucket + 1];
+
+			if (bucket_end - bucket_begin < 2) continue;
+
+			vector<Index> first_samples;
 
-			for (Index j = static_cast<Index>(i + 1); j < samples_number; j++)
+			for (Index k = bucket_begin; k < bucket_end; k++)
 			{
-				sample_j = get_sample_data(j);
+				const Index sample_index = sorted_samples[k];
 
-				if (get_sample_use(j) != SampleUse::Unused
-					&& equal(sample_i.data(), sample_i.data() + sample_i.size(), sample_j.data()))
+				bool is_repeated = false;
+
+				for (const Index& first_sample : first_samples)
 				{
-					set_sample_use(j, SampleUse::Unused);
+					if (rows_equal(first_sample, sample_index))
+					{
+						first_equal_samples[sample_index] = first_sample;
 
-					repeated_samples = push_back(repeated_samples, j);
+						is_repeated = true;
+
+						break;
+					}
 				}
+
+				if (!is_repeated) first_samples.push_back(sample_index);
+			}
+		}
+
+		// Samples already unused are not returned
+
+		vector<pair<Index, Index>> repeated_pairs;
+
+		for (Index i = 0; i < samples_number; i++)
+		{
+			if (first_equal_samples[i] != -1 && get_sample_use(i) != SampleUse::Unused)
+			{
+				repeated_pairs.push_back(make_pair(first_equal_samples[i], i));
 			}
 		}
 
+		sort(repeated_pairs.begin(), repeated_pairs.end());
+
+		Tensor<Index, 1> repeated_samples(static_cast<Index>(repeated_pairs.size()));
+
+		for (Index i = 0; i < repeated_samples.size(); i++)
+		{
+			repeated_samples(i) = repeated_pairs[i].second;
+
+			set_sample_use(repeated_samples(i), SampleUse::Unused);
+		}
+
 		return repeated_samples;
 	}
 
@@ -6456,7 +6755,13 @@ namespace opennn
 
 		const Tensor<Index, 1> target_variables_indices = get_target_variables_indices();
 
-		return mean(data, used_indices, target_variables_indices);
+		Tensor<type, 1> targets_mean = mean(data, used_indices, target_variables_indices);
+
+		// In streaming mode the data matrix is not scaled, so the means are scaled here.
+
+		scale_batch_variables(targets_mean.data(), 1, target_variables_indices);
+
+		return targets_mean;
 	}
 
 	/// Returns the mean values of the target variables on the selection
@@ -6467,7 +6772,11 @@ namespace opennn
 
 		const Tensor<Index, 1> target_variables_indices = get_target_variables_indices();
 
-		return mean(data, selection_indices, target_variables_indices);
+		Tensor<type, 1> targets_mean = mean(data, selection_indices, target_variables_indices);
+
+		scale_batch_variables(targets_mean.data(), 1, target_variables_indices);
+
+		return targets_mean;
 	}
 
 	/// Returns the value of the gmt that has the data set, by default it is 0.
@@ -6937,6 +7246,13 @@ namespace opennn
 
 		const Tensor<Descriptives, 1> input_variables_descriptives = calculate_input_variables_descriptives();
 
+		if (streaming)
+		{
+			set_streaming_variables_scalers(input_variables_indices, input_variables_scalers, input_variables_descriptives);
+
+			return input_variables_descriptives;
+		}
+
 		for (Index i = 0; i < input_variables_number; i++)
 		{
 			switch (input_variables_scalers(i))
@@ -7007,6 +7323,13 @@ namespace opennn
 
 		const Tensor<Descriptives, 1> target_variables_descriptives = calculate_target_variables_descriptives();
 
+		if (streaming)
+		{
+			set_streaming_variables_scalers(target_variables_indices, target_variables_scalers, target_variables_descriptives);
+
+			return target_variables_descriptives;
+		}
+
 		for (Index i = 0; i < target_variables_number; i++)
 		{
 			switch (target_variables_scalers(i))
@@ -7058,6 +7381,15 @@ namespace opennn
 
 		const Tensor<Scaler, 1> input_variables_scalers = get_input_variables_scalers();
 
+		if (streaming)
+		{
+			set_streaming_variables_scalers(input_variables_indices,
+				Tensor<Scaler, 1>(input_variables_number).setConstant(Scaler::NoScaling),
+				input_variables_descriptives);
+
+			return;
+		}
+
 		for (Index i = 0; i < input_variables_number; i++)
 		{
 			switch (input_variables_scalers(i))
@@ -7105,6 +7437,15 @@ namespace opennn
 		const Tensor<Index, 1> target_variables_indices = get_target_variables_indices();
 		const Tensor<Scaler, 1> target_variables_scalers = get_target_variables_scalers();
 
+		if (streaming)
+		{
+			set_streaming_variables_scalers(target_variables_indices,
+				Tensor<Scaler, 1>(target_variables_number).setConstant(Scaler::NoScaling),
+				targets_descriptives);
+
+			return;
+		}
+
 		for (Index i = 0; i < target_variables_number; i++)
 		{
 			switch (target_variables_scalers(i))
@@ -7138,6 +7479,101 @@ namespace opennn
 		}
 	}
 
+	/// Scales the variables of a batch with the scalers and descriptives set by scale_input_variables and scale_target_variables
+	/// in streaming mode. It does nothing if the data set is not in streaming mode.
+	/// @param batch_data Pointer to the batch matrix, with the samples in its rows and the variables in its columns.
+	/// @param batch_samples_number Number of samples in the batch.
+	/// @param variables_indices Indices of the variables in the columns of the batch.
+
+	void DataSet::scale_batch_variables(type* batch_data, const Index& batch_samples_number, const Tensor<Index, 1>& variables_indices) const
+	{
+		if (!streaming || streaming_variables_scalers.size() == 0) return;
+
+		const Index variables_number = variables_indices.size();
+
+		TensorMap<Tensor<type, 2>> batch(batch_data, batch_samples_number, variables_number);
+
+		for (Index j = 0; j < variables_number; j++)
+		{
+			const Index variable_index = variables_indices(j);
+
+			if (variable_index >= streaming_variables_scalers.size()) continue;
+
+			const Descriptives& variable_descriptives = streaming_variables_descriptives(variable_index);
+
+			switch (streaming_variables_scalers(variable_index))
+			{
+			case Scaler::NoScaling:
+				break;
+
+			case Scaler::MinimumMaximum:
+				scale_minimum_maximum(batch, j, variable_descriptives);
+				break;
+
+			case Scaler::MeanStandardDeviation:
+				scale_mean_standard_deviation(batch, j, variable_descriptives);
+				break;
+
+			case Scaler::StandardDeviation:
+				scale_standard_deviation(batch, j, variable_descriptives);
+				break;
+
+			case Scaler::Logarithm:
+			{
+				// The offset is taken from the descriptives, as a batch does not contain the whole column.
+
+				const type offset = variable_descriptives.minimum <= type(0)
+					? abs(variable_descriptives.minimum) + type(1) + NUMERIC_LIMITS_MIN
+					: type(0);
+
+				for (Index i = 0; i < batch_samples_number; i++)
+				{
+					batch(i, j) = log(batch(i, j) + offset);
+				}
+
+				break;
+			}
+
+			default:
+			{
+				ostringstream buffer;
+
+				buffer << "OpenNN Exception: DataSet class\n"
+					<< "void scale_batch_variables(type*, const Index&, const Tensor<Index, 1>&) const method.\n"
+					<< "Unknown scaling and unscaling method: " << int(streaming_variables_scalers(variable_index)) << "\n";
+
+				throw invalid_argument(buffer.str());
+			}
+			}
+		}
+	}
+
+	/// Sets the scalers and descriptives which are applied to the given variables of the batches in streaming mode.
+	/// @param variables_indices Indices of the variables.
+	/// @param variables_scalers Scaler of each variable.
+	/// @param variables_descriptives Descriptives of each variable.
+
+	void DataSet::set_streaming_variables_scalers(const Tensor<Index, 1>& variables_indices,
+		const Tensor<Scaler, 1>& variables_scalers,
+		const Tensor<Descriptives, 1>& variables_descriptives)
+	{
+		const Index variables_number = get_variables_number();
+
+		if (streaming_variables_scalers.size() != variables_number)
+		{
+			streaming_variables_scalers.resize(variables_number);
+			streaming_variables_scalers.setConstant(Scaler::NoScaling);
+
+			streaming_variables_descriptives.resize(variables_number);
+		}
+
+		for (Index i = 0; i < variables_indices.size(); i++)
+		{
+			streaming_variables_scalers(variables_indices(i)) = variables_scalers(i);
+			streaming_variables_descriptives(variables_indices(i)) = variables_descriptives(i);
+		}
+	}
+
 	/// Initializes the data matrix with a given value.
 	/// @param new_value Initialization value.
 
@@ -7465,6 +7901,17 @@ namespace opennn
 
 		file_stream.CloseElement();
 
+		// Sparse inputs
+
+		if (sparse_inputs)
+		{
+			file_stream.OpenElement("SparseInputs");
+
+			file_stream.PushText("1");
+
+			file_stream.CloseElement();
+		}
+
 		// Close DataFile
 
 		file_stream.CloseElement();
@@ -8108,6 +8555,20 @@ namespace opennn
 			}
 		}
 
+		// Sparse inputs
+
+		const tinyxml2::XMLElement* sparse_inputs_element = data_file_element->FirstChildElement("SparseInputs");
+
+		if (sparse_inputs_element)
+		{
+			if (sparse_inputs_element->GetText())
+			{
+				const string new_sparse_inputs_string = sparse_inputs_element->GetText();
+
+				set_sparse_inputs(new_sparse_inputs_string != "0");
+			}
+		}
+
 		// Columns
 
 		const tinyxml2::XMLElement* columns_element = data_set_element->FirstChildElement("Columns");
@@ -9279,7 +9740,7 @@ namespace opennn
 
 		type value;
 
-		data.resize(rows_number, columns_number);
+		set_data_dimensions(rows_number, columns_number);
 
 		for (Index i = 0; i < rows_number * columns_number; i++)
 		{
@@ -9376,15 +9837,475 @@ namespace opennn
 		file.close();
 	}
 
-	/// This method checks if the input data file has the correct format. Returns an error message.
+	/// Signature, version and data alignment of the memory-mapped data file format.
 
-	void DataSet::check_input_csv(const string& input_data_file_name, const char& separator_char) const
-	{
-		std::ifstream file(input_data_file_name.c_str());
+	static const char mapped_data_file_signature[8] = { 'O', 'P', 'N', 'N', 'D', 'A', 'T', 'A' };
 
-		if (!file.is_open())
-		{
-			ostringstream buffer;
+	static const Index mapped_data_file_version = 1;
+
+	static const Index mapped_data_alignment = 4096;
+
+	/// Maps a whole file into memory. The mapping is private, so writes to it are never written back to the file.
+	/// Returns nullptr if the file cannot be opened or mapped, or if it is empty.
+	/// @param file_name Name of the file.
+	/// @param file_size Size of the file in bytes.
+
+	static void* map_file(const string& file_name, size_t& file_size)
+	{
+		void* address = nullptr;
+
+#ifdef _WIN32
+
+		std::wstring_convert<std::codecvt_utf8<wchar_t>> conv;
+
+		const HANDLE file_handle = CreateFileW(conv.from_bytes(file_name).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (file_handle != INVALID_HANDLE_VALUE)
+		{
+			LARGE_INTEGER file_size_integer;
+
+			const HANDLE mapping_handle = GetFileSizeEx(file_handle, &file_size_integer) && file_size_integer.QuadPart > 0
+				? CreateFileMappingW(file_handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr)
+				: nullptr;
+
+			if (mapping_handle != nullptr)
+			{
+				address = MapViewOfFile(mapping_handle, FILE_MAP_COPY, 0, 0, 0);
+				file_size = static_cast<size_t>(file_size_integer.QuadPart);
+
+				CloseHandle(mapping_handle);
+			}
+
+			CloseHandle(file_handle);
+		}
+
+#else
+
+		const int file_descriptor = open(file_name.c_str(), O_RDONLY);
+
+		if (file_descriptor >= 0)
+		{
+			struct stat file_status;
+
+			if (fstat(file_descriptor, &file_status) == 0 && file_status.st_size > 0)
+			{
+				file_size = static_cast<size_t>(file_status.st_size);
+
+				address = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file_descriptor, 0);
+
+				if (address == MAP_FAILED) address = nullptr;
+			}
+
+			close(file_descriptor);
+		}
+
+#endif
+
+		return address;
+	}
+
+	/// Unmaps a file mapped with map_file.
+
+	static void unmap_file(void* address, const size_t& file_size)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(address);
+#else
+		munmap(address, file_size);
+#endif
+	}
+
+	/// Saves the data matrix and its metadata to a file which can be memory-mapped with load_data_mapped.
+	/// The file starts with a versioned header holding the dimensions of the data and the columns (names, uses, types, scalers and categories).
+	/// It is followed by the samples uses, which can be rewritten in place with save_data_mapped_samples_uses,
+	/// and by the data matrix stored by columns and aligned to a page boundary.
+	/// @param new_mapped_data_file_name Name of the memory-mapped data file. It must not be the file currently mapped by this data set.
+
+	void DataSet::save_data_mapped(const string& new_mapped_data_file_name) const
+	{
+		if (has_mapped_data() && new_mapped_data_file_name == mapped_data_file_name)
+		{
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSet class.\n"
+				<< "void save_data_mapped(const string&) const method.\n"
+				<< "Cannot overwrite the memory-mapped data file: " << new_mapped_data_file_name << "\n";
+
+			throw invalid_argument(buffer.str());
+		}
+
+		std::ofstream file(new_mapped_data_file_name.c_str(), ios::binary);
+
+		if (!file.is_open())
+		{
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSet class.\n"
+				<< "void save_data_mapped(const string&) const method.\n"
+				<< "Cannot open mapped data file: " << new_mapped_data_file_name << "\n";
+
+			throw invalid_argument(buffer.str());
+		}
+
+		const auto write_index = [&file](const Index& value)
+		{
+			file.write(reinterpret_cast<const char*>(&value), sizeof(Index));
+		};
+
+		const auto write_string = [&file, &write_index](const string& value)
+		{
+			write_index(static_cast<Index>(value.size()));
+			file.write(value.data(), static_cast<streamsize>(value.size()));
+		};
+
+		const Index samples_number = data.dimension(0);
+		const Index variables_number = data.dimension(1);
+
+		// Header
+
+		file.write(mapped_data_file_signature, sizeof(mapped_data_file_signature));
+
+		write_index(mapped_data_file_version);
+		write_index(static_cast<Index>(sizeof(type)));
+		write_index(samples_number);
+		write_index(variables_number);
+
+		const streamoff offsets_position = file.tellp();
+
+		write_index(0);
+		write_index(0);
+
+		// Columns
+
+		write_index(columns.size());
+
+		for (Index i = 0; i < columns.size(); i++)
+		{
+			write_string(columns(i).name);
+			write_index(static_cast<Index>(columns(i).column_use));
+			write_index(static_cast<Index>(columns(i).type));
+			write_index(static_cast<Index>(columns(i).scaler));
+
+			write_index(columns(i).categories.size());
+
+			for (Index j = 0; j < columns(i).categories.size(); j++)
+			{
+				write_string(columns(i).categories(j));
+				write_index(j < columns(i).categories_uses.size() ? static_cast<Index>(columns(i).categories_uses(j)) : static_cast<Index>(VariableUse::Unused));
+			}
+		}
+
+		write_index(input_variables_dimensions.size());
+
+		for (Index i = 0; i < input_variables_dimensions.size(); i++)
+		{
+			write_index(input_variables_dimensions(i));
+		}
+
+		// Samples uses
+
+		const Index samples_uses_offset = static_cast<Index>(file.tellp());
+
+		for (Index i = 0; i < samples_number; i++)
+		{
+			const char sample_use = static_cast<char>(i < samples_uses.size() ? samples_uses(i) : SampleUse::Unused);
+
+			file.write(&sample_use, 1);
+		}
+
+		// Data, aligned so that the mapped matrix starts on a page boundary
+
+		const Index data_offset = (samples_uses_offset + samples_number + mapped_data_alignment - 1) / mapped_data_alignment * mapped_data_alignment;
+
+		const string padding(static_cast<size_t>(data_offset - samples_uses_offset - samples_number), '\0');
+
+		file.write(padding.data(), static_cast<streamsize>(padding.size()));
+
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<streamsize>(samples_number * variables_number * sizeof(type)));
+
+		file.seekp(offsets_position);
+
+		write_index(samples_uses_offset);
+		write_index(data_offset);
+
+		if (!file)
+		{
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSet class.\n"
+				<< "void save_data_mapped(const string&) const method.\n"
+				<< "Cannot write mapped data file: " << new_mapped_data_file_name << "\n";
+
+			throw invalid_argument(buffer.str());
+		}
+
+		file.close();
+	}
+
+	/// Rewrites the samples uses of a memory-mapped data file in place, without rewriting the data matrix.
+	/// The number of samples in the file must be equal to the number of samples in this data set.
+	/// @param new_mapped_data_file_name File previously written with save_data_mapped.
+
+	void DataSet::save_data_mapped_samples_uses(const string& new_mapped_data_file_name) const
+	{
+		std::fstream file(new_mapped_data_file_name.c_str(), ios::binary | ios::in | ios::out);
+
+		if (!file.is_open())
+		{
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSet class.\n"
+				<< "void save_data_mapped_samples_uses(const string&) const method.\n"
+				<< "Cannot open mapped data file: " << new_mapped_data_file_name << "\n";
+
+			throw invalid_argument(buffer.str());
+		}
+
+		char signature[sizeof(mapped_data_file_signature)];
+
+		Index header[6];
+
+		file.read(signature, sizeof(signature));
+		file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+		const Index samples_number = samples_uses.size();
+
+		if (!file
+			|| memcmp(signature, mapped_data_file_signature, sizeof(signature)) != 0
+			|| header[0] != mapped_data_file_version
+			|| header[2] != samples_number)
+		{
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSet class.\n"
+				<< "void save_data_mapped_samples_uses(const string&) const method.\n"
+				<< "File is not a mapped data file with " << samples_number << " samples: " << new_mapped_data_file_name << "\n";
+
+			throw invalid_argument(buffer.str());
+		}
+
+		string new_samples_uses(static_cast<size_t>(samples_number), '\0');
+
+		for (Index i = 0; i < samples_number; i++)
+		{
+			new_samples_uses[static_cast<size_t>(i)] = static_cast<char>(samples_uses(i));
+		}
+
+		file.seekp(static_cast<streamoff>(header[4]));
+
+		file.write(new_samples_uses.data(), static_cast<streamsize>(new_samples_uses.size()));
+
+		file.close();
+	}
+
+	/// Memory-maps a data file written with save_data_mapped and uses it as the data matrix, without reading it into memory.
+	/// The columns, samples uses and input variables dimensions are set from the file.
+	/// The mapping is private: changes to the data matrix, such as scaling, are never written back to the file.
+	/// @param new_mapped_data_file_name Name of the memory-mapped data file.
+
+	void DataSet::load_data_mapped(const string& new_mapped_data_file_name)
+	{
+		size_t new_mapped_data_size = 0;
+
+		void* new_mapped_data_address = map_file(new_mapped_data_file_name, new_mapped_data_size);
+
+		if (new_mapped_data_address == nullptr)
+		{
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSet class.\n"
+				<< "void load_data_mapped(const string&) method.\n"
+				<< "Cannot map data file: " << new_mapped_data_file_name << "\n";
+
+			throw invalid_argument(buffer.str());
+		}
+
+		const char* file_begin = static_cast<const char*>(new_mapped_data_address);
+		const char* file_end = file_begin + new_mapped_data_size;
+		const char* position = file_begin;
+
+		const auto throw_invalid_file = [&]()
+		{
+			unmap_file(new_mapped_data_address, new_mapped_data_size);
+
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSet class.\n"
+				<< "void load_data_mapped(const string&) method.\n"
+				<< "Invalid mapped data file: " << new_mapped_data_file_name << "\n";
+
+			throw invalid_argument(buffer.str());
+		};
+
+		const auto read_index = [&]()
+		{
+			if (file_end - position < static_cast<ptrdiff_t>(sizeof(Index))) throw_invalid_file();
+
+			Index value;
+			memcpy(&value, position, sizeof(Index));
+			position += sizeof(Index);
+
+			return value;
+		};
+
+		const auto read_string = [&]()
+		{
+			const Index size = read_index();
+
+			if (size < 0 || file_end - position < size) throw_invalid_file();
+
+			const string value(position, static_cast<size_t>(size));
+			position += size;
+
+			return value;
+		};
+
+		// Header
+
+		if (new_mapped_data_size < sizeof(mapped_data_file_signature)
+			|| memcmp(position, mapped_data_file_signature, sizeof(mapped_data_file_signature)) != 0)
+		{
+			throw_invalid_file();
+		}
+
+		position += sizeof(mapped_data_file_signature);
+
+		const Index version = read_index();
+		const Index type_size = read_index();
+		const Index samples_number = read_index();
+		const Index variables_number = read_index();
+		const Index samples_uses_offset = read_index();
+		const Index data_offset = read_index();
+
+		if (version != mapped_data_file_version
+			|| type_size != static_cast<Index>(sizeof(type))
+			|| samples_number < 0
+			|| variables_number < 0
+			|| samples_uses_offset < 0
+			|| data_offset % static_cast<Index>(alignof(type)) != 0
+			|| samples_uses_offset + samples_number > data_offset
+			|| static_cast<size_t>(data_offset) + static_cast<size_t>(samples_number * variables_number) * sizeof(type) > new_mapped_data_size)
+		{
+			throw_invalid_file();
+		}
+
+		// Columns
+
+		const Index new_columns_number = read_index();
+
+		if (new_columns_number < 0) throw_invalid_file();
+
+		Tensor<Column, 1> new_columns(new_columns_number);
+
+		for (Index i = 0; i < new_columns_number; i++)
+		{
+			new_columns(i).name = read_string();
+			new_columns(i).column_use = static_cast<VariableUse>(read_index());
+			new_columns(i).type = static_cast<ColumnType>(read_index());
+			new_columns(i).scaler = static_cast<Scaler>(read_index());
+
+			const Index categories_number = read_index();
+
+			if (categories_number < 0) throw_invalid_file();
+
+			new_columns(i).categories.resize(categories_number);
+			new_columns(i).categories_uses.resize(categories_number);
+
+			for (Index j = 0; j < categories_number; j++)
+			{
+				new_columns(i).categories(j) = read_string();
+				new_columns(i).categories_uses(j) = static_cast<VariableUse>(read_index());
+			}
+		}
+
+		const Index input_variables_rank = read_index();
+
+		if (input_variables_rank < 0) throw_invalid_file();
+
+		Tensor<Index, 1> new_input_variables_dimensions(input_variables_rank);
+
+		for (Index i = 0; i < input_variables_rank; i++)
+		{
+			new_input_variables_dimensions(i) = read_index();
+		}
+
+		// Samples uses
+
+		Tensor<SampleUse, 1> new_samples_uses(samples_number);
+
+		for (Index i = 0; i < samples_number; i++)
+		{
+			new_samples_uses(i) = static_cast<SampleUse>(file_begin[samples_uses_offset + i]);
+		}
+
+		// Data
+
+		release_mapped_data();
+
+		data_storage.resize(0, 0);
+
+		mapped_data_file_name = new_mapped_data_file_name;
+		mapped_data_address = new_mapped_data_address;
+		mapped_data_size = new_mapped_data_size;
+
+		new (&data) TensorMap<Tensor<type, 2>>(reinterpret_cast<type*>(static_cast<char*>(new_mapped_data_address) + data_offset), samples_number, variables_number);
+
+		columns = new_columns;
+		samples_uses = new_samples_uses;
+		input_variables_dimensions = new_input_variables_dimensions;
+
+		rows_labels.resize(0);
+	}
+
+	/// Copies a memory-mapped data matrix into memory and releases the mapping.
+	/// It does nothing if the data is not memory-mapped.
+
+	void DataSet::unmap_data()
+	{
+		if (!has_mapped_data()) return;
+
+		data_storage = data;
+
+		release_mapped_data();
+	}
+
+	/// Resizes the in-memory data matrix, releasing the memory-mapped data file, if any.
+	/// The contents of the data matrix are undefined after this call.
+
+	void DataSet::set_data_dimensions(const Index& new_samples_number, const Index& new_variables_number)
+	{
+		release_mapped_data();
+
+		data_storage.resize(new_samples_number, new_variables_number);
+
+		new (&data) TensorMap<Tensor<type, 2>>(data_storage.data(), new_samples_number, new_variables_number);
+	}
+
+	/// Unmaps the memory-mapped data file, if any, and points the data matrix back to the in-memory storage.
+
+	void DataSet::release_mapped_data()
+	{
+		if (mapped_data_address != nullptr)
+		{
+			unmap_file(mapped_data_address, mapped_data_size);
+
+			mapped_data_file_name.clear();
+			mapped_data_address = nullptr;
+			mapped_data_size = 0;
+		}
+
+		new (&data) TensorMap<Tensor<type, 2>>(data_storage.data(), data_storage.dimension(0), data_storage.dimension(1));
+	}
+
+	/// This method checks if the input data file has the correct format. Returns an error message.
+
+	void DataSet::check_input_csv(const string& input_data_file_name, const char& separator_char) const
+	{
+		std::ifstream file(input_data_file_name.c_str());
+
+		if (!file.is_open())
+		{
+			ostringstream buffer;
 
 			buffer << "OpenNN Exception: DataSet class.\n"
 				<< "void check_input_csv() method.\n"
@@ -10155,7 +11076,11 @@ namespace opennn
 		return neighbors_indices;
 	}
 
-	Tensor<Tensor<type, 1>, 1> DataSet::get_kd_tree_data() const
+	/// Returns the input variables of the used samples, with one sample per column.
+	/// The values of each sample are contiguous, so that the distances in the kd-tree are computed over consecutive memory.
+	/// It is also used to build and score the isolation forest.
+
+	Tensor<type, 2> DataSet::get_kd_tree_data() const
 	{
 		const Index used_samples_number = get_used_samples_number();
 		const Index input_variables_number = get_input_variables_number();
@@ -10163,132 +11088,283 @@ namespace opennn
 		const Tensor<Index, 1> used_samples_indices = get_used_samples_indices();
 		const Tensor<Index, 1> input_variables_indices = get_input_variables_indices();
 
-		Tensor<Tensor<type, 1>, 1> kd_tree_data(used_samples_number);
+		Tensor<type, 2> kd_tree_data(input_variables_number, used_samples_number);
 
+#pragma omp parallel for
 		for (Index i = 0; i < used_samples_number; i++)
 		{
-			kd_tree_data(i) = Tensor<type, 1>(input_variables_number + 1);
-
-			kd_tree_data(i)(0) = type(used_samples_indices(i)); // Storing index
-
 			for (Index j = 0; j < input_variables_number; j++)
-				kd_tree_data(i)(j + 1) = data(used_samples_indices(i), input_variables_indices(j));
+				kd_tree_data(j, i) = data(used_samples_indices(i), input_variables_indices(j));
 		}
 
 		return kd_tree_data;
 	}
 
-	Tensor<Tensor<Index, 1>, 1> DataSet::create_bounding_limits_kd_tree(const Index& depth) const
+	/// Returns the first and last positions of the samples of every node of a balanced kd-tree over the used samples.
+	/// The nodes are stored as a complete binary tree, where the children of node i are the nodes 2i+1 and 2i+2,
+	/// and the leaves are the nodes of the last level.
+	/// @param depth Number of levels of the tree below the root.
+
+	Tensor<Index, 2> DataSet::create_bounding_limits_kd_tree(const Index& depth) const
 	{
-		Tensor<Tensor<Index, 1>, 1> bounding_limits(depth + 1);
+		const Index nodes_number = (static_cast<Index>(1) << (depth + 1)) - 1;
+		const Index first_leaf = nodes_number / 2;
+
+		Tensor<Index, 2> bounding_limits(2, nodes_number);
 
-		bounding_limits(0) = Tensor<Index, 1>(2);
-		bounding_limits(0)(0) = 0;
-		bounding_limits(0)(1) = get_used_samples_number();
+		bounding_limits(0, 0) = 0;
+		bounding_limits(1, 0) = get_used_samples_number();
 
-		for (Index i = 1; i <= depth; i++)
+		for (Index i = 0; i < first_leaf; i++)
 		{
-			bounding_limits(i) = Tensor<Index, 1>(pow(2, i) + 1);
-			bounding_limits(i)(0) = 0;
+			const Index middle = bounding_limits(0, i) + (bounding_limits(1, i) - bounding_limits(0, i)) / 2;
 
-			for (Index j = 1; j < bounding_limits(i).size() - 1; j = j + 2)
-			{
-				bounding_limits(i)(j) = (bounding_limits(i - 1)(j / 2 + 1) - bounding_limits(i - 1)(j / 2)) / 2
-					+ bounding_limits(i - 1)(j / 2);
+			bounding_limits(0, 2 * i + 1) = bounding_limits(0, i);
+			bounding_limits(1, 2 * i + 1) = middle;
 
-				bounding_limits(i)(j + 1) = bounding_limits(i - 1)(j / 2 + 1);
-			}
+			bounding_limits(0, 2 * i + 2) = middle;
+			bounding_limits(1, 2 * i + 2) = bounding_limits(1, i);
 		}
+
 		return bounding_limits;
 	}
 
-	void DataSet::create_kd_tree(Tensor<Tensor<type, 1>, 1>& tree, const Tensor<Tensor<Index, 1>, 1>& bounding_limits) const
+	/// Builds a kd-tree over the columns of the tree data.
+	/// Every node is split at the median of the variable with the largest range, and the nodes of each level are split in parallel.
+	/// On exit, the tree data columns are sorted by their position in the tree, so that the samples of each leaf are contiguous.
+	/// @param tree_data Input variables of the used samples, with one sample per column.
+	/// @param tree_indices Position in the used samples of each column of the sorted tree data.
+	/// @param bounding_limits First and last positions of the samples of every node.
+	/// @param bounding_boxes Lower values, in the first rows, and upper values, in the last rows, of the samples of every node.
+
+	void DataSet::create_kd_tree(Tensor<type, 2>& tree_data,
+		Tensor<Index, 1>& tree_indices,
+		const Tensor<Index, 2>& bounding_limits,
+		Tensor<type, 2>& bounding_boxes) const
 	{
-		const Index depth = bounding_limits.size() - 1;
-		const Index input_variables = tree(0).size();
+		const Index variables_number = tree_data.dimension(0);
+		const Index samples_number = tree_data.dimension(1);
+
+		const Index nodes_number = bounding_limits.dimension(1);
+		const Index first_leaf = nodes_number / 2;
+
+		tree_indices.resize(samples_number);
 
-		auto specific_sort = [&tree](const Index& first, const Index& last, const Index& split_variable)
+		for (Index i = 0; i < samples_number; i++) tree_indices(i) = i;
+
+		bounding_boxes.resize(2 * variables_number, nodes_number);
+
+		for (Index level_begin = 0, level_size = 1; level_begin < nodes_number; level_begin += level_size, level_size *= 2)
+		{
+#pragma omp parallel for schedule(dynamic)
+			for (Index node = level_begin; node < level_begin + level_size; node++)
 			{
-				sort(tree.data() + first, tree.data() + last,
-					[&split_variable](const Tensor<type, 1>& a, const Tensor<type, 1>& b)
+				const Index first = bounding_limits(0, node);
+				const Index last = bounding_limits(1, node);
+
+				for (Index j = 0; j < variables_number; j++)
+				{
+					bounding_boxes(j, node) = numeric_limits<type>::max();
+					bounding_boxes(variables_number + j, node) = numeric_limits<type>::lowest();
+				}
+
+				for (Index i = first; i < last; i++)
+				{
+					const type* sample = tree_data.data() + tree_indices(i) * variables_number;
+
+					for (Index j = 0; j < variables_number; j++)
 					{
-						return a(split_variable) > b(split_variable);
-					});
-			};
+						bounding_boxes(j, node) = min(bounding_boxes(j, node), sample[j]);
+						bounding_boxes(variables_number + j, node) = max(bounding_boxes(variables_number + j, node), sample[j]);
+					}
+				}
 
-		specific_sort(bounding_limits(0)(0), bounding_limits(0)(1), 1);
+				if (node >= first_leaf) continue;
 
-		Index split_variable = 2;
+				Index split_variable = 0;
 
-		for (Index i = 1; i <= depth; i++, split_variable++)
-		{
-			split_variable = max(split_variable % input_variables, static_cast<Index>(1));
+				for (Index j = 1; j < variables_number; j++)
+				{
+					if (bounding_boxes(variables_number + j, node) - bounding_boxes(j, node)
+						> bounding_boxes(variables_number + split_variable, node) - bounding_boxes(split_variable, node))
+						split_variable = j;
+				}
+
+				nth_element(tree_indices.data() + first,
+					tree_indices.data() + bounding_limits(1, 2 * node + 1),
+					tree_indices.data() + last,
+					[&](const Index& a, const Index& b)
+					{
+						return tree_data(split_variable, a) < tree_data(split_variable, b);
+					});
+			}
+		}
 
-			specific_sort(bounding_limits(i)(0), bounding_limits(i)(1), split_variable);
+		Tensor<type, 2> sorted_tree_data(variables_number, samples_number);
 
 #pragma omp parallel for
-			for (Index j = 1; j < (Index)bounding_limits(i).size() - 1; j++)
-				specific_sort(bounding_limits(i)(j) + 1, bounding_limits(i)(j + 1), split_variable);
+		for (Index i = 0; i < samples_number; i++)
+		{
+			copy(tree_data.data() + tree_indices(i) * variables_number,
+				tree_data.data() + (tree_indices(i) + 1) * variables_number,
+				sorted_tree_data.data() + i * variables_number);
 		}
+
+		tree_data = move(sorted_tree_data);
 	}
 
-	Tensor<list<Index>, 1> DataSet::calculate_bounding_boxes_neighbors(const Tensor<Tensor<type, 1>, 1>& tree,
-		const Tensor<Index, 1>& leaves_indices,
-		const Index& depth,
+	/// Returns the k nearest neighbors of every used sample, searching the kd-tree in parallel.
+	/// The search visits first the nearest node, and skips the nodes whose bounding box is further than the current k-th neighbor.
+	/// The neighbors are sorted by distance, as in calculate_k_nearest_neighbors.
+	/// @param tree_data Sorted tree data.
+	/// @param tree_indices Position in the used samples of each column of the sorted tree data.
+	/// @param bounding_limits First and last positions of the samples of every node.
+	/// @param bounding_boxes Lower and upper values of the samples of every node.
+	/// @param k_neighbors Number of neighbors.
+
+	Tensor<list<Index>, 1> DataSet::calculate_bounding_boxes_neighbors(const Tensor<type, 2>& tree_data,
+		const Tensor<Index, 1>& tree_indices,
+		const Tensor<Index, 2>& bounding_limits,
+		const Tensor<type, 2>& bounding_boxes,
 		const Index& k_neighbors) const
 	{
-		/*
-		const Index used_samples_number = get_used_samples_number();
-		const Index leaves_number = pow(2, depth);
+		const Index variables_number = tree_data.dimension(0);
+		const Index samples_number = tree_data.dimension(1);
+
+		const Index nodes_number = bounding_limits.dimension(1);
+		const Index first_leaf = nodes_number / 2;
+
+		const size_t neighbors_number = static_cast<size_t>(max(k_neighbors, static_cast<Index>(0)));
+
+		Tensor<list<Index>, 1> k_nearest_neighbors(samples_number);
+
+		if (neighbors_number == 0) return k_nearest_neighbors;
+
+		const auto calculate_box_distance = [&](const type* sample, const Index& node)
+		{
+			type distance = type(0);
+
+			for (Index j = 0; j < variables_number; j++)
+			{
+				const type lower_error = bounding_boxes(j, node) - sample[j];
+				const type upper_error = sample[j] - bounding_boxes(variables_number + j, node);
 
-		Tensor<type, 1> bounding_box;
+				if (lower_error > type(0)) distance += lower_error * lower_error;
+				else if (upper_error > type(0)) distance += upper_error * upper_error;
+			}
 
-		Tensor<type, 2> distance_matrix;
-		Tensor<list<Index>, 1> k_nearest_neighbors(used_samples_number);
+			return distance;
+		};
 
-		for(Index i = 0; i < leaves_number; i++) // Each bounding box
+#pragma omp parallel for schedule(dynamic, 64)
+		for (Index i = 0; i < samples_number; i++)
 		{
-			const Index first = leaves_indices(i);
-			const Index last = leaves_indices(i+1);
-			bounding_box = Tensor<type, 1>(last-first);
+			const type* sample = tree_data.data() + i * variables_number;
 
-			for(Index j = 0; j < last - first; j++)
-				bounding_box(j) = tree(first+j)(0);
+			vector<pair<type, Index>> nearest_samples;
+			nearest_samples.reserve(neighbors_number);
 
-			Tensor<type, 2> distance_matrix = calculate_distance_matrix(bounding_box);
-			Tensor<list<Index>, 1> box_nearest_neighbors = calculate_k_nearest_neighbors(distance_matrix, k_neighbors);
+			vector<pair<type, Index>> nodes_stack(1, make_pair(type(0), static_cast<Index>(0)));
 
-			for(Index j = 0; j < last - first; j++)
+			while (!nodes_stack.empty())
 			{
-				for(auto & element : box_nearest_neighbors(j))
-					element = bounding_box(element);
+				const type node_distance = nodes_stack.back().first;
+				const Index node = nodes_stack.back().second;
+
+				nodes_stack.pop_back();
+
+				if (nearest_samples.size() == neighbors_number && node_distance >= nearest_samples.front().first) continue;
+
+				if (node < first_leaf)
+				{
+					const Index left_node = 2 * node + 1;
+					const Index right_node = 2 * node + 2;
+
+					const type left_distance = calculate_box_distance(sample, left_node);
+					const type right_distance = calculate_box_distance(sample, right_node);
+
+					if (left_distance <= right_distance)
+					{
+						nodes_stack.push_back(make_pair(right_distance, right_node));
+						nodes_stack.push_back(make_pair(left_distance, left_node));
+					}
+					else
+					{
+						nodes_stack.push_back(make_pair(left_distance, left_node));
+						nodes_stack.push_back(make_pair(right_distance, right_node));
+					}
+
+					continue;
+				}
+
+				for (Index j = bounding_limits(0, node); j < bounding_limits(1, node); j++)
+				{
+					if (j == i) continue;
+
+					const type* other_sample = tree_data.data() + j * variables_number;
+
+					type distance = type(0);
 
-				k_nearest_neighbors(bounding_box(j)) = move(box_nearest_neighbors(j));
+					for (Index v = 0; v < variables_number; v++)
+					{
+						const type error = sample[v] - other_sample[v];
+
+						distance += error * error;
+					}
+
+					if (nearest_samples.size() < neighbors_number)
+					{
+						nearest_samples.push_back(make_pair(distance, j));
+						push_heap(nearest_samples.begin(), nearest_samples.end());
+					}
+					else if (distance < nearest_samples.front().first)
+					{
+						pop_heap(nearest_samples.begin(), nearest_samples.end());
+						nearest_samples.back() = make_pair(distance, j);
+						push_heap(nearest_samples.begin(), nearest_samples.end());
+					}
+				}
 			}
+
+			sort_heap(nearest_samples.begin(), nearest_samples.end());
+
+			list<Index> neighbors_indices;
+
+			for (const auto& nearest_sample : nearest_samples)
+				neighbors_indices.push_back(tree_indices(nearest_sample.second));
+
+			k_nearest_neighbors(tree_indices(i)) = move(neighbors_indices);
 		}
 
 		return k_nearest_neighbors;
-	*/
-		return Tensor<list<Index>, 1>();
 	}
 
+	/// Returns the k nearest neighbors of every used sample using a kd-tree.
+	/// The memory is linear in the number of samples, instead of the quadratic distance matrix of the brute force approach.
+	/// @param k_neighbors Number of neighbors.
+	/// @param min_samples_leaf Minimum number of samples of each leaf of the tree.
+
 	Tensor<list<Index>, 1> DataSet::calculate_kd_tree_neighbors(const Index& k_neighbors, const Index& min_samples_leaf) const
 	{
-		/*
 		const Index used_samples_number = get_used_samples_number();
 
-		Tensor<Tensor<type, 1>, 1> tree = get_kd_tree_data();
+		const Index samples_leaf = max(min_samples_leaf, static_cast<Index>(1));
 
-		const Index depth = max(floor(log(static_cast<type>(used_samples_number)/static_cast<type>(min_samples_leaf))),
-						   static_cast<type>(0.0));
+		const Index depth = used_samples_number > samples_leaf
+			? static_cast<Index>(floor(log2(static_cast<double>(used_samples_number) / static_cast<double>(samples_leaf))))
+			: 0;
 
-		Tensor<Tensor<Index, 1>, 1> bounding_limits = create_bounding_limits_kd_tree(depth);
+		Tensor<type, 2> tree_data = get_kd_tree_data();
 
-		create_kd_tree(tree, bounding_limits);
+		Tensor<Index, 1> tree_indices;
 
-		return calculate_bounding_boxes_neighbors(tree, bounding_limits(depth), depth, k_neighbors);
-	*/
-		return Tensor<list<Index>, 1>();
+		const Tensor<Index, 2> bounding_limits = create_bounding_limits_kd_tree(depth);
+
+		Tensor<type, 2> bounding_boxes;
+
+		create_kd_tree(tree_data, tree_indices, bounding_limits, bounding_boxes);
+
+		return calculate_bounding_boxes_neighbors(tree_data, tree_indices, bounding_limits, bounding_boxes, k_neighbors);
 	}
 
 	Tensor<type, 1> DataSet::calculate_average_reachability(Tensor<list<Index>, 1>& k_nearest_indexes,
@@ -10314,8 +11390,8 @@ namespace opennn
 			{
 				const Index neighbor_k_index = k_nearest_indexes(*neighbor_it).back();
 
-				distance_between_points = calculate_euclidean_distance(input_variables_indices, i, *neighbor_it);
-				distance_2_k_neighbor = calculate_euclidean_distance(input_variables_indices, *neighbor_it, neighbor_k_index);
+				distance_between_points = calculate_euclidean_distance(input_variables_indices, samples_indices(i), samples_indices(*neighbor_it));
+				distance_2_k_neighbor = calculate_euclidean_distance(input_variables_indices, samples_indices(*neighbor_it), samples_indices(neighbor_k_index));
 
 				average_reachability(i) += max(distance_between_points, distance_2_k_neighbor);
 			}
@@ -10345,13 +11421,11 @@ namespace opennn
 
 		Tensor<type, 1> LOF_value(samples_number);
 
-		long double sum;
-
 #pragma omp parallel for
 
 		for (Index i = 0; i < samples_number; i++)
 		{
-			sum = 0.0;
+			long double sum = 0.0;
 
 			for (const auto& neighbor_index : k_nearest_indexes(i))
 				sum += average_reachabilities(i) / average_reachabilities(neighbor_index);
@@ -10402,15 +11476,13 @@ namespace opennn
 		Index k = min(k_neighbors, samples_number - 1);
 		Index min_samples_leaf_fix = max(min_samples_leaf, static_cast<Index>(0));
 
-		if (min_samples_leaf == 0 && samples_number > 5000)
+		if (min_samples_leaf == 0 && samples_number > 1000)
 		{
-			min_samples_leaf_fix = 200;
-			k = min(k, min_samples_leaf_fix - 1);
+			min_samples_leaf_fix = 40;
 			kdtree = true;
 		}
 		else if (min_samples_leaf != 0 && min_samples_leaf < samples_number / 2)
 		{
-			k = min(k, min_samples_leaf_fix - 1);
 			kdtree = true;
 		}
 
@@ -10432,213 +11504,231 @@ namespace opennn
 		return outlier_indexes;
 	}
 
-	void DataSet::calculate_min_max_indices_list(list<Index>& elements, const Index& variable_index, type& min, type& max) const
+	/// Returns the average path length of an unsuccessful search in a binary search tree with a given number of samples.
+	/// It is added to the depth of the leaves of an isolation tree which hold more than one sample.
+	/// @param samples_number Number of samples in the leaf.
+
+	type DataSet::calculate_average_path_length(const Index& samples_number) const
 	{
-		type value;
-		min = max = data(elements.front(), variable_index);
-		for (const auto& sample_index : elements)
-		{
-			value = data(sample_index, variable_index);
-			if (min > value) min = value;
-			else if (max < value) max = value;
-		}
+		if (samples_number <= 1) return type(0);
+
+		const type samples = type(samples_number);
+
+		return type(2) * (log(samples - type(1)) + type(0.5772156649)) - type(2) * (samples - type(1)) / samples;
 	}
 
-	Index DataSet::split_isolation_tree(Tensor<type, 2>& tree, list<list<Index>>& tree_simulation, list<Index>& tree_index) const
+	/// Builds one isolation tree over a subset of samples.
+	/// Each node splits its samples at a random value of a random input variable,
+	/// until the node has one sample, all its values are equal or the maximum depth is reached.
+	/// The nodes are appended to the feature, threshold and children arrays, with the children positions relative to the root.
+	/// @param forest_data Input variables of the used samples, with one sample per column.
+	/// @param sub_set_indices Columns of the forest data used to build the tree.
+	/// @param max_depth Maximum depth of the tree.
+	/// @param tree_random_engine Random engine of the tree.
+
+	void DataSet::create_isolation_tree(const Tensor<type, 2>& forest_data,
+		const Tensor<Index, 1>& sub_set_indices,
+		const Index& max_depth,
+		mt19937& tree_random_engine,
+		vector<Index>& features,
+		vector<type>& thresholds,
+		vector<Index>& children) const
 	{
-		/*
-		const Index current_tree_index = tree_index.front();
-		const type current_variable = tree(current_tree_index, 1);
-		const type division_value = tree(current_tree_index, 0);
+		const Index variables_number = forest_data.dimension(0);
 
-		list<Index> current_node_samples  = tree_simulation.front();
+		Tensor<Index, 1> samples_indices = sub_set_indices;
 
-		list<Index> one_side_samples;
-		list<Index> other_side_samples;
+		features.assign(1, -1);
+		thresholds.assign(1, type(0));
+		children.assign(1, -1);
 
-		Index delta_next_depth_nodes = 0;
-		Index one_side_count = 0;
-		Index other_side_count = 0;
+		uniform_int_distribution<Index> variables_distribution(0, variables_number - 1);
 
-		for(auto & sample_index : current_node_samples)
-		{
-			if(data(sample_index, current_variable) < division_value)
-			{
-				one_side_count++;
-				one_side_samples.emplace_back(sample_index);
-			}
-			else
-			{
-				other_side_count++;
-				other_side_samples.emplace_back(sample_index);
-			}
-		}
+		// Nodes pending to split: node, first sample, last sample and depth
 
-		if(one_side_count != 0)
+		vector<std::array<Index, 4>> nodes_stack(1, std::array<Index, 4>{0, 0, samples_indices.size(), 0});
+
+		while (!nodes_stack.empty())
 		{
-			if(one_side_count != 1)
-			{
-				tree_simulation.emplace_back(one_side_samples);
-				tree_index.emplace_back(current_tree_index*2+1);
-				delta_next_depth_nodes++;
-			}
+			const std::array<Index, 4> current_node = nodes_stack.back();
+
+			nodes_stack.pop_back();
+
+			const Index node = current_node[0];
+			const Index first = current_node[1];
+			const Index last = current_node[2];
+			const Index depth = current_node[3];
+
+			thresholds[node] = type(depth) + calculate_average_path_length(last - first);
 
-			if(other_side_count != 1)
+			if (last - first <= 1 || depth >= max_depth) continue;
+
+			const Index feature = variables_distribution(tree_random_engine);
+
+			type minimum = forest_data(feature, samples_indices(first));
+			type maximum = minimum;
+
+			for (Index i = first + 1; i < last; i++)
 			{
-				tree_simulation.emplace_back(other_side_samples);
-				tree_index.emplace_back(current_tree_index*2+2);
-				delta_next_depth_nodes++;
+				const type value = forest_data(feature, samples_indices(i));
+
+				if (value < minimum) minimum = value;
+				else if (value > maximum) maximum = value;
 			}
 
-			tree(current_tree_index*2+1, 2) = type(one_side_count);
-			tree(current_tree_index*2+2, 2) = type(other_side_count);
-		}
+			if (!(minimum < maximum)) continue;
 
-		return delta_next_depth_nodes;
-	*/
-		return Index();
-	}
+			const type threshold = uniform_real_distribution<type>(minimum, maximum)(tree_random_engine);
 
-	Tensor<type, 2> DataSet::create_isolation_tree(const Tensor<Index, 1>& indices, const Index& max_depth) const
-	{
-		const Index used_samples_number = indices.size();
+			const Index middle = static_cast<Index>(partition(samples_indices.data() + first,
+				samples_indices.data() + last,
+				[&](const Index& sample_index) { return forest_data(feature, sample_index) < threshold; })
+				- samples_indices.data());
 
-		const Index variables_number = get_input_variables_number();
-		const Tensor<Index, 1> input_variables_indices = get_input_variables_indices();
+			const Index left_node = static_cast<Index>(features.size());
 
-		list<list<Index>> tree_simulation;
-		list<Index> tree_index;
-		list<Index> current_node_samples;
+			features[node] = feature;
+			thresholds[node] = threshold;
+			children[node] = left_node;
 
-		Tensor<type, 2> tree(pow(2, max_depth + 1) - 1, 3);
-		tree.setConstant(numeric_limits<type>::infinity());
+			features.insert(features.end(), 2, -1);
+			thresholds.insert(thresholds.end(), 2, type(0));
+			children.insert(children.end(), 2, -1);
 
-		for (Index i = 0; i < used_samples_number; i++)
-			current_node_samples.emplace_back(indices(i));
+			nodes_stack.push_back(std::array<Index, 4>{left_node + 1, middle, last, depth + 1});
+			nodes_stack.push_back(std::array<Index, 4>{left_node, first, middle, depth + 1});
+		}
+	}
 
-		tree_simulation.emplace_back(current_node_samples);
-		tree(0, 2) = type(used_samples_number);
-		tree_index.emplace_back(0);
+	/// Builds an isolation forest, training the trees in parallel.
+	/// Each tree uses its own random engine, seeded from the random engine of the data set, so that the forest is reproducible.
+	/// @param forest_data Input variables of the used samples, with one sample per column.
+	/// @param trees_number Number of trees.
+	/// @param sub_set_size Number of samples of each tree.
+	/// @param max_depth Maximum depth of the trees.
 
-		current_node_samples.clear();
+	DataSet::IsolationForest DataSet::create_isolation_forest(const Tensor<type, 2>& forest_data,
+		const Index& trees_number,
+		const Index& sub_set_size,
+		const Index& max_depth) const
+	{
+		const Index samples_number = forest_data.dimension(1);
 
-		Index current_depth_nodes = 1;
-		Index next_depth_nodes = 0;
-		Index current_variable_index = input_variables_indices(rand() % variables_number);
-		Index current_depth = 0;
+		Tensor<unsigned, 1> trees_seeds(trees_number);
 
-		Index current_index;
+		for (Index i = 0; i < trees_number; i++) trees_seeds(i) = static_cast<unsigned>(random_engine());
 
-		type min;
-		type max;
+		vector<vector<Index>> trees_features(trees_number);
+		vector<vector<type>> trees_thresholds(trees_number);
+		vector<vector<Index>> trees_children(trees_number);
 
-		while (current_depth < max_depth && !(tree_simulation.empty()))
+#pragma omp parallel for schedule(dynamic)
+		for (Index i = 0; i < trees_number; i++)
 		{
-			current_node_samples = tree_simulation.front();
-			current_index = tree_index.front();
+			mt19937 tree_random_engine(trees_seeds(i));
 
-			calculate_min_max_indices_list(current_node_samples, current_variable_index, min, max);
+			// Floyd's algorithm samples the subset without shuffling all the samples
 
-			tree(current_index, 0) = static_cast<type>((max - min) * (type(rand()) / static_cast<type>(RAND_MAX))) + min;
+			vector<Index> sub_set;
+			sub_set.reserve(sub_set_size);
 
-			tree(current_index, 1) = type(current_variable_index);
+			for (Index j = samples_number - sub_set_size; j < samples_number; j++)
+			{
+				const Index sample_index = uniform_int_distribution<Index>(0, j)(tree_random_engine);
+
+				const vector<Index>::iterator position = lower_bound(sub_set.begin(), sub_set.end(), sample_index);
 
-			next_depth_nodes += split_isolation_tree(tree, tree_simulation, tree_index);
+				if (position != sub_set.end() && *position == sample_index)
+					sub_set.insert(lower_bound(sub_set.begin(), sub_set.end(), j), j);
+				else
+					sub_set.insert(position, sample_index);
+			}
 
-			tree_simulation.pop_front();
-			tree_index.pop_front();
+			Tensor<Index, 1> sub_set_indices(sub_set_size);
 
-			current_depth_nodes--;
+			copy(sub_set.begin(), sub_set.end(), sub_set_indices.data());
 
-			if (current_depth_nodes == 0)
-			{
-				current_depth++;
-				swap(current_depth_nodes, next_depth_nodes);
-				current_variable_index = input_variables_indices(rand() % variables_number);
-			}
+			create_isolation_tree(forest_data, sub_set_indices, max_depth, tree_random_engine,
+				trees_features[i], trees_thresholds[i], trees_children[i]);
 		}
 
-		return tree;
-	}
+		IsolationForest forest;
 
-	Tensor<Tensor<type, 2>, 1> DataSet::create_isolation_forest(const Index& trees_number, const Index& sub_set_size, const Index& max_depth) const
-	{
-		const Tensor<Index, 1> indices = get_used_samples_indices();
-		const Index samples_number = get_used_samples_number();
-		Tensor<Tensor<type, 2>, 1> forest(trees_number);
+		forest.trees_offsets.resize(trees_number);
 
-		std::random_device rng;
-		std::mt19937 urng(rng());
+		Index nodes_number = 0;
 
 		for (Index i = 0; i < trees_number; i++)
 		{
-			Tensor<Index, 1> sub_set_indices(sub_set_size);
-			Tensor<Index, 1> aux_indices = indices;
-			std::shuffle(aux_indices.data(), aux_indices.data() + samples_number, urng);
+			forest.trees_offsets(i) = nodes_number;
 
-			for (Index j = 0; j < sub_set_size; j++)
-				sub_set_indices(j) = aux_indices(j);
-
-			forest(i) = create_isolation_tree(sub_set_indices, max_depth);
+			nodes_number += static_cast<Index>(trees_features[i].size());
 		}
-		return forest;
-	}
-
-	type DataSet::calculate_tree_path(const Tensor<type, 2>& tree, const Index& sample_index,
-		const Index& tree_depth) const
-	{
-		Index current_index = 0;
-		Index current_depth = 0;
-		const Index tree_length = tree.dimensions()[0];
 
-		type samples;
-		type value;
+		forest.features.resize(nodes_number);
+		forest.thresholds.resize(nodes_number);
+		forest.children.resize(nodes_number);
 
-		while (current_depth < tree_depth)
+#pragma omp parallel for
+		for (Index i = 0; i < trees_number; i++)
 		{
-			if (tree(current_index, 2) == type(1))
-			{
-				return type(current_depth);
-			}
-			else if (current_index * 2 >= tree_length ||
-				(tree(current_index * 2 + 1, 2) == numeric_limits<type>::infinity())
-				) //Next node doesn't exist or node is leaf
-			{
-				samples = tree(current_index, 2);
+			const Index offset = forest.trees_offsets(i);
 
-				return type(log(samples - type(1)) - (type(2) * (samples - type(1))) / samples + type(0.5772) + type(current_depth));
+			for (Index j = 0; j < static_cast<Index>(trees_features[i].size()); j++)
+			{
+				forest.features(offset + j) = trees_features[i][j];
+				forest.thresholds(offset + j) = trees_thresholds[i][j];
+				forest.children(offset + j) = trees_children[i][j] == -1 ? -1 : offset + trees_children[i][j];
 			}
-
-			value = data(sample_index, static_cast<Index>(tree(current_index, 1)));
-
-			(value < tree(current_index, 0)) ? current_index = current_index * 2 + 1
-				: current_index = current_index * 2 + 2;
-
-			current_depth++;
 		}
 
-		samples = tree(current_index, 2);
-		if (samples == type(1))
-			return type(current_depth);
-		else
-			return type(log(samples - type(1)) - (type(2.0) * (samples - type(1))) / samples + type(0.5772) + type(current_depth));
+		return forest;
 	}
 
-	Tensor<type, 1> DataSet::calculate_average_forest_paths(const Tensor<Tensor<type, 2>, 1>& forest, const Index& tree_depth) const
+	/// Returns the average path length of every used sample over the trees of an isolation forest.
+	/// The samples are scored in parallel blocks, and every tree is applied to a whole block before the next one,
+	/// so that the nodes of the tree stay in cache.
+	/// @param forest Isolation forest.
+	/// @param forest_data Input variables of the used samples, with one sample per column.
+
+	Tensor<type, 1> DataSet::calculate_average_forest_paths(const IsolationForest& forest, const Tensor<type, 2>& forest_data) const
 	{
-		const Index samples_number = get_used_samples_number();
-		const Index n_trees = forest.dimensions()[0];
+		const Index variables_number = forest_data.dimension(0);
+		const Index samples_number = forest_data.dimension(1);
+		const Index trees_number = forest.trees_offsets.size();
+
+		const Index block_size = 256;
+		const Index blocks_number = (samples_number + block_size - 1) / block_size;
+
 		Tensor<type, 1> average_paths(samples_number);
 		average_paths.setZero();
 
-# pragma omp parallel for
-		for (Index i = 0; i < samples_number; i++)
+#pragma omp parallel for schedule(dynamic)
+		for (Index block = 0; block < blocks_number; block++)
 		{
-			for (Index j = 0; j < n_trees; j++)
-				average_paths(i) += calculate_tree_path(forest(j), i, tree_depth);
+			const Index first = block * block_size;
+			const Index last = min(first + block_size, samples_number);
+
+			for (Index j = 0; j < trees_number; j++)
+			{
+				for (Index i = first; i < last; i++)
+				{
+					const type* sample = forest_data.data() + i * variables_number;
+
+					Index node = forest.trees_offsets(j);
+
+					while (forest.features(node) != -1)
+					{
+						node = forest.children(node) + (sample[forest.features(node)] < forest.thresholds(node) ? 0 : 1);
+					}
+
+					average_paths(i) += forest.thresholds(node);
+				}
+			}
 
-			average_paths(i) /= type(n_trees);
+			for (Index i = first; i < last; i++) average_paths(i) /= type(trees_number);
 		}
+
 		return average_paths;
 	}
 
@@ -10649,9 +11739,12 @@ namespace opennn
 		const Index samples_number = get_used_samples_number();
 		const Index fixed_subs_set_samples = min(samples_number, subs_set_samples);
 		const Index max_depth = Index(ceil(log2(fixed_subs_set_samples)) * 2);
-		const Tensor<Tensor<type, 2>, 1> forest = create_isolation_forest(n_trees, fixed_subs_set_samples, max_depth);
 
-		const Tensor<type, 1> average_paths = calculate_average_forest_paths(forest, max_depth);
+		const Tensor<type, 2> forest_data = get_kd_tree_data();
+
+		const IsolationForest forest = create_isolation_forest(forest_data, n_trees, fixed_subs_set_samples, max_depth);
+
+		const Tensor<type, 1> average_paths = calculate_average_forest_paths(forest, forest_data);
 
 		Tensor<Index, 1> outlier_indexes;
 
@@ -10662,6 +11755,45 @@ namespace opennn
 		return outlier_indexes;
 	}
 
+	/// Sets as unused the samples whose average path length in an isolation forest is shorter than the mean
+	/// by more than a number of standard deviations.
+	/// @param trees_number Number of trees of the forest.
+	/// @param deviation_factor Number of standard deviations.
+
+	void DataSet::unuse_isolation_forest_outliers(const Index& trees_number, const type& deviation_factor)
+	{
+		const Tensor<Index, 1> used_samples_indices = get_used_samples_indices();
+
+		const Index samples_number = used_samples_indices.size();
+
+		if (samples_number < 2)
+		{
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSet class.\n"
+				<< "void unuse_isolation_forest_outliers(const Index&, const type&) method.\n"
+				<< "Number of used samples (" << samples_number << ") must be greater than 1.\n";
+
+			throw invalid_argument(buffer.str());
+		}
+
+		const Index sub_set_samples = min(samples_number, static_cast<Index>(256));
+		const Index max_depth = Index(ceil(log2(sub_set_samples)) * 2);
+
+		const Tensor<type, 2> forest_data = get_kd_tree_data();
+
+		const IsolationForest forest = create_isolation_forest(forest_data, trees_number, sub_set_samples, max_depth);
+
+		const Tensor<type, 1> average_paths = calculate_average_forest_paths(forest, forest_data);
+
+		const Tensor<Index, 1> outlier_indexes = select_outliers_via_standard_deviation(average_paths, deviation_factor, false);
+
+		for (Index i = 0; i < samples_number; i++)
+		{
+			if (outlier_indexes(i) == 1) set_sample_use(used_samples_indices(i), SampleUse::Unused);
+		}
+	}
+
 	/// Returns a matrix with the values of autocorrelation for every variable in the data set.
 	/// The number of rows is equal to the number of
 	/// The number of columns is the maximum lags number.
@@ -11428,83 +12560,453 @@ namespace opennn
 	{
 		read_csv_1();
 
-		if (!has_time_columns() && !has_categorical_columns())
-		{
-			read_csv_2_simple();
+		read_csv_parallel();
+	}
 
-			read_csv_3_simple();
-		}
-		else
+	/// Reads the data file with several threads.
+	/// The file is mapped into memory and split into chunks at line boundaries.
+	/// A first parallel pass counts the samples and collects the categories of each chunk, which are then merged in file order.
+	/// A second parallel pass parses every chunk directly into its rows of the data matrix.
+	/// The result is the same as that of the sequential methods read_csv_2_simple and read_csv_3_simple,
+	/// or read_csv_2_complete and read_csv_3_complete, which are used if the file cannot be mapped.
+
+	void DataSet::read_csv_parallel()
+	{
+		const bool is_simple = !has_time_columns() && !has_categorical_columns();
+
+		struct MappedFile
 		{
-			read_csv_2_complete();
+			size_t size = 0;
+			void* address = nullptr;
 
-			read_csv_3_complete();
-		}
-	}
+			~MappedFile() { if (address != nullptr) unmap_file(address, size); }
+		};
 
-	/*
-	Tensor<unsigned char, 1> DataSet::remove_padding(Tensor<unsigned char, 1>& img, const int& rows_number,const int& cols_number, const int& padding)
-	{
-		Tensor<unsigned char, 1> data_without_padding(img.size() - padding*rows_number);
+		MappedFile mapped_file;
 
-		const int channels = 3;
+		mapped_file.address = map_file(data_file_name, mapped_file.size);
 
-		if (rows_number % 4 ==0)
-		{
-			memcpy(data_without_padding.data(), img.data(), static_cast<size_t>(cols_number*channels*rows_number)*sizeof(unsigned char));
-		}
-		else
+		if (mapped_file.address == nullptr)
 		{
-			for (int i = 0; i<rows_number; i++)
+			if (is_simple)
 			{
-				if(i==0)
-				{
-					memcpy(data_without_padding.data(), img.data(), static_cast<size_t>(cols_number*channels)*sizeof(unsigned char));
-				}
-				else
-				{
-					memcpy(data_without_padding.data() + channels*cols_number*i, img.data() + channels*cols_number*i + padding*i, static_cast<size_t>(cols_number*channels)*sizeof(unsigned char));
-				}
+				read_csv_2_simple();
+				read_csv_3_simple();
 			}
+			else
+			{
+				read_csv_2_complete();
+				read_csv_3_complete();
+			}
+
+			return;
 		}
-		return data_without_padding;
-	}
-	*/
 
-	/*
-	void DataSet::sort_channel(Tensor<unsigned char,1>& original, Tensor<unsigned char,1>& sorted, const int& cols_number)
-	{
-		unsigned char* aux_row = nullptr;
+		const char* file_begin = static_cast<const char*>(mapped_file.address);
+		const char* file_end = file_begin + mapped_file.size;
 
-		aux_row = (unsigned char*)malloc(static_cast<size_t>(cols_number*sizeof(unsigned char)));
+		const char separator_char = get_separator_char();
 
-		const int rows_number = static_cast<int>(original.size()/cols_number);
+		const Index columns_number = columns.size();
+		const Index raw_columns_number = has_rows_labels ? columns_number + 1 : columns_number;
 
-		for(int i = 0; i <rows_number; i++)
+		const auto next_line = [&](const char*& position, const char* end)
 		{
-			memcpy(aux_row, original.data() + cols_number*rows_number - (i+1)*cols_number , static_cast<size_t>(cols_number)*sizeof(unsigned char));
+			const char* line_end = static_cast<const char*>(memchr(position, '\n', static_cast<size_t>(end - position)));
 
-			//        reverse(aux_row, aux_row + cols_number); //uncomment this if the lower right corner px should be in the upper left corner.
+			if (line_end == nullptr) line_end = end;
 
-			memcpy(sorted.data() + cols_number*i , aux_row, static_cast<size_t>(cols_number)*sizeof(unsigned char));
-		}
-	}
-	*/
+			string line(position, line_end);
 
-	Tensor<unsigned char, 1> DataSet::read_bmp_image(const string& filename)
-	{
-		FILE* f = fopen(filename.data(), "rb");
+			position = line_end == end ? end : line_end + 1;
 
-		if (!f)
-		{
-			ostringstream buffer;
+			return line;
+		};
 
-			buffer << "OpenNN Exception: DataSet class.\n"
-				<< "void read_bmp_image() method.\n"
-				<< "Couldn't open the file.\n";
+		// Skip header
 
-			throw invalid_argument(buffer.str());
-		}
+		const char* data_begin = file_begin;
+
+		Index header_lines_number = 0;
+
+		if (has_columns_names)
+		{
+			while (data_begin < file_end)
+			{
+				header_lines_number++;
+
+				string line = next_line(data_begin, file_end);
+
+				if (!clean_data_line(line)) continue;
+
+				break;
+			}
+		}
+
+		// Split into chunks
+
+		const Index chunk_minimum_size = 1048576;
+
+		const Index threads_number = thread_pool_device->numThreads();
+
+		const Index chunks_number = max(Index(1), min(4*threads_number, Index(file_end - data_begin)/chunk_minimum_size));
+
+		vector<const char*> chunks_begins(chunks_number + 1);
+
+		chunks_begins[0] = data_begin;
+		chunks_begins[chunks_number] = file_end;
+
+		for (Index i = 1; i < chunks_number; i++)
+		{
+			const char* position = max(chunks_begins[i-1], data_begin + (file_end - data_begin)*i/chunks_number);
+
+			const char* line_end = static_cast<const char*>(memchr(position, '\n', static_cast<size_t>(file_end - position)));
+
+			chunks_begins[i] = line_end == nullptr ? file_end : line_end + 1;
+		}
+
+		struct Chunk
+		{
+			Index lines_number = 0;
+			Index samples_number = 0;
+			Index first_sample_index = 0;
+
+			Index error_line = -1;
+			Index error_tokens_number = 0;
+
+			vector<vector<string>> categories;
+
+			Tensor<string, 1> last_tokens;
+
+			exception_ptr exception = nullptr;
+		};
+
+		vector<Chunk> chunks(chunks_number);
+
+		// Count samples and collect categories
+
+		if (display) cout << "Setting data dimensions..." << endl;
+
+		if (!is_simple)
+		{
+			for (Index j = 0; j < columns_number; j++)
+			{
+				if (columns(j).type != ColumnType::Categorical)
+				{
+					columns(j).column_use = VariableUse::Input;
+				}
+			}
+		}
+
+#pragma omp parallel for schedule(dynamic) num_threads(threads_number)
+
+		for (Index i = 0; i < chunks_number; i++)
+		{
+			Chunk& chunk = chunks[i];
+
+			if (!is_simple) chunk.categories.resize(columns_number);
+
+			const char* position = chunks_begins[i];
+
+			try
+			{
+				while (position < chunks_begins[i+1] && chunk.error_line < 0)
+				{
+					string line = next_line(position, chunks_begins[i+1]);
+
+					chunk.lines_number++;
+
+					if (!clean_data_line(line)) continue;
+
+					if (is_simple)
+					{
+						const Index tokens_number = count_tokens(line, separator_char);
+
+						if (tokens_number != raw_columns_number)
+						{
+							chunk.error_line = chunk.lines_number;
+							chunk.error_tokens_number = tokens_number;
+						}
+					}
+					else
+					{
+						const Tensor<string, 1> tokens = get_tokens(line, separator_char);
+
+						if (tokens.size() != raw_columns_number)
+						{
+							chunk.error_line = chunk.samples_number;
+							chunk.error_tokens_number = tokens.size();
+
+							break;
+						}
+
+						Index column_index = 0;
+
+						for (Index j = 0; j < raw_columns_number; j++)
+						{
+							if (has_rows_labels && j == 0) continue;
+
+							if (columns(column_index).type == ColumnType::Categorical
+								&& tokens(j) != missing_values_label
+								&& tokens(j).find(missing_values_label) == string::npos)
+							{
+								vector<string>& column_categories = chunk.categories[column_index];
+
+								if (find(column_categories.begin(), column_categories.end(), tokens(j)) == column_categories.end())
+								{
+									column_categories.push_back(tokens(j));
+								}
+							}
+
+							column_index++;
+						}
+					}
+
+					if (chunk.error_line < 0) chunk.samples_number++;
+				}
+			}
+			catch (...)
+			{
+				chunk.exception = current_exception();
+			}
+		}
+
+		Index lines_count = header_lines_number;
+		Index samples_count = 0;
+
+		for (Index i = 0; i < chunks_number; i++)
+		{
+			if (chunks[i].exception != nullptr) rethrow_exception(chunks[i].exception);
+
+			if (chunks[i].error_line >= 0)
+			{
+				if (is_simple)
+				{
+					ostringstream buffer;
+
+					buffer << "OpenNN Exception: DataSet class.\n"
+						<< "void read_csv_2_simple() method.\n"
+						<< "Line " << lines_count + chunks[i].error_line << ": Size of tokens("
+						<< chunks[i].error_tokens_number << ") is not equal to number of columns("
+						<< raw_columns_number << ").\n";
+
+					throw invalid_argument(buffer.str());
+				}
+				else
+				{
+					const string message =
+						"Sample " + to_string(samples_count + chunks[i].error_line + 1) + " error:\n"
+						"Size of tokens (" + to_string(chunks[i].error_tokens_number) + ") is not equal to number of columns (" + to_string(raw_columns_number) + ").\n"
+						"Please check the format of the data file (e.g: Use of commas both as decimal and column separator)";
+
+					throw invalid_argument(message);
+				}
+			}
+
+			chunks[i].first_sample_index = samples_count;
+
+			lines_count += chunks[i].lines_number;
+			samples_count += chunks[i].samples_number;
+
+			if (is_simple) continue;
+
+			for (Index j = 0; j < columns_number; j++)
+			{
+				for (const string& category : chunks[i].categories[j])
+				{
+					const string* categories_begin = columns(j).categories.data();
+					const string* categories_end = categories_begin + columns(j).categories.size();
+
+					if (find(categories_begin, categories_end, category) == categories_end)
+					{
+						columns(j).add_category(category);
+					}
+				}
+			}
+		}
+
+		if (is_simple)
+		{
+			set_data_dimensions(samples_count, columns_number);
+
+			set_default_columns_uses();
+
+			samples_uses.resize(samples_count);
+			samples_uses.setConstant(SampleUse::Training);
+
+			split_samples_random();
+
+			if (has_rows_labels) rows_labels.resize(samples_count);
+		}
+		else
+		{
+			if (display) cout << "Setting types..." << endl;
+
+			for (Index j = 0; j < columns_number; j++)
+			{
+				if (columns(j).type == ColumnType::Categorical && columns(j).categories.size() == 2)
+				{
+					columns(j).type = ColumnType::Binary;
+				}
+			}
+
+			set_data_dimensions(samples_count, get_variables_number());
+			data.setZero();
+
+			if (has_rows_labels) rows_labels.resize(samples_count);
+
+			set_default_columns_uses();
+
+			samples_uses.resize(samples_count);
+			samples_uses.setConstant(SampleUse::Training);
+
+			split_samples_random();
+		}
+
+		// Read data
+
+		if (display) cout << "Reading data..." << endl;
+
+#pragma omp parallel for schedule(dynamic) num_threads(threads_number)
+
+		for (Index i = 0; i < chunks_number; i++)
+		{
+			Chunk& chunk = chunks[i];
+
+			const char* position = chunks_begins[i];
+
+			Tensor<string, 1> tokens(is_simple ? raw_columns_number : 0);
+
+			Index sample_index = chunk.first_sample_index;
+
+			const Index last_sample_index = chunk.first_sample_index + chunk.samples_number;
+
+			try
+			{
+				while (position < chunks_begins[i+1] && sample_index < last_sample_index)
+				{
+					string line = next_line(position, chunks_begins[i+1]);
+
+					if (!clean_data_line(line)) continue;
+
+					if (is_simple)
+					{
+						fill_tokens(line, separator_char, tokens);
+
+						read_csv_3_simple_row(tokens, sample_index);
+					}
+					else
+					{
+						tokens = get_tokens(line, separator_char);
+
+						read_csv_3_complete_row(tokens, sample_index);
+					}
+
+					sample_index++;
+				}
+			}
+			catch (...)
+			{
+				chunk.exception = current_exception();
+			}
+
+			chunk.last_tokens = tokens;
+		}
+
+		for (Index i = 0; i < chunks_number; i++)
+		{
+			if (chunks[i].exception != nullptr) rethrow_exception(chunks[i].exception);
+		}
+
+		const Index data_file_preview_index = has_columns_names ? 3 : 2;
+
+		data_file_preview(data_file_preview_index) = chunks[chunks_number - 1].last_tokens;
+
+		for (Index i = chunks_number - 1; i >= 0; i--)
+		{
+			if (chunks[i].samples_number == 0) continue;
+
+			data_file_preview(data_file_preview_index) = chunks[i].last_tokens;
+
+			break;
+		}
+
+		if (display) cout << "Data read succesfully..." << endl;
+
+		// Check Constant and DateTime to unused
+
+		check_constant_columns();
+
+		// Check binary
+
+		if (display) cout << "Checking binary columns..." << endl;
+
+		set_binary_simple_columns();
+	}
+
+	/*
+	Tensor<unsigned char, 1> DataSet::remove_padding(Tensor<unsigned char, 1>& img, const int& rows_number,const int& cols_number, const int& padding)
+	{
+		Tensor<unsigned char, 1> data_without_padding(img.size() - padding*rows_number);
+
+		const int channels = 3;
+
+		if (rows_number % 4 ==0)
+		{
+			memcpy(data_without_padding.data(), img.data(), static_cast<size_t>(cols_number*channels*rows_number)*sizeof(unsigned char));
+		}
+		else
+		{
+			for (int i = 0; i<rows_number; i++)
+			{
+				if(i==0)
+				{
+					memcpy(data_without_padding.data(), img.data(), static_cast<size_t>(cols_number*channels)*sizeof(unsigned char));
+				}
+				else
+				{
+					memcpy(data_without_padding.data() + channels*cols_number*i, img.data() + channels*cols_number*i + padding*i, static_cast<size_t>(cols_number*channels)*sizeof(unsigned char));
+				}
+			}
+		}
+		return data_without_padding;
+	}
+	*/
+
+	/*
+	void DataSet::sort_channel(Tensor<unsigned char,1>& original, Tensor<unsigned char,1>& sorted, const int& cols_number)
+	{
+		unsigned char* aux_row = nullptr;
+
+		aux_row = (unsigned char*)malloc(static_cast<size_t>(cols_number*sizeof(unsigned char)));
+
+		const int rows_number = static_cast<int>(original.size()/cols_number);
+
+		for(int i = 0; i <rows_number; i++)
+		{
+			memcpy(aux_row, original.data() + cols_number*rows_number - (i+1)*cols_number , static_cast<size_t>(cols_number)*sizeof(unsigned char));
+
+			//        reverse(aux_row, aux_row + cols_number); //uncomment this if the lower right corner px should be in the upper left corner.
+
+			memcpy(sorted.data() + cols_number*i , aux_row, static_cast<size_t>(cols_number)*sizeof(unsigned char));
+		}
+	}
+	*/
+
+	Tensor<unsigned char, 1> DataSet::read_bmp_image(const string& filename)
+	{
+		FILE* f = fopen(filename.data(), "rb");
+
+		if (!f)
+		{
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSet class.\n"
+				<< "void read_bmp_image() method.\n"
+				<< "Couldn't open the file.\n";
+
+			throw invalid_argument(buffer.str());
+		}
 
 		unsigned char info[54];
 		fread(info, sizeof(unsigned char), 54, f);
@@ -11682,11 +13184,11 @@ namespace opennn
 		if (classes_number == 2)
 		{
 			Index binary_columns_number = 1;
-			data.resize(images_number, image_size + binary_columns_number);
+			set_data_dimensions(images_number, image_size + binary_columns_number);
 		}
 		else
 		{
-			data.resize(images_number, image_size + classes_number);
+			set_data_dimensions(images_number, image_size + classes_number);
 		}
 
 		data.setZero();
@@ -12703,8 +14205,14 @@ namespace opennn
 
 		read_csv();
 
+		// In sparse inputs mode, the word frequencies are only divided by their standard deviation, so that they keep their zeros
+
 		for (Index i = 0; i < get_input_columns_number(); i++)
+		{
 			set_column_type(i, ColumnType::Numeric);
+
+			if (sparse_inputs) columns(i).set_scaler(Scaler::StandardDeviation);
+		}
 	};
 
 	Tensor<string, 1> DataSet::get_default_columns_names(const Index& columns_number)
@@ -13024,11 +14532,7 @@ namespace opennn
 
 				getline(file, line);
 
-				trim(line);
-
-				erase(line, '"');
-
-				if (line.empty()) continue;
+				if (!clean_data_line(line)) continue;
 
 				break;
 			}
@@ -13051,11 +14555,7 @@ namespace opennn
 
 			getline(file, line);
 
-			trim(line);
-
-			//erase(line, '"');
-
-			if (line.empty()) continue;
+			if (!clean_data_line(line)) continue;
 
 			tokens_count = count_tokens(line, separator_char);
 
@@ -13077,7 +14577,7 @@ namespace opennn
 
 		file.close();
 
-		data.resize(samples_count, columns_number);
+		set_data_dimensions(samples_count, columns_number);
 
 		set_default_columns_uses();
 
@@ -13120,8 +14620,6 @@ namespace opennn
 			throw invalid_argument(buffer.str());
 		}
 
-		const bool is_float = is_same<type, float>::value;
-
 		const char separator_char = get_separator_char();
 
 		string line;
@@ -13134,9 +14632,7 @@ namespace opennn
 			{
 				getline(file, line);
 
-				line = decode(line);
-
-				if (line.empty()) continue;
+				if (!clean_data_line(line)) continue;
 
 				break;
 			}
@@ -13155,48 +14651,17 @@ namespace opennn
 		if (display) cout << "Reading data..." << endl;
 
 		Index sample_index = 0;
-		Index column_index = 0;
 
 		while (file.good())
 		{
 			getline(file, line);
 
-			line = decode(line);
-
-			trim(line);
-
-			erase(line, '"');
-
-			if (line.empty()) continue;
+			if (!clean_data_line(line)) continue;
 
 			fill_tokens(line, separator_char, tokens);
 
-			for (Index j = 0; j < raw_columns_number; j++)
-			{
-				trim(tokens(j));
-
-				if (has_rows_labels && j == 0)
-				{
-					rows_labels(sample_index) = tokens(j);
-				}
-				else if (tokens(j) == missing_values_label || tokens(j).empty())
-				{
-					data(sample_index, column_index) = static_cast<type>(NAN);
-					column_index++;
-				}
-				else if (is_float)
-				{
-					data(sample_index, column_index) = type(strtof(tokens(j).data(), nullptr));
-					column_index++;
-				}
-				else
-				{
-					data(sample_index, column_index) = type(stof(tokens(j)));
-					column_index++;
-				}
-			}
+			read_csv_3_simple_row(tokens, sample_index);
 
-			column_index = 0;
 			sample_index++;
 		}
 
@@ -13219,6 +14684,68 @@ namespace opennn
 		set_binary_simple_columns();
 	}
 
+	/// Decodes a line of the data file, trims it and removes its quotes.
+	/// All the data file readers use it, so that they skip exactly the same header and blank lines.
+	/// Returns false if the line is empty afterwards.
+	/// @param line Line of the data file, which is cleaned in place.
+
+	bool DataSet::clean_data_line(string& line) const
+	{
+		line = decode(line);
+
+		trim(line);
+
+		erase(line, '"');
+
+		return !line.empty();
+	}
+
+	/// Fills a row of the data matrix from the tokens of a line of a numeric data file.
+	/// The tokens are trimmed in place.
+	/// @param tokens Tokens of the line.
+	/// @param sample_index Index of the row to be filled.
+
+	void DataSet::read_csv_3_simple_row(Tensor<string, 1>& tokens, const Index& sample_index)
+	{
+		const bool is_float = is_same<type, float>::value;
+
+		const Index raw_columns_number = has_rows_labels ? columns.size() + 1 : columns.size();
+
+		Index column_index = 0;
+
+		float value;
+
+		for (Index j = 0; j < raw_columns_number; j++)
+		{
+			trim(tokens(j));
+
+			if (has_rows_labels && j == 0)
+			{
+				rows_labels(sample_index) = tokens(j);
+			}
+			else if (tokens(j) == missing_values_label || tokens(j).empty())
+			{
+				data(sample_index, column_index) = static_cast<type>(NAN);
+				column_index++;
+			}
+			else if (parse_number(tokens(j), value))
+			{
+				data(sample_index, column_index) = type(value);
+				column_index++;
+			}
+			else if (is_float)
+			{
+				data(sample_index, column_index) = type(strtof(tokens(j).data(), nullptr));
+				column_index++;
+			}
+			else
+			{
+				data(sample_index, column_index) = type(stof(tokens(j)));
+				column_index++;
+			}
+		}
+	}
+
 	void DataSet::read_csv_2_complete()
 	{
 		std::regex accent_regex("[\\xC0-\\xFF]");
@@ -13278,9 +14805,7 @@ namespace opennn
 			{
 				getline(file, line);
 
-				trim(line);
-
-				if (line.empty()) continue;
+				if (!clean_data_line(line)) continue;
 
 				break;
 			}
@@ -13298,13 +14823,7 @@ namespace opennn
 		{
 			getline(file, line);
 
-			line = decode(line);
-
-			trim(line);
-
-			erase(line, '"');
-
-			if (line.empty()) continue;
+			if (!clean_data_line(line)) continue;
 
 			tokens = get_tokens(line, separator_char);
 
@@ -13365,7 +14884,7 @@ namespace opennn
 
 		const Index variables_number = get_variables_number();
 
-		data.resize(static_cast<Index>(samples_number), variables_number);
+		set_data_dimensions(static_cast<Index>(samples_number), variables_number);
 		data.setZero();
 
 		if (has_rows_labels) rows_labels.resize(samples_number);
@@ -13414,19 +14933,11 @@ namespace opennn
 
 		const char separator_char = get_separator_char();
 
-		const Index columns_number = columns.size();
-
-		const Index raw_columns_number = has_rows_labels ? columns_number + 1 : columns_number;
-
 		string line;
 
 		Tensor<string, 1> tokens;
 
-		string token;
-
-		unsigned sample_index = 0;
-		unsigned variable_index = 0;
-		unsigned column_index = 0;
+		Index sample_index = 0;
 
 		// Skip header
 
@@ -13436,11 +14947,7 @@ namespace opennn
 			{
 				getline(file, line);
 
-				line = decode(line);
-
-				trim(line);
-
-				if (line.empty()) continue;
+				if (!clean_data_line(line)) continue;
 
 				break;
 			}
@@ -13454,143 +14961,156 @@ namespace opennn
 		{
 			getline(file, line);
 
-			line = decode(line);
+			if (!clean_data_line(line)) continue;
 
-			trim(line);
+			tokens = get_tokens(line, separator_char);
 
-			erase(line, '"');
+			read_csv_3_complete_row(tokens, sample_index);
 
-			if (line.empty()) continue;
+			sample_index++;
+		}
 
-			tokens = get_tokens(line, separator_char);
+		const Index data_file_preview_index = has_columns_names ? 3 : 2;
 
-			variable_index = 0;
-			column_index = 0;
+		data_file_preview(data_file_preview_index) = tokens;
 
-			for (Index j = 0; j < raw_columns_number; j++)
-			{
-				trim(tokens(j));
+		if (display) cout << "Data read succesfully..." << endl;
+
+		file.close();
 
-				if (has_rows_labels && j == 0)
+		// Check Constant and DateTime to unused
+
+		check_constant_columns();
+
+		// Check binary
+
+		if (display) cout << "Checking binary columns..." << endl;
+
+		set_binary_simple_columns();
+	}
+
+	/// Fills a row of the data matrix from the tokens of a line of a data file with categorical, binary or date time columns.
+	/// The tokens are trimmed in place.
+	/// @param tokens Tokens of the line.
+	/// @param sample_index Index of the row to be filled.
+
+	void DataSet::read_csv_3_complete_row(Tensor<string, 1>& tokens, const Index& sample_index)
+	{
+		const Index raw_columns_number = has_rows_labels ? columns.size() + 1 : columns.size();
+
+		Index variable_index = 0;
+		Index column_index = 0;
+
+		double value;
+
+		for (Index j = 0; j < raw_columns_number; j++)
+		{
+			trim(tokens(j));
+
+			if (has_rows_labels && j == 0)
+			{
+				rows_labels(sample_index) = tokens(j);
+				continue;
+			}
+			else if (columns(column_index).type == ColumnType::Numeric)
+			{
+				if (tokens(j) == missing_values_label || tokens(j).empty())
 				{
-					rows_labels(sample_index) = tokens(j);
-					continue;
+					data(sample_index, variable_index) = static_cast<type>(NAN);
+					variable_index++;
+				}
+				else if (parse_number(tokens(j), value))
+				{
+					data(sample_index, variable_index) = static_cast<type>(value);
+					variable_index++;
 				}
-				else if (columns(column_index).type == ColumnType::Numeric)
+				else
 				{
-					if (tokens(j) == missing_values_label || tokens(j).empty())
+					try
 					{
-						data(sample_index, variable_index) = static_cast<type>(NAN);
+						data(sample_index, variable_index) = static_cast<type>(stod(tokens(j)));
 						variable_index++;
 					}
-					else
+					catch (const invalid_argument& e)
 					{
-						try
-						{
-							data(sample_index, variable_index) = static_cast<type>(stod(tokens(j)));
-							variable_index++;
-						}
-						catch (const invalid_argument& e)
-						{
-							ostringstream buffer;
+						ostringstream buffer;
 
-							buffer << "OpenNN Exception: DataSet class.\n"
-								<< "void read_csv_3_complete() method.\n"
-								<< "Sample " << sample_index << "; Invalid number: " << tokens(j) << "\n";
+						buffer << "OpenNN Exception: DataSet class.\n"
+							<< "void read_csv_3_complete() method.\n"
+							<< "Sample " << sample_index << "; Invalid number: " << tokens(j) << "\n";
 
-							throw invalid_argument(buffer.str());
-						}
+						throw invalid_argument(buffer.str());
 					}
 				}
-				else if (columns(column_index).type == ColumnType::DateTime)
+			}
+			else if (columns(column_index).type == ColumnType::DateTime)
+			{
+				if (tokens(j) == missing_values_label || tokens(j).empty())
 				{
-					if (tokens(j) == missing_values_label || tokens(j).empty())
-					{
-						data(sample_index, variable_index) = static_cast<type>(NAN);
-						variable_index++;
-					}
-					else
-					{
-						data(sample_index, variable_index) = static_cast<type>(date_to_timestamp(tokens(j), gmt));
-						variable_index++;
-					}
+					data(sample_index, variable_index) = static_cast<type>(NAN);
+					variable_index++;
 				}
-				else if (columns(column_index).type == ColumnType::Categorical)
+				else
 				{
-					for (Index k = 0; k < columns(column_index).get_categories_number(); k++)
-					{
-						if (tokens(j) == missing_values_label)
-						{
-							data(sample_index, variable_index) = static_cast<type>(NAN);
-						}
-						else if (tokens(j) == columns(column_index).categories(k))
-						{
-							data(sample_index, variable_index) = type(1);
-						}
-
-						variable_index++;
-					}
+					data(sample_index, variable_index) = static_cast<type>(date_to_timestamp(tokens(j), gmt));
+					variable_index++;
 				}
-				else if (columns(column_index).type == ColumnType::Binary)
+			}
+			else if (columns(column_index).type == ColumnType::Categorical)
+			{
+				for (Index k = 0; k < columns(column_index).get_categories_number(); k++)
 				{
-					string lower_case_token = tokens(j);
-
-					trim(lower_case_token);
-					transform(lower_case_token.begin(), lower_case_token.end(), lower_case_token.begin(), ::tolower);
-
-					Tensor<string, 1> positive_words(5);
-					Tensor<string, 1> negative_words(5);
-
-					positive_words.setValues({ "yes", "positive", "+", "true", "si" });
-					negative_words.setValues({ "no", "negative", "-", "false", "no" });
-
-					if (tokens(j) == missing_values_label || tokens(j).find(missing_values_label) != string::npos)
+					if (tokens(j) == missing_values_label)
 					{
 						data(sample_index, variable_index) = static_cast<type>(NAN);
 					}
-					else if (contains(positive_words, lower_case_token))
-					{
-						data(sample_index, variable_index) = type(1);
-					}
-					else if (contains(negative_words, lower_case_token))
-					{
-						data(sample_index, variable_index) = type(0);
-					}
-					else if (columns(column_index).categories.size() > 0 && tokens(j) == columns(column_index).categories(0))
-					{
-						data(sample_index, variable_index) = type(1);
-					}
-					else if (tokens(j) == columns(column_index).name)
+					else if (tokens(j) == columns(column_index).categories(k))
 					{
 						data(sample_index, variable_index) = type(1);
 					}
 
 					variable_index++;
 				}
-
-				column_index++;
 			}
+			else if (columns(column_index).type == ColumnType::Binary)
+			{
+				string lower_case_token = tokens(j);
 
-			sample_index++;
-		}
-
-		const Index data_file_preview_index = has_columns_names ? 3 : 2;
-
-		data_file_preview(data_file_preview_index) = tokens;
+				trim(lower_case_token);
+				transform(lower_case_token.begin(), lower_case_token.end(), lower_case_token.begin(), ::tolower);
 
-		if (display) cout << "Data read succesfully..." << endl;
+				Tensor<string, 1> positive_words(5);
+				Tensor<string, 1> negative_words(5);
 
-		file.close();
+				positive_words.setValues({ "yes", "positive", "+", "true", "si" });
+				negative_words.setValues({ "no", "negative", "-", "false", "no" });
 
-		// Check Constant and DateTime to unused
-
-		check_constant_columns();
-
-		// Check binary
+				if (tokens(j) == missing_values_label || tokens(j).find(missing_values_label) != string::npos)
+				{
+					data(sample_index, variable_index) = static_cast<type>(NAN);
+				}
+				else if (contains(positive_words, lower_case_token))
+				{
+					data(sample_index, variable_index) = type(1);
+				}
+				else if (contains(negative_words, lower_case_token))
+				{
+					data(sample_index, variable_index) = type(0);
+				}
+				else if (columns(column_index).categories.size() > 0 && tokens(j) == columns(column_index).categories(0))
+				{
+					data(sample_index, variable_index) = type(1);
+				}
+				else if (tokens(j) == columns(column_index).name)
+				{
+					data(sample_index, variable_index) = type(1);
+				}
 
-		if (display) cout << "Checking binary columns..." << endl;
+				variable_index++;
+			}
 
-		set_binary_simple_columns();
+			column_index++;
+		}
 	}
 
 	void DataSet::check_separators(const string& line) const
@@ -13741,6 +15261,13 @@ namespace opennn
 		return true;
 	}
 
+	/// Returns true if the data matrix is a view over a memory-mapped data file, and false otherwise.
+
+	bool DataSet::has_mapped_data() const
+	{
+		return mapped_data_address != nullptr;
+	}
+
 	Tensor<Index, 1> DataSet::count_nan_columns() const
 	{
 		const Index columns_number = get_columns_number();
@@ -13972,13 +15499,19 @@ namespace opennn
 		const Tensor<Index, 1>& inputs,
 		const Tensor<Index, 1>& targets)
 	{
-		const Tensor<type, 2>& data = data_set_pointer->get_data();
+		const TensorMap<Tensor<type, 2>>& data = data_set_pointer->get_data();
 
 		const Tensor<Index, 1>& input_variables_dimensions = data_set_pointer->get_input_variables_dimensions();
 
-		if (input_variables_dimensions.size() == 1)
+		if (sparse_inputs)
+		{
+			fill_sparse_inputs(samples, inputs);
+		}
+		else if (input_variables_dimensions.size() == 1)
 		{
 			fill_submatrix(data, samples, inputs, inputs_data);
+
+			data_set_pointer->scale_batch_variables(inputs_data, samples.size(), inputs);
 		}
 		else if (input_variables_dimensions.size() == 3)
 		{
@@ -13989,7 +15522,7 @@ namespace opennn
 			const Index rows_number = input_variables_dimensions(1);
 			const Index columns_number = input_variables_dimensions(2);
 
-			TensorMap<Tensor<type, 4>> inputs(inputs_data, rows_number, columns_number, channels_number, batch_size);
+			TensorMap<Tensor<type, 4>> images(inputs_data, rows_number, columns_number, channels_number, batch_size);
 
 			Index index = 0;
 
@@ -14020,7 +15553,7 @@ namespace opennn
 					{
 						for (Index channel = channels_number - 1; channel >= 0; channel--)
 						{
-							inputs(row, col, channel, image) = data(image, index);
+							images(row, col, channel, image) = data(samples(image), inputs(index));
 							index++;
 						}
 					}
@@ -14029,6 +15562,90 @@ namespace opennn
 		}
 
 		fill_submatrix(data, samples, targets, targets_data);
+
+		data_set_pointer->scale_batch_variables(targets_data, samples.size(), targets);
+	}
+
+	/// Copies the inputs of the batch from the data matrix of the data set, in compressed sparse row format.
+	/// The columns of the sparse inputs are the positions of the variables in the inputs indices.
+	/// Each thread takes a block of rows and reads it column by column, as the data matrix is column major.
+	/// All the inputs of the samples are read, as for a dense batch, but only the non zero ones are stored.
+	/// @param samples Indices of the samples of the batch.
+	/// @param inputs Indices of the input variables.
+
+	void DataSetBatch::fill_sparse_inputs(const Tensor<Index, 1>& samples, const Tensor<Index, 1>& inputs)
+	{
+		const TensorMap<Tensor<type, 2>>& data = data_set_pointer->get_data();
+
+		const Index samples_number = samples.size();
+		const Index inputs_number = inputs.size();
+
+		Tensor<Index, 1> rows_positions(samples_number + 1);
+		rows_positions.setZero();
+
+		Index* batch_columns = nullptr;
+		type* batch_values = nullptr;
+
+#pragma omp parallel
+		{
+			const Index threads_number = omp_get_num_threads();
+			const Index thread_index = omp_get_thread_num();
+
+			const Index first_row = samples_number * thread_index / threads_number;
+			const Index last_row = samples_number * (thread_index + 1) / threads_number;
+
+			for (Index j = 0; j < inputs_number; j++)
+				for (Index i = first_row; i < last_row; i++)
+					if (data(samples(i), inputs(j)) != type(0)) rows_positions(i + 1)++;
+
+#pragma omp barrier
+
+#pragma omp single
+			{
+				for (Index i = 0; i < samples_number; i++)
+					rows_positions(i + 1) += rows_positions(i);
+
+				inputs_sparse.resize(samples_number, inputs_number);
+				inputs_sparse.resizeNonZeros(rows_positions(samples_number));
+
+				copy(rows_positions.data(), rows_positions.data() + samples_number + 1, inputs_sparse.outerIndexPtr());
+
+				batch_columns = inputs_sparse.innerIndexPtr();
+				batch_values = inputs_sparse.valuePtr();
+			}
+
+			// The inputs are read in order, so that the column indices of each row are increasing
+
+			for (Index j = 0; j < inputs_number; j++)
+			{
+				for (Index i = first_row; i < last_row; i++)
+				{
+					const type value = data(samples(i), inputs(j));
+
+					if (value == type(0)) continue;
+
+					batch_columns[rows_positions(i)] = j;
+					batch_values[rows_positions(i)] = value;
+
+					rows_positions(i)++;
+				}
+			}
+		}
+	}
+
+	/// Sets whether the inputs of the batch are carried in compressed sparse row format.
+	/// They are only sparse if the data set is in sparse inputs mode and not in streaming mode,
+	/// as the batches of the streaming mode are scaled when they are filled.
+	/// @param new_sparse_inputs True to request sparse inputs.
+
+	void DataSetBatch::set_sparse_inputs(const bool& new_sparse_inputs)
+	{
+		sparse_inputs = new_sparse_inputs
+			&& data_set_pointer != nullptr
+			&& data_set_pointer->get_sparse_inputs()
+			&& !data_set_pointer->get_streaming();
+
+		if (!sparse_inputs) inputs_sparse = SparseMatrix<type, RowMajor, Index>();
 	}
 
 	DataSetBatch::DataSetBatch(const Index& new_samples_number, DataSet* new_data_set_pointer)
@@ -14099,10 +15716,195 @@ namespace opennn
 		cout << TensorMap<Tensor<type, 2>>(targets_data, targets_dimensions(0), targets_dimensions(1)) << endl;
 	}
 
+	DataSetBatchPrefetcher::DataSetBatchPrefetcher(const Index& new_batch_size, DataSet* new_data_set_pointer, const Index& new_queue_depth)
+	{
+		set(new_batch_size, new_data_set_pointer, new_queue_depth);
+	}
+
+	DataSetBatchPrefetcher::~DataSetBatchPrefetcher()
+	{
+		stop();
+	}
+
+	/// Allocates the batches of the prefetcher.
+	/// @param new_batch_size Number of samples in each batch.
+	/// @param new_data_set_pointer Pointer to the data set from which the batches are filled.
+	/// @param new_queue_depth Maximum number of batches filled ahead.
+
+	void DataSetBatchPrefetcher::set(const Index& new_batch_size, DataSet* new_data_set_pointer, const Index& new_queue_depth)
+	{
+		stop();
+
+		queue_depth = new_queue_depth;
+
+		const Index batches_number = queue_depth < 2 ? 1 : queue_depth;
+
+		batches.resize(static_cast<size_t>(batches_number));
+
+		for (DataSetBatch& batch : batches)
+		{
+			batch.set(new_batch_size, new_data_set_pointer);
+		}
+	}
+
+	/// Sets whether the batches of the prefetcher carry their inputs in compressed sparse row format.
+	/// It must be called before start().
+	/// @param new_sparse_inputs True to request sparse inputs.
+
+	void DataSetBatchPrefetcher::set_sparse_inputs(const bool& new_sparse_inputs)
+	{
+		stop();
+
+		for (DataSetBatch& batch : batches)
+		{
+			batch.set_sparse_inputs(new_sparse_inputs);
+		}
+	}
+
+	Index DataSetBatchPrefetcher::get_queue_depth() const
+	{
+		return queue_depth;
+	}
+
+	/// Starts filling the batches of an epoch.
+	/// The data set must not be modified until all of them have been consumed or stop() is called.
+	/// @param new_samples_indices Matrix with the samples of each batch in its rows, as returned by DataSet::get_batches.
+	/// @param new_inputs_indices Indices of the input variables.
+	/// @param new_targets_indices Indices of the target variables.
+
+	void DataSetBatchPrefetcher::start(const Tensor<Index, 2>& new_samples_indices,
+		const Tensor<Index, 1>& new_inputs_indices,
+		const Tensor<Index, 1>& new_targets_indices)
+	{
+		stop();
+
+		samples_indices = new_samples_indices;
+		inputs_indices = new_inputs_indices;
+		targets_indices = new_targets_indices;
+
+		filled_batches_number = 0;
+		consumed_batches_number = 0;
+
+		stopping = false;
+
+		producer_exception = nullptr;
+
+		// The thread budget is per thread, so the producer takes the one of the caller
+
+		producer_threads_number = omp_get_max_threads();
+
+		if (queue_depth >= 2 && samples_indices.dimension(0) > 0)
+		{
+			producer = thread(&DataSetBatchPrefetcher::produce, this);
+		}
+	}
+
+	/// Returns the next batch of the epoch, waiting until it has been filled.
+	/// The returned batch stays valid until the following call.
+
+	DataSetBatch& DataSetBatchPrefetcher::next()
+	{
+		if (consumed_batches_number >= samples_indices.dimension(0))
+		{
+			ostringstream buffer;
+
+			buffer << "OpenNN Exception: DataSetBatchPrefetcher class.\n"
+				<< "DataSetBatch& next() method.\n"
+				<< "All the batches of the epoch have been consumed.\n";
+
+			throw invalid_argument(buffer.str());
+		}
+
+		if (queue_depth < 2)
+		{
+			DataSetBatch& batch = batches[0];
+
+			batch.fill(samples_indices.chip(consumed_batches_number, 0), inputs_indices, targets_indices);
+
+			consumed_batches_number++;
+
+			return batch;
+		}
+
+		unique_lock<mutex> lock(batches_mutex);
+
+		batches_condition.wait(lock, [this] { return filled_batches_number > consumed_batches_number || producer_exception; });
+
+		if (producer_exception) rethrow_exception(producer_exception);
+
+		DataSetBatch& batch = batches[static_cast<size_t>(consumed_batches_number % queue_depth)];
+
+		consumed_batches_number++;
+
+		lock.unlock();
+
+		// The previous batch is released by asking for the next one
+
+		batches_condition.notify_all();
+
+		return batch;
+	}
+
+	/// Stops the background thread, discarding the batches not consumed.
+
+	void DataSetBatchPrefetcher::stop()
+	{
+		{
+			lock_guard<mutex> lock(batches_mutex);
+
+			stopping = true;
+		}
+
+		batches_condition.notify_all();
+
+		if (producer.joinable()) producer.join();
+	}
+
+	void DataSetBatchPrefetcher::produce()
+	{
+		ThreadRuntime::get_instance().set_thread_budget(producer_threads_number);
+
+		const Index batches_number = samples_indices.dimension(0);
+
+		for (Index i = 0; i < batches_number; i++)
+		{
+			{
+				unique_lock<mutex> lock(batches_mutex);
+
+				// A buffer is free once the consumer has asked for the batch after the one it holds
+
+				batches_condition.wait(lock, [this, i] { return stopping || i + 1 < consumed_batches_number + queue_depth; });
+
+				if (stopping) return;
+			}
+
+			try
+			{
+				batches[static_cast<size_t>(i % queue_depth)].fill(samples_indices.chip(i, 0), inputs_indices, targets_indices);
+			}
+			catch (...)
+			{
+				lock_guard<mutex> lock(batches_mutex);
+
+				producer_exception = current_exception();
+
+				batches_condition.notify_all();
+
+				return;
+			}
+
+			{
+				lock_guard<mutex> lock(batches_mutex);
+
+				filled_batches_number = i + 1;
+			}
+
+			batches_condition.notify_all();
+		}
+	}
+
 	void DataSet::shuffle()
 	{
-		random_device rng;
-		mt19937 urng(rng());
 
 		const Index data_rows = data.dimension(0);
 		const Index data_columns = data.dimension(1);
@@ -14111,7 +15913,7 @@ namespace opennn
 
 		for (Index i = 0; i < data_rows; i++) indices(i) = i;
 
-		std::shuffle(&indices(0), &indices(data_rows - 1), urng);
+		std::shuffle(&indices(0), &indices(data_rows - 1), random_engine);
 
 		Tensor<type, 2> new_data(data_rows, data_columns);
 		Tensor<string, 1> new_rows_labels(data_rows);
@@ -29,6 +29,11 @@
 #include <stdio.h>
 #include <limits.h>
 #include <list>
+#include <vector>
+#include <array>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <filesystem>
 #include <experimental/filesystem>
 
@@ -38,6 +43,7 @@
 // OpenNN includes
 
 #include "config.h"
+#include "thread_runtime.h"
 #include "statistics.h"
 #include "scaling.h"
 #include "correlations.h"
@@ -387,8 +393,8 @@ public:
 
     // Data get methods
 
-    const Tensor<type, 2>& get_data() const;
-    Tensor<type, 2>* get_data_pointer();
+    const TensorMap<Tensor<type, 2>>& get_data() const;
+    TensorMap<Tensor<type, 2>>* get_data_pointer();
 
     const Tensor<type, 2>& get_time_series_data() const;
     const Tensor<type, 2>& get_associative_data() const;
@@ -477,6 +483,11 @@ public:
 
     const bool& get_display() const;
 
+    const bool& get_streaming() const;
+    const Index& get_streaming_window_samples_number() const;
+
+    const bool& get_sparse_inputs() const;
+
     // Set methods
 
     void set();
@@ -496,6 +507,8 @@ public:
 
     void set_threads_number(const int&);
 
+    void set_random_seed(const unsigned&);
+
     // Samples set methods
 
     void set_samples_number(const Index&);
@@ -609,6 +622,11 @@ public:
 
     void set_display(const bool&);
 
+    void set_streaming(const bool&);
+    void set_streaming_window_samples_number(const Index&);
+
+    void set_sparse_inputs(const bool&);
+
     // Check methods
 
     bool is_empty() const;
@@ -623,6 +641,8 @@ public:
 
     bool has_selection() const;
 
+    bool has_mapped_data() const;
+
     // Splitting methods
 
     void split_samples_sequential(const type& training_ratio = static_cast<type>(0.6),
@@ -737,6 +757,8 @@ public:
     void unscale_input_variables(const Tensor<Descriptives, 1>&);
     void unscale_target_variables(const Tensor<Descriptives, 1>&);
 
+    void scale_batch_variables(type*, const Index&, const Tensor<Index, 1>&) const;
+
     // Classification methods
 
     Tensor<Index, 1> calculate_target_distribution() const;
@@ -847,6 +869,13 @@ public:
 
     void load_auto_associative_data_binary(const string&);
 
+    void save_data_mapped(const string&) const;
+    void save_data_mapped_samples_uses(const string&) const;
+
+    void load_data_mapped(const string&);
+
+    void unmap_data();
+
     void check_input_csv(const string&, const char&) const;
 
     Tensor<type, 2> read_input_csv(const string&, const char&, const string&, const bool&, const bool&) const;
@@ -944,24 +973,84 @@ public:
     void read_csv_2_complete();
     void read_csv_3_complete();
 
+    void read_csv_parallel();
+
     void check_separators(const string&) const;
 
     void check_special_characters(const string&) const;
 
 private:
 
+    Tensor<Index, 2> get_streaming_batches(const Tensor<Index, 1>&, const Index&) const;
+
+    void set_streaming_variables_scalers(const Tensor<Index, 1>&, const Tensor<Scaler, 1>&, const Tensor<Descriptives, 1>&);
+
+    bool clean_data_line(string&) const;
+
+    void read_csv_3_simple_row(Tensor<string, 1>&, const Index&);
+    void read_csv_3_complete_row(Tensor<string, 1>&, const Index&);
+
+    void set_data_dimensions(const Index&, const Index&);
+
+    void release_mapped_data();
+
     DataSet::ProjectType project_type;
 
-    ThreadPool* thread_pool = nullptr;
     ThreadPoolDevice* thread_pool_device = nullptr;
 
+    /// Random engine used for batches shuffling and samples splitting.
+
+    mutable mt19937 random_engine = mt19937(random_device()());
+
     // DATA
 
     /// Data Matrix.
     /// The number of rows is the number of samples.
     /// The number of columns is the number of variables.
+    /// It is a view over data_storage, or over a memory-mapped data file after load_data_mapped.
+
+    TensorMap<Tensor<type, 2>> data = TensorMap<Tensor<type, 2>>(nullptr, 0, 0);
+
+    /// In-memory storage of the data matrix, empty while the data is memory-mapped.
+
+    Tensor<type, 2> data_storage;
 
-    Tensor<type, 2> data;
+    // MAPPED DATA FILE
+
+    /// Name of the memory-mapped data file, if any.
+
+    string mapped_data_file_name;
+
+    /// Address and size in bytes of the memory-mapped data file.
+
+    void* mapped_data_address = nullptr;
+
+    size_t mapped_data_size = 0;
+
+    // STREAMING
+
+    /// Streaming mode. The data matrix is never scaled in place;
+    /// the scaling is applied to each batch, and shuffled batches are drawn from windows of consecutive samples.
+
+    bool streaming = false;
+
+    /// Number of consecutive samples in each shuffling window of the streaming mode.
+
+    Index streaming_window_samples_number = 65536;
+
+    /// Scaler and descriptives applied to each variable of the batches in streaming mode.
+
+    Tensor<Scaler, 1> streaming_variables_scalers;
+
+    Tensor<Descriptives, 1> streaming_variables_descriptives;
+
+    // SPARSE INPUTS
+
+    /// Sparse inputs mode. The batches carry their inputs as compressed sparse rows,
+    /// built from the rows of the data matrix when the batches are filled.
+    /// The dense data matrix is kept, so this mode does not reduce the memory of the data set.
+
+    bool sparse_inputs = false;
 
     // Samples
 
@@ -1098,15 +1187,17 @@ private:
 
     Tensor<list<Index>, 1> calculate_k_nearest_neighbors(const Tensor<type, 2>&, const Index& = 20) const;
 
-    Tensor<Tensor<type, 1>, 1> get_kd_tree_data() const;
+    Tensor<type, 2> get_kd_tree_data() const;
 
-    Tensor<Tensor<Index, 1>, 1> create_bounding_limits_kd_tree(const Index&) const;
+    Tensor<Index, 2> create_bounding_limits_kd_tree(const Index&) const;
 
-    void create_kd_tree(Tensor<Tensor<type, 1>, 1>&, const Tensor<Tensor<Index, 1>, 1>&) const;
+    void create_kd_tree(Tensor<type, 2>&, Tensor<Index, 1>&, const Tensor<Index, 2>&, Tensor<type, 2>&) const;
 
-    Tensor<list<Index>, 1> calculate_bounding_boxes_neighbors(const Tensor<Tensor<type, 1>, 1>&,
+    Tensor<list<Index>, 1> calculate_bounding_boxes_neighbors(const Tensor<type, 2>&,
                                                               const Tensor<Index, 1>&,
-                                                              const Index&, const Index&) const;
+                                                              const Tensor<Index, 2>&,
+                                                              const Tensor<type, 2>&,
+                                                              const Index&) const;
 
     Tensor<list<Index>, 1> calculate_kd_tree_neighbors(const Index& = 20, const Index& = 40) const;
 
@@ -1116,17 +1207,40 @@ private:
 
     // Isolation Forest
 
-    void calculate_min_max_indices_list(list<Index>&, const Index&, type&, type&) const;
+    /// This structure stores the nodes of all the trees of an isolation forest as consecutive arrays.
 
-    Index split_isolation_tree(Tensor<type, 2>&, list<list<Index>>&, list<Index>&) const;
+    struct IsolationForest
+    {
+        /// Position of the root node of each tree.
 
-    Tensor<type, 2> create_isolation_tree(const Tensor<Index, 1>&, const Index&) const;
+        Tensor<Index, 1> trees_offsets;
 
-    Tensor<Tensor<type, 2>, 1> create_isolation_forest(const Index&, const Index&, const Index&) const;
+        /// Input variable of each split node, or -1 for the leaves.
 
-    type calculate_tree_path(const Tensor<type, 2>&, const Index&, const Index&) const;
+        Tensor<Index, 1> features;
+
+        /// Split value of each split node, or path length of each leaf.
+
+        Tensor<type, 1> thresholds;
+
+        /// Position of the left child of each split node. The right child is next to it.
+
+        Tensor<Index, 1> children;
+    };
 
-    Tensor<type, 1> calculate_average_forest_paths(const Tensor<Tensor<type, 2>, 1>&, const Index&) const;
+    type calculate_average_path_length(const Index&) const;
+
+    void create_isolation_tree(const Tensor<type, 2>&,
+                               const Tensor<Index, 1>&,
+                               const Index&,
+                               mt19937&,
+                               vector<Index>&,
+                               vector<type>&,
+                               vector<Index>&) const;
+
+    IsolationForest create_isolation_forest(const Tensor<type, 2>&, const Index&, const Index&, const Index&) const;
+
+    Tensor<type, 1> calculate_average_forest_paths(const IsolationForest&, const Tensor<type, 2>&) const;
 
 };
 
@@ -1157,8 +1271,12 @@ struct DataSetBatch
         inputs_dimensions = get_dimensions(new_inputs);
     }
 
+    void set_sparse_inputs(const bool&);
+
     void fill(const Tensor<Index, 1>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&);
 
+    void fill_sparse_inputs(const Tensor<Index, 1>&, const Tensor<Index, 1>&);
+
     void print() const;
 
     Index batch_size = 0;
@@ -1169,6 +1287,12 @@ struct DataSetBatch
 
     Tensor<Index, 1> inputs_dimensions;
 
+    /// True if the inputs of the batch are filled in inputs_sparse instead of inputs_data.
+
+    bool sparse_inputs = false;
+
+    SparseMatrix<type, RowMajor, Index> inputs_sparse;
+
     type* targets_data;
 
     Tensor<Index, 1> targets_dimensions;
@@ -1176,6 +1300,73 @@ struct DataSetBatch
 };
 
 
+/// This structure fills the batches of an epoch in a background thread.
+///
+/// Up to queue depth batches are gathered ahead, each one in its own DataSetBatch,
+/// so that the next batches are filled while the current one is propagated.
+/// A queue depth lower than 2 fills every batch synchronously in next().
+
+struct DataSetBatchPrefetcher
+{
+    /// Default constructor.
+
+    DataSetBatchPrefetcher() {}
+
+    DataSetBatchPrefetcher(const Index&, DataSet*, const Index& = 2);
+
+    /// Destructor.
+
+    virtual ~DataSetBatchPrefetcher();
+
+    DataSetBatchPrefetcher(const DataSetBatchPrefetcher&) = delete;
+    DataSetBatchPrefetcher& operator=(const DataSetBatchPrefetcher&) = delete;
+
+    void set(const Index&, DataSet*, const Index& = 2);
+
+    void set_sparse_inputs(const bool&);
+
+    Index get_queue_depth() const;
+
+    void start(const Tensor<Index, 2>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&);
+
+    DataSetBatch& next();
+
+    void stop();
+
+private:
+
+    void produce();
+
+    Index queue_depth = 2;
+
+    vector<DataSetBatch> batches;
+
+    Tensor<Index, 2> samples_indices;
+
+    Tensor<Index, 1> inputs_indices;
+    Tensor<Index, 1> targets_indices;
+
+    /// Number of batches filled, and number of batches handed out by next().
+
+    Index filled_batches_number = 0;
+    Index consumed_batches_number = 0;
+
+    bool stopping = false;
+
+    exception_ptr producer_exception = nullptr;
+
+    /// OpenMP thread budget of the thread which started the epoch, which the producer thread follows too.
+
+    int producer_threads_number = 1;
+
+    thread producer;
+
+    mutex batches_mutex;
+
+    condition_variable batches_condition;
+};
+
+
 }
 
 #endif
@@ -101,6 +101,14 @@ const type& GradientDescent::get_maximum_time() const
 }
 
 
+/// Returns the number of shards of the training batch whose gradients are calculated concurrently.
+
+const Index& GradientDescent::get_shards_number() const
+{
+    return shards_number;
+}
+
+
 /// Sets a pointer to a loss index object to be associated with the gradient descent object.
 /// It also sets that loss index to the learning rate algorithm.
 /// @param new_loss_index_pointer Pointer to a loss index object.
@@ -125,6 +133,8 @@ void GradientDescent::set_default()
     maximum_epochs_number = 1000;
     maximum_time = type(3600);
 
+    shards_number = 1;
+
     // UTILITIES
 
     display_period = 10;
@@ -210,6 +220,30 @@ void GradientDescent::set_maximum_time(const type& new_maximum_time)
 }
 
 
+/// Sets the number of shards of the training batch whose gradients are calculated concurrently.
+/// Each shard has its own batch, forward propagation and back-propagation,
+/// and the shards gradients are added into the training gradient.
+/// This only gives the same results as the whole batch for error terms that are sums over the samples,
+/// and it is not available for recurrent, long short-term memory or batch normalization layers.
+/// @param new_shards_number Number of shards. If it is one the whole training batch is back-propagated at once.
+
+void GradientDescent::set_shards_number(const Index& new_shards_number)
+{
+    if(new_shards_number < 1)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: GradientDescent class.\n"
+               << "void set_shards_number(const Index&) method.\n"
+               << "Number of shards must be greater than 0.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    shards_number = new_shards_number;
+}
+
+
 /// Returns the gradient descent training direction,
 /// which is the negative of the normalized gradient.
 /// @param gradient Loss index gradient.
@@ -398,6 +432,13 @@ TrainingResults GradientDescent::perform_training()
     LossIndexBackPropagation training_back_propagation(training_samples_number, loss_index_pointer);
     LossIndexBackPropagation selection_back_propagation(selection_samples_number, loss_index_pointer);
 
+    LossIndexShardedBackPropagation training_sharded_back_propagation;
+
+    if(shards_number > 1)
+    {
+        training_sharded_back_propagation.set(shards_number, training_samples_indices, loss_index_pointer);
+    }
+
     // Optimization algorithm
 
     GradientDescentData optimization_data(this);
@@ -423,11 +464,18 @@ TrainingResults GradientDescent::perform_training()
 
         optimization_data.epoch = epoch;
 
-        // Neural network
-        neural_network_pointer->forward_propagate(training_batch, training_forward_propagation, switch_train);
+        // Neural network and loss index
 
-        // Loss index
-        loss_index_pointer->back_propagate(training_batch, training_forward_propagation, training_back_propagation);
+        if(shards_number > 1)
+        {
+            loss_index_pointer->back_propagate(training_sharded_back_propagation, training_back_propagation);
+        }
+        else
+        {
+            neural_network_pointer->forward_propagate(training_batch, training_forward_propagation, switch_train);
+
+            loss_index_pointer->back_propagate(training_batch, training_forward_propagation, training_back_propagation);
+        }
         results.training_error_history(epoch) = training_back_propagation.error;
 
         // Update parameters
@@ -511,6 +559,15 @@ TrainingResults GradientDescent::perform_training()
 
         old_loss = training_back_propagation.loss;
 
+        if(!stop_training && check_evaluation_rejection(epoch))
+        {
+            if(display) cout << "Epoch " << epoch << endl << "Training run rejected by the evaluation callback." << endl;
+
+            stop_training = true;
+
+            results.stopping_condition = StoppingCondition::EvaluationRejection;
+        }
+
         if(stop_training)
         {
             results.loss = training_back_propagation.loss;
@@ -691,6 +748,17 @@ void GradientDescent::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     file_stream.CloseElement();
 
+    // Shards number
+
+    file_stream.OpenElement("ShardsNumber");
+
+    buffer.str("");
+    buffer << shards_number;
+
+    file_stream.PushText(buffer.str().c_str());
+
+    file_stream.CloseElement();
+
     // Hardware use
 
     file_stream.OpenElement("HardwareUse");
@@ -834,6 +902,25 @@ void GradientDescent::from_XML(const tinyxml2::XMLDocument& document)
         }
     }
 
+    // Shards number
+    {
+        const tinyxml2::XMLElement* element = root_element->FirstChildElement("ShardsNumber");
+
+        if(element)
+        {
+            const Index new_shards_number = static_cast<Index>(atoi(element->GetText()));
+
+            try
+            {
+                set_shards_number(new_shards_number);
+            }
+            catch(const invalid_argument& e)
+            {
+                cerr << e.what() << endl;
+            }
+        }
+    }
+
     // Hardware use
     {
         const tinyxml2::XMLElement* element = root_element->FirstChildElement("HardwareUse");
@@ -70,6 +70,8 @@ public:
    const Index& get_maximum_epochs_number() const;
    const type& get_maximum_time() const;
 
+   const Index& get_shards_number() const;
+
    // Set methods
 
    void set_loss_index_pointer(LossIndex*) final;
@@ -89,6 +91,8 @@ public:
 
    void set_maximum_time(const type&);
 
+   void set_shards_number(const Index&);
+
    // Training methods
 
    void calculate_training_direction(const Tensor<type, 1>&, Tensor<type, 1>&) const;
@@ -144,6 +148,11 @@ private:
 
    type maximum_time;
 
+   /// Number of shards of the training batch whose gradients are calculated concurrently.
+   /// If it is one the whole training batch is back-propagated at once.
+
+   Index shards_number = 1;
+
 };
 
 
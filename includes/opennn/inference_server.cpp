@@ -0,0 +1,526 @@
+//   OpenNN: Open Neural Networks Library
+//   www.opennn.net
+//
+//   I N F E R E N C E   S E R V E R   C L A S S
+//
+//   Artificial Intelligence Techniques SL
+//   artelnics@artelnics.com
+
+#include "inference_server.h"
+
+namespace opennn
+{
+
+/// Number of latest requests whose latencies are kept for the percentiles.
+
+static const Index latencies_window = 4096;
+
+
+/// Neural network constructor. It starts the worker threads.
+/// @param new_neural_network_pointer Pointer to the neural network served.
+/// @param new_maximum_batch_size Maximum number of requests coalesced in a batch.
+/// @param new_maximum_delay Maximum time in microseconds that a request waits for its batch to fill.
+/// @param new_contexts_number Number of worker threads, each one with its own inference context.
+
+InferenceServer::InferenceServer(NeuralNetwork* new_neural_network_pointer,
+                                 const Index& new_maximum_batch_size,
+                                 const Index& new_maximum_delay,
+                                 const Index& new_contexts_number)
+{
+    ostringstream buffer;
+
+    if(new_neural_network_pointer == nullptr || new_neural_network_pointer->get_layers_number() == 0)
+    {
+        buffer << "OpenNN Exception: InferenceServer class.\n"
+               << "InferenceServer(NeuralNetwork*, const Index&, const Index&, const Index&) constructor.\n"
+               << "Neural network is nullptr or has no layers.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    if(new_neural_network_pointer->has_recurrent_layer() || new_neural_network_pointer->has_long_short_term_memory_layer())
+    {
+        buffer << "OpenNN Exception: InferenceServer class.\n"
+               << "InferenceServer(NeuralNetwork*, const Index&, const Index&, const Index&) constructor.\n"
+               << "Neural network cannot have recurrent or long short-term memory layers.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    if(new_maximum_batch_size < 1 || new_maximum_delay < 0 || new_contexts_number < 1)
+    {
+        buffer << "OpenNN Exception: InferenceServer class.\n"
+               << "InferenceServer(NeuralNetwork*, const Index&, const Index&, const Index&) constructor.\n"
+               << "Maximum batch size and number of contexts must be greater than 0, and maximum delay cannot be negative.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    neural_network_pointer = new_neural_network_pointer;
+    maximum_batch_size = new_maximum_batch_size;
+    maximum_delay = new_maximum_delay;
+
+    const int pool_threads_number = ThreadRuntime::get_instance().get_threads_number();
+
+    threads_budget = max(1, pool_threads_number/static_cast<int>(new_contexts_number));
+
+    latencies.resize(latencies_window);
+    latencies.setZero();
+
+    // The workers already started are stopped if another one cannot be started
+
+    try
+    {
+        for(Index i = 0; i < new_contexts_number; i++)
+        {
+            workers.push_back(thread(&InferenceServer::run_worker, this));
+        }
+    }
+    catch(...)
+    {
+        stop();
+
+        throw;
+    }
+}
+
+
+/// Destructor.
+/// It stops the server after completing the pending requests.
+
+InferenceServer::~InferenceServer()
+{
+    stop();
+}
+
+
+/// Queues a single sample request.
+/// Returns a future which gets the outputs of the neural network for that sample,
+/// or the exception thrown while calculating them.
+/// This method can be called from any number of threads.
+/// @param inputs Inputs of the sample.
+
+future<Tensor<type, 1>> InferenceServer::submit(const Tensor<type, 1>& inputs)
+{
+    if(inputs.size() != neural_network_pointer->get_inputs_number())
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: InferenceServer class.\n"
+               << "future<Tensor<type, 1>> submit(const Tensor<type, 1>&) method.\n"
+               << "Size of inputs (" << inputs.size() << ") must be equal to number of inputs ("
+               << neural_network_pointer->get_inputs_number() << ").\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    InferenceRequest request;
+
+    request.inputs = inputs;
+    request.arrival_time = chrono::steady_clock::now();
+
+    future<Tensor<type, 1>> outputs_future = request.outputs_promise.get_future();
+
+    Index queue_depth;
+
+    {
+        lock_guard<mutex> lock(requests_mutex);
+
+        if(stopping)
+        {
+            ostringstream buffer;
+
+            buffer << "OpenNN Exception: InferenceServer class.\n"
+                   << "future<Tensor<type, 1>> submit(const Tensor<type, 1>&) method.\n"
+                   << "Inference server is stopped.\n";
+
+            throw invalid_argument(buffer.str());
+        }
+
+        requests.push_back(move(request));
+
+        queue_depth = static_cast<Index>(requests.size());
+    }
+
+    // Idle workers wait for the first request, and the worker filling a batch waits for it to be full
+
+    if(queue_depth == 1 || queue_depth >= maximum_batch_size)
+    {
+        requests_condition.notify_all();
+    }
+
+    lock_guard<mutex> lock(counters_mutex);
+
+    maximum_queue_depth = max(maximum_queue_depth, queue_depth);
+
+    return outputs_future;
+}
+
+
+/// Queues a single sample request and waits for its outputs.
+/// @param inputs Inputs of the sample.
+
+Tensor<type, 1> InferenceServer::calculate_outputs(const Tensor<type, 1>& inputs)
+{
+    return submit(inputs).get();
+}
+
+
+/// Returns a pointer to the neural network served.
+
+NeuralNetwork* InferenceServer::get_neural_network_pointer() const
+{
+    return neural_network_pointer;
+}
+
+
+/// Returns the maximum number of requests in a batch.
+
+const Index& InferenceServer::get_maximum_batch_size() const
+{
+    return maximum_batch_size;
+}
+
+
+/// Returns the maximum time in microseconds that a request waits for its batch to fill.
+
+const Index& InferenceServer::get_maximum_delay() const
+{
+    return maximum_delay;
+}
+
+
+/// Returns the number of worker threads, which is the number of inference contexts.
+
+Index InferenceServer::get_contexts_number() const
+{
+    return static_cast<Index>(workers.size());
+}
+
+
+/// Returns true if the server accepts requests, and false if it has been stopped.
+
+bool InferenceServer::is_running() const
+{
+    lock_guard<mutex> lock(requests_mutex);
+
+    return !stopping;
+}
+
+
+/// Returns the number of requests waiting for a worker.
+
+Index InferenceServer::get_queue_depth() const
+{
+    lock_guard<mutex> lock(requests_mutex);
+
+    return static_cast<Index>(requests.size());
+}
+
+
+/// Returns the maximum number of requests that have been waiting at the same time.
+
+Index InferenceServer::get_maximum_queue_depth() const
+{
+    lock_guard<mutex> lock(counters_mutex);
+
+    return maximum_queue_depth;
+}
+
+
+/// Returns the number of requests completed.
+
+Index InferenceServer::get_requests_number() const
+{
+    lock_guard<mutex> lock(counters_mutex);
+
+    return requests_number;
+}
+
+
+/// Returns the number of batches run.
+
+Index InferenceServer::get_batches_number() const
+{
+    lock_guard<mutex> lock(counters_mutex);
+
+    return batches_number;
+}
+
+
+/// Returns the mean number of requests per batch.
+
+type InferenceServer::get_mean_batch_size() const
+{
+    lock_guard<mutex> lock(counters_mutex);
+
+    if(batches_number == 0) return type(0);
+
+    return type(requests_number)/type(batches_number);
+}
+
+
+/// Returns a percentile of the latencies of the latest requests, in microseconds.
+/// The latency of a request goes from its arrival to the completion of its outputs.
+/// @param percentile Percentile between 0 and 100, for instance 50, 95 or 99.
+
+type InferenceServer::calculate_latency_percentile(const type& percentile) const
+{
+    if(percentile < type(0) || percentile > type(100))
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: InferenceServer class.\n"
+               << "type calculate_latency_percentile(const type&) const method.\n"
+               << "Percentile (" << percentile << ") must be between 0 and 100.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    vector<type> sorted_latencies;
+
+    {
+        lock_guard<mutex> lock(counters_mutex);
+
+        sorted_latencies.assign(latencies.data(), latencies.data() + latencies_number);
+    }
+
+    if(sorted_latencies.empty()) return type(0);
+
+    const Index size = static_cast<Index>(sorted_latencies.size());
+
+    const Index index = min(size - 1, static_cast<Index>(ceil(percentile*type(size)/type(100))) - 1);
+
+    const auto position = sorted_latencies.begin() + max(Index(0), index);
+
+    nth_element(sorted_latencies.begin(), position, sorted_latencies.end());
+
+    return *position;
+}
+
+
+/// Sets all the counters to zero.
+
+void InferenceServer::reset_counters()
+{
+    lock_guard<mutex> lock(counters_mutex);
+
+    requests_number = 0;
+    batches_number = 0;
+    maximum_queue_depth = 0;
+
+    latencies.setZero();
+    latencies_number = 0;
+    latencies_index = 0;
+}
+
+
+/// Prints to the screen the counters of the server.
+
+void InferenceServer::print_counters() const
+{
+    cout << "Inference server counters" << endl;
+    cout << "Queue depth: " << get_queue_depth() << endl;
+    cout << "Maximum queue depth: " << get_maximum_queue_depth() << endl;
+    cout << "Requests number: " << get_requests_number() << endl;
+    cout << "Batches number: " << get_batches_number() << endl;
+    cout << "Mean batch size: " << get_mean_batch_size() << endl;
+    cout << "Latency percentile 50 (us): " << calculate_latency_percentile(type(50)) << endl;
+    cout << "Latency percentile 95 (us): " << calculate_latency_percentile(type(95)) << endl;
+    cout << "Latency percentile 99 (us): " << calculate_latency_percentile(type(99)) << endl;
+}
+
+
+/// Stops accepting requests, completes the pending ones and joins the worker threads.
+
+void InferenceServer::stop()
+{
+    {
+        lock_guard<mutex> lock(requests_mutex);
+
+        stopping = true;
+    }
+
+    requests_condition.notify_all();
+
+    for(thread& worker : workers)
+    {
+        if(worker.joinable()) worker.join();
+    }
+}
+
+
+/// Loop of a worker thread.
+/// It waits for the first request, then for the batch to fill or for the oldest request to reach the maximum delay,
+/// takes up to the maximum batch size requests and calculates their outputs in a single batch.
+/// If its inference context cannot be built, it stops the server and sets the exception in the queued requests.
+
+void InferenceServer::run_worker()
+{
+    ThreadRuntime::get_instance().set_thread_budget(threads_budget);
+
+    unique_ptr<NeuralNetworkInferenceContext> inference_context;
+
+    try
+    {
+        inference_context.reset(new NeuralNetworkInferenceContext(neural_network_pointer));
+    }
+    catch(...)
+    {
+        // The server stops, and the queued requests get the exception instead of waiting for a worker that is gone
+
+        deque<InferenceRequest> failed_requests;
+
+        {
+            lock_guard<mutex> lock(requests_mutex);
+
+            stopping = true;
+
+            failed_requests.swap(requests);
+        }
+
+        requests_condition.notify_all();
+
+        for(InferenceRequest& request : failed_requests)
+        {
+            request.outputs_promise.set_exception(current_exception());
+        }
+
+        return;
+    }
+
+    const Index inputs_number = neural_network_pointer->get_inputs_number();
+    const Index outputs_number = neural_network_pointer->get_outputs_number();
+
+    Tensor<type, 1> inputs(maximum_batch_size*inputs_number);
+    Tensor<type, 1> outputs(maximum_batch_size*outputs_number);
+
+    Tensor<Index, 1> inputs_dimensions(2);
+
+    vector<InferenceRequest> batch;
+
+    batch.reserve(static_cast<size_t>(maximum_batch_size));
+
+    while(true)
+    {
+        batch.clear();
+
+        {
+            unique_lock<mutex> lock(requests_mutex);
+
+            requests_condition.wait(lock, [this]{return stopping || !requests.empty();});
+
+            if(requests.empty()) return;
+
+            const chrono::steady_clock::time_point deadline
+                    = requests.front().arrival_time + chrono::microseconds(maximum_delay);
+
+            requests_condition.wait_until(lock, deadline,
+                                          [this]{return stopping || static_cast<Index>(requests.size()) >= maximum_batch_size;});
+
+            // Another worker could have taken the requests in the meantime
+
+            if(requests.empty()) continue;
+
+            const Index batch_size = min(maximum_batch_size, static_cast<Index>(requests.size()));
+
+            for(Index i = 0; i < batch_size; i++)
+            {
+                batch.push_back(move(requests.front()));
+
+                requests.pop_front();
+            }
+
+            if(!requests.empty()) requests_condition.notify_all();
+        }
+
+        const Index batch_size = static_cast<Index>(batch.size());
+
+        // The batch matrix is column-major, with one sample in each row
+
+        for(Index i = 0; i < batch_size; i++)
+        {
+            const type* sample_inputs_data = batch[static_cast<size_t>(i)].inputs.data();
+
+            for(Index j = 0; j < inputs_number; j++)
+            {
+                inputs(i + j*batch_size) = sample_inputs_data[j];
+            }
+        }
+
+        inputs_dimensions.setValues({batch_size, inputs_number});
+
+        try
+        {
+            neural_network_pointer->calculate_outputs(inputs.data(), inputs_dimensions, outputs.data(), *inference_context);
+        }
+        catch(...)
+        {
+            for(InferenceRequest& request : batch)
+            {
+                request.outputs_promise.set_exception(current_exception());
+            }
+
+            record_batch(batch, chrono::steady_clock::now());
+
+            continue;
+        }
+
+        for(Index i = 0; i < batch_size; i++)
+        {
+            Tensor<type, 1> sample_outputs(outputs_number);
+
+            for(Index j = 0; j < outputs_number; j++)
+            {
+                sample_outputs(j) = outputs(i + j*batch_size);
+            }
+
+            batch[static_cast<size_t>(i)].outputs_promise.set_value(move(sample_outputs));
+        }
+
+        record_batch(batch, chrono::steady_clock::now());
+    }
+}
+
+
+/// Updates the counters with a completed batch.
+/// @param batch Requests of the batch.
+/// @param completion_time Time at which the outputs of the batch were completed.
+
+void InferenceServer::record_batch(const vector<InferenceRequest>& batch, const chrono::steady_clock::time_point& completion_time)
+{
+    lock_guard<mutex> lock(counters_mutex);
+
+    batches_number++;
+
+    for(const InferenceRequest& request : batch)
+    {
+        requests_number++;
+
+        latencies(latencies_index) = type(chrono::duration<double, micro>(completion_time - request.arrival_time).count());
+
+        latencies_index = (latencies_index + 1)%latencies_window;
+
+        latencies_number = min(latencies_number + 1, latencies_window);
+    }
+}
+
+}
+
+
+// OpenNN: Open Neural Networks Library.
+// Copyright(C) 2005-2022 Artificial Intelligence Techniques, SL.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
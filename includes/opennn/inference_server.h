@@ -0,0 +1,186 @@
+//   OpenNN: Open Neural Networks Library
+//   www.opennn.net
+//
+//   I N F E R E N C E   S E R V E R   C L A S S   H E A D E R
+//
+//   Artificial Intelligence Techniques SL
+//   artelnics@artelnics.com
+
+#ifndef INFERENCESERVER_H
+#define INFERENCESERVER_H
+
+// System includes
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// OpenNN includes
+
+#include "config.h"
+#include "neural_network.h"
+#include "thread_runtime.h"
+
+namespace opennn
+{
+
+/// This class serves the outputs of a neural network to concurrent single sample requests within the process.
+///
+/// Requests from any number of threads are queued and coalesced into micro-batches,
+/// which are sent through the batched inference path of the neural network.
+/// A batch is run as soon as it is full, or when its oldest request reaches the maximum delay.
+/// Each worker thread owns an inference context, so the forward propagation buffers are reused and never shared.
+/// The neural network must not be modified while the server is running,
+/// and it cannot have recurrent or long short-term memory layers, whose states are kept by the layers.
+
+class InferenceServer
+{
+
+public:
+
+    // Constructors
+
+    explicit InferenceServer(NeuralNetwork*, const Index& = 32, const Index& = 1000, const Index& = 1);
+
+    // Destructor
+
+    virtual ~InferenceServer();
+
+    InferenceServer(const InferenceServer&) = delete;
+
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    // Requests
+
+    future<Tensor<type, 1>> submit(const Tensor<type, 1>&);
+
+    Tensor<type, 1> calculate_outputs(const Tensor<type, 1>&);
+
+    // Get methods
+
+    NeuralNetwork* get_neural_network_pointer() const;
+
+    const Index& get_maximum_batch_size() const;
+
+    const Index& get_maximum_delay() const;
+
+    Index get_contexts_number() const;
+
+    bool is_running() const;
+
+    // Counters
+
+    Index get_queue_depth() const;
+
+    Index get_maximum_queue_depth() const;
+
+    Index get_requests_number() const;
+
+    Index get_batches_number() const;
+
+    type get_mean_batch_size() const;
+
+    type calculate_latency_percentile(const type&) const;
+
+    void reset_counters();
+
+    void print_counters() const;
+
+    // Server methods
+
+    void stop();
+
+private:
+
+    /// Single sample request waiting in the queue.
+
+    struct InferenceRequest
+    {
+        Tensor<type, 1> inputs;
+
+        promise<Tensor<type, 1>> outputs_promise;
+
+        chrono::steady_clock::time_point arrival_time;
+    };
+
+    void run_worker();
+
+    void record_batch(const vector<InferenceRequest>&, const chrono::steady_clock::time_point&);
+
+    /// Pointer to the neural network served.
+
+    NeuralNetwork* neural_network_pointer = nullptr;
+
+    /// Maximum number of requests in a batch.
+
+    Index maximum_batch_size = 32;
+
+    /// Maximum time in microseconds that a request waits in the queue for its batch to fill.
+
+    Index maximum_delay = 1000;
+
+    /// Thread budget of each worker, so that the workers share the threads of the pool.
+
+    int threads_budget = 1;
+
+    /// Requests waiting for a worker.
+
+    deque<InferenceRequest> requests;
+
+    mutable mutex requests_mutex;
+
+    condition_variable requests_condition;
+
+    bool stopping = false;
+
+    /// Worker threads, each one with its own inference context.
+
+    vector<thread> workers;
+
+    // Counters
+
+    mutable mutex counters_mutex;
+
+    Index requests_number = 0;
+
+    Index batches_number = 0;
+
+    Index maximum_queue_depth = 0;
+
+    /// Latencies in microseconds of the latest requests, from the arrival to the completion of each one.
+
+    Tensor<type, 1> latencies;
+
+    Index latencies_number = 0;
+
+    Index latencies_index = 0;
+};
+
+}
+
+#endif
+
+
+// OpenNN: Open Neural Networks Library.
+// Copyright(C) 2005-2022 Artificial Intelligence Techniques, SL.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
@@ -8,12 +8,15 @@
 
 #include "layer.h"
 
+#ifdef __F16C__
+    #include <immintrin.h>
+#endif
+
 namespace opennn
 {
 
 Layer::~Layer()
 {
-    delete thread_pool;
     delete thread_pool_device;
 }
 
@@ -75,11 +78,43 @@ string Layer::get_type_string() const
 
 void Layer::set_threads_number(const int& new_threads_number)
 {
-    if(thread_pool != nullptr) delete this->thread_pool;
     if(thread_pool_device != nullptr) delete this->thread_pool_device;
 
-    thread_pool = new ThreadPool(new_threads_number);
-    thread_pool_device = new ThreadPoolDevice(thread_pool, new_threads_number);
+    thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device(new_threads_number);
+}
+
+
+/// Seeds the random engine used by set_parameters_random(), so that the initial parameters can be reproduced.
+/// @param new_random_seed Seed for the random engine of this layer.
+
+void Layer::set_random_seed(const unsigned& new_random_seed)
+{
+    random_engine.seed(new_random_seed);
+}
+
+
+/// Returns the number of threads of the OpenMP kernels of this layer for a number of tasks.
+/// It is bounded by the threads of the thread pool device and by the thread budget of the calling thread,
+/// so that the threads which share the pool with a budget, such as the workers of the inference server, do not oversubscribe it.
+/// @param tasks_number Number of tasks of the kernel.
+
+int Layer::get_kernels_threads_number(const Index& tasks_number) const
+{
+    const Index threads_number = min(Index(thread_pool_device->numThreads()), Index(omp_get_max_threads()));
+
+    return static_cast<int>(min(threads_number, tasks_number));
+}
+
+
+/// Returns a random number uniformly distributed in [minimum, maximum), drawn from the random engine of this layer.
+/// @param minimum Minimum value.
+/// @param maximum Maximum value.
+
+type Layer::calculate_random_uniform(const type& minimum, const type& maximum)
+{
+    uniform_real_distribution<type> distribution(minimum, maximum);
+
+    return distribution(random_engine);
 }
 
 
@@ -157,6 +192,44 @@ Tensor<type, 1> Layer::get_parameters() const
 }
 
 
+/// Returns true if the parameters of the layer can be stored in an external buffer, and false otherwise.
+
+bool Layer::can_bind_parameters() const
+{
+    return false;
+}
+
+
+/// Makes the layer store its parameters in an external buffer, in the same order as get_parameters.
+/// The current parameters are copied into that buffer.
+
+void Layer::bind_parameters(type*)
+{
+    ostringstream buffer;
+
+    buffer << "OpenNN Exception: Layer class.\n"
+           << "bind_parameters(type*) method.\n"
+           << "This method is not implemented in the layer type (" << get_type_string() << ").\n";
+
+    throw invalid_argument(buffer.str());
+}
+
+
+/// Makes the layer store its parameters in its own memory again.
+
+void Layer::unbind_parameters()
+{
+}
+
+
+/// Returns a pointer to the first parameter of the layer if they are stored contiguously, and nullptr otherwise.
+
+const type* Layer::get_parameters_data() const
+{
+    return nullptr;
+}
+
+
 void Layer::calculate_outputs(type*, const Tensor<Index, 1>&,  type*, const Tensor<Index, 1>&)
 {
     ostringstream buffer;
@@ -2308,6 +2381,564 @@ void Layer::competitive(type* x_data, const Tensor<Index, 1>& x_dimensions, type
 }
 
 
+void Layer::linear_fused(const type* combinations, type* activations, type* activations_derivatives, const Index& size)
+{
+    if(activations != combinations) copy(combinations, combinations + size, activations);
+
+    if(activations_derivatives != nullptr) fill_n(activations_derivatives, size, type(1));
+}
+
+
+void Layer::logistic_fused(const type* combinations, type* activations, type* activations_derivatives, const Index& size)
+{
+    const Map<const Array<type, Dynamic, 1>> x(combinations, size);
+    Map<Array<type, Dynamic, 1>> y(activations, size);
+
+    y = (type(1) + x.exp().inverse()).inverse();
+
+    if(activations_derivatives == nullptr) return;
+
+    Map<Array<type, Dynamic, 1>> dy(activations_derivatives, size);
+
+    dy = y*(type(1) - y);
+}
+
+
+void Layer::hyperbolic_tangent_fused(const type* combinations, type* activations, type* activations_derivatives, const Index& size)
+{
+    const Map<const Array<type, Dynamic, 1>> x(combinations, size);
+    Map<Array<type, Dynamic, 1>> y(activations, size);
+
+    y = x.tanh();
+
+    if(activations_derivatives == nullptr) return;
+
+    Map<Array<type, Dynamic, 1>> dy(activations_derivatives, size);
+
+    dy = type(1) - y.square();
+}
+
+
+void Layer::rectified_linear_fused(const type* combinations, type* activations, type* activations_derivatives, const Index& size)
+{
+    const Map<const Array<type, Dynamic, 1>> x(combinations, size);
+
+    if(activations_derivatives != nullptr)
+    {
+        Map<Array<type, Dynamic, 1>> dy(activations_derivatives, size);
+
+        dy = (x < type(0)).select(type(0), Array<type, Dynamic, 1>::Ones(size));
+    }
+
+    Map<Array<type, Dynamic, 1>> y(activations, size);
+
+    y = x.max(type(0));
+}
+
+
+void Layer::hard_sigmoid_fused(const type* combinations, type* activations, type* activations_derivatives, const Index& size)
+{
+    const Map<const Array<type, Dynamic, 1>> x(combinations, size);
+
+    if(activations_derivatives != nullptr)
+    {
+        Map<Array<type, Dynamic, 1>> dy(activations_derivatives, size);
+
+        dy = (x < type(-2.5) || x > type(2.5)).select(type(0), Array<type, Dynamic, 1>::Constant(size, type(0.2)));
+    }
+
+    Map<Array<type, Dynamic, 1>> y(activations, size);
+
+    y = (type(0.2)*x + type(0.5)).min(type(1)).max(type(0));
+}
+
+
+/// Calculates the combinations of a layer, inputs*synaptic_weights + biases, together with its activations and activations derivatives.
+/// All matrices are column-major, with the samples in the rows.
+/// The output matrix is split into tiles of samples and neurons which fit in the cache.
+/// For each tile, the biases, the matrix product and the activation are computed in a single sweep,
+/// instead of making a full pass over the combinations for each of them.
+/// The tiles are distributed among the threads of this layer.
+/// @param inputs_data Pointer to the inputs matrix.
+/// @param samples_number Number of rows of the inputs matrix.
+/// @param inputs_number Number of columns of the inputs matrix.
+/// @param synaptic_weights_data Pointer to the synaptic weights matrix, with as many rows as inputs.
+/// @param neurons_number Number of columns of the synaptic weights matrix.
+/// @param biases_data Pointer to the biases, with one for each neuron. If it is nullptr, no biases are added.
+/// @param combinations_data Pointer to the combinations matrix.
+/// @param activations_data Pointer to the activations matrix. It can be the combinations matrix itself.
+/// @param activations_derivatives_data Pointer to the activations derivatives matrix, or nullptr if they are not needed.
+/// @param activation Element-wise activation function. If it is nullptr, only the combinations are computed.
+/// @param accumulate True to add the product to the current combinations instead of overwriting them.
+
+void Layer::calculate_fused_combinations(const type* inputs_data, const Index& samples_number, const Index& inputs_number,
+                                         const type* synaptic_weights_data, const Index& neurons_number,
+                                         const type* biases_data,
+                                         type* combinations_data,
+                                         type* activations_data,
+                                         type* activations_derivatives_data,
+                                         FusedActivation activation,
+                                         const bool& accumulate) const
+{
+    const Index tile_samples_number = 256;
+    const Index tile_neurons_number = 64;
+
+    const Index samples_tiles_number = (samples_number + tile_samples_number - 1)/tile_samples_number;
+    const Index neurons_tiles_number = (neurons_number + tile_neurons_number - 1)/tile_neurons_number;
+
+    const Index tiles_number = samples_tiles_number*neurons_tiles_number;
+
+    if(tiles_number == 0) return;
+
+    const Map<const Matrix<type, Dynamic, Dynamic>> inputs(inputs_data, samples_number, inputs_number);
+    const Map<const Matrix<type, Dynamic, Dynamic>> synaptic_weights(synaptic_weights_data, inputs_number, neurons_number);
+
+    Map<Matrix<type, Dynamic, Dynamic>> combinations(combinations_data, samples_number, neurons_number);
+
+    const int threads_number = get_kernels_threads_number(tiles_number);
+
+    // Inside the parallel region the matrix products run on one thread each
+
+#pragma omp parallel for schedule(static) num_threads(threads_number)
+
+    for(Index tile = 0; tile < tiles_number; tile++)
+    {
+        const Index first_sample = (tile%samples_tiles_number)*tile_samples_number;
+        const Index first_neuron = (tile/samples_tiles_number)*tile_neurons_number;
+
+        const Index tile_samples = min(tile_samples_number, samples_number - first_sample);
+        const Index tile_neurons = min(tile_neurons_number, neurons_number - first_neuron);
+
+        auto combinations_tile = combinations.block(first_sample, first_neuron, tile_samples, tile_neurons);
+
+        if(accumulate)
+        {
+            combinations_tile.noalias() += inputs.middleRows(first_sample, tile_samples)
+                                         * synaptic_weights.middleCols(first_neuron, tile_neurons);
+        }
+        else
+        {
+            combinations_tile.noalias() = inputs.middleRows(first_sample, tile_samples)
+                                        * synaptic_weights.middleCols(first_neuron, tile_neurons);
+        }
+
+        for(Index j = 0; j < tile_neurons; j++)
+        {
+            const Index offset = (first_neuron + j)*samples_number + first_sample;
+
+            if(biases_data != nullptr)
+            {
+                combinations_tile.col(j).array() += biases_data[first_neuron + j];
+            }
+
+            if(activation != nullptr)
+            {
+                activation(combinations_data + offset,
+                           activations_data + offset,
+                           activations_derivatives_data == nullptr ? nullptr : activations_derivatives_data + offset,
+                           tile_samples);
+            }
+        }
+    }
+}
+
+
+/// Converts an array of half precision numbers (IEEE fp16) to single precision.
+/// The conversion works on the bits with masks instead of branches, so that the loop is vectorized,
+/// and it is exact for normal and subnormal numbers, infinities and NaNs.
+/// If the compiler targets the F16C instructions, they convert the bulk of the array.
+/// @param half_data Pointer to the half precision numbers.
+/// @param data Pointer to the single precision numbers.
+/// @param size Number of elements.
+
+static void widen_half(const half_float::half* half_data, float* data, const Index& size)
+{
+    const uint16_t* half_bits = reinterpret_cast<const uint16_t*>(half_data);
+
+    const uint32_t exponent_mask = 0x0F800000u;
+    const uint32_t exponent_adjust = 0x38000000u;
+
+    float subnormal_adjust;
+    const uint32_t subnormal_adjust_bits = 0x38800000u;
+    memcpy(&subnormal_adjust, &subnormal_adjust_bits, sizeof(float));
+
+    Index first = 0;
+
+#ifdef __F16C__
+
+    // Hardware conversion of eight numbers at a time
+
+    for(; first + 8 <= size; first += 8)
+    {
+        _mm256_storeu_ps(data + first, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(half_bits + first))));
+    }
+
+#endif
+
+#pragma omp simd
+    for(Index i = first; i < size; i++)
+    {
+        const uint32_t bits = half_bits[i];
+
+        const uint32_t sign = (bits & 0x8000u) << 16;
+
+        uint32_t magnitude = (bits & 0x7FFFu) << 13;
+
+        const uint32_t exponent = magnitude & exponent_mask;
+
+        // Infinities and NaNs keep the maximum exponent, and subnormal numbers are renormalized
+
+        const uint32_t infinity_mask = 0u - static_cast<uint32_t>(exponent == exponent_mask);
+        const uint32_t subnormal_mask = 0u - static_cast<uint32_t>(exponent == 0);
+
+        magnitude += exponent_adjust + (exponent_adjust & infinity_mask);
+
+        const uint32_t subnormal_bits = magnitude + 0x00800000u;
+
+        float subnormal;
+        memcpy(&subnormal, &subnormal_bits, sizeof(float));
+
+        subnormal -= subnormal_adjust;
+
+        uint32_t renormalized_bits;
+        memcpy(&renormalized_bits, &subnormal, sizeof(float));
+
+        const uint32_t value_bits = (magnitude & ~subnormal_mask) | (renormalized_bits & subnormal_mask) | sign;
+
+        memcpy(data + i, &value_bits, sizeof(float));
+    }
+}
+
+
+/// Calculates the combinations of a layer whose synaptic weights are stored in half precision (IEEE fp16).
+/// The output matrix is split into tiles as in calculate_fused_combinations.
+/// The synaptic weights of the neurons of each tile are widened to single precision in a buffer of the thread,
+/// so the weights are read from memory with half the traffic while the arithmetic is done in single precision.
+/// @param inputs_data Pointer to the inputs matrix, column-major with the samples in the rows.
+/// @param samples_number Number of rows of the inputs matrix.
+/// @param inputs_number Number of columns of the inputs matrix.
+/// @param half_synaptic_weights_data Pointer to the half precision synaptic weights, with one column per neuron.
+/// @param neurons_number Number of neurons.
+/// @param biases_data Pointer to the biases.
+/// @param combinations_data Pointer to the combinations matrix.
+/// @param activations_data Pointer to the activations matrix. It is only written if there is an activation.
+/// @param activation Element-wise activation applied to the combinations, or nullptr.
+
+void Layer::calculate_half_combinations(const type* inputs_data, const Index& samples_number, const Index& inputs_number,
+                                        const half_float::half* half_synaptic_weights_data, const Index& neurons_number,
+                                        const type* biases_data,
+                                        type* combinations_data,
+                                        type* activations_data,
+                                        FusedActivation activation) const
+{
+    const Index tile_samples_number = 256;
+    const Index tile_neurons_number = 64;
+
+    const Index samples_tiles_number = (samples_number + tile_samples_number - 1)/tile_samples_number;
+    const Index neurons_tiles_number = (neurons_number + tile_neurons_number - 1)/tile_neurons_number;
+
+    const Index tiles_number = samples_tiles_number*neurons_tiles_number;
+
+    if(tiles_number == 0) return;
+
+    const Map<const Matrix<type, Dynamic, Dynamic>> inputs(inputs_data, samples_number, inputs_number);
+
+    Map<Matrix<type, Dynamic, Dynamic>> combinations(combinations_data, samples_number, neurons_number);
+
+    const int threads_number = get_kernels_threads_number(tiles_number);
+
+#pragma omp parallel num_threads(threads_number)
+    {
+        Matrix<type, Dynamic, Dynamic> synaptic_weights(inputs_number, tile_neurons_number);
+
+        Index widened_first_neuron = -1;
+
+#pragma omp for schedule(static)
+
+        for(Index tile = 0; tile < tiles_number; tile++)
+        {
+            const Index first_sample = (tile%samples_tiles_number)*tile_samples_number;
+            const Index first_neuron = (tile/samples_tiles_number)*tile_neurons_number;
+
+            const Index tile_samples = min(tile_samples_number, samples_number - first_sample);
+            const Index tile_neurons = min(tile_neurons_number, neurons_number - first_neuron);
+
+            // Consecutive tiles of a thread usually share the neurons, so their weights are widened once
+
+            if(first_neuron != widened_first_neuron)
+            {
+                widen_half(half_synaptic_weights_data + first_neuron*inputs_number,
+                           synaptic_weights.data(),
+                           inputs_number*tile_neurons);
+
+                widened_first_neuron = first_neuron;
+            }
+
+            auto combinations_tile = combinations.block(first_sample, first_neuron, tile_samples, tile_neurons);
+
+            combinations_tile.noalias() = inputs.middleRows(first_sample, tile_samples)
+                                        * synaptic_weights.leftCols(tile_neurons);
+
+            for(Index j = 0; j < tile_neurons; j++)
+            {
+                const Index offset = (first_neuron + j)*samples_number + first_sample;
+
+                combinations_tile.col(j).array() += biases_data[first_neuron + j];
+
+                if(activation != nullptr)
+                {
+                    activation(combinations_data + offset, activations_data + offset, nullptr, tile_samples);
+                }
+            }
+        }
+    }
+}
+
+
+/// Quantizes the synaptic weights of a dense layer to 8 bits, with one symmetric scale per neuron.
+/// The weights of each neuron are mapped to [-127, 127], so that weight = scale*quantized_weight.
+/// @param synaptic_weights_data Pointer to the synaptic weights matrix, with one column per neuron.
+/// @param inputs_number Number of rows of the synaptic weights matrix.
+/// @param neurons_number Number of columns of the synaptic weights matrix.
+/// @param quantized_synaptic_weights Quantized synaptic weights, with the same layout.
+/// @param synaptic_weights_scales Scale of the synaptic weights of each neuron.
+
+void Layer::quantize_synaptic_weights(const type* synaptic_weights_data, const Index& inputs_number, const Index& neurons_number,
+                                      Tensor<int8_t, 2>& quantized_synaptic_weights,
+                                      Tensor<type, 1>& synaptic_weights_scales) const
+{
+    quantized_synaptic_weights.resize(inputs_number, neurons_number);
+    synaptic_weights_scales.resize(neurons_number);
+
+    for(Index j = 0; j < neurons_number; j++)
+    {
+        const type* column = synaptic_weights_data + j*inputs_number;
+
+        type maximum = type(0);
+
+        for(Index i = 0; i < inputs_number; i++) maximum = max(maximum, abs(column[i]));
+
+        const type scale = maximum > type(0) ? maximum/type(127) : type(1);
+
+        synaptic_weights_scales(j) = scale;
+
+        for(Index i = 0; i < inputs_number; i++)
+        {
+            quantized_synaptic_weights(i,j) = static_cast<int8_t>(min(max(round(column[i]/scale), type(-127)), type(127)));
+        }
+    }
+}
+
+
+/// Calculates the combinations of a layer with 8 bits synaptic weights and inputs, and 32 bits accumulation.
+/// The inputs are quantized with a single symmetric scale, calibrated beforehand, and stored sample by sample,
+/// so that each combination is the dot product of two contiguous rows of bytes.
+/// The samples are split into tiles which fit in the cache, and the tiles are distributed among the threads of this layer.
+/// The combinations are then rescaled, the biases added and the activation applied to each column of the tile.
+/// @param inputs_data Pointer to the inputs matrix, column-major with the samples in the rows.
+/// @param samples_number Number of rows of the inputs matrix.
+/// @param inputs_number Number of columns of the inputs matrix.
+/// @param quantized_synaptic_weights_data Pointer to the quantized synaptic weights, with one column per neuron.
+/// @param synaptic_weights_scales_data Pointer to the scale of the synaptic weights of each neuron.
+/// @param neurons_number Number of neurons.
+/// @param inputs_scale Scale of the inputs.
+/// @param biases_data Pointer to the biases.
+/// @param quantized_inputs_data Pointer to a buffer of samples_number*inputs_number bytes for the quantized inputs.
+/// @param combinations_data Pointer to the combinations matrix.
+/// @param activations_data Pointer to the activations matrix. It is only written if there is an activation.
+/// @param activation Element-wise activation applied to the combinations, or nullptr.
+
+void Layer::calculate_quantized_combinations(const type* inputs_data, const Index& samples_number, const Index& inputs_number,
+                                             const int8_t* quantized_synaptic_weights_data, const type* synaptic_weights_scales_data, const Index& neurons_number,
+                                             const type& inputs_scale,
+                                             const type* biases_data,
+                                             int8_t* quantized_inputs_data,
+                                             type* combinations_data,
+                                             type* activations_data,
+                                             FusedActivation activation) const
+{
+    const Index tile_samples_number = 64;
+
+    const Index tiles_number = (samples_number + tile_samples_number - 1)/tile_samples_number;
+
+    if(tiles_number == 0) return;
+
+    const type inverse_inputs_scale = type(1)/inputs_scale;
+
+    const int threads_number = get_kernels_threads_number(tiles_number);
+
+#pragma omp parallel for schedule(static) num_threads(threads_number)
+
+    for(Index tile = 0; tile < tiles_number; tile++)
+    {
+        const Index first_sample = tile*tile_samples_number;
+        const Index tile_samples = min(tile_samples_number, samples_number - first_sample);
+
+        for(Index k = 0; k < tile_samples; k++)
+        {
+            int8_t* quantized_inputs_row = quantized_inputs_data + (first_sample + k)*inputs_number;
+
+            for(Index i = 0; i < inputs_number; i++)
+            {
+                const type value = round(inputs_data[first_sample + k + i*samples_number]*inverse_inputs_scale);
+
+                quantized_inputs_row[i] = static_cast<int8_t>(min(max(value, type(-127)), type(127)));
+            }
+        }
+
+        for(Index j = 0; j < neurons_number; j++)
+        {
+            const int8_t* quantized_synaptic_weights_column = quantized_synaptic_weights_data + j*inputs_number;
+
+            const type scale = inputs_scale*synaptic_weights_scales_data[j];
+            const type bias = biases_data[j];
+
+            type* combinations_column = combinations_data + j*samples_number + first_sample;
+
+            for(Index k = 0; k < tile_samples; k++)
+            {
+                const int8_t* quantized_inputs_row = quantized_inputs_data + (first_sample + k)*inputs_number;
+
+                int32_t sum = 0;
+
+#pragma omp simd reduction(+:sum)
+                for(Index i = 0; i < inputs_number; i++)
+                {
+                    sum += static_cast<int32_t>(quantized_inputs_row[i])*static_cast<int32_t>(quantized_synaptic_weights_column[i]);
+                }
+
+                combinations_column[k] = scale*static_cast<type>(sum) + bias;
+            }
+
+            if(activation != nullptr)
+            {
+                activation(combinations_column,
+                           activations_data + j*samples_number + first_sample,
+                           nullptr,
+                           tile_samples);
+            }
+        }
+    }
+}
+
+
+/// Serializes the 8 bits synaptic weights of a quantized dense layer.
+/// @param file_stream TinyXML printer.
+/// @param inputs_scale Scale of the inputs.
+/// @param synaptic_weights_scales Scale of the synaptic weights of each neuron.
+/// @param quantized_synaptic_weights Quantized synaptic weights.
+
+void Layer::write_quantization_XML(tinyxml2::XMLPrinter& file_stream,
+                                   const type& inputs_scale,
+                                   const Tensor<type, 1>& synaptic_weights_scales,
+                                   const Tensor<int8_t, 2>& quantized_synaptic_weights) const
+{
+    ostringstream buffer;
+
+    buffer.precision(9);
+
+    file_stream.OpenElement("Quantization");
+
+    // Inputs scale
+
+    file_stream.OpenElement("InputsScale");
+
+    buffer << inputs_scale;
+
+    file_stream.PushText(buffer.str().c_str());
+
+    file_stream.CloseElement();
+
+    // Synaptic weights scales
+
+    file_stream.OpenElement("SynapticWeightsScales");
+
+    buffer.str("");
+
+    for(Index i = 0; i < synaptic_weights_scales.size(); i++)
+    {
+        buffer << synaptic_weights_scales(i);
+
+        if(i != synaptic_weights_scales.size()-1) buffer << " ";
+    }
+
+    file_stream.PushText(buffer.str().c_str());
+
+    file_stream.CloseElement();
+
+    // Quantized synaptic weights
+
+    file_stream.OpenElement("QuantizedSynapticWeights");
+
+    buffer.str("");
+
+    for(Index i = 0; i < quantized_synaptic_weights.size(); i++)
+    {
+        buffer << static_cast<int>(quantized_synaptic_weights(i));
+
+        if(i != quantized_synaptic_weights.size()-1) buffer << " ";
+    }
+
+    file_stream.PushText(buffer.str().c_str());
+
+    file_stream.CloseElement();
+
+    // Quantization (end tag)
+
+    file_stream.CloseElement();
+}
+
+
+/// Loads the 8 bits synaptic weights of a quantized dense layer.
+/// The quantized synaptic weights must already have the dimensions of the layer.
+/// @param quantization_element Quantization element of the layer.
+/// @param inputs_scale Scale of the inputs.
+/// @param synaptic_weights_scales Scale of the synaptic weights of each neuron.
+/// @param quantized_synaptic_weights Quantized synaptic weights.
+
+void Layer::quantization_from_XML(const tinyxml2::XMLElement* quantization_element,
+                                  type& inputs_scale,
+                                  Tensor<type, 1>& synaptic_weights_scales,
+                                  Tensor<int8_t, 2>& quantized_synaptic_weights) const
+{
+    const tinyxml2::XMLElement* inputs_scale_element = quantization_element->FirstChildElement("InputsScale");
+    const tinyxml2::XMLElement* scales_element = quantization_element->FirstChildElement("SynapticWeightsScales");
+    const tinyxml2::XMLElement* weights_element = quantization_element->FirstChildElement("QuantizedSynapticWeights");
+
+    const Tensor<string, 1> scales_tokens
+            = scales_element && scales_element->GetText() ? get_tokens(scales_element->GetText(), ' ') : Tensor<string, 1>();
+
+    const Tensor<string, 1> weights_tokens
+            = weights_element && weights_element->GetText() ? get_tokens(weights_element->GetText(), ' ') : Tensor<string, 1>();
+
+    if(!inputs_scale_element || !inputs_scale_element->GetText()
+    || scales_tokens.size() != quantized_synaptic_weights.dimension(1)
+    || weights_tokens.size() != quantized_synaptic_weights.size())
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: Layer class.\n"
+               << "void quantization_from_XML(const tinyxml2::XMLElement*, type&, Tensor<type, 1>&, Tensor<int8_t, 2>&) const method.\n"
+               << "Quantization element does not match the layer.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    inputs_scale = type(atof(inputs_scale_element->GetText()));
+
+    synaptic_weights_scales.resize(scales_tokens.size());
+
+    for(Index i = 0; i < scales_tokens.size(); i++)
+    {
+        synaptic_weights_scales(i) = type(atof(scales_tokens(i).c_str()));
+    }
+
+    for(Index i = 0; i < weights_tokens.size(); i++)
+    {
+        quantized_synaptic_weights(i) = static_cast<int8_t>(atoi(weights_tokens(i).c_str()));
+    }
+}
+
 }
 
 // OpenNN: Open Neural Networks Library.
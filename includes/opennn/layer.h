@@ -20,10 +20,12 @@
 #include <ctype.h>
 #include <iostream>
 #include <vector>
+#include <random>
 
 // OpenNN includes
 
 #include "config.h"
+#include "thread_runtime.h"
 #include "tensor_utilities.h"
 #include "statistics.h"
 #include "data_set.h"
@@ -64,10 +66,7 @@ public:
 
     explicit Layer()   
     {
-        const int n = omp_get_max_threads();
-
-        thread_pool = new ThreadPool(n);
-        thread_pool_device = new ThreadPoolDevice(thread_pool, n);
+        thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device();
     }
 
     // Destructor
@@ -85,6 +84,8 @@ public:
 
     virtual void set_parameters_random();
 
+    void set_random_seed(const unsigned&);
+
     // Architecture
 
     virtual Index get_parameters_number() const;
@@ -94,6 +95,13 @@ public:
 
     virtual void set_parameters(const Tensor<type, 1>&, const Index&);
 
+    // Parameters arena
+
+    virtual bool can_bind_parameters() const;
+    virtual void bind_parameters(type*);
+    virtual void unbind_parameters();
+    virtual const type* get_parameters_data() const;
+
     void set_threads_number(const int&);
 
     virtual void insert_gradient(LayerBackPropagation*, const Index&, Tensor<type, 1>&) const {}
@@ -153,15 +161,22 @@ public:
 
     virtual void write_XML(tinyxml2::XMLPrinter&) const {}
 
+    virtual void write_XML(tinyxml2::XMLPrinter& file_stream, const bool&) const {write_XML(file_stream);}
+
     // Expression methods
 
     virtual string write_expression(const Tensor<string, 1>&, const Tensor<string, 1>&) const {return string();}
 
 protected:
 
-    ThreadPool* thread_pool = nullptr;
     ThreadPoolDevice* thread_pool_device = nullptr;
 
+    /// Random engine used to initialize the parameters of this layer.
+
+    mt19937 random_engine = mt19937(random_device()());
+
+    type calculate_random_uniform(const type& = type(0), const type& = type(1));
+
     /// Layer name.
 
     string layer_name = "layer";
@@ -200,6 +215,64 @@ protected:
     void symmetric_threshold_derivatives(type*, const Tensor<Index, 1>&, type*, const Tensor<Index, 1>&, type*, const Tensor<Index, 1>&) const;
     void threshold_derivatives(type*, const Tensor<Index, 1>&, type*, const Tensor<Index, 1>&, type*, const Tensor<Index, 1>&) const;
 
+    int get_kernels_threads_number(const Index&) const;
+
+    /// Fused combinations and activations
+
+    /// Element-wise activation applied by calculate_fused_combinations to each contiguous column of a tile.
+    /// The arguments are the combinations, the activations, the activations derivatives (nullptr if they are not needed) and the number of elements.
+
+    typedef void (*FusedActivation)(const type*, type*, type*, const Index&);
+
+    static void linear_fused(const type*, type*, type*, const Index&);
+    static void logistic_fused(const type*, type*, type*, const Index&);
+    static void hyperbolic_tangent_fused(const type*, type*, type*, const Index&);
+    static void rectified_linear_fused(const type*, type*, type*, const Index&);
+    static void hard_sigmoid_fused(const type*, type*, type*, const Index&);
+
+    void calculate_fused_combinations(const type*, const Index&, const Index&,
+                                      const type*, const Index&,
+                                      const type*,
+                                      type*,
+                                      type*,
+                                      type*,
+                                      FusedActivation = nullptr,
+                                      const bool& = false) const;
+
+    /// Quantized combinations
+
+    void quantize_synaptic_weights(const type*, const Index&, const Index&,
+                                   Tensor<int8_t, 2>&,
+                                   Tensor<type, 1>&) const;
+
+    void calculate_quantized_combinations(const type*, const Index&, const Index&,
+                                          const int8_t*, const type*, const Index&,
+                                          const type&,
+                                          const type*,
+                                          int8_t*,
+                                          type*,
+                                          type*,
+                                          FusedActivation = nullptr) const;
+
+    void write_quantization_XML(tinyxml2::XMLPrinter&,
+                                const type&,
+                                const Tensor<type, 1>&,
+                                const Tensor<int8_t, 2>&) const;
+
+    void quantization_from_XML(const tinyxml2::XMLElement*,
+                               type&,
+                               Tensor<type, 1>&,
+                               Tensor<int8_t, 2>&) const;
+
+    /// Half precision combinations
+
+    void calculate_half_combinations(const type*, const Index&, const Index&,
+                                     const half_float::half*, const Index&,
+                                     const type*,
+                                     type*,
+                                     type*,
+                                     FusedActivation = nullptr) const;
+
     const Eigen::array<IndexPair<Index>, 1> A_BT = {IndexPair<Index>(1, 1)};
     const Eigen::array<IndexPair<Index>, 1> AT_B = {IndexPair<Index>(0, 0)};
     const Eigen::array<IndexPair<Index>, 1> A_B = {IndexPair<Index>(1, 0)};
@@ -244,6 +317,11 @@ struct LayerBackPropagation
 
     virtual void set(const Index&, Layer*) {}
 
+    /// Makes the layer write its gradient directly into an external buffer.
+    /// Returns false if the layer does not support it.
+
+    virtual bool bind_gradient(type*) { return false; }
+
     virtual void print() const {}   
 
     virtual Tensor< TensorMap< Tensor<type, 1> >*, 1> get_layer_gradient() {
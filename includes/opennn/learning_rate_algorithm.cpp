@@ -37,7 +37,6 @@ LearningRateAlgorithm::LearningRateAlgorithm(LossIndex* new_loss_index_pointer)
 
 LearningRateAlgorithm::~LearningRateAlgorithm()
 {
-    delete thread_pool;
     delete thread_pool_device;
 }
 
@@ -150,12 +149,9 @@ void LearningRateAlgorithm::set(LossIndex* new_loss_index_pointer)
 
 void LearningRateAlgorithm::set_default()
 {
-    delete thread_pool;
     delete thread_pool_device;
 
-    const int n = omp_get_max_threads();
-    thread_pool = new ThreadPool(n);
-    thread_pool_device = new ThreadPoolDevice(thread_pool, n);
+    thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device();
 
     // TRAINING OPERATORS
 
@@ -179,11 +175,9 @@ void LearningRateAlgorithm::set_loss_index_pointer(LossIndex* new_loss_index_poi
 
 void LearningRateAlgorithm::set_threads_number(const int& new_threads_number)
 {
-    if(thread_pool != nullptr) delete this->thread_pool;
     if(thread_pool_device != nullptr) delete this->thread_pool_device;
 
-    thread_pool = new ThreadPool(new_threads_number);
-    thread_pool_device = new ThreadPoolDevice(thread_pool, new_threads_number);
+    thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device(new_threads_number);
 }
 
 
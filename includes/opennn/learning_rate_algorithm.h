@@ -23,6 +23,7 @@
 // OpenNN includes
 
 #include "config.h"
+#include "thread_runtime.h"
 #include "neural_network.h"
 #include "loss_index.h"
 #include "optimization_algorithm.h"
@@ -289,7 +290,6 @@ protected:
 
    const type golden_ratio = static_cast<type>(1.618);
 
-   ThreadPool* thread_pool = nullptr;
    ThreadPoolDevice* thread_pool_device = nullptr;
 };
 
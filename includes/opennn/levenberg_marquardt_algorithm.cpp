@@ -107,6 +107,15 @@ const type& LevenbergMarquardtAlgorithm::get_maximum_damping_parameter() const
 }
 
 
+/// Returns the number of samples whose squared errors Jacobian is stored at once.
+/// Zero means that the Jacobian of the whole training batch is stored.
+
+const Index& LevenbergMarquardtAlgorithm::get_jacobian_chunk_size() const
+{
+    return jacobian_chunk_size;
+}
+
+
 /// Sets the following default values for the Levenberg-Marquardt algorithm:
 /// Training parameters:
 /// <ul>
@@ -146,6 +155,8 @@ void LevenbergMarquardtAlgorithm::set_default()
 
     minimum_damping_parameter = static_cast<type>(1.0e-6);
     maximum_damping_parameter = static_cast<type>(1.0e6);
+
+    jacobian_chunk_size = 0;
 }
 
 
@@ -241,6 +252,28 @@ void LevenbergMarquardtAlgorithm::set_maximum_damping_parameter(const type& new_
 }
 
 
+/// Sets the number of samples whose squared errors Jacobian is stored at once.
+/// If it is smaller than the number of training samples, the products of the Jacobian are accumulated
+/// chunk by chunk and the peak memory of the Jacobian does not depend on the data set size.
+/// @param new_jacobian_chunk_size Number of samples per chunk, or zero to store the whole Jacobian.
+
+void LevenbergMarquardtAlgorithm::set_jacobian_chunk_size(const Index& new_jacobian_chunk_size)
+{
+    if(new_jacobian_chunk_size < 0)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: LevenbergMarquardtAlgorithm class.\n"
+               << "void set_jacobian_chunk_size(const Index&) method.\n"
+               << "Jacobian chunk size must be equal or greater than 0.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    jacobian_chunk_size = new_jacobian_chunk_size;
+}
+
+
 /// Sets a new minimum loss improvement during training.
 /// @param new_minimum_loss_decrease Minimum improvement in the loss between two iterations.
 
@@ -431,14 +464,27 @@ TrainingResults LevenbergMarquardtAlgorithm::perform_training()
         unscaling_layer_pointer->set(target_variables_descriptives, target_variables_scalers);
     }
 
-    DataSetBatch training_batch(training_samples_number, data_set_pointer);
-    training_batch.fill(training_samples_indices, input_variables_indices, target_variables_indices);
+    // In chunked mode the training structures hold one chunk, and they are also used for the selection error
+
+    const bool is_chunked = jacobian_chunk_size > 0 && jacobian_chunk_size < training_samples_number;
+
+    const Index batch_samples_number = is_chunked ? jacobian_chunk_size : training_samples_number;
 
-    DataSetBatch selection_batch(selection_samples_number, data_set_pointer);
-    selection_batch.fill(selection_samples_indices, input_variables_indices, target_variables_indices);
+    DataSetBatch training_batch(batch_samples_number, data_set_pointer);
+    DataSetBatch selection_batch;
 
-    NeuralNetworkForwardPropagation training_forward_propagation(training_samples_number, neural_network_pointer);
-    NeuralNetworkForwardPropagation selection_forward_propagation(selection_samples_number, neural_network_pointer);
+    NeuralNetworkForwardPropagation training_forward_propagation(batch_samples_number, neural_network_pointer);
+    NeuralNetworkForwardPropagation selection_forward_propagation;
+
+    if(!is_chunked)
+    {
+        training_batch.fill(training_samples_indices, input_variables_indices, target_variables_indices);
+
+        selection_batch.set(selection_samples_number, data_set_pointer);
+        selection_batch.fill(selection_samples_indices, input_variables_indices, target_variables_indices);
+
+        selection_forward_propagation.set(selection_samples_number, neural_network_pointer);
+    }
 
     // Loss index
 
@@ -449,8 +495,10 @@ TrainingResults LevenbergMarquardtAlgorithm::perform_training()
 
     Index selection_failures = 0;
 
-    LossIndexBackPropagationLM training_back_propagation_lm(training_samples_number, loss_index_pointer);
-    LossIndexBackPropagationLM selection_back_propagation_lm(selection_samples_number, loss_index_pointer);
+    LossIndexBackPropagationLM training_back_propagation_lm(batch_samples_number, loss_index_pointer);
+    LossIndexBackPropagationLM selection_back_propagation_lm;
+
+    if(!is_chunked) selection_back_propagation_lm.set(selection_samples_number, loss_index_pointer);
 
     // Training strategy stuff
 
@@ -472,21 +520,40 @@ TrainingResults LevenbergMarquardtAlgorithm::perform_training()
 
         optimization_data.epoch = epoch;
 
-        // Neural network
+        if(is_chunked)
+        {
+            back_propagate_lm_chunks(training_samples_indices,
+                                     training_batch,
+                                     training_forward_propagation,
+                                     training_back_propagation_lm);
+        }
+        else
+        {
+            // Neural network
 
-        neural_network_pointer->forward_propagate(training_batch,
-                                                  training_forward_propagation,
-                                                  switch_train);
+            neural_network_pointer->forward_propagate(training_batch,
+                                                      training_forward_propagation,
+                                                      switch_train);
 
-        // Loss index
+            // Loss index
 
-        loss_index_pointer->back_propagate_lm(training_batch,
-                                              training_forward_propagation,
-                                              training_back_propagation_lm);
+            loss_index_pointer->back_propagate_lm(training_batch,
+                                                  training_forward_propagation,
+                                                  training_back_propagation_lm);
+        }
 
         results.training_error_history(epoch) = training_back_propagation_lm.error;
 
-        if(has_selection)
+        if(has_selection && is_chunked)
+        {
+            results.selection_error_history(epoch) = calculate_error_lm_chunks(selection_samples_indices,
+                                                                               training_batch,
+                                                                               training_forward_propagation,
+                                                                               training_back_propagation_lm);
+
+            if(epoch != 0 && results.selection_error_history(epoch) > results.selection_error_history(epoch-1)) selection_failures++;
+        }
+        else if(has_selection)
         {
             neural_network_pointer->forward_propagate(selection_batch,
                                                       selection_forward_propagation,
@@ -517,7 +584,7 @@ TrainingResults LevenbergMarquardtAlgorithm::perform_training()
         if(display && epoch%display_period == 0)
         {
             cout << "Training error: " << training_back_propagation_lm.error << endl;
-            if(has_selection) cout << "Selection error: " << selection_back_propagation_lm.error << endl;
+            if(has_selection) cout << "Selection error: " << results.selection_error_history(epoch) << endl;
             cout << "Damping parameter: " << damping_parameter << endl;
             cout << "Elapsed time: " << write_time(elapsed_time) << endl;
         }
@@ -571,6 +638,15 @@ TrainingResults LevenbergMarquardtAlgorithm::perform_training()
             results.stopping_condition = StoppingCondition::MaximumTime;
         }
 
+        if(!stop_training && check_evaluation_rejection(epoch))
+        {
+            if(display) cout << "Epoch " << epoch << endl << "Training run rejected by the evaluation callback." << endl;
+
+            stop_training = true;
+
+            results.stopping_condition = StoppingCondition::EvaluationRejection;
+        }
+
         if(stop_training)
         {
             results.loss = training_back_propagation_lm.loss;
@@ -591,10 +667,21 @@ TrainingResults LevenbergMarquardtAlgorithm::perform_training()
 
         if(epoch != 0 && epoch%save_period == 0) neural_network_pointer->save(neural_network_file_name);
 
-        update_parameters(training_batch,
-                          training_forward_propagation,
-                          training_back_propagation_lm,
-                          optimization_data);
+        if(is_chunked)
+        {
+            update_parameters_chunks(training_samples_indices,
+                                     training_batch,
+                                     training_forward_propagation,
+                                     training_back_propagation_lm,
+                                     optimization_data);
+        }
+        else
+        {
+            update_parameters(training_batch,
+                              training_forward_propagation,
+                              training_back_propagation_lm,
+                              optimization_data);
+        }
     }
 
     if(neural_network_pointer->get_project_type() == NeuralNetwork::ProjectType::AutoAssociation)
@@ -702,34 +789,288 @@ void LevenbergMarquardtAlgorithm::update_parameters(const DataSetBatch& batch,
         }
     }while(damping_parameter < maximum_damping_parameter);
 
-    if(!success)
+    if(!success) calculate_epsilon_parameters_increment(back_propagation_lm, optimization_data);
+
+    // Set parameters
+
+    neural_network_pointer->set_parameters(back_propagation_lm.parameters);
+}
+
+
+/// Moves each parameter by the machine epsilon against its gradient.
+/// It is used when no damping parameter decreases the loss.
+
+void LevenbergMarquardtAlgorithm::calculate_epsilon_parameters_increment(LossIndexBackPropagationLM& back_propagation_lm,
+                                                                         LevenbergMarquardtAlgorithmData& optimization_data) const
+{
+    const Index parameters_number = back_propagation_lm.parameters.size();
+
+    for(Index i = 0; i < parameters_number; i++)
     {
-        const Index parameters_number = back_propagation_lm.parameters.size();
+        if(abs(back_propagation_lm.gradient(i)) < type(NUMERIC_LIMITS_MIN))
+        {
+            optimization_data.parameters_increment(i) = type(0);
+        }
+        else if(back_propagation_lm.gradient(i) > type(0))
+        {
+            back_propagation_lm.parameters(i) -= numeric_limits<type>::epsilon();
 
-        for(Index i = 0; i < parameters_number; i++)
+            optimization_data.parameters_increment(i) = -numeric_limits<type>::epsilon();
+        }
+        else if(back_propagation_lm.gradient(i) < type(0))
         {
-            if(abs(back_propagation_lm.gradient(i)) < type(NUMERIC_LIMITS_MIN))
-            {
-                back_propagation_lm.parameters(i) = back_propagation_lm.parameters(i);
+            back_propagation_lm.parameters(i) += numeric_limits<type>::epsilon();
 
-                optimization_data.parameters_increment(i) = type(0);
-            }
-            else if(back_propagation_lm.gradient(i) > type(0))
-            {
-                back_propagation_lm.parameters(i) -= numeric_limits<type>::epsilon();
-                        //= nextafter(back_propagation_lm.parameters(i), back_propagation_lm.parameters(i)-1);
+            optimization_data.parameters_increment(i) = numeric_limits<type>::epsilon();
+        }
+    }
+}
+
+
+/// Fills the samples indices of the chunk which starts at a given position.
+/// All the chunks have the batch size of the back-propagation structures.
+/// If fewer samples remain, the chunk is completed at its beginning with preceding samples, which must be skipped.
+/// Returns the number of leading samples to be skipped in the chunk.
+/// @param samples_indices Indices of all the samples.
+/// @param first_sample Position of the first sample of the chunk.
+/// @param chunk_samples_indices Indices of the samples in the chunk.
+
+Index LevenbergMarquardtAlgorithm::fill_chunk_samples_indices(const Tensor<Index, 1>& samples_indices,
+                                                             const Index& first_sample,
+                                                             Tensor<Index, 1>& chunk_samples_indices) const
+{
+    const Index samples_number = samples_indices.size();
+    const Index chunk_size = chunk_samples_indices.size();
+
+    const Index skipped_samples_number = chunk_size - min(chunk_size, samples_number - first_sample);
+
+    for(Index i = 0; i < chunk_size; i++)
+    {
+        const Index index = ((first_sample - skipped_samples_number + i)%samples_number + samples_number)%samples_number;
+
+        chunk_samples_indices(i) = samples_indices(index);
+    }
+
+    return skipped_samples_number;
+}
+
+
+/// Calculates the loss, gradient and hessian approximation of the Levenberg-Marquardt algorithm
+/// without storing the squared errors Jacobian of all the samples.
+/// The Jacobian is calculated for one chunk of samples at a time, and its products J^T J and J^T e
+/// are accumulated into the hessian and the gradient of the back-propagation structure.
+/// @param samples_indices Indices of the samples.
+
+void LevenbergMarquardtAlgorithm::back_propagate_lm_chunks(const Tensor<Index, 1>& samples_indices,
+                                                          DataSetBatch& batch,
+                                                          NeuralNetworkForwardPropagation& forward_propagation,
+                                                          LossIndexBackPropagationLM& back_propagation_lm) const
+{
+    DataSet* data_set_pointer = loss_index_pointer->get_data_set_pointer();
+
+    NeuralNetwork* neural_network_pointer = loss_index_pointer->get_neural_network_pointer();
+
+    const Tensor<Index, 1> input_variables_indices = data_set_pointer->get_input_variables_indices();
+    const Tensor<Index, 1> target_variables_indices = data_set_pointer->get_target_variables_indices();
+
+    const Index samples_number = samples_indices.size();
+    const Index chunk_size = back_propagation_lm.batch_samples_number;
+    const Index parameters_number = back_propagation_lm.parameters.size();
+
+    Tensor<Index, 1> chunk_samples_indices(chunk_size);
+
+    Map<Matrix<type, Dynamic, Dynamic>> hessian(back_propagation_lm.hessian.data(), parameters_number, parameters_number);
+    Map<Matrix<type, Dynamic, 1>> gradient(back_propagation_lm.gradient.data(), parameters_number);
+
+    hessian.setZero();
+    gradient.setZero();
+
+    type squared_errors_sum = type(0);
+
+    bool switch_train = true;
+
+    for(Index first_sample = 0; first_sample < samples_number; first_sample += chunk_size)
+    {
+        const Index skipped_samples_number = fill_chunk_samples_indices(samples_indices, first_sample, chunk_samples_indices);
+
+        const Index chunk_samples_number = chunk_size - skipped_samples_number;
+
+        batch.fill(chunk_samples_indices, input_variables_indices, target_variables_indices);
+
+        neural_network_pointer->forward_propagate(batch, forward_propagation, switch_train);
+
+        loss_index_pointer->calculate_errors_lm(batch, forward_propagation, back_propagation_lm);
+
+        loss_index_pointer->calculate_squared_errors_lm(batch, forward_propagation, back_propagation_lm);
+
+        loss_index_pointer->calculate_layers_delta_lm(batch, forward_propagation, back_propagation_lm);
+
+        loss_index_pointer->calculate_squared_errors_jacobian_lm(batch, forward_propagation, back_propagation_lm);
+
+        const Map<const Matrix<type, Dynamic, Dynamic>, 0, OuterStride<>> squared_errors_jacobian(
+                back_propagation_lm.squared_errors_jacobian.data() + skipped_samples_number,
+                chunk_samples_number,
+                parameters_number,
+                OuterStride<>(chunk_size));
+
+        const Map<const Matrix<type, Dynamic, 1>> squared_errors(
+                back_propagation_lm.squared_errors.data() + skipped_samples_number,
+                chunk_samples_number);
+
+        hessian.selfadjointView<Lower>().rankUpdate(squared_errors_jacobian.transpose());
+
+        gradient.noalias() += squared_errors_jacobian.transpose()*squared_errors;
+
+        squared_errors_sum += squared_errors.squaredNorm();
+    }
+
+    #pragma omp parallel for
+    for(Index j = 0; j < parameters_number; j++)
+        for(Index i = 0; i < j; i++)
+            hessian(i,j) = hessian(j,i);
+
+    const type coefficient = loss_index_pointer->calculate_error_coefficient_lm(samples_number);
+
+    back_propagation_lm.error = coefficient*squared_errors_sum;
+
+    back_propagation_lm.gradient.device(*thread_pool_device) = type(2)*coefficient*back_propagation_lm.gradient;
+
+    back_propagation_lm.hessian.device(*thread_pool_device) = type(2)*coefficient*back_propagation_lm.hessian;
+
+    // Loss
+
+    back_propagation_lm.loss = back_propagation_lm.error;
+
+    // Regularization
+
+    if(loss_index_pointer->get_regularization_method() != LossIndex::RegularizationMethod::NoRegularization)
+    {
+        const type regularization_weight = loss_index_pointer->get_regularization_weight();
+
+        const type regularization = loss_index_pointer->calculate_regularization(back_propagation_lm.parameters);
+
+        back_propagation_lm.loss += regularization_weight*regularization;
+
+        loss_index_pointer->calculate_regularization_gradient(back_propagation_lm.parameters, back_propagation_lm.regularization_gradient);
+
+        back_propagation_lm.gradient.device(*thread_pool_device) += regularization_weight*back_propagation_lm.regularization_gradient;
+
+        loss_index_pointer->calculate_regularization_hessian(back_propagation_lm.parameters, back_propagation_lm.regularization_hessian);
+
+        back_propagation_lm.hessian.device(*thread_pool_device) += regularization_weight*back_propagation_lm.regularization_hessian;
+    }
+}
+
+
+/// Calculates the error of the neural network over some samples, one chunk of samples at a time.
+/// Only the errors of the back-propagation structure are modified.
+/// @param samples_indices Indices of the samples.
+
+type LevenbergMarquardtAlgorithm::calculate_error_lm_chunks(const Tensor<Index, 1>& samples_indices,
+                                                           DataSetBatch& batch,
+                                                           NeuralNetworkForwardPropagation& forward_propagation,
+                                                           LossIndexBackPropagationLM& back_propagation_lm) const
+{
+    DataSet* data_set_pointer = loss_index_pointer->get_data_set_pointer();
+
+    NeuralNetwork* neural_network_pointer = loss_index_pointer->get_neural_network_pointer();
+
+    const Tensor<Index, 1> input_variables_indices = data_set_pointer->get_input_variables_indices();
+    const Tensor<Index, 1> target_variables_indices = data_set_pointer->get_target_variables_indices();
+
+    const Index samples_number = samples_indices.size();
+    const Index chunk_size = back_propagation_lm.batch_samples_number;
+
+    Tensor<Index, 1> chunk_samples_indices(chunk_size);
+
+    type squared_errors_sum = type(0);
+
+    bool switch_train = true;
+
+    for(Index first_sample = 0; first_sample < samples_number; first_sample += chunk_size)
+    {
+        const Index skipped_samples_number = fill_chunk_samples_indices(samples_indices, first_sample, chunk_samples_indices);
+
+        batch.fill(chunk_samples_indices, input_variables_indices, target_variables_indices);
+
+        neural_network_pointer->forward_propagate(batch, forward_propagation, switch_train);
+
+        loss_index_pointer->calculate_errors_lm(batch, forward_propagation, back_propagation_lm);
+
+        loss_index_pointer->calculate_squared_errors_lm(batch, forward_propagation, back_propagation_lm);
+
+        const Map<const Matrix<type, Dynamic, 1>> squared_errors(
+                back_propagation_lm.squared_errors.data() + skipped_samples_number,
+                chunk_size - skipped_samples_number);
+
+        squared_errors_sum += squared_errors.squaredNorm();
+    }
 
-                optimization_data.parameters_increment(i) = -numeric_limits<type>::epsilon();
+    return loss_index_pointer->calculate_error_coefficient_lm(samples_number)*squared_errors_sum;
+}
+
+
+/// Updates the parameters with the hessian approximation and the gradient accumulated by back_propagate_lm_chunks.
+/// The damped system is solved with a Cholesky decomposition made in place on the hessian storage,
+/// which is restored and factorized again at each damping retry, without recalculating the Jacobian.
+/// The loss at the potential parameters is evaluated chunk by chunk.
+/// @param samples_indices Indices of the training samples.
+
+void LevenbergMarquardtAlgorithm::update_parameters_chunks(const Tensor<Index, 1>& samples_indices,
+                                                          DataSetBatch& batch,
+                                                          NeuralNetworkForwardPropagation& forward_propagation,
+                                                          LossIndexBackPropagationLM& back_propagation_lm,
+                                                          LevenbergMarquardtAlgorithmData& optimization_data)
+{
+    const type regularization_weight = loss_index_pointer->get_regularization_weight();
+
+    NeuralNetwork* neural_network_pointer = loss_index_pointer->get_neural_network_pointer();
+
+    bool success = false;
+
+    do
+    {
+        if(perform_damped_Cholesky_decomposition(back_propagation_lm.hessian,
+                                                 damping_parameter,
+                                                 back_propagation_lm.gradient,
+                                                 optimization_data.parameters_increment))
+        {
+            optimization_data.potential_parameters.device(*thread_pool_device)
+                    = back_propagation_lm.parameters - optimization_data.parameters_increment;
+
+            neural_network_pointer->set_parameters(optimization_data.potential_parameters);
+
+            type new_loss;
+
+            try{
+                new_loss = calculate_error_lm_chunks(samples_indices, batch, forward_propagation, back_propagation_lm)
+                        + regularization_weight*loss_index_pointer->calculate_regularization(optimization_data.potential_parameters);
+            }catch(const invalid_argument&)
+            {
+                new_loss = back_propagation_lm.loss;
             }
-            else if(back_propagation_lm.gradient(i) < type(0))
+
+            if(new_loss < back_propagation_lm.loss) // succesfull step
             {
-                back_propagation_lm.parameters(i) += numeric_limits<type>::epsilon();
-                        //= nextafter(back_propagation_lm.parameters(i), back_propagation_lm.parameters(i)+1);
+                set_damping_parameter(damping_parameter/damping_parameter_factor);
+
+                optimization_data.parameters_increment.device(*thread_pool_device) = -optimization_data.parameters_increment;
+
+                back_propagation_lm.parameters = optimization_data.potential_parameters;
 
-                optimization_data.parameters_increment(i) = numeric_limits<type>::epsilon();
+                back_propagation_lm.loss = new_loss;
+
+                success = true;
+
+                break;
             }
         }
-    }
+
+        set_damping_parameter(damping_parameter*damping_parameter_factor);
+
+    }while(damping_parameter < maximum_damping_parameter);
+
+    if(!success) calculate_epsilon_parameters_increment(back_propagation_lm, optimization_data);
 
     // Set parameters
 
@@ -756,6 +1097,11 @@ Tensor<string, 2> LevenbergMarquardtAlgorithm::to_string_matrix() const
     labels_values(0,0) = "Damping parameter factor";
     labels_values(0,1) = to_string(double(damping_parameter_factor));
 
+    // Jacobian chunk size
+
+    labels_values(1,0) = "Jacobian chunk size";
+    labels_values(1,1) = to_string(jacobian_chunk_size);
+
     // Minimum loss decrease
 
     labels_values(2,0) = "Minimum loss decrease";
@@ -806,6 +1152,17 @@ void LevenbergMarquardtAlgorithm::write_XML(tinyxml2::XMLPrinter& file_stream) c
 
     file_stream.CloseElement();
 
+    // Jacobian chunk size
+
+    file_stream.OpenElement("JacobianChunkSize");
+
+    buffer.str("");
+    buffer << jacobian_chunk_size;
+
+    file_stream.PushText(buffer.str().c_str());
+
+    file_stream.CloseElement();
+
     // Minimum loss decrease
 
     file_stream.OpenElement("MinimumLossDecrease");
@@ -1006,6 +1363,25 @@ void LevenbergMarquardtAlgorithm::from_XML(const tinyxml2::XMLDocument& document
         }
     }
 
+    // Jacobian chunk size
+    {
+        const tinyxml2::XMLElement* element = root_element->FirstChildElement("JacobianChunkSize");
+
+        if(element)
+        {
+            const Index new_jacobian_chunk_size = static_cast<Index>(atoi(element->GetText()));
+
+            try
+            {
+                set_jacobian_chunk_size(new_jacobian_chunk_size);
+            }
+            catch(const invalid_argument& e)
+            {
+                cerr << e.what() << endl;
+            }
+        }
+    }
+
     // Hardware use
     {
         const tinyxml2::XMLElement* element = root_element->FirstChildElement("HardwareUse");
@@ -76,6 +76,8 @@ public:
    const type& get_minimum_damping_parameter() const;
    const type& get_maximum_damping_parameter() const;
 
+   const Index& get_jacobian_chunk_size() const;
+
    // Set methods
 
    void set_default() override;
@@ -87,6 +89,8 @@ public:
    void set_minimum_damping_parameter(const type&);
    void set_maximum_damping_parameter(const type&);
 
+   void set_jacobian_chunk_size(const Index&);
+
    // Stopping criteria
 
    void set_minimum_loss_decrease(const type&);
@@ -109,6 +113,29 @@ public:
            LossIndexBackPropagationLM&,
            LevenbergMarquardtAlgorithmData&);
 
+   void calculate_epsilon_parameters_increment(LossIndexBackPropagationLM&, LevenbergMarquardtAlgorithmData&) const;
+
+   // Chunked training methods
+
+   Index fill_chunk_samples_indices(const Tensor<Index, 1>&, const Index&, Tensor<Index, 1>&) const;
+
+   void back_propagate_lm_chunks(const Tensor<Index, 1>&,
+                                 DataSetBatch&,
+                                 NeuralNetworkForwardPropagation&,
+                                 LossIndexBackPropagationLM&) const;
+
+   type calculate_error_lm_chunks(const Tensor<Index, 1>&,
+                                  DataSetBatch&,
+                                  NeuralNetworkForwardPropagation&,
+                                  LossIndexBackPropagationLM&) const;
+
+   void update_parameters_chunks(
+           const Tensor<Index, 1>&,
+           DataSetBatch&,
+           NeuralNetworkForwardPropagation&,
+           LossIndexBackPropagationLM&,
+           LevenbergMarquardtAlgorithmData&);
+
    string write_optimization_algorithm_type() const final;
 
    // Serialization methods
@@ -139,6 +166,11 @@ private:
 
    type damping_parameter_factor;
 
+   /// Number of samples whose squared errors Jacobian is stored at once.
+   /// If it is zero the Jacobian of the whole training batch is stored.
+
+   Index jacobian_chunk_size = 0;
+
    // Stopping criteria 
 
    /// Minimum loss improvement between two successive iterations. It is a stopping criterion.
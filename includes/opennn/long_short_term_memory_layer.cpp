@@ -44,7 +44,7 @@ LongShortTermMemoryLayer::LongShortTermMemoryLayer(const Index& new_inputs_numbe
 
 Index LongShortTermMemoryLayer::get_inputs_number() const
 {
-    return input_weights.dimension(0);
+    return weights.dimension(0);
 }
 
 
@@ -52,7 +52,7 @@ Index LongShortTermMemoryLayer::get_inputs_number() const
 
 Index LongShortTermMemoryLayer::get_neurons_number() const
 {
-    return output_biases.size();
+    return biases.size()/4;
 }
 
 
@@ -73,7 +73,9 @@ Index LongShortTermMemoryLayer::get_parameters_number() const
 
 Tensor<type, 1> LongShortTermMemoryLayer::get_forget_biases() const
 {
-    return forget_biases;
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 1>>(biases.data(), neurons_number);
 }
 
 
@@ -83,7 +85,9 @@ Tensor<type, 1> LongShortTermMemoryLayer::get_forget_biases() const
 
 Tensor<type, 1> LongShortTermMemoryLayer::get_input_biases() const
 {
-    return input_biases;
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 1>>(biases.data() + neurons_number, neurons_number);
 }
 
 
@@ -93,7 +97,9 @@ Tensor<type, 1> LongShortTermMemoryLayer::get_input_biases() const
 
 Tensor<type, 1> LongShortTermMemoryLayer::get_state_biases() const
 {
-    return state_biases;
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 1>>(biases.data() + 2*neurons_number, neurons_number);
 }
 
 
@@ -103,7 +109,9 @@ Tensor<type, 1> LongShortTermMemoryLayer::get_state_biases() const
 
 Tensor<type, 1> LongShortTermMemoryLayer::get_output_biases() const
 {
-    return output_biases;
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 1>>(biases.data() + 3*neurons_number, neurons_number);
 }
 
 /// Returns the forget weights from the lstm.
@@ -113,7 +121,10 @@ Tensor<type, 1> LongShortTermMemoryLayer::get_output_biases() const
 ///
 Tensor<type, 2> LongShortTermMemoryLayer::get_forget_weights() const
 {
-    return forget_weights;
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 2>>(weights.data(), inputs_number, neurons_number);
 }
 
 /// Returns the input weights from the lstm.
@@ -123,7 +134,10 @@ Tensor<type, 2> LongShortTermMemoryLayer::get_forget_weights() const
 
 Tensor<type, 2> LongShortTermMemoryLayer::get_input_weights() const
 {
-    return input_weights;
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 2>>(weights.data() + inputs_number*neurons_number, inputs_number, neurons_number);
 }
 
 
@@ -134,7 +148,10 @@ Tensor<type, 2> LongShortTermMemoryLayer::get_input_weights() const
 
 Tensor<type, 2> LongShortTermMemoryLayer::get_state_weights() const
 {
-    return state_weights;
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 2>>(weights.data() + 2*inputs_number*neurons_number, inputs_number, neurons_number);
 }
 
 /// Returns the output weights from the lstm.
@@ -144,7 +161,10 @@ Tensor<type, 2> LongShortTermMemoryLayer::get_state_weights() const
 
 Tensor<type, 2> LongShortTermMemoryLayer::get_output_weights() const
 {
-    return output_weights;
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 2>>(weights.data() + 3*inputs_number*neurons_number, inputs_number, neurons_number);
 }
 
 
@@ -155,7 +175,9 @@ Tensor<type, 2> LongShortTermMemoryLayer::get_output_weights() const
 
 Tensor<type, 2> LongShortTermMemoryLayer::get_forget_recurrent_weights() const
 {
-    return forget_recurrent_weights;
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 2>>(recurrent_weights.data(), neurons_number, neurons_number);
 }
 
 
@@ -166,7 +188,9 @@ Tensor<type, 2> LongShortTermMemoryLayer::get_forget_recurrent_weights() const
 
 Tensor<type, 2> LongShortTermMemoryLayer::get_input_recurrent_weights() const
 {
-    return input_recurrent_weights;
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 2>>(recurrent_weights.data() + neurons_number*neurons_number, neurons_number, neurons_number);
 }
 
 
@@ -177,7 +201,9 @@ Tensor<type, 2> LongShortTermMemoryLayer::get_input_recurrent_weights() const
 
 Tensor<type, 2> LongShortTermMemoryLayer::get_state_recurrent_weights() const
 {
-    return state_recurrent_weights;
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 2>>(recurrent_weights.data() + 2*neurons_number*neurons_number, neurons_number, neurons_number);
 }
 
 
@@ -188,7 +214,9 @@ Tensor<type, 2> LongShortTermMemoryLayer::get_state_recurrent_weights() const
 
 Tensor<type, 2> LongShortTermMemoryLayer::get_output_recurrent_weights() const
 {
-    return output_recurrent_weights;
+    const Index neurons_number = get_neurons_number();
+
+    return TensorMap<const Tensor<type, 2>>(recurrent_weights.data() + 3*neurons_number*neurons_number, neurons_number, neurons_number);
 }
 
 
@@ -210,81 +238,19 @@ Tensor<type, 1> LongShortTermMemoryLayer::get_parameters() const
 
     Tensor<type, 1> parameters(parameters_number);
 
-    Index current_position = forget_biases.size();
+    // The forget, input, state and output blocks of biases, weights and recurrent weights follow each other
 
-    // Biases
-
-    copy(forget_biases.data(),
-         forget_biases.data() + forget_biases.size(),
+    copy(biases.data(),
+         biases.data() + biases.size(),
          parameters.data());
 
-    copy(input_biases.data(),
-         input_biases.data() + input_biases.size(),
-         parameters.data() + current_position);
-
-    current_position += input_biases.size();
-
-    copy(state_biases.data(),
-         state_biases.data() + state_biases.size(),
-         parameters.data() + current_position);
+    copy(weights.data(),
+         weights.data() + weights.size(),
+         parameters.data() + biases.size());
 
-    current_position += state_biases.size();
-
-    copy(output_biases.data(),
-         output_biases.data() + output_biases.size(),
-         parameters.data() + current_position);
-
-    current_position += output_biases.size();
-
-    // Weights
-
-    copy(forget_weights.data(),
-         forget_weights.data() + forget_weights.size(),
-         parameters.data() + current_position);
-
-    current_position += forget_weights.size();
-
-    copy(input_weights.data(),
-         input_weights.data() + input_weights.size(),
-         parameters.data() + current_position);
-
-    current_position += input_weights.size();
-
-    copy(state_weights.data(),
-         state_weights.data() + state_weights.size(),
-         parameters.data() + current_position);
-
-    current_position += state_weights.size();
-
-    copy(output_weights.data(),
-         output_weights.data() + output_weights.size(),
-         parameters.data() + current_position);
-
-    current_position += output_weights.size();
-
-    // Recurrent weights
-
-    copy(forget_recurrent_weights.data(),
-         forget_recurrent_weights.data() + forget_recurrent_weights.size(),
-         parameters.data() + current_position);
-
-    current_position += forget_recurrent_weights.size();
-
-    copy(input_recurrent_weights.data(),
-         input_recurrent_weights.data() + input_recurrent_weights.size(),
-         parameters.data() + current_position);
-
-    current_position += input_recurrent_weights.size();
-
-    copy(state_recurrent_weights.data(),
-         state_recurrent_weights.data() + state_recurrent_weights.size(),
-         parameters.data() + current_position);
-
-    current_position += state_recurrent_weights.size();
-
-    copy(output_recurrent_weights.data(),
-         output_recurrent_weights.data() + output_recurrent_weights.size(),
-         parameters.data() + current_position);
+    copy(recurrent_weights.data(),
+         recurrent_weights.data() + recurrent_weights.size(),
+         parameters.data() + biases.size() + weights.size());
 
     return parameters;
 }
@@ -292,20 +258,11 @@ Tensor<type, 1> LongShortTermMemoryLayer::get_parameters() const
 
 Tensor< TensorMap< Tensor<type, 1> >*, 1> LongShortTermMemoryLayer::get_layer_parameters()
 {
-    Tensor< TensorMap< Tensor<type, 1> >*, 1> layer_parameters(12);
-
-    layer_parameters(0) = new TensorMap<Tensor<type, 1>>(input_biases.data(), input_biases.size());
-    layer_parameters(1) = new TensorMap<Tensor<type, 1>>(forget_biases.data(), input_biases.size());
-    layer_parameters(2) = new TensorMap<Tensor<type, 1>>(state_biases.data(), state_biases.size());
-    layer_parameters(3) = new TensorMap<Tensor<type, 1>>(output_biases.data(), output_biases.size());
-    layer_parameters(4) = new TensorMap<Tensor<type, 1>>(input_weights.data(), input_weights.size());
-    layer_parameters(5) = new TensorMap<Tensor<type, 1>>(forget_weights.data(), forget_weights.size());
-    layer_parameters(6) = new TensorMap<Tensor<type, 1>>(state_weights.data(), state_weights.size());
-    layer_parameters(7) = new TensorMap<Tensor<type, 1>>(output_weights.data(), output_weights.size());
-    layer_parameters(8) = new TensorMap<Tensor<type, 1>>(input_recurrent_weights.data(), input_recurrent_weights.size());
-    layer_parameters(9) = new TensorMap<Tensor<type, 1>>(forget_recurrent_weights.data(), forget_recurrent_weights.size());
-    layer_parameters(10) = new TensorMap<Tensor<type, 1>>(state_recurrent_weights.data(), state_recurrent_weights.size());
-    layer_parameters(11) = new TensorMap<Tensor<type, 1>>(output_recurrent_weights.data(), output_recurrent_weights.size());
+    Tensor< TensorMap< Tensor<type, 1> >*, 1> layer_parameters(3);
+
+    layer_parameters(0) = new TensorMap<Tensor<type, 1>>(biases.data(), biases.size());
+    layer_parameters(1) = new TensorMap<Tensor<type, 1>>(weights.data(), weights.size());
+    layer_parameters(2) = new TensorMap<Tensor<type, 1>>(recurrent_weights.data(), recurrent_weights.size());
 
     return layer_parameters;
 }
@@ -422,20 +379,11 @@ void LongShortTermMemoryLayer::set()
 
 void LongShortTermMemoryLayer::set(const Index& new_inputs_number, const Index& new_neurons_number)
 {
-    input_biases.resize(new_neurons_number);
-    forget_biases.resize(new_neurons_number);
-    state_biases.resize(new_neurons_number);
-    output_biases.resize(new_neurons_number);
+    biases.resize(4*new_neurons_number);
 
-    input_weights.resize(new_inputs_number, new_neurons_number);
-    forget_weights.resize(new_inputs_number, new_neurons_number);
-    state_weights.resize(new_inputs_number, new_neurons_number);
-    output_weights.resize(new_inputs_number, new_neurons_number);
+    weights.resize(new_inputs_number, 4*new_neurons_number);
 
-    input_recurrent_weights.resize(new_neurons_number, new_neurons_number);
-    forget_recurrent_weights.resize(new_neurons_number, new_neurons_number);
-    state_recurrent_weights.resize(new_neurons_number, new_neurons_number);
-    output_recurrent_weights.resize(new_neurons_number, new_neurons_number);
+    recurrent_weights.resize(new_neurons_number, 4*new_neurons_number);
 
     hidden_states.resize(new_neurons_number); // memory
     hidden_states.setZero();
@@ -523,7 +471,9 @@ void LongShortTermMemoryLayer::set_neurons_number(const Index& new_neurons_numbe
 
 void LongShortTermMemoryLayer::set_forget_biases(const Tensor<type, 1>& new_biases)
 {
-    forget_biases = new_biases;
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_biases.data(), new_biases.data() + neurons_number, biases.data());
 }
 
 
@@ -532,7 +482,9 @@ void LongShortTermMemoryLayer::set_forget_biases(const Tensor<type, 1>& new_bias
 
 void LongShortTermMemoryLayer::set_input_biases(const Tensor<type, 1>& new_biases)
 {
-    input_biases = new_biases;
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_biases.data(), new_biases.data() + neurons_number, biases.data() + neurons_number);
 }
 
 
@@ -541,7 +493,9 @@ void LongShortTermMemoryLayer::set_input_biases(const Tensor<type, 1>& new_biase
 
 void LongShortTermMemoryLayer::set_state_biases(const Tensor<type, 1>& new_biases)
 {
-    state_biases = new_biases;
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_biases.data(), new_biases.data() + neurons_number, biases.data() + 2*neurons_number);
 }
 
 
@@ -550,7 +504,9 @@ void LongShortTermMemoryLayer::set_state_biases(const Tensor<type, 1>& new_biase
 
 void LongShortTermMemoryLayer::set_output_biases(const Tensor<type, 1>& new_biases)
 {
-    output_biases = new_biases;
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_biases.data(), new_biases.data() + neurons_number, biases.data() + 3*neurons_number);
 }
 
 
@@ -562,7 +518,10 @@ void LongShortTermMemoryLayer::set_output_biases(const Tensor<type, 1>& new_bias
 
 void LongShortTermMemoryLayer::set_forget_weights(const Tensor<type, 2>& new_forget_weights)
 {
-    forget_weights = new_forget_weights;
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_forget_weights.data(), new_forget_weights.data() + inputs_number*neurons_number, weights.data());
 }
 
 
@@ -574,7 +533,10 @@ void LongShortTermMemoryLayer::set_forget_weights(const Tensor<type, 2>& new_for
 
 void LongShortTermMemoryLayer::set_input_weights(const Tensor<type, 2>& new_input_weight)
 {
-    input_weights = new_input_weight;
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_input_weight.data(), new_input_weight.data() + inputs_number*neurons_number, weights.data() + inputs_number*neurons_number);
 }
 
 
@@ -586,7 +548,10 @@ void LongShortTermMemoryLayer::set_input_weights(const Tensor<type, 2>& new_inpu
 
 void LongShortTermMemoryLayer::set_state_weights(const Tensor<type, 2>& new_state_weights)
 {
-    state_weights = new_state_weights;
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_state_weights.data(), new_state_weights.data() + inputs_number*neurons_number, weights.data() + 2*inputs_number*neurons_number);
 }
 
 
@@ -598,8 +563,10 @@ void LongShortTermMemoryLayer::set_state_weights(const Tensor<type, 2>& new_stat
 
 void LongShortTermMemoryLayer::set_output_weights(const Tensor<type, 2>& new_output_weight)
 {
-    output_weights = new_output_weight;
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
 
+    copy(new_output_weight.data(), new_output_weight.data() + inputs_number*neurons_number, weights.data() + 3*inputs_number*neurons_number);
 }
 
 
@@ -611,7 +578,9 @@ void LongShortTermMemoryLayer::set_output_weights(const Tensor<type, 2>& new_out
 
 void LongShortTermMemoryLayer::set_forget_recurrent_weights(const Tensor<type, 2>& new_forget_recurrent_weight)
 {
-    forget_recurrent_weights = new_forget_recurrent_weight;
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_forget_recurrent_weight.data(), new_forget_recurrent_weight.data() + neurons_number*neurons_number, recurrent_weights.data());
 }
 
 
@@ -624,7 +593,9 @@ void LongShortTermMemoryLayer::set_forget_recurrent_weights(const Tensor<type, 2
 
 void LongShortTermMemoryLayer::set_input_recurrent_weights(const Tensor<type, 2>& new_input_recurrent_weight)
 {
-    input_recurrent_weights = new_input_recurrent_weight;
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_input_recurrent_weight.data(), new_input_recurrent_weight.data() + neurons_number*neurons_number, recurrent_weights.data() + neurons_number*neurons_number);
 }
 
 
@@ -636,7 +607,9 @@ void LongShortTermMemoryLayer::set_input_recurrent_weights(const Tensor<type, 2>
 
 void LongShortTermMemoryLayer::set_state_recurrent_weights(const Tensor<type, 2>& new_state_recurrent_weight)
 {
-    state_recurrent_weights = new_state_recurrent_weight;
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_state_recurrent_weight.data(), new_state_recurrent_weight.data() + neurons_number*neurons_number, recurrent_weights.data() + 2*neurons_number*neurons_number);
 }
 
 
@@ -648,7 +621,9 @@ void LongShortTermMemoryLayer::set_state_recurrent_weights(const Tensor<type, 2>
 
 void LongShortTermMemoryLayer::set_output_recurrent_weights(const Tensor<type, 2>& new_output_recurrent_weight)
 {
-    output_recurrent_weights = new_output_recurrent_weight;
+    const Index neurons_number = get_neurons_number();
+
+    copy(new_output_recurrent_weight.data(), new_output_recurrent_weight.data() + neurons_number*neurons_number, recurrent_weights.data() + 3*neurons_number*neurons_number);
 }
 
 
@@ -657,94 +632,17 @@ void LongShortTermMemoryLayer::set_output_recurrent_weights(const Tensor<type, 2
 
 void LongShortTermMemoryLayer::set_parameters(const Tensor<type, 1>& new_parameters, const Index& index)
 {
-    const Index neurons_number = get_neurons_number();
-    const Index inputs_number = get_inputs_number();
-
-    Index current_index = index;
-
-    // Biases
-
-    Index size = neurons_number;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         forget_biases.data());
-
-    current_index += size;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         input_biases.data());
-
-    current_index += size;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         state_biases.data());
-
-    current_index += size;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         output_biases.data());
-
-    current_index += size;
-
-    // Weights
-
-    size = inputs_number*neurons_number;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         forget_weights.data());
-
-    current_index += size;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         input_weights.data());
-
-    current_index += size;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         state_weights.data());
-
-    current_index += size;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         output_weights.data());
-
-    current_index += size;
-
-    // Recurrent weights
-
-    size = neurons_number*neurons_number;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         forget_recurrent_weights.data());
-
-    current_index += size;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         input_recurrent_weights.data());
+    copy(new_parameters.data() + index,
+         new_parameters.data() + index + biases.size(),
+         biases.data());
 
-    current_index += size;
+    copy(new_parameters.data() + index + biases.size(),
+         new_parameters.data() + index + biases.size() + weights.size(),
+         weights.data());
 
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         state_recurrent_weights.data());
-
-    current_index += size;
-
-    copy(new_parameters.data() + current_index,
-         new_parameters.data() + current_index + size,
-         output_recurrent_weights.data());
-
-    current_index += size;
+    copy(new_parameters.data() + index + biases.size() + weights.size(),
+         new_parameters.data() + index + biases.size() + weights.size() + recurrent_weights.size(),
+         recurrent_weights.data());
 }
 
 
@@ -917,10 +815,7 @@ void LongShortTermMemoryLayer::set_display(const bool& new_display)
 
 void LongShortTermMemoryLayer::set_biases_constant(const type& value)
 {
-    forget_biases.setConstant(value);
-    input_biases.setConstant(value);
-    state_biases.setConstant(value);
-    output_biases.setConstant(value);
+    biases.setConstant(value);
 }
 
 
@@ -929,7 +824,9 @@ void LongShortTermMemoryLayer::set_biases_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_forget_biases_constant(const type& value)
 {
-    forget_biases.setConstant(value);
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(biases.data(), neurons_number, value);
 }
 
 
@@ -938,7 +835,9 @@ void LongShortTermMemoryLayer::set_forget_biases_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_input_biases_constant(const type& value)
 {
-    input_biases.setConstant(value);
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(biases.data() + neurons_number, neurons_number, value);
 }
 
 
@@ -947,7 +846,9 @@ void LongShortTermMemoryLayer::set_input_biases_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_state_biases_constant(const type& value)
 {
-    state_biases.setConstant(value);
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(biases.data() + 2*neurons_number, neurons_number, value);
 }
 
 
@@ -956,7 +857,9 @@ void LongShortTermMemoryLayer::set_state_biases_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_output_biases_constant(const type& value)
 {
-    output_biases.setConstant(value);
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(biases.data() + 3*neurons_number, neurons_number, value);
 }
 
 
@@ -965,10 +868,7 @@ void LongShortTermMemoryLayer::set_output_biases_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_weights_constant(const type& value)
 {
-    forget_weights.setConstant(value);
-    input_weights.setConstant(value);
-    state_weights.setConstant(value);
-    output_weights.setConstant(value);
+    weights.setConstant(value);
 }
 
 
@@ -977,7 +877,10 @@ void LongShortTermMemoryLayer::set_weights_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_forget_weights_constant(const type& value)
 {
-    forget_weights.setConstant(value);
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(weights.data(), inputs_number*neurons_number, value);
 }
 
 
@@ -986,7 +889,10 @@ void LongShortTermMemoryLayer::set_forget_weights_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_input_weights_constant(const type& value)
 {
-    input_weights.setConstant(value);
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(weights.data() + inputs_number*neurons_number, inputs_number*neurons_number, value);
 }
 
 
@@ -995,7 +901,10 @@ void LongShortTermMemoryLayer::set_input_weights_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_state_weights_constant(const type& value)
 {
-    state_weights.setConstant(value);
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(weights.data() + 2*inputs_number*neurons_number, inputs_number*neurons_number, value);
 }
 
 
@@ -1004,7 +913,10 @@ void LongShortTermMemoryLayer::set_state_weights_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_output_weights_constant(const type&  value)
 {
-    output_weights.setConstant(value);
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(weights.data() + 3*inputs_number*neurons_number, inputs_number*neurons_number, value);
 }
 
 
@@ -1013,10 +925,7 @@ void LongShortTermMemoryLayer::set_output_weights_constant(const type&  value)
 
 void LongShortTermMemoryLayer::set_recurrent_weights_constant(const type& value)
 {
-    forget_recurrent_weights.setConstant(value);
-    input_recurrent_weights.setConstant(value);
-    state_recurrent_weights.setConstant(value);
-    output_recurrent_weights.setConstant(value);
+    recurrent_weights.setConstant(value);
 }
 
 
@@ -1025,7 +934,9 @@ void LongShortTermMemoryLayer::set_recurrent_weights_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_forget_recurrent_weights_constant(const type& value)
 {
-    forget_recurrent_weights.setConstant(value);
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(recurrent_weights.data(), neurons_number*neurons_number, value);
 }
 
 
@@ -1034,7 +945,9 @@ void LongShortTermMemoryLayer::set_forget_recurrent_weights_constant(const type&
 
 void LongShortTermMemoryLayer::set_input_recurrent_weights_constant(const type& value)
 {
-    input_recurrent_weights.setConstant(value);
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(recurrent_weights.data() + neurons_number*neurons_number, neurons_number*neurons_number, value);
 }
 
 
@@ -1043,7 +956,9 @@ void LongShortTermMemoryLayer::set_input_recurrent_weights_constant(const type&
 
 void LongShortTermMemoryLayer::set_state_recurrent_weights_constant(const type& value)
 {
-    state_recurrent_weights.setConstant(value);
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(recurrent_weights.data() + 2*neurons_number*neurons_number, neurons_number*neurons_number, value);
 }
 
 
@@ -1052,7 +967,9 @@ void LongShortTermMemoryLayer::set_state_recurrent_weights_constant(const type&
 
 void LongShortTermMemoryLayer::set_output_recurrent_weights_constant(const type&  value)
 {
-    output_recurrent_weights.setConstant(value);
+    const Index neurons_number = get_neurons_number();
+
+    fill_n(recurrent_weights.data() + 3*neurons_number*neurons_number, neurons_number*neurons_number, value);
 }
 
 
@@ -1079,20 +996,11 @@ void LongShortTermMemoryLayer::set_cell_states_constant(const type& value)
 
 void LongShortTermMemoryLayer::set_parameters_constant(const type& value)
 {
-    forget_biases.setConstant(value);
-    input_biases.setConstant(value);
-    state_biases.setConstant(value);
-    output_biases.setConstant(value);
+    biases.setConstant(value);
 
-    forget_weights.setConstant(value);
-    input_weights.setConstant(value);
-    state_weights.setConstant(value);
-    output_weights.setConstant(value);
+    weights.setConstant(value);
 
-    forget_recurrent_weights.setConstant(value);
-    input_recurrent_weights.setConstant(value);
-    state_recurrent_weights.setConstant(value);
-    output_recurrent_weights.setConstant(value);
+    recurrent_weights.setConstant(value);
 
     hidden_states.setZero();
 
@@ -1110,92 +1018,29 @@ void LongShortTermMemoryLayer::set_parameters_random()
 
     // Biases
 
-    for(Index i = 0; i < forget_biases.size(); i++)
-    {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
-
-        forget_biases(i) = minimum + (maximum - minimum)*random;
-    }
-
-    for(Index i = 0; i < input_biases.size(); i++)
-    {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
-
-        input_biases(i) = minimum + (maximum - minimum)*random;
-    }
-
-    for(Index i = 0; i < state_biases.size(); i++)
-    {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
-
-        state_biases(i) = minimum + (maximum - minimum)*random;
-    }
-
-    for(Index i = 0; i < output_biases.size(); i++)
+    for(Index i = 0; i < biases.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
-        output_biases(i) = minimum + (maximum - minimum)*random;
+        biases(i) = minimum + (maximum - minimum)*random;
     }
 
     // Weights
 
-    for(Index i = 0; i < forget_weights.size(); i++)
-    {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
-
-        forget_weights(i) = minimum + (maximum - minimum)*random;
-    }
-
-    for(Index i = 0; i < input_weights.size(); i++)
-    {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
-
-        input_weights(i) = minimum + (maximum - minimum)*random;
-    }
-
-    for(Index i = 0; i < state_weights.size(); i++)
-    {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
-
-        state_weights(i) = minimum + (maximum - minimum)*random;
-    }
-
-    for(Index i = 0; i < output_weights.size(); i++)
+    for(Index i = 0; i < weights.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
-        output_weights(i) = minimum + (maximum - minimum)*random;
+        weights(i) = minimum + (maximum - minimum)*random;
     }
 
     // Recurrent weights
 
-    for(Index i = 0; i < forget_recurrent_weights.size(); i++)
-    {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
-
-        forget_recurrent_weights(i) = minimum + (maximum - minimum)*random;
-    }
-
-    for(Index i = 0; i < input_recurrent_weights.size(); i++)
-    {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
-
-        input_recurrent_weights(i) = minimum + (maximum - minimum)*random;
-    }
-
-    for(Index i = 0; i < state_recurrent_weights.size(); i++)
-    {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
-
-        state_recurrent_weights(i) = minimum + (maximum - minimum)*random;
-    }
-
-    for(Index i = 0; i < output_recurrent_weights.size(); i++)
+    for(Index i = 0; i < recurrent_weights.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
-        output_recurrent_weights(i) = minimum + (maximum - minimum)*random;
+        recurrent_weights(i) = minimum + (maximum - minimum)*random;
     }
 }
 
@@ -1232,15 +1077,25 @@ void LongShortTermMemoryLayer::calculate_combinations(type* inputs_data, const T
     }
 #endif
 
-    TensorMap<Tensor<type, 1>> inputs(inputs_data, inputs_dimensions(0));
-
-    TensorMap<Tensor<type, 1>> combinations(combinations_data, combinations_dimensions(0));
+    const Index neurons_number = combinations_dimensions(0);
 
-    combinations.device(*thread_pool_device) = inputs.contract(weights, AT_B);
+    // Biases plus recurrent product, then the inputs product is accumulated on the same combinations
 
-    combinations.device(*thread_pool_device) += biases;
+    calculate_fused_combinations(hidden_states.data(), 1, hidden_states.size(),
+                                 recurrent_weights.data(), neurons_number,
+                                 biases.data(),
+                                 combinations_data,
+                                 combinations_data,
+                                 nullptr);
 
-    combinations.device(*thread_pool_device) += hidden_states.contract(recurrent_weights, AT_B);
+    calculate_fused_combinations(inputs_data, 1, inputs_dimensions(0),
+                                 weights.data(), neurons_number,
+                                 nullptr,
+                                 combinations_data,
+                                 combinations_data,
+                                 nullptr,
+                                 nullptr,
+                                 true);
 }
 
 
@@ -1484,6 +1339,126 @@ void LongShortTermMemoryLayer::calculate_recurrent_activations_derivatives(type*
 }
 
 
+/// Returns the element-wise form of an activation function, to be applied to the gates in one sweep,
+/// or nullptr if the activation function has no such form.
+/// @param function Activation function.
+
+Layer::FusedActivation LongShortTermMemoryLayer::get_fused_activation(const ActivationFunction& function) const
+{
+    switch(function)
+    {
+    case ActivationFunction::Linear: return linear_fused;
+
+    case ActivationFunction::Logistic: return logistic_fused;
+
+    case ActivationFunction::HyperbolicTangent: return hyperbolic_tangent_fused;
+
+    case ActivationFunction::RectifiedLinear: return rectified_linear_fused;
+
+    case ActivationFunction::HardSigmoid: return hard_sigmoid_fused;
+
+    default: return nullptr;
+    }
+}
+
+
+/// Calculates the activations, and optionally the activations derivatives, of a contiguous block of combinations.
+/// @param recurrent True to use the recurrent activation function, and false to use the activation function.
+/// @param combinations_data Pointer to the combinations.
+/// @param activations_data Pointer to the activations. It must not be the combinations.
+/// @param activations_derivatives_data Pointer to the activations derivatives, or nullptr if they are not needed.
+/// @param size Number of combinations, which is a multiple of the number of neurons.
+
+void LongShortTermMemoryLayer::calculate_fused_activations(const bool& recurrent,
+                                                           type* combinations_data,
+                                                           type* activations_data,
+                                                           type* activations_derivatives_data,
+                                                           const Index& size)
+{
+    const FusedActivation fused_activation = get_fused_activation(recurrent ? recurrent_activation_function : activation_function);
+
+    if(fused_activation != nullptr)
+    {
+        fused_activation(combinations_data, activations_data, activations_derivatives_data, size);
+
+        return;
+    }
+
+    // The activation functions are element-wise, and the block is seen as a matrix with as many columns as neurons
+
+    const Index neurons_number = get_neurons_number();
+
+    Tensor<Index, 1> dimensions(2);
+    dimensions.setValues({size/neurons_number, neurons_number});
+
+    if(activations_derivatives_data == nullptr)
+    {
+        if(recurrent)
+        {
+            calculate_recurrent_activations(combinations_data, dimensions, activations_data, dimensions);
+        }
+        else
+        {
+            calculate_activations(combinations_data, dimensions, activations_data, dimensions);
+        }
+    }
+    else
+    {
+        if(recurrent)
+        {
+            calculate_recurrent_activations_derivatives(combinations_data, dimensions, activations_data, dimensions, activations_derivatives_data, dimensions);
+        }
+        else
+        {
+            calculate_activations_derivatives(combinations_data, dimensions, activations_data, dimensions, activations_derivatives_data, dimensions);
+        }
+    }
+}
+
+
+/// Calculates the activations of the four gates of one timestep.
+/// The combinations are a matrix with the sequences in the rows and the forget, input, state and output gates in consecutive blocks of columns.
+/// The forget and input gates are contiguous, and they are activated together.
+/// @param combinations_data Pointer to the combinations of the gates.
+/// @param activations_data Pointer to the activations of the gates.
+/// @param activations_derivatives_data Pointer to the activations derivatives of the gates, or nullptr if they are not needed.
+/// @param sequences_number Number of sequences.
+
+void LongShortTermMemoryLayer::calculate_gates_activations(type* combinations_data,
+                                                           type* activations_data,
+                                                           type* activations_derivatives_data,
+                                                           const Index& sequences_number)
+{
+    const Index gate_size = sequences_number*get_neurons_number();
+
+    const bool derivatives = activations_derivatives_data != nullptr;
+
+    // Forget and input gates
+
+    calculate_fused_activations(true,
+                                combinations_data,
+                                activations_data,
+                                activations_derivatives_data,
+                                2*gate_size);
+
+    // State gate
+
+    calculate_fused_activations(false,
+                                combinations_data + 2*gate_size,
+                                activations_data + 2*gate_size,
+                                derivatives ? activations_derivatives_data + 2*gate_size : nullptr,
+                                gate_size);
+
+    // Output gate
+
+    calculate_fused_activations(true,
+                                combinations_data + 3*gate_size,
+                                activations_data + 3*gate_size,
+                                derivatives ? activations_derivatives_data + 3*gate_size : nullptr,
+                                gate_size);
+}
+
+
 //void LongShortTermMemoryLayer::calculate_outputs(type* inputs_data, const Tensor<Index, 1>& inputs_dimensions,
 //                                                 type* outputs_data, const Tensor<Index, 1>& outputs_dimensions)
 //{
@@ -1657,7 +1632,7 @@ void LongShortTermMemoryLayer::calculate_hidden_delta(PerceptronLayerForwardProp
                                                       PerceptronLayerBackPropagation* next_back_propagation,
                                                       LongShortTermMemoryLayerBackPropagation* back_propagation) const
 {
-    const Tensor<type, 2>& next_synaptic_weights = static_cast<PerceptronLayer*>(next_back_propagation->layer_pointer)->get_synaptic_weights();
+    const TensorMap<Tensor<type, 2>>& next_synaptic_weights = static_cast<PerceptronLayer*>(next_back_propagation->layer_pointer)->get_synaptic_weights();
 
     const TensorMap<Tensor<type,2>> next_layer_deltas(next_back_propagation->deltas_data, next_back_propagation->deltas_dimensions(0), next_back_propagation->deltas_dimensions(1));
     TensorMap<Tensor<type,2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
@@ -1672,7 +1647,7 @@ void LongShortTermMemoryLayer::calculate_hidden_delta(ProbabilisticLayerForwardP
 {
     const ProbabilisticLayer* probabilistic_layer_pointer = static_cast<ProbabilisticLayer*>(next_back_propagation->layer_pointer);
 
-    const Tensor<type, 2>& next_synaptic_weights = probabilistic_layer_pointer->get_synaptic_weights();
+    const TensorMap<Tensor<type, 2>>& next_synaptic_weights = probabilistic_layer_pointer->get_synaptic_weights();
 
     const TensorMap<Tensor<type, 2>> next_deltas(next_back_propagation->deltas_data, next_back_propagation->deltas_dimensions(0), next_back_propagation->deltas_dimensions(1));;
     TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
@@ -1749,2295 +1724,348 @@ void LongShortTermMemoryLayer::forward_propagate(type* inputs_data,
                                                  LayerForwardPropagation* forward_propagation,
                                                  bool& switch_train)
 {
-    LongShortTermMemoryLayerForwardPropagation* long_short_term_memory_layer_forward_propagation
-            = static_cast<LongShortTermMemoryLayerForwardPropagation*>(forward_propagation);
-
-    const Index samples_number = inputs_dimensions(0);
-    const Index neurons_number = get_neurons_number();
-
     if(inputs_dimensions.size() != 2)
     {
         ostringstream buffer;
 
-        buffer << "OpenNN Exception: ProbabilisticLayer class.\n"
+        buffer << "OpenNN Exception: LongShortTermMemoryLayer class.\n"
                << "void forward_propagate(type*, const Tensor<Index, 1>&, LayerForwardPropagation*) final.\n"
                << "Inputs rank must be equal to 2.\n";
 
         throw invalid_argument(buffer.str());
     }
 
-    TensorMap<Tensor<type, 2>> inputs(inputs_data, inputs_dimensions(0), inputs_dimensions(1));
-
-    const Tensor<Index, 1> outputs_dimensions = forward_propagation->outputs_dimensions;
-
-    const TensorMap<Tensor<type, 2>> outputs(forward_propagation->outputs_data, outputs_dimensions(0), outputs_dimensions(1));
-
-    Tensor<Index, 1> current_inputs_dimensions(1);
+    LongShortTermMemoryLayerForwardPropagation* long_short_term_memory_layer_forward_propagation
+            = static_cast<LongShortTermMemoryLayerForwardPropagation*>(forward_propagation);
 
-    Tensor<Index, 1> combinations_dimensions;
-    Tensor<Index, 1> activations_dimensions;
-    Tensor<Index, 1> derivatives_dimensions;
+    forward_propagate_sequences(inputs_data, inputs_dimensions(0),
+                                biases.data(), weights.data(), recurrent_weights.data(),
+                                long_short_term_memory_layer_forward_propagation,
+                                switch_train);
+}
 
-    Index copy_index = 0;
 
-    for(Index i = 0; i < samples_number; i++)
+void LongShortTermMemoryLayer::forward_propagate(type* inputs_data, const Tensor<Index, 1>& inputs_dimensions, Tensor<type, 1>& parameters, LayerForwardPropagation* forward_propagation)
+{
+    if(inputs_dimensions.size() != 2)
     {
-        if(i%timesteps == 0)
-        {
-            hidden_states.setZero();
-            cell_states.setZero();
-        }
+        ostringstream buffer;
 
-        long_short_term_memory_layer_forward_propagation->current_inputs = inputs.chip(i,0);
+        buffer << "OpenNN Exception: LongShortTermMemoryLayer class.\n"
+               << "void forward_propagate(type*, const Tensor<Index, 1>&, Tensor<type, 1>&, LayerForwardPropagation*) final.\n"
+               << "Inputs rank must be equal to 2.\n";
 
-        current_inputs_dimensions.setValues({long_short_term_memory_layer_forward_propagation->current_inputs.size()});
+        throw invalid_argument(buffer.str());
+    }
 
-        combinations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_combinations);
-
-        calculate_combinations(long_short_term_memory_layer_forward_propagation->current_inputs.data(),
-                               current_inputs_dimensions,
-                               forget_weights,
-                               forget_recurrent_weights,
-                               forget_biases,
-                               long_short_term_memory_layer_forward_propagation->current_forget_combinations.data(),
-                               combinations_dimensions);
-
-        combinations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_combinations);
-        activations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_activations);
-        derivatives_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_activations_derivatives);
-
-        if(switch_train)
-        {
-            calculate_recurrent_activations_derivatives(long_short_term_memory_layer_forward_propagation->current_forget_combinations.data(),
-                                                        combinations_dimensions,
-                                                        long_short_term_memory_layer_forward_propagation->current_forget_activations.data(),
-                                                        activations_dimensions,
-                                                        long_short_term_memory_layer_forward_propagation->current_forget_activations_derivatives.data(),
-                                                        derivatives_dimensions);
-        }
-        else
-        {
-            calculate_activations(long_short_term_memory_layer_forward_propagation->current_forget_combinations.data(),
-                                  combinations_dimensions,
-                                  long_short_term_memory_layer_forward_propagation->current_forget_activations.data(),
-                                  activations_dimensions);
-        }
-
-        combinations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_combinations);
-
-        calculate_combinations(long_short_term_memory_layer_forward_propagation->current_inputs.data(),
-                               current_inputs_dimensions,
-                               input_weights,
-                               input_recurrent_weights,
-                               input_biases,
-                               long_short_term_memory_layer_forward_propagation->current_input_combinations.data(),
-                               combinations_dimensions);
-
-        combinations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_combinations);
-        activations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_activations);
-        derivatives_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_activations_derivatives);
-
-        if(switch_train)
-        {
-            calculate_recurrent_activations_derivatives(long_short_term_memory_layer_forward_propagation->current_input_combinations.data(),
-                                                        combinations_dimensions,
-                                                        long_short_term_memory_layer_forward_propagation->current_input_activations.data(),
-                                                        activations_dimensions,
-                                                        long_short_term_memory_layer_forward_propagation->current_input_activations_derivatives.data(),
-                                                        combinations_dimensions);
-        }
-        else
-        {
-            calculate_activations(long_short_term_memory_layer_forward_propagation->current_input_combinations.data(),
-                                  combinations_dimensions,
-                                  long_short_term_memory_layer_forward_propagation->current_input_activations.data(),
-                                  activations_dimensions);
-        }
-
-        combinations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_combinations);
-
-        calculate_combinations(long_short_term_memory_layer_forward_propagation->current_inputs.data(),
-                               current_inputs_dimensions,
-                               state_weights,
-                               state_recurrent_weights,
-                               state_biases,
-                               long_short_term_memory_layer_forward_propagation->current_state_combinations.data(),
-                               combinations_dimensions);
-
-        combinations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_combinations);
-        activations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_activations);
-        derivatives_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_activations_derivatives);
-
-        if(switch_train)
-        {
-            calculate_recurrent_activations_derivatives(long_short_term_memory_layer_forward_propagation->current_state_combinations.data(),
-                                                        combinations_dimensions,
-                                                        long_short_term_memory_layer_forward_propagation->current_state_activations.data(),
-                                                        activations_dimensions,
-                                                        long_short_term_memory_layer_forward_propagation->current_state_activations_derivatives.data(),
-                                                        derivatives_dimensions);
-        }
-        else
-        {
-            calculate_activations(long_short_term_memory_layer_forward_propagation->current_state_combinations.data(),
-                                  combinations_dimensions,
-                                  long_short_term_memory_layer_forward_propagation->current_state_activations.data(),
-                                  activations_dimensions);
-        }
-
-        combinations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_combinations);
-
-        calculate_combinations(long_short_term_memory_layer_forward_propagation->current_inputs.data(),
-                               current_inputs_dimensions,
-                               output_weights,
-                               output_recurrent_weights,
-                               output_biases,
-                               long_short_term_memory_layer_forward_propagation->current_output_combinations.data(),
-                               combinations_dimensions);
-
-        combinations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_combinations);
-        activations_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_activations);
-        derivatives_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_forget_activations_derivatives);
-
-        if(switch_train)
-        {
-            calculate_recurrent_activations_derivatives(long_short_term_memory_layer_forward_propagation->current_output_combinations.data(),
-                                                        combinations_dimensions,
-                                                        long_short_term_memory_layer_forward_propagation->current_output_activations.data(),
-                                                        activations_dimensions,
-                                                        long_short_term_memory_layer_forward_propagation->current_output_activations_derivatives.data(),
-                                                        derivatives_dimensions);
-        }
-        else
-        {
-            calculate_activations(long_short_term_memory_layer_forward_propagation->current_output_combinations.data(),
-                                  combinations_dimensions,
-                                  long_short_term_memory_layer_forward_propagation->current_output_activations.data(),
-                                  activations_dimensions);
-        }
-
-        cell_states = long_short_term_memory_layer_forward_propagation->current_forget_activations * cell_states +
-                long_short_term_memory_layer_forward_propagation->current_input_activations * long_short_term_memory_layer_forward_propagation->current_state_activations;
-
-        combinations_dimensions = get_dimensions(cell_states);
-        activations_dimensions = get_dimensions(hidden_states);
-        derivatives_dimensions = get_dimensions(long_short_term_memory_layer_forward_propagation->current_hidden_states_derivatives);
-
-        if(switch_train)
-        {
-            calculate_activations_derivatives(cell_states.data(),
-                                              combinations_dimensions,
-                                              hidden_states.data(),
-                                              activations_dimensions,
-                                              long_short_term_memory_layer_forward_propagation->current_hidden_states_derivatives.data(),
-                                              derivatives_dimensions);
-        }
-        else
-        {
-            calculate_activations(cell_states.data(),
-                                  combinations_dimensions,
-                                  hidden_states.data(),
-                                  activations_dimensions);
-        }
-
-        hidden_states *= long_short_term_memory_layer_forward_propagation->current_output_activations;
-
-        // Activations 2d
-
-        for(Index j = 0; j < neurons_number; j++) outputs(i,j) = hidden_states(j);
-
-        // Forget (activations and activations derivatives)
-
-        copy(long_short_term_memory_layer_forward_propagation->current_forget_activations.data(),
-             long_short_term_memory_layer_forward_propagation->current_forget_activations.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->forget_activations.data() + copy_index);
-
-        copy(long_short_term_memory_layer_forward_propagation->current_forget_activations_derivatives.data(),
-             long_short_term_memory_layer_forward_propagation->current_forget_activations_derivatives.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->forget_activations_derivatives.data() + copy_index);
-
-        // Input (activations and activations derivatives)
-
-        copy(long_short_term_memory_layer_forward_propagation->current_input_activations.data(),
-             long_short_term_memory_layer_forward_propagation->current_input_activations.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->input_activations.data() + copy_index);
-
-        copy(long_short_term_memory_layer_forward_propagation->current_input_activations_derivatives.data(),
-             long_short_term_memory_layer_forward_propagation->current_input_activations_derivatives.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->input_activations_derivatives.data() + copy_index);
-
-        // State (activations and activations derivatives)
-
-        copy(long_short_term_memory_layer_forward_propagation->current_state_activations.data(),
-             long_short_term_memory_layer_forward_propagation->current_state_activations.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->state_activations.data() + copy_index);
-
-        copy(long_short_term_memory_layer_forward_propagation->current_state_activations_derivatives.data(),
-             long_short_term_memory_layer_forward_propagation->current_state_activations_derivatives.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->state_activations_derivatives.data() + copy_index);
-
-        // Output (activations and activations derivatives)
-
-        copy(long_short_term_memory_layer_forward_propagation->current_output_activations.data(),
-             long_short_term_memory_layer_forward_propagation->current_output_activations.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->output_activations.data() + copy_index);
-
-        copy(long_short_term_memory_layer_forward_propagation->current_output_activations_derivatives.data(),
-             long_short_term_memory_layer_forward_propagation->current_output_activations_derivatives.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->output_activations_derivatives.data() + copy_index);
-
-        // Cell states (activations)
-
-        copy(cell_states.data(),
-             cell_states.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->cell_states_activations.data() + copy_index);
-
-        // Hidden states (activations and activations derivatives)
-
-        copy(hidden_states.data(),
-             hidden_states.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->hidden_states_activations.data() + copy_index);
-
-        copy(long_short_term_memory_layer_forward_propagation->current_hidden_states_derivatives.data(),
-             long_short_term_memory_layer_forward_propagation->current_hidden_states_derivatives.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->hidden_states_activations_derivatives.data() + copy_index);
-
-        copy_index += neurons_number;
-    }
-}
-
-
-void LongShortTermMemoryLayer::forward_propagate(type* inputs_data, const Tensor<Index, 1>& inputs_dimensions, Tensor<type, 1>& parameters, LayerForwardPropagation* forward_propagation)
-{
-
-    if(inputs_dimensions.size() != 2)
-    {
-        ostringstream buffer;
-
-        buffer << "OpenNN Exception: ProbabilisticLayer class.\n"
-               << "void forward_propagate(type*, const Tensor<Index, 1>&, Tensor<type, 1>&, LayerForwardPropagation*) final.\n"
-               << "Inputs rank must be equal to 2.\n";
-
-        throw invalid_argument(buffer.str());
-    }
-
-
-    LongShortTermMemoryLayerForwardPropagation* long_short_term_memory_layer_forward_propagation
-            = static_cast<LongShortTermMemoryLayerForwardPropagation*>(forward_propagation);
-
-    const Index inputs_number = get_inputs_number();
-    const Index neurons_number = get_neurons_number();
-
-    const TensorMap<Tensor<type, 1>> forget_biases(parameters.data(), neurons_number);
-    const TensorMap<Tensor<type, 1>> input_biases(parameters.data()+neurons_number, neurons_number);
-    const TensorMap<Tensor<type, 1>> state_biases(parameters.data()+2*neurons_number, neurons_number);
-    const TensorMap<Tensor<type, 1>> output_biases(parameters.data()+3*neurons_number, neurons_number);
-
-    const TensorMap<Tensor<type, 2>> forget_weights(parameters.data()+4*neurons_number, inputs_number, neurons_number);
-    const TensorMap<Tensor<type, 2>> input_weights(parameters.data()+4*neurons_number+inputs_number*neurons_number, inputs_number, neurons_number);
-    const TensorMap<Tensor<type, 2>> state_weights(parameters.data()+4*neurons_number+2*inputs_number*neurons_number, inputs_number, neurons_number);
-    const TensorMap<Tensor<type, 2>> output_weights(parameters.data()+4*neurons_number+3*inputs_number*neurons_number, inputs_number, neurons_number);
-
-    const TensorMap<Tensor<type, 2>> forget_recurrent_weights(parameters.data()+4*neurons_number+4*inputs_number*neurons_number, neurons_number, neurons_number);
-    const TensorMap<Tensor<type, 2>> input_recurrent_weights(parameters.data()+4*neurons_number+4*inputs_number*neurons_number+neurons_number*neurons_number, neurons_number, neurons_number);
-    const TensorMap<Tensor<type, 2>> state_recurrent_weights(parameters.data()+4*neurons_number+4*inputs_number*neurons_number+2*neurons_number*neurons_number, neurons_number, neurons_number);
-    const TensorMap<Tensor<type, 2>> output_recurrent_weights(parameters.data()+4*neurons_number+4*inputs_number*neurons_number+3*neurons_number*neurons_number, neurons_number, neurons_number);
-
-    const Index samples_number = inputs_dimensions(0);
-
-    TensorMap<Tensor<type, 2>> inputs(inputs_data, inputs_dimensions(0), inputs_dimensions(1));
-
-    const Tensor<Index, 1> outputs_dimensions = forward_propagation->outputs_dimensions;
-
-    TensorMap<Tensor<type, 2>> outputs(forward_propagation->outputs_data, outputs_dimensions(0), outputs_dimensions(1));
-
-    Tensor<type, 1> forget_combinations(neurons_number);
-    Tensor<type, 1> input_combinations(neurons_number);
-    Tensor<type, 1> state_combinations(neurons_number);
-    Tensor<type, 1> output_combinations(neurons_number);
-
-    Tensor<type, 1> forget_activations(neurons_number);
-    Tensor<type, 1> input_activations(neurons_number);
-    Tensor<type, 1> state_activations(neurons_number);
-    Tensor<type, 1> output_activations(neurons_number);
-
-    Tensor<type, 1> forget_activations_derivatives(neurons_number);
-    Tensor<type, 1> input_activations_derivatives(neurons_number);
-    Tensor<type, 1> state_activations_derivatives(neurons_number);
-    Tensor<type, 1> output_activations_derivatives(neurons_number);
-
-    Tensor<type, 1> hidden_states_derivatives(neurons_number);
-
-    Tensor<Index, 1> current_inputs_dimensions;
-    Tensor<Index, 1> combinations_dimensions;
-    Tensor<Index, 1> activations_dimensions;
-    Tensor<Index, 1> derivatives_dimensions;
-
-    Index copy_index = 0;
-
-    for(Index i = 0; i < samples_number; i++)
-    {
-        if(i%timesteps == 0)
-        {
-            hidden_states.setZero();
-            cell_states.setZero();
-        }
-
-        Tensor<type, 1> current_inputs = inputs.chip(i,0);
-        current_inputs_dimensions = get_dimensions(current_inputs);
-
-        combinations_dimensions = get_dimensions(forget_combinations);
-        activations_dimensions = get_dimensions(forget_activations);
-        derivatives_dimensions = get_dimensions(forget_activations_derivatives);
-
-        calculate_combinations(current_inputs.data(), current_inputs_dimensions, forget_weights, forget_recurrent_weights, forget_biases, forget_combinations.data(), combinations_dimensions);
-        calculate_recurrent_activations_derivatives(forget_combinations.data(),
-                                                    combinations_dimensions,
-                                                    forget_activations.data(),
-                                                    activations_dimensions,
-                                                    forget_activations_derivatives.data(),
-                                                    derivatives_dimensions);
-
-        combinations_dimensions = get_dimensions(input_combinations);
-        activations_dimensions = get_dimensions(input_activations);
-        derivatives_dimensions = get_dimensions(input_activations_derivatives);
-
-        calculate_combinations(current_inputs.data(), current_inputs_dimensions, input_weights, input_recurrent_weights, input_biases, input_combinations.data(), combinations_dimensions);
-        calculate_recurrent_activations_derivatives(input_combinations.data(),
-                                                    combinations_dimensions,
-                                                    input_activations.data(),
-                                                    activations_dimensions,
-                                                    input_activations_derivatives.data(),
-                                                    derivatives_dimensions);
-
-        combinations_dimensions = get_dimensions(state_combinations);
-        activations_dimensions = get_dimensions(state_activations);
-        derivatives_dimensions = get_dimensions(state_activations_derivatives);
-
-        calculate_combinations(current_inputs.data(), current_inputs_dimensions, state_weights, state_recurrent_weights, state_biases, state_combinations.data(), combinations_dimensions);
-        calculate_recurrent_activations_derivatives(state_combinations.data(),
-                                                    combinations_dimensions,
-                                                    state_activations.data(),
-                                                    activations_dimensions,
-                                                    state_activations_derivatives.data(),
-                                                    derivatives_dimensions);
-
-        combinations_dimensions = get_dimensions(output_combinations);
-        activations_dimensions = get_dimensions(output_activations);
-        derivatives_dimensions = get_dimensions(output_activations_derivatives);
-
-        calculate_combinations(current_inputs.data(), current_inputs_dimensions, output_weights, output_recurrent_weights, output_biases, output_combinations.data(), combinations_dimensions);
-        calculate_recurrent_activations_derivatives(output_combinations.data(),
-                                                    combinations_dimensions,
-                                                    output_activations.data(),
-                                                    activations_dimensions,
-                                                    output_activations_derivatives.data(),
-                                                    derivatives_dimensions);
-
-        combinations_dimensions = get_dimensions(cell_states);
-        activations_dimensions = get_dimensions(hidden_states);
-        derivatives_dimensions = get_dimensions(hidden_states_derivatives);
-
-        cell_states = forget_activations * cell_states + input_activations * state_activations;
-        calculate_activations_derivatives(cell_states.data(),
-                                          combinations_dimensions,
-                                          hidden_states.data(),
-                                          activations_dimensions,
-                                          hidden_states_derivatives.data(),
-                                          derivatives_dimensions);
-
-        hidden_states *= output_activations;
-
-        // Activations 2d
-
-        for(Index j = 0; j < neurons_number; j++) outputs(i,j) = hidden_states(j);
-
-        // Forget (activations and activations derivatives)
-
-        copy(long_short_term_memory_layer_forward_propagation->current_forget_activations.data(),
-             long_short_term_memory_layer_forward_propagation->current_forget_activations.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->forget_activations.data() + copy_index);
-
-        copy(long_short_term_memory_layer_forward_propagation->current_forget_activations_derivatives.data(),
-             long_short_term_memory_layer_forward_propagation->current_forget_activations_derivatives.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->forget_activations_derivatives.data() + copy_index);
-
-        // Input (activations and activations derivatives)
-
-        copy(long_short_term_memory_layer_forward_propagation->current_input_activations.data(),
-             long_short_term_memory_layer_forward_propagation->current_input_activations.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->input_activations.data() + copy_index);
-
-        copy(long_short_term_memory_layer_forward_propagation->current_input_activations_derivatives.data(),
-             long_short_term_memory_layer_forward_propagation->current_input_activations_derivatives.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->input_activations_derivatives.data() + copy_index);
-
-        // State (activations and activations derivatives)
-
-        copy(long_short_term_memory_layer_forward_propagation->current_state_activations.data(),
-             long_short_term_memory_layer_forward_propagation->current_state_activations.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->state_activations.data() + copy_index);
-
-        copy(long_short_term_memory_layer_forward_propagation->current_state_activations_derivatives.data(),
-             long_short_term_memory_layer_forward_propagation->current_state_activations_derivatives.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->state_activations_derivatives.data() + copy_index);
-
-        // Output (activations and activations derivatives)
-
-        copy(long_short_term_memory_layer_forward_propagation->current_output_activations.data(),
-             long_short_term_memory_layer_forward_propagation->current_output_activations.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->output_activations.data() + copy_index);
-
-        copy(long_short_term_memory_layer_forward_propagation->current_output_activations_derivatives.data(),
-             long_short_term_memory_layer_forward_propagation->current_output_activations_derivatives.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->output_activations_derivatives.data() + copy_index);
-
-        // Cell states (activations)
-
-        copy(cell_states.data(),
-             cell_states.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->cell_states_activations.data() + copy_index);
-
-        // Hidden states (activations and activations derivatives)
-
-        copy(hidden_states.data(),
-             hidden_states.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->hidden_states_activations.data() + copy_index);
-
-        copy(long_short_term_memory_layer_forward_propagation->current_hidden_states_derivatives.data(),
-             long_short_term_memory_layer_forward_propagation->current_hidden_states_derivatives.data() + neurons_number,
-             long_short_term_memory_layer_forward_propagation->hidden_states_activations_derivatives.data() + copy_index);
-
-        copy_index += neurons_number;
-    }
-}
-
-
-void LongShortTermMemoryLayer::insert_gradient(LayerBackPropagation* back_propagation,
-                                               const Index& index,
-                                               Tensor<type, 1>& gradient) const
-{
-    const Index inputs_number = get_inputs_number();
-    const Index neurons_number = get_neurons_number();
-
-    LongShortTermMemoryLayerBackPropagation* long_short_term_memory_layer_back_propagation =
-            static_cast<LongShortTermMemoryLayerBackPropagation*>(back_propagation);
-
-    // Biases
-
-    copy(long_short_term_memory_layer_back_propagation->forget_biases_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->forget_biases_derivatives.data() + neurons_number,
-         gradient.data() + index);
-
-    copy(long_short_term_memory_layer_back_propagation->input_biases_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->input_biases_derivatives.data() + neurons_number,
-         gradient.data() + index + neurons_number);
-
-    copy(long_short_term_memory_layer_back_propagation->state_biases_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->state_biases_derivatives.data() + neurons_number,
-         gradient.data() + index + 2*neurons_number);
-
-    copy(long_short_term_memory_layer_back_propagation->output_biases_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->output_biases_derivatives.data() + neurons_number,
-         gradient.data() + index + 3*neurons_number);
-
-    // Weights
-
-    copy(long_short_term_memory_layer_back_propagation->forget_weights_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->forget_weights_derivatives.data() + inputs_number*neurons_number,
-         gradient.data() + index + 4*neurons_number);
-
-    copy(long_short_term_memory_layer_back_propagation->input_weights_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->input_weights_derivatives.data() + inputs_number*neurons_number,
-         gradient.data() + index + 4*neurons_number + inputs_number*neurons_number);
-
-    copy(long_short_term_memory_layer_back_propagation->state_weights_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->state_weights_derivatives.data() + inputs_number*neurons_number,
-         gradient.data() + index + 4*neurons_number + 2*inputs_number*neurons_number);
-
-    copy(long_short_term_memory_layer_back_propagation->output_weights_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->output_weights_derivatives.data() + inputs_number*neurons_number,
-         gradient.data() + index + 4*neurons_number + 3*inputs_number*neurons_number);
-
-    // Recurrent weights
-
-    copy(long_short_term_memory_layer_back_propagation->forget_recurrent_weights_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->forget_recurrent_weights_derivatives.data() + neurons_number*neurons_number,
-         gradient.data() + index + 4*neurons_number + 4*inputs_number*neurons_number);
-
-    copy(long_short_term_memory_layer_back_propagation->input_recurrent_weights_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->input_recurrent_weights_derivatives.data() + neurons_number*neurons_number,
-         gradient.data() + index + 4*neurons_number + 4*inputs_number*neurons_number + neurons_number*neurons_number);
-
-    copy(long_short_term_memory_layer_back_propagation->state_recurrent_weights_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->state_recurrent_weights_derivatives.data() + neurons_number*neurons_number,
-         gradient.data() + index + 4*neurons_number + 4*inputs_number*neurons_number + 2*neurons_number*neurons_number);
-
-    copy(long_short_term_memory_layer_back_propagation->output_recurrent_weights_derivatives.data(),
-         long_short_term_memory_layer_back_propagation->output_recurrent_weights_derivatives.data() + neurons_number*neurons_number,
-         gradient.data() + index + 4*neurons_number + 4*inputs_number*neurons_number + 3*neurons_number*neurons_number);
-}
-
-
-void LongShortTermMemoryLayer::calculate_error_gradient(type* inputs_data,
-                                                        LayerForwardPropagation* forward_propagation,
-    LayerBackPropagation* back_propagation) const
-{
-    const Index batch_samples_number = back_propagation->batch_samples_number;
-
-    LongShortTermMemoryLayerForwardPropagation* long_short_term_memory_layer_forward_propagation =
-            static_cast<LongShortTermMemoryLayerForwardPropagation*>(forward_propagation);
-
-    LongShortTermMemoryLayerBackPropagation* long_short_term_memory_layer_back_propagation =
-            static_cast<LongShortTermMemoryLayerBackPropagation*>(back_propagation);
-
-//#pragma omp parallel
-    {
-        // Biases
-
-        const TensorMap<Tensor<type, 2>> inputs(inputs_data, batch_samples_number, get_inputs_number());
-
-
-        calculate_forget_biases_error_gradient(inputs,
-                                               long_short_term_memory_layer_forward_propagation,
-                                               long_short_term_memory_layer_back_propagation);
-
-        calculate_input_biases_error_gradient(inputs,
-                                              long_short_term_memory_layer_forward_propagation,
-                                              long_short_term_memory_layer_back_propagation);
-
-        calculate_state_biases_error_gradient(inputs,
-                                              long_short_term_memory_layer_forward_propagation,
-                                              long_short_term_memory_layer_back_propagation);
-
-        calculate_output_biases_error_gradient(inputs,
-                                               long_short_term_memory_layer_forward_propagation,
-                                               long_short_term_memory_layer_back_propagation);
-
-        // Weights
-
-        calculate_forget_weights_error_gradient(inputs,
-                                                long_short_term_memory_layer_forward_propagation,
-                                                long_short_term_memory_layer_back_propagation);
-
-        calculate_input_weights_error_gradient(inputs,
-                                               long_short_term_memory_layer_forward_propagation,
-                                               long_short_term_memory_layer_back_propagation);
-
-        calculate_state_weights_error_gradient(inputs,
-                                               long_short_term_memory_layer_forward_propagation,
-                                               long_short_term_memory_layer_back_propagation);
-
-        calculate_output_weights_error_gradient(inputs,
-                                                long_short_term_memory_layer_forward_propagation,
-                                                long_short_term_memory_layer_back_propagation);
-
-        // Recurrent weights
-
-        calculate_forget_recurrent_weights_error_gradient(inputs,
-                                                          long_short_term_memory_layer_forward_propagation,
-                                                          long_short_term_memory_layer_back_propagation);
-
-        calculate_input_recurrent_weights_error_gradient(inputs,
-                                                         long_short_term_memory_layer_forward_propagation,
-                                                         long_short_term_memory_layer_back_propagation);
-
-        calculate_state_recurrent_weights_error_gradient(inputs,
-                                                         long_short_term_memory_layer_forward_propagation,
-                                                         long_short_term_memory_layer_back_propagation);
-
-        calculate_output_recurrent_weights_error_gradient(inputs,
-                                                          long_short_term_memory_layer_forward_propagation,
-                                                          long_short_term_memory_layer_back_propagation);
-    }
-}
-
-
-void LongShortTermMemoryLayer::calculate_forget_weights_error_gradient(const Tensor<type, 2>& inputs,
-                                                                       LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                       LongShortTermMemoryLayerBackPropagation* back_propagation) const
-{
-    const Index samples_number = inputs.dimension(0);
-    const Index inputs_number = get_inputs_number();
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = inputs_number*neurons_number;
-
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
-
-    Tensor<type, 2> input_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> forget_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> state_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> output_combinations_weights_derivatives(parameters_number, neurons_number);
-
-    Tensor<type, 2> hidden_states_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> cell_state_weights_derivatives(parameters_number, neurons_number);
-
-    input_combinations_weights_derivatives.setZero();
-    forget_combinations_weights_derivatives.setZero();
-    state_combinations_weights_derivatives.setZero();
-    output_combinations_weights_derivatives.setZero();
-    hidden_states_weights_derivatives.setZero();
-    cell_state_weights_derivatives.setZero();
-
-    Index column_index = 0;
-    Index input_index = 0;
-
-    Index copy_index = 0;
-
-    back_propagation->forget_weights_derivatives.setZero();
-
-    for(Index sample = 0; sample < samples_number; sample++)
-    {
-        const Tensor<type, 1> current_inputs = inputs.chip(sample, 0); // memcpy?
-        const Tensor<type, 1> current_layer_deltas = deltas.chip(sample,0); // memcpy?
-
-        // Forget activations and derivatives
-
-        copy(forward_propagation->forget_activations.data() + copy_index,
-             forward_propagation->forget_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations.data());
-
-        copy(forward_propagation->forget_activations_derivatives.data() + copy_index,
-             forward_propagation->forget_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations_derivatives.data());
-
-        // Input activations and derivatives
-
-        copy(forward_propagation->input_activations.data() + copy_index,
-             forward_propagation->input_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations.data());
-
-        copy(forward_propagation->input_activations_derivatives.data() + copy_index,
-             forward_propagation->input_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations_derivatives.data());
-
-        // State activations and derivatives
-
-        copy(forward_propagation->state_activations.data() + copy_index,
-             forward_propagation->state_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations.data());
-
-        copy(forward_propagation->state_activations_derivatives.data() + copy_index,
-             forward_propagation->state_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations_derivatives.data());
-
-        // Output activations and derivatives
-
-        copy(forward_propagation->output_activations.data() + copy_index,
-             forward_propagation->output_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations.data());
-
-        copy(forward_propagation->output_activations_derivatives.data() + copy_index,
-             forward_propagation->output_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations_derivatives.data());
-
-        // Cell states and hidden states
-
-        copy(forward_propagation->cell_states_activations.data() + copy_index,
-             forward_propagation->cell_states_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_cell_state_activations.data());
-
-        copy(forward_propagation->hidden_states_activations_derivatives.data() + copy_index,
-             forward_propagation->hidden_states_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_hidden_states_derivatives.data());
-
-        if(sample%timesteps == 0)
-        {
-            forward_propagation->previous_cell_state_activations.setZero();
-
-            forget_combinations_weights_derivatives.setZero();
-            input_combinations_weights_derivatives.setZero();
-            output_combinations_weights_derivatives.setZero();
-            state_combinations_weights_derivatives.setZero();
-
-            cell_state_weights_derivatives.setZero();
-        }
-        else
-        {
-            copy(forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->cell_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_cell_state_activations.data());
-
-            forget_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(forget_recurrent_weights, A_B);
-
-            input_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(input_recurrent_weights, A_B);
-            multiply_rows(input_combinations_weights_derivatives, forward_propagation->current_input_activations_derivatives);
-
-            state_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(state_recurrent_weights, A_B);
-            multiply_rows(state_combinations_weights_derivatives, forward_propagation->current_state_activations_derivatives);
-
-            output_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(output_recurrent_weights, A_B);
-            multiply_rows(output_combinations_weights_derivatives, forward_propagation->current_output_activations_derivatives);
-        }
-
-        column_index = 0;
-        input_index = 0;
-
-        for(Index i = 0; i < parameters_number; i++)
-        {
-            forget_combinations_weights_derivatives(i, column_index) += current_inputs(input_index);
-
-            input_index++;
-
-            if(input_index == inputs_number)
-            {
-                input_index = 0;
-                column_index++;
-            }
-        }
-
-        multiply_rows(cell_state_weights_derivatives,
-                      forward_propagation->current_forget_activations);
-
-        multiply_rows(input_combinations_weights_derivatives,
-                      forward_propagation->current_state_activations);
-
-        cell_state_weights_derivatives += input_combinations_weights_derivatives;
-
-        multiply_rows(state_combinations_weights_derivatives,
-                      forward_propagation->current_input_activations);
-
-        cell_state_weights_derivatives += state_combinations_weights_derivatives;
-
-        multiply_rows(forget_combinations_weights_derivatives,
-                      forward_propagation->current_forget_activations_derivatives*forward_propagation->previous_cell_state_activations);
-
-        cell_state_weights_derivatives += forget_combinations_weights_derivatives;
-
-        copy(cell_state_weights_derivatives.data(),
-             cell_state_weights_derivatives.data() + cell_state_weights_derivatives.size(),
-             hidden_states_weights_derivatives.data());
-
-        multiply_rows(hidden_states_weights_derivatives,
-                      forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
-
-        multiply_rows(output_combinations_weights_derivatives,
-                      calculate_activations(forward_propagation->current_cell_state_activations));
-        hidden_states_weights_derivatives += output_combinations_weights_derivatives;
-
-        back_propagation->forget_weights_derivatives += hidden_states_weights_derivatives.contract(current_layer_deltas, A_B);
-
-        copy_index += neurons_number;
-    }
-}
-
-
-void LongShortTermMemoryLayer::calculate_input_weights_error_gradient(const Tensor<type, 2>& inputs,
-                                                                      LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                      LongShortTermMemoryLayerBackPropagation* back_propagation) const
-{
-    const Index samples_number = inputs.dimension(0);
-    const Index inputs_number = get_inputs_number();
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = inputs_number*neurons_number;
-
-    Tensor<type, 2> input_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> forget_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> state_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> output_combinations_weights_derivatives(parameters_number, neurons_number);
-
-    Tensor<type, 2> hidden_states_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> cell_state_weights_derivatives(parameters_number, neurons_number);
-
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
-
-    input_combinations_weights_derivatives.setZero();
-    forget_combinations_weights_derivatives.setZero();
-    state_combinations_weights_derivatives.setZero();
-    output_combinations_weights_derivatives.setZero();
-    hidden_states_weights_derivatives.setZero();
-    cell_state_weights_derivatives.setZero();
-
-    Index column_index = 0;
-    Index input_index = 0;
-
-    Index copy_index = 0;
-
-    back_propagation->input_weights_derivatives.setZero();
-
-    for(Index sample = 0; sample < samples_number; sample++)
-    {
-        forward_propagation->current_inputs = inputs.chip(sample, 0); // memcpy?
-
-        back_propagation->current_layer_deltas = deltas.chip(sample,0); // memcpy?
-
-        copy(forward_propagation->forget_activations.data() + copy_index,
-             forward_propagation->forget_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations.data());
-
-        copy(forward_propagation->forget_activations_derivatives.data() + copy_index,
-             forward_propagation->forget_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations_derivatives.data());
-
-        copy(forward_propagation->input_activations.data() + copy_index,
-             forward_propagation->input_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations.data());
-
-        copy(forward_propagation->input_activations_derivatives.data() + copy_index,
-             forward_propagation->input_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations_derivatives.data());
-
-        copy(forward_propagation->state_activations.data() + copy_index,
-             forward_propagation->state_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations.data());
-
-        copy(forward_propagation->state_activations_derivatives.data() + copy_index,
-             forward_propagation->state_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations_derivatives.data());
-
-        copy(forward_propagation->output_activations.data() + copy_index,
-             forward_propagation->output_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations.data());
-
-        copy(forward_propagation->output_activations_derivatives.data() + copy_index,
-             forward_propagation->output_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations_derivatives.data());
-
-        copy(forward_propagation->cell_states_activations.data() + copy_index,
-             forward_propagation->cell_states_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_cell_state_activations.data());
-
-        copy(forward_propagation->hidden_states_activations_derivatives.data() + copy_index,
-             forward_propagation->hidden_states_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_hidden_states_derivatives.data());
-
-        if(sample%timesteps == 0)
-        {
-            forward_propagation->previous_cell_state_activations.setZero();
-
-            forget_combinations_weights_derivatives.setZero();
-            input_combinations_weights_derivatives.setZero();
-            output_combinations_weights_derivatives.setZero();
-            state_combinations_weights_derivatives.setZero();
-
-            cell_state_weights_derivatives.setZero();
-            hidden_states_weights_derivatives.setZero();
-        }
-        else
-        {
-            copy(forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->cell_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_cell_state_activations.data());
-
-            forget_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(forget_recurrent_weights, A_B);
-
-            multiply_rows(forget_combinations_weights_derivatives,
-                          forward_propagation->current_forget_activations_derivatives);
-
-            input_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(input_recurrent_weights, A_B);
-
-            state_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(state_recurrent_weights, A_B);
-
-            multiply_rows(state_combinations_weights_derivatives,
-                          forward_propagation->current_state_activations_derivatives);
-
-            output_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(output_recurrent_weights, A_B);
-
-            multiply_rows(output_combinations_weights_derivatives,
-                          forward_propagation->current_output_activations_derivatives);
-        }
-
-        column_index = 0;
-        input_index = 0;
-
-        for(Index i = 0; i < parameters_number; i++)
-        {
-            input_combinations_weights_derivatives(i, column_index) += forward_propagation->current_inputs[input_index];
-
-            input_index++;
-
-            if(input_index == inputs_number)
-            {
-                input_index = 0;
-                column_index++;
-            }
-        }
-
-        multiply_rows(cell_state_weights_derivatives,
-                      forward_propagation->current_forget_activations);
-
-        multiply_rows(forget_combinations_weights_derivatives,
-                      forward_propagation->previous_cell_state_activations);
-
-        cell_state_weights_derivatives += forget_combinations_weights_derivatives;
-
-        multiply_rows(state_combinations_weights_derivatives,
-                      forward_propagation->current_input_activations);
-
-        cell_state_weights_derivatives += state_combinations_weights_derivatives;
-
-        multiply_rows(input_combinations_weights_derivatives,
-                      forward_propagation->current_input_activations_derivatives*forward_propagation->current_state_activations);
-
-        cell_state_weights_derivatives += input_combinations_weights_derivatives;
-
-        hidden_states_weights_derivatives = cell_state_weights_derivatives;
-
-        multiply_rows(hidden_states_weights_derivatives,
-                      forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
-
-        multiply_rows(output_combinations_weights_derivatives,
-                      calculate_activations(forward_propagation->current_cell_state_activations));
-
-        hidden_states_weights_derivatives += output_combinations_weights_derivatives;
-
-        back_propagation->input_weights_derivatives
-                += hidden_states_weights_derivatives.contract(back_propagation->current_layer_deltas, A_B);
-
-        copy_index += neurons_number;
-    }
-}
-
-
-void LongShortTermMemoryLayer::calculate_state_weights_error_gradient(const Tensor<type, 2>& inputs,
-                                                                      LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                      LongShortTermMemoryLayerBackPropagation* back_propagation) const
-{
-    const Index samples_number = inputs.dimension(0);
-    const Index inputs_number = get_inputs_number();
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = inputs_number*neurons_number;
-
-    TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
-
-    Tensor<type, 2> input_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> forget_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> state_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> output_combinations_weights_derivatives(parameters_number, neurons_number);
-
-    Tensor<type, 2> hidden_states_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> cell_state_weights_derivatives(parameters_number, neurons_number);
-
-    input_combinations_weights_derivatives.setZero();
-    forget_combinations_weights_derivatives.setZero();
-    state_combinations_weights_derivatives.setZero();
-    output_combinations_weights_derivatives.setZero();
-    hidden_states_weights_derivatives.setZero();
-    cell_state_weights_derivatives.setZero();
-
-    Index column_index = 0;
-    Index input_index = 0;
-
-    Index copy_index = 0;
-
-    back_propagation->state_weights_derivatives.setZero();
-
-    for(Index sample = 0; sample < samples_number; sample++)
-    {
-        forward_propagation->current_inputs = inputs.chip(sample, 0); // memcpy?
-
-        back_propagation->current_layer_deltas = deltas.chip(sample,0); // memcpy?
-
-        copy(forward_propagation->forget_activations.data() + copy_index,
-             forward_propagation->forget_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations.data());
-
-        copy(forward_propagation->forget_activations_derivatives.data() + copy_index,
-             forward_propagation->forget_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations_derivatives.data());
-
-        copy(forward_propagation->input_activations.data() + copy_index,
-             forward_propagation->input_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations.data());
-
-        copy(forward_propagation->input_activations_derivatives.data() + copy_index,
-             forward_propagation->input_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations_derivatives.data());
-
-        copy(forward_propagation->state_activations.data() + copy_index,
-             forward_propagation->state_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations.data());
-
-        copy(forward_propagation->state_activations_derivatives.data() + copy_index,
-             forward_propagation->state_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations_derivatives.data());
-
-        copy(forward_propagation->output_activations.data() + copy_index,
-             forward_propagation->output_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations.data());
-
-        copy(forward_propagation->output_activations_derivatives.data() + copy_index,
-             forward_propagation->output_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations_derivatives.data());
-
-        copy(forward_propagation->cell_states_activations.data() + copy_index,
-             forward_propagation->cell_states_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_cell_state_activations.data());
-
-        copy(forward_propagation->hidden_states_activations_derivatives.data() + copy_index,
-             forward_propagation->hidden_states_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_hidden_states_derivatives.data());
-
-        if(sample%timesteps == 0)
-        {
-            forward_propagation->previous_cell_state_activations.setZero();
-
-            forget_combinations_weights_derivatives.setZero();
-            input_combinations_weights_derivatives.setZero();
-            output_combinations_weights_derivatives.setZero();
-            state_combinations_weights_derivatives.setZero();
-
-            cell_state_weights_derivatives.setZero();
-        }
-        else
-        {
-            copy(forward_propagation->cell_states_activations.data() + (copy_index - neurons_number),
-            forward_propagation->cell_states_activations.data() + (copy_index - neurons_number) + neurons_number,
-            forward_propagation->previous_cell_state_activations.data());
-
-            forget_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(forget_recurrent_weights, A_B);
-            multiply_rows(forget_combinations_weights_derivatives, forward_propagation->current_forget_activations_derivatives);
-
-            input_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(input_recurrent_weights, A_B);
-            multiply_rows(input_combinations_weights_derivatives, forward_propagation->current_input_activations_derivatives);
-
-            state_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(state_recurrent_weights, A_B);
-
-            output_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(output_recurrent_weights, A_B);
-            multiply_rows(output_combinations_weights_derivatives, forward_propagation->current_output_activations_derivatives);
-        }
-
-        column_index = 0;
-        input_index = 0;
-
-        for(Index i = 0; i < parameters_number; i++)
-        {
-            state_combinations_weights_derivatives(i, column_index) += forward_propagation->current_inputs[input_index];
-
-            input_index++;
-
-            if(input_index == inputs_number)
-            {
-                input_index = 0;
-                column_index++;
-            }
-        }
-
-        multiply_rows(cell_state_weights_derivatives, forward_propagation->current_forget_activations);
-        multiply_rows(forget_combinations_weights_derivatives, forward_propagation->previous_cell_state_activations);
-        cell_state_weights_derivatives += forget_combinations_weights_derivatives;
-        multiply_rows(input_combinations_weights_derivatives, forward_propagation->current_state_activations);
-        cell_state_weights_derivatives += input_combinations_weights_derivatives;
-        multiply_rows(state_combinations_weights_derivatives, (forward_propagation->current_state_activations_derivatives*forward_propagation->current_input_activations));
-        cell_state_weights_derivatives += state_combinations_weights_derivatives;
-
-        hidden_states_weights_derivatives = cell_state_weights_derivatives;
-        multiply_rows(hidden_states_weights_derivatives, forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
-        multiply_rows(output_combinations_weights_derivatives, calculate_activations(forward_propagation->current_cell_state_activations));
-        hidden_states_weights_derivatives += output_combinations_weights_derivatives;
-
-        back_propagation->state_weights_derivatives += hidden_states_weights_derivatives.contract(back_propagation->current_layer_deltas, A_B);
-
-        copy_index += neurons_number;
-    }
-}
-
-
-void LongShortTermMemoryLayer::calculate_output_weights_error_gradient(const Tensor<type, 2>& inputs,
-                                                                       LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                       LongShortTermMemoryLayerBackPropagation* back_propagation) const
-{
-    const Index samples_number = inputs.dimension(0);
-    const Index inputs_number = get_inputs_number();
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = inputs_number*neurons_number;
-
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
-
-    Tensor<type, 2> input_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> forget_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> state_combinations_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> output_combinations_weights_derivatives(parameters_number, neurons_number);
-
-    Tensor<type, 2> hidden_states_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> cell_state_weights_derivatives(parameters_number, neurons_number);
-
-    input_combinations_weights_derivatives.setZero();
-    forget_combinations_weights_derivatives.setZero();
-    state_combinations_weights_derivatives.setZero();
-    output_combinations_weights_derivatives.setZero();
-    hidden_states_weights_derivatives.setZero();
-    cell_state_weights_derivatives.setZero();
-
-    Index column_index = 0;
-    Index input_index = 0;
-
-    Index copy_index = 0;
-
-    back_propagation->output_weights_derivatives.setZero();
-
-    for(Index sample = 0; sample < samples_number; sample++)
-    {
-        forward_propagation->current_inputs = inputs.chip(sample, 0); // memcpy?
-
-        back_propagation->current_layer_deltas = deltas.chip(sample,0); // memcpy?
-
-        copy(forward_propagation->forget_activations.data() + copy_index,
-             forward_propagation->forget_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations.data());
-
-        copy(forward_propagation->forget_activations_derivatives.data() + copy_index,
-             forward_propagation->forget_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations_derivatives.data());
-
-        copy(forward_propagation->input_activations.data() + copy_index,
-             forward_propagation->input_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations.data());
-
-        copy(forward_propagation->input_activations_derivatives.data() + copy_index,
-             forward_propagation->input_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations_derivatives.data());
-
-        copy(forward_propagation->state_activations.data() + copy_index,
-             forward_propagation->state_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations.data());
-
-        copy(forward_propagation->state_activations_derivatives.data() + copy_index,
-             forward_propagation->state_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations_derivatives.data());
-
-        copy(forward_propagation->output_activations.data() + copy_index,
-             forward_propagation->output_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations.data());
-
-        copy(forward_propagation->output_activations_derivatives.data() + copy_index,
-             forward_propagation->output_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations_derivatives.data());
-
-        copy(forward_propagation->cell_states_activations.data() + copy_index,
-             forward_propagation->cell_states_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_cell_state_activations.data());
-
-        copy(forward_propagation->hidden_states_activations_derivatives.data() + copy_index,
-             forward_propagation->hidden_states_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_hidden_states_derivatives.data());
-
-        if(sample%timesteps == 0)
-        {
-            forward_propagation->previous_cell_state_activations.setZero();
-
-            forget_combinations_weights_derivatives.setZero();
-            input_combinations_weights_derivatives.setZero();
-            output_combinations_weights_derivatives.setZero();
-            state_combinations_weights_derivatives.setZero();
-
-            cell_state_weights_derivatives.setZero();
-        }
-        else
-        {
-            copy(forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->cell_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_cell_state_activations.data());
-
-            forget_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(forget_recurrent_weights, A_B);
-            multiply_rows(forget_combinations_weights_derivatives, forward_propagation->current_forget_activations_derivatives);
-            input_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(input_recurrent_weights, A_B);
-            multiply_rows(input_combinations_weights_derivatives, forward_propagation->current_input_activations_derivatives);
-            state_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(state_recurrent_weights, A_B);
-            multiply_rows(state_combinations_weights_derivatives, forward_propagation->current_state_activations_derivatives);
-            output_combinations_weights_derivatives = hidden_states_weights_derivatives.contract(output_recurrent_weights, A_B);
-        }
-
-        column_index = 0;
-        input_index = 0;
-
-        for(Index i = 0; i < parameters_number; i++)
-        {
-            output_combinations_weights_derivatives(i, column_index) += forward_propagation->current_inputs[input_index];
-
-            input_index++;
-
-            if(input_index == inputs_number)
-            {
-                input_index = 0;
-                column_index++;
-            }
-        }
-
-        multiply_rows(cell_state_weights_derivatives, forward_propagation->current_forget_activations);
-        multiply_rows(forget_combinations_weights_derivatives, forward_propagation->previous_cell_state_activations);
-        cell_state_weights_derivatives += forget_combinations_weights_derivatives;
-        multiply_rows(state_combinations_weights_derivatives, forward_propagation->current_input_activations);
-        cell_state_weights_derivatives += state_combinations_weights_derivatives;
-        multiply_rows(input_combinations_weights_derivatives, forward_propagation->current_state_activations);
-        cell_state_weights_derivatives += input_combinations_weights_derivatives;
-
-         hidden_states_weights_derivatives = cell_state_weights_derivatives;
-         multiply_rows(hidden_states_weights_derivatives, forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
-         multiply_rows(output_combinations_weights_derivatives, forward_propagation->current_output_activations_derivatives*calculate_activations(forward_propagation->current_cell_state_activations));
-        hidden_states_weights_derivatives += output_combinations_weights_derivatives;
-
-        back_propagation->output_weights_derivatives += hidden_states_weights_derivatives.contract(back_propagation->current_layer_deltas, A_B);
-
-        copy_index += neurons_number;
-    }
-}
-
-
-void LongShortTermMemoryLayer::calculate_forget_recurrent_weights_error_gradient(const Tensor<type, 2>& inputs,
-                                                                                 LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                                 LongShortTermMemoryLayerBackPropagation* back_propagation) const
-{
-    const Index samples_number = inputs.dimension(0);
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = neurons_number*neurons_number;
-
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
-
-    Tensor<type, 1> forget_recurrent_weights_error_gradient(parameters_number);
-    forget_recurrent_weights_error_gradient.setZero();
-
-    Tensor<type, 2> input_combinations_recurrent_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> forget_combinations_recurrent_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> state_combinations_recurrent_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> output_combinations_recurrent_weights_derivatives(parameters_number, neurons_number);
-
-    Tensor<type, 2> hidden_states_recurrent_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> cell_state_recurrent_weights_derivatives(parameters_number, neurons_number);
-
-    Index column_index = 0;
-    Index activation_index = 0;
-
-    Index copy_index = 0;
-
-    back_propagation->forget_recurrent_weights_derivatives.setZero();
-
-    for(Index sample = 0; sample < samples_number; sample++)
-    {
-        back_propagation->current_layer_deltas = deltas.chip(sample, 0);
-
-        copy(forward_propagation->forget_activations.data() + copy_index,
-             forward_propagation->forget_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations.data());
-
-        copy(forward_propagation->forget_activations_derivatives.data() + copy_index,
-             forward_propagation->forget_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations_derivatives.data());
-
-        copy(forward_propagation->input_activations.data() + copy_index,
-             forward_propagation->input_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations.data());
-
-        copy(forward_propagation->input_activations_derivatives.data() + copy_index,
-             forward_propagation->input_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations_derivatives.data());
-
-        copy(forward_propagation->state_activations.data() + copy_index,
-             forward_propagation->state_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations.data());
-
-        copy(forward_propagation->state_activations_derivatives.data() + copy_index,
-             forward_propagation->state_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations_derivatives.data());
-
-        copy(forward_propagation->output_activations.data() + copy_index,
-             forward_propagation->output_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations.data());
-
-        copy(forward_propagation->output_activations_derivatives.data() + copy_index,
-             forward_propagation->output_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations_derivatives.data());
-
-        copy(forward_propagation->cell_states_activations.data() + copy_index,
-             forward_propagation->cell_states_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_cell_state_activations.data());
-
-        copy(forward_propagation->hidden_states_activations_derivatives.data() + copy_index,
-             forward_propagation->hidden_states_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_hidden_states_derivatives.data());
-
-        if(sample%timesteps == 0)
-        {
-            cell_state_recurrent_weights_derivatives.setZero();
-            hidden_states_recurrent_weights_derivatives.setZero();
-        }
-        else
-        {
-            copy(forward_propagation->hidden_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->hidden_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_hidden_state_activations.data());
-
-            copy(forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->cell_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_cell_state_activations.data());
-
-            forget_combinations_recurrent_weights_derivatives = hidden_states_recurrent_weights_derivatives.contract(forget_recurrent_weights, A_B);
-            input_combinations_recurrent_weights_derivatives = hidden_states_recurrent_weights_derivatives.contract(input_recurrent_weights, A_B);
-            multiply_rows(input_combinations_recurrent_weights_derivatives, forward_propagation->current_input_activations_derivatives);
-            state_combinations_recurrent_weights_derivatives = hidden_states_recurrent_weights_derivatives.contract(state_recurrent_weights, A_B);
-            multiply_rows(state_combinations_recurrent_weights_derivatives, forward_propagation->current_state_activations_derivatives);
-            output_combinations_recurrent_weights_derivatives = hidden_states_recurrent_weights_derivatives.contract(output_recurrent_weights, A_B);
-            multiply_rows(output_combinations_recurrent_weights_derivatives, forward_propagation->current_output_activations_derivatives);
-
-            column_index = 0;
-            activation_index = 0;
-
-            for(Index i = 0; i < parameters_number; i++)
-            {
-                forget_combinations_recurrent_weights_derivatives(i, column_index) += forward_propagation->previous_hidden_state_activations[activation_index];
-
-                activation_index++;
-
-                if(activation_index == neurons_number)
-                {
-                    activation_index = 0;
-                    column_index++;
-                }
-            }
+    LongShortTermMemoryLayerForwardPropagation* long_short_term_memory_layer_forward_propagation
+            = static_cast<LongShortTermMemoryLayerForwardPropagation*>(forward_propagation);
 
-            multiply_rows(cell_state_recurrent_weights_derivatives, forward_propagation->current_forget_activations);
-            multiply_rows(input_combinations_recurrent_weights_derivatives, forward_propagation->current_state_activations);
-            cell_state_recurrent_weights_derivatives += input_combinations_recurrent_weights_derivatives;
-            multiply_rows(state_combinations_recurrent_weights_derivatives, forward_propagation->current_input_activations);
-            cell_state_recurrent_weights_derivatives += state_combinations_recurrent_weights_derivatives;
-            multiply_rows(forget_combinations_recurrent_weights_derivatives, (forward_propagation->current_forget_activations_derivatives*forward_propagation->previous_cell_state_activations));
-            cell_state_recurrent_weights_derivatives += forget_combinations_recurrent_weights_derivatives;
-
-            hidden_states_recurrent_weights_derivatives = cell_state_recurrent_weights_derivatives;
-            multiply_rows(hidden_states_recurrent_weights_derivatives, forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
-            multiply_rows(output_combinations_recurrent_weights_derivatives, calculate_activations(forward_propagation->current_cell_state_activations));
-            hidden_states_recurrent_weights_derivatives += output_combinations_recurrent_weights_derivatives;
-        }
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
 
-        back_propagation->forget_recurrent_weights_derivatives += hidden_states_recurrent_weights_derivatives.contract(back_propagation->current_layer_deltas, A_B);
+    const type* parameters_biases = parameters.data();
+    const type* parameters_weights = parameters_biases + 4*neurons_number;
+    const type* parameters_recurrent_weights = parameters_weights + 4*inputs_number*neurons_number;
 
-        copy_index += neurons_number;
-    }
+    forward_propagate_sequences(inputs_data, inputs_dimensions(0),
+                                parameters_biases, parameters_weights, parameters_recurrent_weights,
+                                long_short_term_memory_layer_forward_propagation,
+                                true);
 }
 
 
-void LongShortTermMemoryLayer::calculate_input_recurrent_weights_error_gradient(const Tensor<type, 2>& inputs,
-                                                                                LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                                LongShortTermMemoryLayerBackPropagation* back_propagation) const
+/// Propagates a batch of consecutive sequences through the layer, with given parameters.
+/// The hidden and cell states are reset every timesteps samples, so the batch holds independent sequences.
+/// All the sequences advance together: for each timestep there is a single matrix product of their previous hidden states
+/// with the recurrent weights of the four gates, followed by the activations of the four gates in one sweep.
+/// The products of the inputs with the weights do not depend on the previous timestep, and they are computed at once for all the timesteps.
+/// @param inputs_data Pointer to the inputs of the batch, with the samples in the rows.
+/// @param samples_number Number of samples in the batch.
+/// @param biases_data Pointer to the biases of the four gates.
+/// @param weights_data Pointer to the weights of the four gates.
+/// @param recurrent_weights_data Pointer to the recurrent weights of the four gates.
+/// @param forward_propagation Forward propagation structure of this layer.
+/// @param switch_train True to compute also the activations derivatives needed in training.
+
+void LongShortTermMemoryLayer::forward_propagate_sequences(const type* inputs_data, const Index& samples_number,
+                                                           const type* biases_data, const type* weights_data, const type* recurrent_weights_data,
+                                                           LongShortTermMemoryLayerForwardPropagation* forward_propagation,
+                                                           const bool& switch_train)
 {
-    const Index samples_number = inputs.dimension(0);
+    const Index inputs_number = get_inputs_number();
     const Index neurons_number = get_neurons_number();
-    const Index parameters_number = neurons_number*neurons_number;
-
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
+    const Index gates_number = 4*neurons_number;
 
-    Tensor<type, 1> forget_recurrent_weights_error_gradient(parameters_number);
-    forget_recurrent_weights_error_gradient.setZero();
+    if(forward_propagation->timesteps != timesteps) forward_propagation->set_timesteps(timesteps);
 
-    Tensor<type, 2> input_combinations_recurrent_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> forget_combinations_recurrent_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> state_combinations_recurrent_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> output_combinations_recurrent_weights_derivatives(parameters_number, neurons_number);
+    const Index sequences_number = forward_propagation->sequences_number;
+    const Index rows_number = sequences_number*timesteps;
 
-    Tensor<type, 2> hidden_states_recurrent_weights_derivatives(parameters_number, neurons_number);
-    Tensor<type, 2> cell_state_recurrent_weights_derivatives(parameters_number, neurons_number);
+    // Inputs ordered by timestep. The missing timesteps of the last sequence are zero.
 
-    Index column_index = 0;
-    Index activation_index = 0;
+    const TensorMap<Tensor<type, 2>> batch_inputs(const_cast<type*>(inputs_data), samples_number, inputs_number);
 
-    Index copy_index = 0;
+    Tensor<type, 2>& inputs = forward_propagation->inputs;
 
-    back_propagation->input_recurrent_weights_derivatives.setZero();
+#pragma omp parallel for
 
-    for(Index sample = 0; sample < samples_number; sample++)
+    for(Index j = 0; j < inputs_number; j++)
     {
-        back_propagation->current_layer_deltas = deltas.chip(sample, 0);
-
-        copy(forward_propagation->forget_activations.data() + copy_index,
-             forward_propagation->forget_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations.data());
-
-        copy(forward_propagation->forget_activations_derivatives.data() + copy_index,
-             forward_propagation->forget_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations_derivatives.data());
-
-        copy(forward_propagation->input_activations.data() + copy_index,
-             forward_propagation->input_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations.data());
-
-        copy(forward_propagation->input_activations_derivatives.data() + copy_index,
-             forward_propagation->input_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations_derivatives.data());
-
-        copy(forward_propagation->state_activations.data() + copy_index,
-             forward_propagation->state_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations.data());
-
-        copy(forward_propagation->state_activations_derivatives.data() + copy_index,
-             forward_propagation->state_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations_derivatives.data());
-
-        copy(forward_propagation->output_activations.data() + copy_index,
-             forward_propagation->output_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations.data());
-
-        copy(forward_propagation->output_activations_derivatives.data() + copy_index,
-             forward_propagation->output_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations_derivatives.data());
-
-        copy(forward_propagation->cell_states_activations.data() + copy_index,
-             forward_propagation->cell_states_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_cell_state_activations.data());
-
-        copy(forward_propagation->hidden_states_activations_derivatives.data() + copy_index,
-             forward_propagation->hidden_states_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_hidden_states_derivatives.data());
-
-        if(sample%timesteps == 0)
-        {
-            cell_state_recurrent_weights_derivatives.setZero();
-            hidden_states_recurrent_weights_derivatives.setZero();
-        }
-        else
+        for(Index i = 0; i < samples_number; i++)
         {
-            copy(forward_propagation->hidden_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->hidden_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_hidden_state_activations.data());
-
-            copy(forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->cell_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_cell_state_activations.data());
-
-            forget_combinations_recurrent_weights_derivatives = hidden_states_recurrent_weights_derivatives.contract(forget_recurrent_weights, A_B);
-            multiply_rows(forget_combinations_recurrent_weights_derivatives, forward_propagation->current_forget_activations_derivatives);
-            input_combinations_recurrent_weights_derivatives = hidden_states_recurrent_weights_derivatives.contract(input_recurrent_weights, A_B);
-            state_combinations_recurrent_weights_derivatives = hidden_states_recurrent_weights_derivatives.contract(state_recurrent_weights, A_B);
-            multiply_rows(state_combinations_recurrent_weights_derivatives, forward_propagation->current_state_activations_derivatives);
-            output_combinations_recurrent_weights_derivatives = hidden_states_recurrent_weights_derivatives.contract(output_recurrent_weights, A_B);
-            multiply_rows(output_combinations_recurrent_weights_derivatives, forward_propagation->current_output_activations_derivatives);
-
-            column_index = 0;
-            activation_index = 0;
-
-            for(Index i = 0; i < parameters_number; i++)
-            {
-                input_combinations_recurrent_weights_derivatives(i, column_index) += forward_propagation->previous_hidden_state_activations[activation_index];
-
-                activation_index++;
-
-                if(activation_index == neurons_number)
-                {
-                    activation_index = 0;
-                    column_index++;
-                }
-            }
-
-            multiply_rows(cell_state_recurrent_weights_derivatives, forward_propagation->current_forget_activations);
-            multiply_rows(input_combinations_recurrent_weights_derivatives, forward_propagation->current_input_activations_derivatives*forward_propagation->current_state_activations);
-            cell_state_recurrent_weights_derivatives += input_combinations_recurrent_weights_derivatives;
-            multiply_rows(state_combinations_recurrent_weights_derivatives, forward_propagation->current_input_activations);
-            cell_state_recurrent_weights_derivatives += state_combinations_recurrent_weights_derivatives;
-            multiply_rows(forget_combinations_recurrent_weights_derivatives, forward_propagation->previous_cell_state_activations);
-            cell_state_recurrent_weights_derivatives += forget_combinations_recurrent_weights_derivatives;
-
-            hidden_states_recurrent_weights_derivatives = cell_state_recurrent_weights_derivatives;
-            multiply_rows(hidden_states_recurrent_weights_derivatives, forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
-            multiply_rows(output_combinations_recurrent_weights_derivatives, calculate_activations(forward_propagation->current_cell_state_activations));
-            hidden_states_recurrent_weights_derivatives += output_combinations_recurrent_weights_derivatives;
+            inputs(i/timesteps + sequences_number*(i%timesteps), j) = batch_inputs(i, j);
         }
 
-        back_propagation->input_recurrent_weights_derivatives += hidden_states_recurrent_weights_derivatives.contract(back_propagation->current_layer_deltas, A_B);
-
-        copy_index += neurons_number;
-    }
-}
-
-
-void LongShortTermMemoryLayer::calculate_state_recurrent_weights_error_gradient(const Tensor<type, 2>& inputs,
-                                                                                LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                                LongShortTermMemoryLayerBackPropagation* back_propagation) const
-{
-    const Index samples_number = inputs.dimension(0);
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = neurons_number*neurons_number;
-
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
-
-    Tensor<type, 1> forget_recurrent_weights_error_gradient(parameters_number);
-    forget_recurrent_weights_error_gradient.setZero();
-
-    Index column_index = 0;
-    Index activation_index = 0;
-
-    Index copy_index = 0;
-
-    back_propagation->state_recurrent_weights_derivatives.setZero();
-
-    for(Index sample = 0; sample < samples_number; sample++)
-    {
-        back_propagation->current_layer_deltas = deltas.chip(sample, 0);
-
-        copy(forward_propagation->forget_activations.data() + copy_index,
-             forward_propagation->forget_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations.data());
-
-        copy(forward_propagation->forget_activations_derivatives.data() + copy_index,
-             forward_propagation->forget_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations_derivatives.data());
-
-        copy(forward_propagation->input_activations.data() + copy_index,
-             forward_propagation->input_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations.data());
-
-        copy(forward_propagation->input_activations_derivatives.data() + copy_index,
-             forward_propagation->input_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations_derivatives.data());
-
-        copy(forward_propagation->state_activations.data() + copy_index,
-             forward_propagation->state_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations.data());
-
-        copy(forward_propagation->state_activations_derivatives.data() + copy_index,
-             forward_propagation->state_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations_derivatives.data());
-
-        copy(forward_propagation->output_activations.data() + copy_index,
-             forward_propagation->output_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations.data());
-
-        copy(forward_propagation->output_activations_derivatives.data() + copy_index,
-             forward_propagation->output_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations_derivatives.data());
-
-        copy(forward_propagation->cell_states_activations.data() + copy_index,
-             forward_propagation->cell_states_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_cell_state_activations.data());
-
-        copy(forward_propagation->hidden_states_activations_derivatives.data() + copy_index,
-             forward_propagation->hidden_states_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_hidden_states_derivatives.data());
-
-        if(sample%timesteps == 0)
-        {
-            back_propagation->cell_state_recurrent_weights_derivatives.setZero();
-            back_propagation->hidden_states_recurrent_weights_derivatives.setZero();
-        }
-        else
+        for(Index i = samples_number; i < rows_number; i++)
         {
-            copy(forward_propagation->hidden_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->hidden_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_hidden_state_activations.data());
-
-            copy(forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->cell_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_cell_state_activations.data());
-
-            back_propagation->forget_combinations_recurrent_weights_derivatives = back_propagation->hidden_states_recurrent_weights_derivatives.contract(forget_recurrent_weights, A_B);
-            multiply_rows(back_propagation->forget_combinations_recurrent_weights_derivatives, forward_propagation->current_forget_activations_derivatives);
-            back_propagation->input_combinations_recurrent_weights_derivatives = back_propagation->hidden_states_recurrent_weights_derivatives.contract(input_recurrent_weights, A_B);
-            multiply_rows(back_propagation->input_combinations_recurrent_weights_derivatives, forward_propagation->current_input_activations_derivatives);
-            back_propagation->state_combinations_recurrent_weights_derivatives = back_propagation->hidden_states_recurrent_weights_derivatives.contract(state_recurrent_weights, A_B);
-            back_propagation->state_combinations_recurrent_weights_derivatives = back_propagation->hidden_states_recurrent_weights_derivatives.contract(output_recurrent_weights, A_B);
-            multiply_rows(back_propagation->state_combinations_recurrent_weights_derivatives, forward_propagation->current_output_activations_derivatives);
-
-            column_index = 0;
-            activation_index = 0;
-
-            for(Index i = 0; i < parameters_number; i++)
-            {
-                back_propagation->state_combinations_recurrent_weights_derivatives(i, column_index) += forward_propagation->previous_hidden_state_activations[activation_index];
-
-                activation_index++;
-
-                if(activation_index == neurons_number)
-                {
-                    activation_index = 0;
-                    column_index++;
-                }
-            }
-
-            multiply_rows(back_propagation->cell_state_recurrent_weights_derivatives, forward_propagation->current_forget_activations);
-            multiply_rows(back_propagation->input_combinations_recurrent_weights_derivatives, forward_propagation->current_state_activations);
-            back_propagation->cell_state_recurrent_weights_derivatives += back_propagation->input_combinations_recurrent_weights_derivatives;
-            multiply_rows(back_propagation->state_combinations_recurrent_weights_derivatives, forward_propagation->current_state_activations_derivatives*forward_propagation->current_input_activations);
-            back_propagation->cell_state_recurrent_weights_derivatives += back_propagation->state_combinations_recurrent_weights_derivatives;
-            multiply_rows(back_propagation->forget_combinations_recurrent_weights_derivatives, forward_propagation->previous_cell_state_activations);
-            back_propagation->cell_state_recurrent_weights_derivatives += back_propagation->forget_combinations_recurrent_weights_derivatives;
-
-            back_propagation->hidden_states_recurrent_weights_derivatives = back_propagation->cell_state_recurrent_weights_derivatives;
-            multiply_rows(back_propagation->hidden_states_recurrent_weights_derivatives, forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
-            multiply_rows(back_propagation->state_combinations_recurrent_weights_derivatives, calculate_activations(forward_propagation->current_cell_state_activations));
-            back_propagation->hidden_states_recurrent_weights_derivatives += back_propagation->state_combinations_recurrent_weights_derivatives;
+            inputs(i/timesteps + sequences_number*(i%timesteps), j) = type(0);
         }
-
-        back_propagation->state_recurrent_weights_derivatives += back_propagation->hidden_states_recurrent_weights_derivatives.contract(back_propagation->current_layer_deltas, A_B);
-
-        copy_index += neurons_number;
     }
-}
-
-
-void LongShortTermMemoryLayer::calculate_output_recurrent_weights_error_gradient(const Tensor<type, 2>& inputs,
-                                                                                 LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                                 LongShortTermMemoryLayerBackPropagation* back_propagation) const
-{
-    const Index samples_number = inputs.dimension(0);
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = neurons_number*neurons_number;
 
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
+    // Inputs combinations of all the timesteps
 
+    calculate_fused_combinations(inputs.data(), rows_number, inputs_number,
+                                 weights_data, gates_number,
+                                 biases_data,
+                                 forward_propagation->inputs_combinations.data(),
+                                 forward_propagation->inputs_combinations.data(),
+                                 nullptr);
 
-    Index column_index = 0;
-    Index activation_index = 0;
+    const Map<const Matrix<type, Dynamic, Dynamic>> inputs_combinations(forward_propagation->inputs_combinations.data(), rows_number, gates_number);
+    const Map<const Matrix<type, Dynamic, Dynamic>> recurrent_weights_matrix(recurrent_weights_data, neurons_number, gates_number);
 
-    Index copy_index = 0;
+    Map<Matrix<type, Dynamic, Dynamic>> gates_combinations(forward_propagation->gates_combinations.data(), sequences_number, gates_number);
+    Map<Matrix<type, Dynamic, Dynamic>> hidden_states_matrix(forward_propagation->hidden_states.data(), rows_number, neurons_number);
 
-    back_propagation->output_recurrent_weights_derivatives.setZero();
+    const Index gates_size = sequences_number*gates_number;
+    const Index states_size = sequences_number*neurons_number;
 
-    for(Index sample = 0; sample < samples_number; sample++)
+    for(Index t = 0; t < timesteps; t++)
     {
-        back_propagation->current_layer_deltas = deltas.chip(sample, 0);
-
-        copy(forward_propagation->forget_activations.data() + copy_index,
-             forward_propagation->forget_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations.data());
-
-        copy(forward_propagation->forget_activations_derivatives.data() + copy_index,
-             forward_propagation->forget_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations_derivatives.data());
-
-        copy(forward_propagation->input_activations.data() + copy_index,
-             forward_propagation->input_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations.data());
-
-        copy(forward_propagation->input_activations_derivatives.data() + copy_index,
-             forward_propagation->input_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations_derivatives.data());
-
-        copy(forward_propagation->state_activations.data() + copy_index,
-             forward_propagation->state_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations.data());
-
-        copy(forward_propagation->state_activations_derivatives.data() + copy_index,
-             forward_propagation->state_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations_derivatives.data());
-
-        copy(forward_propagation->output_activations.data() + copy_index,
-             forward_propagation->output_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations.data());
-
-        copy(forward_propagation->output_activations_derivatives.data() + copy_index,
-             forward_propagation->output_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations_derivatives.data());
+        // Combinations of the four gates
 
-        copy(forward_propagation->cell_states_activations.data() + copy_index,
-             forward_propagation->cell_states_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_cell_state_activations.data());
+        gates_combinations = inputs_combinations.middleRows(t*sequences_number, sequences_number);
 
-        copy(forward_propagation->hidden_states_activations_derivatives.data() + copy_index,
-             forward_propagation->hidden_states_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_hidden_states_derivatives.data());
-
-        if(sample%timesteps == 0)
-        {
-            back_propagation->cell_state_recurrent_weights_derivatives.setZero();
-            back_propagation->hidden_states_recurrent_weights_derivatives.setZero();
-        }
-        else
+        if(t != 0)
         {
-            copy(forward_propagation->hidden_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->hidden_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_hidden_state_activations.data());
-
-            copy(forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->cell_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_cell_state_activations.data());
-
-            back_propagation->forget_combinations_recurrent_weights_derivatives = back_propagation->hidden_states_recurrent_weights_derivatives.contract(forget_recurrent_weights, A_B);
-            multiply_rows(back_propagation->forget_combinations_recurrent_weights_derivatives, forward_propagation->current_forget_activations_derivatives);
-            back_propagation->input_combinations_recurrent_weights_derivatives = back_propagation->hidden_states_recurrent_weights_derivatives.contract(input_recurrent_weights, A_B);
-            multiply_rows(back_propagation->input_combinations_recurrent_weights_derivatives, forward_propagation->current_input_activations_derivatives);
-            back_propagation->state_combinations_recurrent_weights_derivatives = back_propagation->hidden_states_recurrent_weights_derivatives.contract(state_recurrent_weights, A_B);
-            multiply_rows(back_propagation->state_combinations_recurrent_weights_derivatives, forward_propagation->current_state_activations_derivatives);
-            back_propagation->output_combinations_recurrent_weights_derivatives = back_propagation->hidden_states_recurrent_weights_derivatives.contract(output_recurrent_weights, A_B);
-
-            column_index = 0;
-            activation_index = 0;
-
-            for(Index i = 0; i < parameters_number; i++)
-            {
-                back_propagation->output_combinations_recurrent_weights_derivatives(i, column_index) += forward_propagation->previous_hidden_state_activations[activation_index];
-
-                activation_index++;
-
-                if(activation_index == neurons_number)
-                {
-                    activation_index = 0;
-                    column_index++;
-                }
-            }
-
-            multiply_rows(back_propagation->cell_state_recurrent_weights_derivatives, forward_propagation->current_forget_activations);
-            multiply_rows(back_propagation->input_combinations_recurrent_weights_derivatives, forward_propagation->current_state_activations);
-            back_propagation->cell_state_recurrent_weights_derivatives += back_propagation->input_combinations_recurrent_weights_derivatives;
-            multiply_rows(back_propagation->state_combinations_recurrent_weights_derivatives, forward_propagation->current_input_activations);
-            back_propagation->cell_state_recurrent_weights_derivatives += back_propagation->state_combinations_recurrent_weights_derivatives;
-            multiply_rows(back_propagation->forget_combinations_recurrent_weights_derivatives, forward_propagation->previous_cell_state_activations);
-            back_propagation->cell_state_recurrent_weights_derivatives += back_propagation->forget_combinations_recurrent_weights_derivatives;
-
-            back_propagation->hidden_states_recurrent_weights_derivatives = back_propagation->cell_state_recurrent_weights_derivatives;
-            multiply_rows(back_propagation->cell_state_recurrent_weights_derivatives, forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
-            multiply_rows(back_propagation->output_combinations_recurrent_weights_derivatives, forward_propagation->current_output_activations_derivatives*calculate_activations(forward_propagation->current_cell_state_activations));
-            back_propagation->hidden_states_recurrent_weights_derivatives += back_propagation->output_combinations_recurrent_weights_derivatives;
+            gates_combinations.noalias() += hidden_states_matrix.middleRows((t-1)*sequences_number, sequences_number)*recurrent_weights_matrix;
         }
 
-        back_propagation->output_recurrent_weights_derivatives += back_propagation->hidden_states_recurrent_weights_derivatives.contract(back_propagation->current_layer_deltas, A_B);
-
-        copy_index += neurons_number;
-    }
-}
-
-
-void LongShortTermMemoryLayer::calculate_forget_biases_error_gradient(const Tensor<type, 2>& inputs,
-                                                                      LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                      LongShortTermMemoryLayerBackPropagation* back_propagation) const
-{
-    const Index samples_number = inputs.dimension(0);
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = neurons_number;
-
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
-
-    back_propagation->input_combinations_biases_derivatives.setZero();
-    back_propagation->forget_combinations_biases_derivatives.setZero();
-    back_propagation->state_combinations_biases_derivatives.setZero();
-    back_propagation->output_combinations_biases_derivatives.setZero();
-
-    back_propagation->hidden_states_biases_derivatives.setZero();
-    back_propagation->cell_state_biases_derivatives.setZero();
-
-    Index copy_index = 0;
-
-    back_propagation->forget_biases_derivatives.setZero();
-
-    for(Index sample = 0; sample < samples_number; sample++)
-    {
-        const Tensor<type, 1> current_layer_deltas = deltas.chip(sample, 0);
-
-        copy(forward_propagation->forget_activations.data() + copy_index,
-             forward_propagation->forget_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations.data());
+        type* gates_activations_data = forward_propagation->gates_activations.data() + t*gates_size;
+        type* gates_activations_derivatives_data = forward_propagation->gates_activations_derivatives.data() + t*gates_size;
 
-        copy(forward_propagation->forget_activations_derivatives.data() + copy_index,
-             forward_propagation->forget_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations_derivatives.data());
+        calculate_gates_activations(gates_combinations.data(),
+                                    gates_activations_data,
+                                    switch_train ? gates_activations_derivatives_data : nullptr,
+                                    sequences_number);
 
-        copy(forward_propagation->input_activations.data() + copy_index,
-             forward_propagation->input_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations.data());
+        // Cell states
 
-        copy(forward_propagation->input_activations_derivatives.data() + copy_index,
-             forward_propagation->input_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations_derivatives.data());
+        const Map<const Array<type, Dynamic, Dynamic>> forget_activations(gates_activations_data, sequences_number, neurons_number);
+        const Map<const Array<type, Dynamic, Dynamic>> input_activations(gates_activations_data + states_size, sequences_number, neurons_number);
+        const Map<const Array<type, Dynamic, Dynamic>> state_activations(gates_activations_data + 2*states_size, sequences_number, neurons_number);
+        const Map<const Array<type, Dynamic, Dynamic>> output_activations(gates_activations_data + 3*states_size, sequences_number, neurons_number);
 
-        copy(forward_propagation->state_activations.data() + copy_index,
-             forward_propagation->state_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations.data());
+        type* cell_states_data = forward_propagation->cell_states.data() + t*states_size;
+        type* cell_states_activations_data = forward_propagation->cell_states_activations.data() + t*states_size;
+        type* cell_states_activations_derivatives_data = forward_propagation->cell_states_activations_derivatives.data() + t*states_size;
 
-        copy(forward_propagation->state_activations_derivatives.data() + copy_index,
-             forward_propagation->state_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations_derivatives.data());
+        Map<Array<type, Dynamic, Dynamic>> cell_states_array(cell_states_data, sequences_number, neurons_number);
 
-        copy(forward_propagation->output_activations.data() + copy_index,
-             forward_propagation->output_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations.data());
-
-        copy(forward_propagation->output_activations_derivatives.data() + copy_index,
-             forward_propagation->output_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations_derivatives.data());
-
-        copy(forward_propagation->cell_states_activations.data() + copy_index,
-             forward_propagation->cell_states_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_cell_state_activations.data());
-
-        copy(forward_propagation->hidden_states_activations_derivatives.data() + copy_index,
-             forward_propagation->hidden_states_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_hidden_states_derivatives.data());
-
-        if(sample%timesteps == 0)
+        if(t == 0)
         {
-            back_propagation->forget_combinations_biases_derivatives.setZero();
-            back_propagation->input_combinations_biases_derivatives.setZero();
-            back_propagation->state_combinations_biases_derivatives.setZero();
-            back_propagation->output_combinations_biases_derivatives.setZero();
-
-            forward_propagation->previous_cell_state_activations.setZero();
-
-            back_propagation->cell_state_biases_derivatives.setZero();
+            cell_states_array = input_activations*state_activations;
         }
         else
         {
-            copy(forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->cell_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 forward_propagation->previous_cell_state_activations.data());
-
-            back_propagation->forget_combinations_biases_derivatives
-                    = back_propagation->hidden_states_biases_derivatives.contract(forget_recurrent_weights, A_B);
-
-            back_propagation->input_combinations_biases_derivatives
-                    = back_propagation->hidden_states_biases_derivatives.contract(input_recurrent_weights, A_B);
+            const Map<const Array<type, Dynamic, Dynamic>> previous_cell_states(cell_states_data - states_size, sequences_number, neurons_number);
 
-            multiply_rows(back_propagation->input_combinations_biases_derivatives,
-                          forward_propagation->current_input_activations_derivatives);
-
-            back_propagation->state_combinations_biases_derivatives
-                    = back_propagation->hidden_states_biases_derivatives.contract(state_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->state_combinations_biases_derivatives,
-                          forward_propagation->current_state_activations_derivatives);
-
-            back_propagation->output_combinations_biases_derivatives
-                    = back_propagation->hidden_states_biases_derivatives.contract(output_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->output_combinations_biases_derivatives,
-                          forward_propagation->current_output_activations_derivatives);
+            cell_states_array = forget_activations*previous_cell_states + input_activations*state_activations;
         }
 
-        for(Index row = 0; row < parameters_number; row++) back_propagation->forget_combinations_biases_derivatives(row, row) += static_cast<type>(1.0);
-
-        multiply_rows(back_propagation->cell_state_biases_derivatives,
-                      forward_propagation->current_forget_activations);
-
-        multiply_rows(back_propagation->input_combinations_biases_derivatives,
-                      forward_propagation->current_state_activations);
-
-        back_propagation->cell_state_biases_derivatives += back_propagation->input_combinations_biases_derivatives;
-
-        multiply_rows(back_propagation->state_combinations_biases_derivatives,
-                      forward_propagation->current_input_activations);
+        // Hidden states
 
-        back_propagation->cell_state_biases_derivatives += back_propagation->state_combinations_biases_derivatives;
+        calculate_fused_activations(false,
+                                    cell_states_data,
+                                    cell_states_activations_data,
+                                    switch_train ? cell_states_activations_derivatives_data : nullptr,
+                                    states_size);
 
-        multiply_rows(back_propagation->forget_combinations_biases_derivatives,
-                      forward_propagation->current_forget_activations_derivatives*forward_propagation->previous_cell_state_activations);
+        const Map<const Array<type, Dynamic, Dynamic>> cell_states_activations(cell_states_activations_data, sequences_number, neurons_number);
 
-        back_propagation->cell_state_biases_derivatives += back_propagation->forget_combinations_biases_derivatives;
-
-        back_propagation->hidden_states_biases_derivatives = back_propagation->cell_state_biases_derivatives;
-
-        multiply_rows(back_propagation->hidden_states_biases_derivatives,
-                      forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
-
-        multiply_rows(back_propagation->output_combinations_biases_derivatives,
-                      calculate_activations(forward_propagation->current_cell_state_activations));
-
-        back_propagation->hidden_states_biases_derivatives += back_propagation->output_combinations_biases_derivatives;
-
-        back_propagation->forget_biases_derivatives += back_propagation->hidden_states_biases_derivatives.contract(current_layer_deltas, A_B);
-
-        copy_index += neurons_number;
+        hidden_states_matrix.middleRows(t*sequences_number, sequences_number).array() = output_activations*cell_states_activations;
     }
-}
-
 
-void LongShortTermMemoryLayer::calculate_input_biases_error_gradient(const Tensor<type, 2>& inputs,
-                                                                     LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                     LongShortTermMemoryLayerBackPropagation* back_propagation) const
-{
-    const Index samples_number = inputs.dimension(0);
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = neurons_number;
-
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
-
-    back_propagation->input_combinations_biases_derivatives.setZero();
-    back_propagation->forget_combinations_biases_derivatives.setZero();
-    back_propagation->state_combinations_biases_derivatives.setZero();
-    back_propagation->output_combinations_biases_derivatives.setZero();
+    // Outputs in the order of the batch
 
-    back_propagation->hidden_states_biases_derivatives.setZero();
-    back_propagation->cell_state_biases_derivatives.setZero();
+    TensorMap<Tensor<type, 2>> outputs(forward_propagation->outputs_data, samples_number, neurons_number);
 
-    Tensor<type, 1> previous_cell_state_activations(neurons_number);
+#pragma omp parallel for
 
-    Index copy_index = 0;
-
-    back_propagation->input_biases_derivatives.setZero();
-
-    for(Index sample = 0; sample < samples_number; sample++)
+    for(Index j = 0; j < neurons_number; j++)
     {
-        back_propagation->current_layer_deltas = deltas.chip(sample, 0);
-
-        copy(forward_propagation->forget_activations.data() + copy_index,
-             forward_propagation->forget_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations.data());
-
-        copy(forward_propagation->forget_activations_derivatives.data() + copy_index,
-             forward_propagation->forget_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_forget_activations_derivatives.data());
-
-        copy(forward_propagation->input_activations.data() + copy_index,
-             forward_propagation->input_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations.data());
-
-        copy(forward_propagation->input_activations_derivatives.data() + copy_index,
-             forward_propagation->input_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_input_activations_derivatives.data());
-
-        copy(forward_propagation->state_activations.data() + copy_index,
-             forward_propagation->state_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations.data());
-
-        copy(forward_propagation->state_activations_derivatives.data() + copy_index,
-             forward_propagation->state_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_state_activations_derivatives.data());
-
-        copy(forward_propagation->output_activations.data() + copy_index,
-             forward_propagation->output_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations.data());
-
-        copy(forward_propagation->output_activations_derivatives.data() + copy_index,
-             forward_propagation->output_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_output_activations_derivatives.data());
-
-        copy(forward_propagation->cell_states_activations.data() + copy_index,
-             forward_propagation->cell_states_activations.data() + copy_index + neurons_number,
-             forward_propagation->current_cell_state_activations.data());
-
-        copy(forward_propagation->hidden_states_activations_derivatives.data() + copy_index,
-             forward_propagation->hidden_states_activations_derivatives.data() + copy_index + neurons_number,
-             forward_propagation->current_hidden_states_derivatives.data());
-
-        if(sample%timesteps == 0)
-        {
-            back_propagation->forget_combinations_biases_derivatives.setZero();
-            back_propagation->input_combinations_biases_derivatives.setZero();
-            back_propagation->state_combinations_biases_derivatives.setZero();
-            back_propagation->output_combinations_biases_derivatives.setZero();
-
-            previous_cell_state_activations.setZero();
-            back_propagation->cell_state_biases_derivatives.setZero();
-        }
-        else
+        for(Index i = 0; i < samples_number; i++)
         {
-            copy(forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                 forward_propagation->cell_states_activations.data() + (copy_index-neurons_number) + neurons_number,
-                 previous_cell_state_activations.data());
-
-            back_propagation->forget_combinations_biases_derivatives
-                    = back_propagation->hidden_states_biases_derivatives.contract(forget_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->forget_combinations_biases_derivatives,
-                          forward_propagation->current_forget_activations_derivatives);
-
-            back_propagation->input_combinations_biases_derivatives
-                    = back_propagation->hidden_states_biases_derivatives.contract(input_recurrent_weights, A_B);
-
-            back_propagation->state_combinations_biases_derivatives
-                    = back_propagation->hidden_states_biases_derivatives.contract(state_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->state_combinations_biases_derivatives,
-                          forward_propagation->current_state_activations_derivatives);
-
-            back_propagation->output_combinations_biases_derivatives
-                    = back_propagation->hidden_states_biases_derivatives.contract(output_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->output_combinations_biases_derivatives,
-                          forward_propagation->current_output_activations_derivatives);
+            outputs(i, j) = hidden_states_matrix(i/timesteps + sequences_number*(i%timesteps), j);
         }
-
-        for(Index row = 0; row < parameters_number; row++)
-            back_propagation->input_combinations_biases_derivatives(row, row) += static_cast<type>(1.0);
-
-        multiply_rows(back_propagation->cell_state_biases_derivatives,
-                      forward_propagation->current_forget_activations);
-
-        multiply_rows(back_propagation->forget_combinations_biases_derivatives, previous_cell_state_activations);
-
-        back_propagation->cell_state_biases_derivatives += back_propagation->forget_combinations_biases_derivatives;
-
-        multiply_rows(back_propagation->state_combinations_biases_derivatives,
-                      forward_propagation->current_input_activations);
-
-        back_propagation->cell_state_biases_derivatives += back_propagation->state_combinations_biases_derivatives;
-
-        multiply_rows(back_propagation->input_combinations_biases_derivatives,
-                      forward_propagation->current_input_activations_derivatives*forward_propagation->current_state_activations);
-
-        back_propagation->cell_state_biases_derivatives += back_propagation->input_combinations_biases_derivatives;
-
-        back_propagation->hidden_states_biases_derivatives = back_propagation->cell_state_biases_derivatives;
-
-        multiply_rows(back_propagation->hidden_states_biases_derivatives,
-                      forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
-
-        multiply_rows(back_propagation->output_combinations_biases_derivatives,
-                      calculate_activations(forward_propagation->current_cell_state_activations));
-
-        back_propagation->hidden_states_biases_derivatives += back_propagation->output_combinations_biases_derivatives;
-
-        back_propagation->input_biases_derivatives
-                += back_propagation->hidden_states_biases_derivatives.contract(back_propagation->current_layer_deltas, A_B);
-
-        copy_index += neurons_number;
     }
 }
 
 
-void LongShortTermMemoryLayer::calculate_state_biases_error_gradient(const Tensor<type, 2>& inputs,
-                                                                     LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                     LongShortTermMemoryLayerBackPropagation* back_propagation) const
+void LongShortTermMemoryLayer::insert_gradient(LayerBackPropagation* back_propagation,
+                                               const Index& index,
+                                               Tensor<type, 1>& gradient) const
 {
-    const Index samples_number = inputs.dimension(0);
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = neurons_number;
-
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
-
-    back_propagation->input_combinations_biases_derivatives.setZero();
-    back_propagation->forget_combinations_biases_derivatives.setZero();
-    back_propagation->state_combinations_biases_derivatives.setZero();
-    back_propagation->output_combinations_biases_derivatives.setZero();
-
-    back_propagation->hidden_states_biases_derivatives.setZero();
-    back_propagation->cell_state_biases_derivatives.setZero();
-
-    Index copy_index = 0;
-
-    back_propagation->state_biases_derivatives.setZero();
-
-    for(Index sample = 0; sample < samples_number; sample++)
-    {
-        const Tensor<type, 1> current_layer_deltas = deltas.chip(sample, 0);
-
-        memcpy(forward_propagation->current_forget_activations.data(),
-               forward_propagation->forget_activations.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
-
-        memcpy(forward_propagation->current_forget_activations_derivatives.data(),
-               forward_propagation->forget_activations_derivatives.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
-
-        memcpy(forward_propagation->current_input_activations.data(),
-               forward_propagation->input_activations.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
-
-        memcpy(forward_propagation->current_input_activations_derivatives.data(),
-               forward_propagation->input_activations_derivatives.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
-
-        memcpy(forward_propagation->current_state_activations.data(),
-               forward_propagation->state_activations.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
-
-        memcpy(forward_propagation->current_state_activations_derivatives.data(),
-               forward_propagation->state_activations_derivatives.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
-
-        memcpy(forward_propagation->current_output_activations.data(),
-               forward_propagation->output_activations.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
-
-        memcpy(forward_propagation->current_output_activations_derivatives.data(),
-               forward_propagation->output_activations_derivatives.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
-
-        memcpy(forward_propagation->current_cell_state_activations.data(),
-               forward_propagation->cell_states_activations.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
-
-        memcpy(forward_propagation->current_hidden_states_derivatives.data(),
-               forward_propagation->hidden_states_activations_derivatives.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
-
-        if(sample%timesteps == 0)
-        {
-            back_propagation->forget_combinations_biases_derivatives.setZero();
-            back_propagation->input_combinations_biases_derivatives.setZero();
-            back_propagation->state_combinations_biases_derivatives.setZero();
-            back_propagation->output_combinations_biases_derivatives.setZero();
-
-            forward_propagation->previous_cell_state_activations.setZero();
-            back_propagation->cell_state_biases_derivatives.setZero();
-        }
-        else
-        {
-            memcpy(forward_propagation->previous_cell_state_activations.data(),
-                   forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                   static_cast<size_t>(neurons_number)*sizeof(type));
-
-            back_propagation->forget_combinations_biases_derivatives = back_propagation->hidden_states_biases_derivatives.contract(forget_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->forget_combinations_biases_derivatives,
-                          forward_propagation->current_forget_activations_derivatives);
-
-            back_propagation->input_combinations_biases_derivatives = back_propagation->hidden_states_biases_derivatives.contract(input_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->input_combinations_biases_derivatives,
-                          forward_propagation->current_input_activations_derivatives);
-
-            back_propagation->state_combinations_biases_derivatives = back_propagation->hidden_states_biases_derivatives.contract(state_recurrent_weights, A_B);
-
-            back_propagation->output_combinations_biases_derivatives = back_propagation->hidden_states_biases_derivatives.contract(output_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->output_combinations_biases_derivatives,
-                          forward_propagation->current_output_activations_derivatives);
-        }
+    LongShortTermMemoryLayerBackPropagation* long_short_term_memory_layer_back_propagation =
+            static_cast<LongShortTermMemoryLayerBackPropagation*>(back_propagation);
 
-        for(Index row = 0; row < parameters_number; row++) back_propagation->state_combinations_biases_derivatives(row, row) += static_cast<type>(1.0);
+    const Tensor<type, 1>& biases_derivatives = long_short_term_memory_layer_back_propagation->biases_derivatives;
+    const Tensor<type, 2>& weights_derivatives = long_short_term_memory_layer_back_propagation->weights_derivatives;
+    const Tensor<type, 2>& recurrent_weights_derivatives = long_short_term_memory_layer_back_propagation->recurrent_weights_derivatives;
 
-        multiply_rows(back_propagation->cell_state_biases_derivatives,
-                      forward_propagation->current_forget_activations);
+    // Biases
 
-        multiply_rows(back_propagation->forget_combinations_biases_derivatives, forward_propagation->previous_cell_state_activations);
+    copy(biases_derivatives.data(),
+         biases_derivatives.data() + biases_derivatives.size(),
+         gradient.data() + index);
 
-        back_propagation->cell_state_biases_derivatives += back_propagation->forget_combinations_biases_derivatives;
+    // Weights
 
-        multiply_rows(back_propagation->input_combinations_biases_derivatives,
-                      forward_propagation->current_state_activations);
+    copy(weights_derivatives.data(),
+         weights_derivatives.data() + weights_derivatives.size(),
+         gradient.data() + index + biases_derivatives.size());
 
-        back_propagation->cell_state_biases_derivatives += back_propagation->input_combinations_biases_derivatives;
+    // Recurrent weights
 
-        multiply_rows(back_propagation->state_combinations_biases_derivatives,
-                      forward_propagation->current_state_activations_derivatives*forward_propagation->current_input_activations);
+    copy(recurrent_weights_derivatives.data(),
+         recurrent_weights_derivatives.data() + recurrent_weights_derivatives.size(),
+         gradient.data() + index + biases_derivatives.size() + weights_derivatives.size());
+}
 
-        back_propagation->cell_state_biases_derivatives += back_propagation->state_combinations_biases_derivatives;
 
-        back_propagation->hidden_states_biases_derivatives = back_propagation->cell_state_biases_derivatives;
+/// Calculates the gradient of the error with respect to the parameters of the layer, by back propagation through time.
+/// It goes backwards over the timesteps of all the sequences in the batch at once, with a single matrix product for each timestep.
+/// The gradients of the weights and recurrent weights are then computed with one matrix product over all the timesteps.
+/// The inputs are taken from the forward propagation, where they are ordered by timestep.
 
-        multiply_rows(back_propagation->hidden_states_biases_derivatives,
-                      forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
+void LongShortTermMemoryLayer::calculate_error_gradient(type*,
+                                                        LayerForwardPropagation* forward_propagation,
+                                                        LayerBackPropagation* back_propagation) const
+{
+    LongShortTermMemoryLayerForwardPropagation* long_short_term_memory_layer_forward_propagation =
+            static_cast<LongShortTermMemoryLayerForwardPropagation*>(forward_propagation);
 
-        multiply_rows(back_propagation->output_combinations_biases_derivatives,
-                      calculate_activations(forward_propagation->current_cell_state_activations));
+    LongShortTermMemoryLayerBackPropagation* long_short_term_memory_layer_back_propagation =
+            static_cast<LongShortTermMemoryLayerBackPropagation*>(back_propagation);
 
-        back_propagation->hidden_states_biases_derivatives += back_propagation->output_combinations_biases_derivatives;
+    const Index samples_number = back_propagation->batch_samples_number;
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+    const Index gates_number = 4*neurons_number;
 
-        back_propagation->state_biases_derivatives += back_propagation->hidden_states_biases_derivatives.contract(current_layer_deltas, A_B);
+    const Index sequences_timesteps = long_short_term_memory_layer_forward_propagation->timesteps;
+    const Index sequences_number = long_short_term_memory_layer_forward_propagation->sequences_number;
+    const Index rows_number = sequences_number*sequences_timesteps;
 
-        copy_index += neurons_number;
+    if(long_short_term_memory_layer_back_propagation->gates_deltas.dimension(0) != rows_number)
+    {
+        long_short_term_memory_layer_back_propagation->set_timesteps(sequences_timesteps);
     }
-}
 
+    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, samples_number, neurons_number);
 
-void LongShortTermMemoryLayer::calculate_output_biases_error_gradient(const Tensor<type, 2>& inputs,
-                                                                      LongShortTermMemoryLayerForwardPropagation* forward_propagation,
-                                                                      LongShortTermMemoryLayerBackPropagation* back_propagation) const
-{
-    const Index samples_number = inputs.dimension(0);
-    const Index neurons_number = get_neurons_number();
-    const Index parameters_number = neurons_number;
+    const Map<const Matrix<type, Dynamic, Dynamic>> recurrent_weights_matrix(recurrent_weights.data(), neurons_number, gates_number);
 
-    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
+    Map<Matrix<type, Dynamic, Dynamic>> gates_deltas(long_short_term_memory_layer_back_propagation->gates_deltas.data(), rows_number, gates_number);
 
-    back_propagation->input_combinations_biases_derivatives.setZero();
-    back_propagation->forget_combinations_biases_derivatives.setZero();
-    back_propagation->state_combinations_biases_derivatives.setZero();
-    back_propagation->output_combinations_biases_derivatives.setZero();
-    back_propagation->hidden_states_biases_derivatives.setZero();
-    back_propagation->cell_state_biases_derivatives.setZero();
+    Map<Array<type, Dynamic, Dynamic>> hidden_states_deltas(long_short_term_memory_layer_back_propagation->hidden_states_deltas.data(), sequences_number, neurons_number);
+    Map<Array<type, Dynamic, Dynamic>> cell_states_deltas(long_short_term_memory_layer_back_propagation->cell_states_deltas.data(), sequences_number, neurons_number);
 
-    Index copy_index = 0;
+    hidden_states_deltas.setZero();
+    cell_states_deltas.setZero();
 
-    back_propagation->output_biases_derivatives.setZero();
+    const Index gates_size = sequences_number*gates_number;
+    const Index states_size = sequences_number*neurons_number;
 
-    for(Index sample = 0; sample < samples_number; sample++)
+    for(Index t = sequences_timesteps - 1; t >= 0; t--)
     {
-        back_propagation->current_layer_deltas = deltas.chip(sample, 0);
+        // Deltas of the hidden states: those of the outputs plus those coming from the next timestep
 
-        memcpy(forward_propagation->current_forget_activations.data(),
-               forward_propagation->forget_activations.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
+        for(Index j = 0; j < neurons_number; j++)
+        {
+            for(Index s = 0; s < sequences_number; s++)
+            {
+                const Index sample_index = s*sequences_timesteps + t;
 
-        memcpy(forward_propagation->current_forget_activations_derivatives.data(),
-               forward_propagation->forget_activations_derivatives.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
+                if(sample_index < samples_number) hidden_states_deltas(s, j) += deltas(sample_index, j);
+            }
+        }
 
-        memcpy(forward_propagation->current_input_activations.data(),
-               forward_propagation->input_activations.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
+        const type* gates_activations_data = long_short_term_memory_layer_forward_propagation->gates_activations.data() + t*gates_size;
+        const type* gates_activations_derivatives_data = long_short_term_memory_layer_forward_propagation->gates_activations_derivatives.data() + t*gates_size;
 
-        memcpy(forward_propagation->current_input_activations_derivatives.data(),
-               forward_propagation->input_activations_derivatives.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
+        const Map<const Array<type, Dynamic, Dynamic>> forget_activations(gates_activations_data, sequences_number, neurons_number);
+        const Map<const Array<type, Dynamic, Dynamic>> input_activations(gates_activations_data + states_size, sequences_number, neurons_number);
+        const Map<const Array<type, Dynamic, Dynamic>> state_activations(gates_activations_data + 2*states_size, sequences_number, neurons_number);
+        const Map<const Array<type, Dynamic, Dynamic>> output_activations(gates_activations_data + 3*states_size, sequences_number, neurons_number);
 
-        memcpy(forward_propagation->current_state_activations.data(),
-               forward_propagation->state_activations.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
+        const Map<const Array<type, Dynamic, Dynamic>> forget_activations_derivatives(gates_activations_derivatives_data, sequences_number, neurons_number);
+        const Map<const Array<type, Dynamic, Dynamic>> input_activations_derivatives(gates_activations_derivatives_data + states_size, sequences_number, neurons_number);
+        const Map<const Array<type, Dynamic, Dynamic>> state_activations_derivatives(gates_activations_derivatives_data + 2*states_size, sequences_number, neurons_number);
+        const Map<const Array<type, Dynamic, Dynamic>> output_activations_derivatives(gates_activations_derivatives_data + 3*states_size, sequences_number, neurons_number);
 
-        memcpy(forward_propagation->current_state_activations_derivatives.data(),
-               forward_propagation->state_activations_derivatives.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
+        const Map<const Array<type, Dynamic, Dynamic>> cell_states_activations(long_short_term_memory_layer_forward_propagation->cell_states_activations.data() + t*states_size, sequences_number, neurons_number);
+        const Map<const Array<type, Dynamic, Dynamic>> cell_states_activations_derivatives(long_short_term_memory_layer_forward_propagation->cell_states_activations_derivatives.data() + t*states_size, sequences_number, neurons_number);
 
-        memcpy(forward_propagation->current_output_activations.data(),
-               forward_propagation->output_activations.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
+        auto timestep_deltas = gates_deltas.middleRows(t*sequences_number, sequences_number);
 
-        memcpy(forward_propagation->current_output_activations_derivatives.data(),
-               forward_propagation->output_activations_derivatives.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
+        // Deltas of the cell states, plus those coming from the next timestep
 
-        memcpy(forward_propagation->current_cell_state_activations.data(),
-               forward_propagation->cell_states_activations.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
+        cell_states_deltas += hidden_states_deltas*output_activations*cell_states_activations_derivatives;
 
-        memcpy(forward_propagation->current_hidden_states_derivatives.data(),
-               forward_propagation->hidden_states_activations_derivatives.data()+copy_index,
-               static_cast<size_t>(neurons_number)*sizeof(type));
+        // Deltas of the gates combinations
 
-        if(sample%timesteps == 0)
+        if(t == 0)
         {
-            back_propagation->forget_combinations_biases_derivatives.setZero();
-            back_propagation->input_combinations_biases_derivatives.setZero();
-            back_propagation->state_combinations_biases_derivatives.setZero();
-            back_propagation->output_combinations_biases_derivatives.setZero();
-
-            forward_propagation->previous_cell_state_activations.setZero();
-            back_propagation->cell_state_biases_derivatives.setZero();
+            timestep_deltas.leftCols(neurons_number).setZero();
         }
         else
         {
-            memcpy(forward_propagation->previous_cell_state_activations.data(),
-                   forward_propagation->cell_states_activations.data() + (copy_index-neurons_number),
-                   static_cast<size_t>(neurons_number)*sizeof(type));
-
-            back_propagation->forget_combinations_biases_derivatives = back_propagation->hidden_states_biases_derivatives.contract(forget_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->forget_combinations_biases_derivatives,
-                          forward_propagation->current_forget_activations_derivatives);
+            const Map<const Array<type, Dynamic, Dynamic>> previous_cell_states(long_short_term_memory_layer_forward_propagation->cell_states.data() + (t-1)*states_size, sequences_number, neurons_number);
 
-            back_propagation->input_combinations_biases_derivatives = back_propagation->hidden_states_biases_derivatives.contract(input_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->input_combinations_biases_derivatives,
-                          forward_propagation->current_input_activations_derivatives);
-
-            back_propagation->state_combinations_biases_derivatives = back_propagation->hidden_states_biases_derivatives.contract(state_recurrent_weights, A_B);
-
-            multiply_rows(back_propagation->state_combinations_biases_derivatives,
-                          forward_propagation->current_state_activations_derivatives);
-
-            back_propagation->output_combinations_biases_derivatives = back_propagation->hidden_states_biases_derivatives.contract(output_recurrent_weights, A_B);
+            timestep_deltas.leftCols(neurons_number).array() = cell_states_deltas*previous_cell_states*forget_activations_derivatives;
         }
 
-        for(Index row = 0; row < parameters_number; row++) back_propagation->output_combinations_biases_derivatives(row, row) += static_cast<type>(1.0);
+        timestep_deltas.middleCols(neurons_number, neurons_number).array() = cell_states_deltas*state_activations*input_activations_derivatives;
+        timestep_deltas.middleCols(2*neurons_number, neurons_number).array() = cell_states_deltas*input_activations*state_activations_derivatives;
+        timestep_deltas.rightCols(neurons_number).array() = hidden_states_deltas*cell_states_activations*output_activations_derivatives;
 
-        multiply_rows(back_propagation->cell_state_biases_derivatives,
-                      forward_propagation->current_forget_activations);
+        // Deltas for the previous timestep
 
-        multiply_rows(back_propagation->forget_combinations_biases_derivatives, forward_propagation->previous_cell_state_activations);
+        cell_states_deltas *= forget_activations;
 
-        back_propagation->cell_state_biases_derivatives += back_propagation->forget_combinations_biases_derivatives;
-
-        multiply_rows(back_propagation->state_combinations_biases_derivatives,
-                      forward_propagation->current_input_activations);
-
-        back_propagation->cell_state_biases_derivatives += back_propagation->state_combinations_biases_derivatives;
+        if(t != 0) hidden_states_deltas.matrix().noalias() = timestep_deltas*recurrent_weights_matrix.transpose();
+    }
 
-        multiply_rows(back_propagation->input_combinations_biases_derivatives,
-                      forward_propagation->current_state_activations);
+    // Gradients over all the timesteps
 
-        back_propagation->cell_state_biases_derivatives += back_propagation->input_combinations_biases_derivatives;
+    const Map<const Matrix<type, Dynamic, Dynamic>> inputs(long_short_term_memory_layer_forward_propagation->inputs.data(), rows_number, inputs_number);
+    const Map<const Matrix<type, Dynamic, Dynamic>> hidden_states_matrix(long_short_term_memory_layer_forward_propagation->hidden_states.data(), rows_number, neurons_number);
 
-        back_propagation->hidden_states_biases_derivatives = back_propagation->cell_state_biases_derivatives;
+    Map<Matrix<type, Dynamic, 1>> biases_derivatives(long_short_term_memory_layer_back_propagation->biases_derivatives.data(), gates_number);
+    Map<Matrix<type, Dynamic, Dynamic>> weights_derivatives(long_short_term_memory_layer_back_propagation->weights_derivatives.data(), inputs_number, gates_number);
+    Map<Matrix<type, Dynamic, Dynamic>> recurrent_weights_derivatives(long_short_term_memory_layer_back_propagation->recurrent_weights_derivatives.data(), neurons_number, gates_number);
 
-        multiply_rows(back_propagation->hidden_states_biases_derivatives,
-                      forward_propagation->current_output_activations*forward_propagation->current_hidden_states_derivatives);
+    biases_derivatives.noalias() = gates_deltas.colwise().sum().transpose();
 
-        multiply_rows(back_propagation->output_combinations_biases_derivatives,
-                      forward_propagation->current_output_activations_derivatives*calculate_activations(forward_propagation->current_cell_state_activations));
+    weights_derivatives.noalias() = inputs.transpose()*gates_deltas;
 
-        back_propagation->hidden_states_biases_derivatives += back_propagation->output_combinations_biases_derivatives;
+    // The hidden states of each timestep multiply the gates deltas of the next one
 
-        back_propagation->output_biases_derivatives += back_propagation->hidden_states_biases_derivatives.contract(back_propagation->current_layer_deltas, A_B);
+    const Index previous_rows_number = rows_number - sequences_number;
 
-        copy_index += neurons_number;
-    }
+    recurrent_weights_derivatives.noalias() = hidden_states_matrix.topRows(previous_rows_number).transpose()*gates_deltas.bottomRows(previous_rows_number);
 }
 
 
@@ -4081,6 +2109,21 @@ string LongShortTermMemoryLayer::write_expression(const Tensor<string, 1>& input
 
 #endif
 
+    const Tensor<type, 1> forget_biases = get_forget_biases();
+    const Tensor<type, 1> input_biases = get_input_biases();
+    const Tensor<type, 1> state_biases = get_state_biases();
+    const Tensor<type, 1> output_biases = get_output_biases();
+
+    const Tensor<type, 2> forget_weights = get_forget_weights();
+    const Tensor<type, 2> input_weights = get_input_weights();
+    const Tensor<type, 2> state_weights = get_state_weights();
+    const Tensor<type, 2> output_weights = get_output_weights();
+
+    const Tensor<type, 2> forget_recurrent_weights = get_forget_recurrent_weights();
+    const Tensor<type, 2> input_recurrent_weights = get_input_recurrent_weights();
+    const Tensor<type, 2> state_recurrent_weights = get_state_recurrent_weights();
+    const Tensor<type, 2> output_recurrent_weights = get_output_recurrent_weights();
+
     ostringstream buffer;
 
         // Forget gate
@@ -4329,6 +2372,15 @@ void LongShortTermMemoryLayer::from_XML(const tinyxml2::XMLDocument& document)
 
 
 void LongShortTermMemoryLayer::write_XML(tinyxml2::XMLPrinter& file_stream) const
+{
+    write_XML(file_stream, true);
+}
+
+
+/// Serializes the long short-term memory layer, leaving the parameters element empty if the parameters are written apart.
+/// @param write_parameters True to write the values of the parameters, false otherwise.
+
+void LongShortTermMemoryLayer::write_XML(tinyxml2::XMLPrinter& file_stream, const bool& write_parameters) const
 {
     ostringstream buffer;
 
@@ -4397,19 +2449,22 @@ void LongShortTermMemoryLayer::write_XML(tinyxml2::XMLPrinter& file_stream) cons
 
     file_stream.OpenElement("Parameters");
 
-    buffer.str("");
+    if(write_parameters)
+    {
+        buffer.str("");
 
-    const Tensor<type, 1> parameters = get_parameters();
-    const Index parameters_size = parameters.size();
+        const Tensor<type, 1> parameters = get_parameters();
+        const Index parameters_size = parameters.size();
 
-    for(Index i = 0; i < parameters_size; i++)
-    {
-        buffer << parameters(i);
+        for(Index i = 0; i < parameters_size; i++)
+        {
+            buffer << parameters(i);
 
-        if(i != (parameters_size-1)) buffer << " ";
-    }
+            if(i != (parameters_size-1)) buffer << " ";
+        }
 
-    file_stream.PushText(buffer.str().c_str());
+        file_stream.PushText(buffer.str().c_str());
+    }
 
     file_stream.CloseElement();
 
@@ -199,6 +199,14 @@ public:
                                           type*, const Tensor<Index, 1>&,
                                           type*, const Tensor<Index, 1>&);
 
+   // Fused gates
+
+   FusedActivation get_fused_activation(const ActivationFunction&) const;
+
+   void calculate_fused_activations(const bool&, type*, type*, type*, const Index&);
+
+   void calculate_gates_activations(type*, type*, type*, const Index&);
+
    // Long short-term memory layer outputs
 
 //   void calculate_outputs(type*, const Tensor<Index, 1>&, type*, const Tensor<Index, 1>&) final;
@@ -221,60 +229,16 @@ public:
 
    void forward_propagate(type*, const Tensor<Index, 1>&, Tensor<type, 1>&, LayerForwardPropagation*) final;
 
+   void forward_propagate_sequences(const type*, const Index&,
+                                    const type*, const type*, const type*,
+                                    LongShortTermMemoryLayerForwardPropagation*, const bool&);
+
    // Eror gradient
 
    void insert_gradient(LayerBackPropagation*, const Index& , Tensor<type, 1>&) const final;
 
    void calculate_error_gradient(type*, LayerForwardPropagation*, LayerBackPropagation*) const final;
 
-   void calculate_forget_weights_error_gradient(const Tensor<type, 2>&,
-                                                LongShortTermMemoryLayerForwardPropagation*,
-                                                LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_input_weights_error_gradient(const Tensor<type, 2>&,
-                                               LongShortTermMemoryLayerForwardPropagation*,
-                                               LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_state_weights_error_gradient(const Tensor<type, 2>&,
-                                               LongShortTermMemoryLayerForwardPropagation*,
-                                               LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_output_weights_error_gradient(const Tensor<type, 2>&,
-                                                LongShortTermMemoryLayerForwardPropagation*,
-                                                LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_forget_recurrent_weights_error_gradient(const Tensor<type, 2>&,
-                                                          LongShortTermMemoryLayerForwardPropagation*,
-                                                          LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_input_recurrent_weights_error_gradient(const Tensor<type, 2>&,
-                                                         LongShortTermMemoryLayerForwardPropagation*,
-                                                         LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_state_recurrent_weights_error_gradient(const Tensor<type, 2>&,
-                                                         LongShortTermMemoryLayerForwardPropagation*,
-                                                         LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_output_recurrent_weights_error_gradient(const Tensor<type, 2>&,
-                                                          LongShortTermMemoryLayerForwardPropagation*,
-                                                          LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_forget_biases_error_gradient(const Tensor<type, 2>&,
-                                               LongShortTermMemoryLayerForwardPropagation*,
-                                               LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_input_biases_error_gradient(const Tensor<type, 2>&,
-                                              LongShortTermMemoryLayerForwardPropagation*,
-                                              LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_state_biases_error_gradient(const Tensor<type, 2>&,
-                                              LongShortTermMemoryLayerForwardPropagation*,
-                                              LongShortTermMemoryLayerBackPropagation*) const;
-
-   void calculate_output_biases_error_gradient(const Tensor<type, 2>&,
-                                               LongShortTermMemoryLayerForwardPropagation*,
-                                               LongShortTermMemoryLayerBackPropagation*) const;
-
    // Expression methods
 
    string write_expression(const Tensor<string, 1>&, const Tensor<string, 1>&) const final;
@@ -286,25 +250,24 @@ public:
    void from_XML(const tinyxml2::XMLDocument&) final;
 
    void write_XML(tinyxml2::XMLPrinter&) const final;
+   void write_XML(tinyxml2::XMLPrinter&, const bool&) const final;
 
 protected:
 
    Index timesteps = 3;
 
-   Tensor<type, 1> input_biases;
-   Tensor<type, 1> forget_biases;
-   Tensor<type, 1> state_biases;
-   Tensor<type, 1> output_biases;
+   /// Biases of the forget, input, state and output gates, in this order.
+
+   Tensor<type, 1> biases;
+
+   /// Weights of the four gates, packed in one matrix with as many rows as inputs.
+   /// The columns of the forget, input, state and output gates follow each other.
+
+   Tensor<type, 2> weights;
 
-   Tensor<type, 2> input_weights;
-   Tensor<type, 2> forget_weights;
-   Tensor<type, 2> state_weights;
-   Tensor<type, 2> output_weights;
+   /// Recurrent weights of the four gates, packed in one matrix with as many rows as neurons.
 
-   Tensor<type, 2> forget_recurrent_weights;
-   Tensor<type, 2> input_recurrent_weights;
-   Tensor<type, 2> state_recurrent_weights;
-   Tensor<type, 2> output_recurrent_weights;
+   Tensor<type, 2> recurrent_weights;
 
    /// Activation function variable.
 
@@ -345,7 +308,6 @@ struct LongShortTermMemoryLayerForwardPropagation : LayerForwardPropagation
     {
         layer_pointer = new_layer_pointer;
 
-        const Index inputs_number = layer_pointer->get_inputs_number();
         const Index neurons_number = layer_pointer->get_neurons_number();
 
         batch_samples_number = new_batch_samples_number;
@@ -361,103 +323,81 @@ struct LongShortTermMemoryLayerForwardPropagation : LayerForwardPropagation
 
         // Rest of quantities
 
-        previous_hidden_state_activations.resize(neurons_number);
-        previous_cell_state_activations.resize(neurons_number);
+        set_timesteps(static_cast<LongShortTermMemoryLayer*>(layer_pointer)->get_timesteps());
+    }
+
 
-        current_inputs.resize(inputs_number);
+    /// Sizes the quantities of the sequences in the batch.
+    /// The batch holds consecutive sequences of timesteps samples, and the last one can be shorter.
+    /// The quantities of the sequences are ordered by timestep, so that row s + sequences_number*t holds timestep t of sequence s.
+    /// @param new_timesteps Number of timesteps of each sequence.
 
-        current_forget_combinations.resize(neurons_number);
-        current_input_combinations.resize(neurons_number);
-        current_state_combinations.resize(neurons_number);
-        current_output_combinations.resize(neurons_number);
+    void set_timesteps(const Index& new_timesteps)
+    {
+        const Index inputs_number = layer_pointer->get_inputs_number();
+        const Index neurons_number = layer_pointer->get_neurons_number();
 
-        current_forget_activations.resize(neurons_number);
-        current_input_activations.resize(neurons_number);
-        current_state_activations.resize(neurons_number);
-        current_output_activations.resize(neurons_number);
+        timesteps = new_timesteps;
 
-        current_cell_state_activations.resize(neurons_number);
+        sequences_number = (batch_samples_number + timesteps - 1)/timesteps;
 
-        current_forget_activations_derivatives.resize(neurons_number);
-        current_input_activations_derivatives.resize(neurons_number);
-        current_state_activations_derivatives.resize(neurons_number);
-        current_output_activations_derivatives.resize(neurons_number);
-        current_hidden_states_derivatives.resize(neurons_number);
+        const Index rows_number = sequences_number*timesteps;
 
-        forget_activations.resize(batch_samples_number, neurons_number);
-        input_activations.resize(batch_samples_number, neurons_number);
-        state_activations.resize(batch_samples_number, neurons_number);
-        output_activations.resize(batch_samples_number, neurons_number);
-        cell_states_activations.resize(batch_samples_number, neurons_number);
-        hidden_states_activations.resize(batch_samples_number, neurons_number);
+        inputs.resize(rows_number, inputs_number);
+        inputs_combinations.resize(rows_number, 4*neurons_number);
 
-        forget_activations_derivatives.resize(batch_samples_number, neurons_number);
-        input_activations_derivatives.resize(batch_samples_number, neurons_number);
-        state_activations_derivatives.resize(batch_samples_number, neurons_number);
-        output_activations_derivatives.resize(batch_samples_number, neurons_number);
-        cell_states_activations_derivatives.resize(batch_samples_number, neurons_number);
-        hidden_states_activations_derivatives.resize(batch_samples_number, neurons_number);
+        gates_combinations.resize(sequences_number, 4*neurons_number);
 
-        combinations.resize(batch_samples_number, neurons_number);
+        gates_activations.resize(sequences_number, 4*neurons_number, timesteps);
+        gates_activations_derivatives.resize(sequences_number, 4*neurons_number, timesteps);
+
+        cell_states.resize(sequences_number, neurons_number, timesteps);
+        cell_states_activations.resize(sequences_number, neurons_number, timesteps);
+        cell_states_activations_derivatives.resize(sequences_number, neurons_number, timesteps);
+
+        hidden_states.resize(rows_number, neurons_number);
     }
 
+
     void print() const
     {
-        cout << "Combinations: " << endl;
-        cout << combinations << endl;
+        cout << "Gates activations: " << endl;
+        cout << gates_activations << endl;
 
-        cout << "Current inputs: " << endl;
-        cout << current_inputs << endl;
+        cout << "Cell states: " << endl;
+        cout << cell_states << endl;
 
-        cout << "Current input combinations: " << endl;
-        cout << current_input_combinations << endl;
+        cout << "Hidden states: " << endl;
+        cout << hidden_states << endl;
+     }
 
-        cout << "Current input activations: " << endl;
-        cout << current_input_activations << endl;
+    Index timesteps = 0;
+    Index sequences_number = 0;
 
-        cout << "Current input activations derivatives: " << endl;
-        cout << current_input_activations_derivatives << endl;
-     }
+    /// Inputs of the batch, ordered by timestep.
 
-    Tensor<type, 2> combinations;
+    Tensor<type, 2> inputs;
 
-    Tensor<type, 1> previous_hidden_state_activations;
-    Tensor<type, 1> previous_cell_state_activations;
+    /// Inputs times weights plus biases of the four gates, for all the timesteps.
 
-    Tensor<type, 1> current_inputs;
+    Tensor<type, 2> inputs_combinations;
 
-    Tensor<type, 1> current_forget_combinations;
-    Tensor<type, 1> current_input_combinations;
-    Tensor<type, 1> current_state_combinations;
-    Tensor<type, 1> current_output_combinations;
+    /// Combinations of the four gates in the current timestep.
 
-    Tensor<type, 1> current_forget_activations;
-    Tensor<type, 1> current_input_activations;
-    Tensor<type, 1> current_state_activations;
-    Tensor<type, 1> current_output_activations;
+    Tensor<type, 2> gates_combinations;
 
-    Tensor<type, 1> current_forget_activations_derivatives;
-    Tensor<type, 1> current_input_activations_derivatives;
-    Tensor<type, 1> current_state_activations_derivatives;
-    Tensor<type, 1> current_output_activations_derivatives;
+    /// Activations of the forget, input, state and output gates, with a block of sequences by gates for each timestep.
 
-    Tensor<type, 1> current_hidden_states_derivatives;
+    Tensor<type, 3> gates_activations;
+    Tensor<type, 3> gates_activations_derivatives;
 
-    Tensor<type, 1> current_cell_state_activations;
+    Tensor<type, 3> cell_states;
+    Tensor<type, 3> cell_states_activations;
+    Tensor<type, 3> cell_states_activations_derivatives;
 
-    Tensor<type, 2, RowMajor> forget_activations;
-    Tensor<type, 2, RowMajor> input_activations;
-    Tensor<type, 2, RowMajor> state_activations;
-    Tensor<type, 2, RowMajor> output_activations;
-    Tensor<type, 2, RowMajor> cell_states_activations;
-    Tensor<type, 2, RowMajor> hidden_states_activations;
+    /// Hidden states, ordered by timestep as the inputs.
 
-    Tensor<type, 2, RowMajor> forget_activations_derivatives;
-    Tensor<type, 2, RowMajor> input_activations_derivatives;
-    Tensor<type, 2, RowMajor> state_activations_derivatives;
-    Tensor<type, 2, RowMajor> output_activations_derivatives;
-    Tensor<type, 2, RowMajor> cell_states_activations_derivatives;
-    Tensor<type, 2, RowMajor> hidden_states_activations_derivatives;
+    Tensor<type, 2> hidden_states;
 };
 
 
@@ -490,141 +430,59 @@ struct LongShortTermMemoryLayerBackPropagation : LayerBackPropagation
         //delete deltas_data;
         deltas_data = (type*)malloc(static_cast<size_t>(batch_samples_number*neurons_number*sizeof(type)));
 
-        current_layer_deltas.resize(neurons_number);
-
-        forget_weights_derivatives.resize(inputs_number*neurons_number);
-        input_weights_derivatives.resize(inputs_number*neurons_number);
-        state_weights_derivatives.resize(inputs_number*neurons_number);
-        output_weights_derivatives.resize(inputs_number*neurons_number);
-
-        forget_recurrent_weights_derivatives.resize(neurons_number*neurons_number);
-        input_recurrent_weights_derivatives.resize(neurons_number*neurons_number);
-        state_recurrent_weights_derivatives.resize(neurons_number*neurons_number);
-        output_recurrent_weights_derivatives.resize(neurons_number*neurons_number);
+        biases_derivatives.resize(4*neurons_number);
+        weights_derivatives.resize(inputs_number, 4*neurons_number);
+        recurrent_weights_derivatives.resize(neurons_number, 4*neurons_number);
 
-        forget_biases_derivatives.resize(neurons_number);
-        input_biases_derivatives.resize(neurons_number);
-        state_biases_derivatives.resize(neurons_number);
-        output_biases_derivatives.resize(neurons_number);
+        set_timesteps(static_cast<LongShortTermMemoryLayer*>(layer_pointer)->get_timesteps());
+    }
 
-        input_combinations_biases_derivatives.resize(neurons_number, neurons_number);
-        forget_combinations_biases_derivatives.resize(neurons_number, neurons_number);
-        state_combinations_biases_derivatives.resize(neurons_number, neurons_number);
-        output_combinations_biases_derivatives.resize(neurons_number, neurons_number);
 
-        hidden_states_biases_derivatives.resize(neurons_number, neurons_number);
-        cell_state_biases_derivatives.resize(neurons_number, neurons_number);
+    /// Sizes the deltas of the sequences in the batch, which are ordered by timestep as in the forward propagation.
+    /// @param new_timesteps Number of timesteps of each sequence.
 
-        input_combinations_weights_derivatives.resize(inputs_number*neurons_number, neurons_number);
-        forget_combinations_weights_derivatives.resize(inputs_number*neurons_number, neurons_number);
-        state_combinations_weights_derivatives.resize(inputs_number*neurons_number, neurons_number);
-        output_combinations_weights_derivatives.resize(inputs_number*neurons_number, neurons_number);
+    void set_timesteps(const Index& new_timesteps)
+    {
+        const Index neurons_number = layer_pointer->get_neurons_number();
 
-        hidden_states_weights_derivatives.resize(inputs_number*neurons_number, neurons_number);
-        cell_state_weights_derivatives.resize(inputs_number*neurons_number, neurons_number);
+        const Index sequences_number = (batch_samples_number + new_timesteps - 1)/new_timesteps;
 
-        input_combinations_recurrent_weights_derivatives.resize(neurons_number*neurons_number, neurons_number);
-        forget_combinations_recurrent_weights_derivatives.resize(neurons_number*neurons_number, neurons_number);
-        state_combinations_recurrent_weights_derivatives.resize(neurons_number*neurons_number, neurons_number);
-        output_combinations_recurrent_weights_derivatives.resize(neurons_number*neurons_number, neurons_number);
+        gates_deltas.resize(sequences_number*new_timesteps, 4*neurons_number);
 
-        hidden_states_recurrent_weights_derivatives.resize(neurons_number*neurons_number, neurons_number);
-        cell_state_recurrent_weights_derivatives.resize(neurons_number*neurons_number, neurons_number);
+        hidden_states_deltas.resize(sequences_number, neurons_number);
+        cell_states_deltas.resize(sequences_number, neurons_number);
     }
 
+
     void print() const
     {
     }
 
     Tensor< TensorMap< Tensor<type, 1> >*, 1> get_layer_gradient()
     {
-        Tensor< TensorMap< Tensor<type, 1> >*, 1> layer_gradient(30);
-
-        layer_gradient(0) = new TensorMap<Tensor<type, 1>>(input_biases_derivatives.data(), input_biases_derivatives.size());
-        layer_gradient(1) = new TensorMap<Tensor<type, 1>>(forget_biases_derivatives.data(), forget_biases_derivatives.size());
-        layer_gradient(2) = new TensorMap<Tensor<type, 1>>(state_biases_derivatives.data(), state_biases_derivatives.size());
-        layer_gradient(3) = new TensorMap<Tensor<type, 1>>(output_biases_derivatives.data(), output_biases_derivatives.size());
-
-        layer_gradient(4) = new TensorMap<Tensor<type, 1>>(input_weights_derivatives.data(), input_weights_derivatives.size());
-        layer_gradient(5) = new TensorMap<Tensor<type, 1>>(forget_weights_derivatives.data(), forget_weights_derivatives.size());
-        layer_gradient(6) = new TensorMap<Tensor<type, 1>>(state_weights_derivatives.data(), state_weights_derivatives.size());
-        layer_gradient(7) = new TensorMap<Tensor<type, 1>>(output_weights_derivatives.data(), output_weights_derivatives.size());
+        Tensor< TensorMap< Tensor<type, 1> >*, 1> layer_gradient(3);
 
-        layer_gradient(8) = new TensorMap<Tensor<type, 1>>(input_recurrent_weights_derivatives.data(), input_recurrent_weights_derivatives.size());
-        layer_gradient(9) = new TensorMap<Tensor<type, 1>>(forget_recurrent_weights_derivatives.data(), forget_recurrent_weights_derivatives.size());
-        layer_gradient(10) = new TensorMap<Tensor<type, 1>>(state_recurrent_weights_derivatives.data(), state_recurrent_weights_derivatives.size());
-        layer_gradient(11) = new TensorMap<Tensor<type, 1>>(output_recurrent_weights_derivatives.data(), output_recurrent_weights_derivatives.size());
-
-        layer_gradient(12) = new TensorMap<Tensor<type, 1>>(input_combinations_biases_derivatives.data(), input_combinations_biases_derivatives.size());
-        layer_gradient(13) = new TensorMap<Tensor<type, 1>>(forget_combinations_biases_derivatives.data(), forget_combinations_biases_derivatives.size());
-        layer_gradient(14) = new TensorMap<Tensor<type, 1>>(state_combinations_biases_derivatives.data(), state_combinations_biases_derivatives.size());
-        layer_gradient(15) = new TensorMap<Tensor<type, 1>>(output_combinations_biases_derivatives.data(), output_combinations_biases_derivatives.size());
-
-        layer_gradient(16) = new TensorMap<Tensor<type, 1>>(hidden_states_biases_derivatives.data(), hidden_states_biases_derivatives.size());
-        layer_gradient(17) = new TensorMap<Tensor<type, 1>>(cell_state_biases_derivatives.data(), cell_state_biases_derivatives.size());
-
-        layer_gradient(18) = new TensorMap<Tensor<type, 1>>(input_combinations_weights_derivatives.data(), input_combinations_weights_derivatives.size());
-        layer_gradient(19) = new TensorMap<Tensor<type, 1>>(forget_combinations_weights_derivatives.data(), forget_combinations_weights_derivatives.size());
-        layer_gradient(20) = new TensorMap<Tensor<type, 1>>(state_combinations_weights_derivatives.data(), state_combinations_weights_derivatives.size());
-        layer_gradient(21) = new TensorMap<Tensor<type, 1>>(output_combinations_weights_derivatives.data(), output_combinations_weights_derivatives.size());
-
-        layer_gradient(22) = new TensorMap<Tensor<type, 1>>(hidden_states_weights_derivatives.data(), hidden_states_weights_derivatives.size());
-        layer_gradient(23) = new TensorMap<Tensor<type, 1>>(cell_state_weights_derivatives.data(), cell_state_weights_derivatives.size());
-
-        layer_gradient(24) = new TensorMap<Tensor<type, 1>>(input_combinations_recurrent_weights_derivatives.data(), input_combinations_recurrent_weights_derivatives.size());
-        layer_gradient(25) = new TensorMap<Tensor<type, 1>>(forget_combinations_recurrent_weights_derivatives.data(), forget_combinations_recurrent_weights_derivatives.size());
-        layer_gradient(26) = new TensorMap<Tensor<type, 1>>(state_combinations_recurrent_weights_derivatives.data(), state_combinations_recurrent_weights_derivatives.size());
-        layer_gradient(27) = new TensorMap<Tensor<type, 1>>(output_combinations_recurrent_weights_derivatives.data(), output_combinations_recurrent_weights_derivatives.size());
-
-        layer_gradient(28) = new TensorMap<Tensor<type, 1>>(hidden_states_recurrent_weights_derivatives.data(), hidden_states_recurrent_weights_derivatives.size());
-        layer_gradient(29) = new TensorMap<Tensor<type, 1>>(cell_state_recurrent_weights_derivatives.data(), cell_state_recurrent_weights_derivatives.size());
+        layer_gradient(0) = new TensorMap<Tensor<type, 1>>(biases_derivatives.data(), biases_derivatives.size());
+        layer_gradient(1) = new TensorMap<Tensor<type, 1>>(weights_derivatives.data(), weights_derivatives.size());
+        layer_gradient(2) = new TensorMap<Tensor<type, 1>>(recurrent_weights_derivatives.data(), recurrent_weights_derivatives.size());
 
         return layer_gradient;
     }
 
-    Tensor<type, 1> current_layer_deltas;
+    Tensor<type, 1> biases_derivatives;
+    Tensor<type, 2> weights_derivatives;
+    Tensor<type, 2> recurrent_weights_derivatives;
 
-    Tensor<type, 1> forget_weights_derivatives;
-    Tensor<type, 1> input_weights_derivatives;
-    Tensor<type, 1> state_weights_derivatives;
-    Tensor<type, 1> output_weights_derivatives;
+    /// Deltas of the combinations of the four gates, for all the timesteps.
 
-    Tensor<type, 1> forget_recurrent_weights_derivatives;
-    Tensor<type, 1> input_recurrent_weights_derivatives;
-    Tensor<type, 1> state_recurrent_weights_derivatives;
-    Tensor<type, 1> output_recurrent_weights_derivatives;
+    Tensor<type, 2> gates_deltas;
 
-    Tensor<type, 1> forget_biases_derivatives;
-    Tensor<type, 1> input_biases_derivatives;
-    Tensor<type, 1> state_biases_derivatives;
-    Tensor<type, 1> output_biases_derivatives;
+    /// Deltas of the hidden states and the cell states in the current timestep.
 
-    Tensor<type, 2> input_combinations_biases_derivatives;
-    Tensor<type, 2> forget_combinations_biases_derivatives;
-    Tensor<type, 2> state_combinations_biases_derivatives;
-    Tensor<type, 2> output_combinations_biases_derivatives;
-
-    Tensor<type, 2> hidden_states_biases_derivatives;
-    Tensor<type, 2> cell_state_biases_derivatives;
-
-    Tensor<type, 2> input_combinations_weights_derivatives;
-    Tensor<type, 2> forget_combinations_weights_derivatives;
-    Tensor<type, 2> state_combinations_weights_derivatives;
-    Tensor<type, 2> output_combinations_weights_derivatives;
-
-    Tensor<type, 2> hidden_states_weights_derivatives;
-    Tensor<type, 2> cell_state_weights_derivatives;
-
-    Tensor<type, 2> input_combinations_recurrent_weights_derivatives;
-    Tensor<type, 2> forget_combinations_recurrent_weights_derivatives;
-    Tensor<type, 2> state_combinations_recurrent_weights_derivatives;
-    Tensor<type, 2> output_combinations_recurrent_weights_derivatives;
-
-    Tensor<type, 2> hidden_states_recurrent_weights_derivatives;
-    Tensor<type, 2> cell_state_recurrent_weights_derivatives;
+    Tensor<type, 2> hidden_states_deltas;
+    Tensor<type, 2> cell_states_deltas;
 };
 
-
 }
 
 #endif
@@ -40,7 +40,6 @@ LossIndex::LossIndex(NeuralNetwork* new_neural_network_pointer, DataSet* new_dat
 
 LossIndex::~LossIndex()
 {
-    delete thread_pool;
     delete thread_pool_device;
 }
 
@@ -172,11 +171,9 @@ void LossIndex::set(const LossIndex& other_error_term)
 
 void LossIndex::set_threads_number(const int& new_threads_number)
 {
-    if(thread_pool != nullptr) delete this->thread_pool;
     if(thread_pool_device != nullptr) delete this->thread_pool_device;
 
-    thread_pool = new ThreadPool(new_threads_number);
-    thread_pool_device = new ThreadPoolDevice(thread_pool, new_threads_number);
+    thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device(new_threads_number);
 }
 
 
@@ -201,13 +198,9 @@ void LossIndex::set_data_set_pointer(DataSet* new_data_set_pointer)
 
 void LossIndex::set_default()
 {
-    delete thread_pool;
     delete thread_pool_device;
 
-    const int n = omp_get_max_threads();
-
-    thread_pool = new ThreadPool(n);
-    thread_pool_device = new ThreadPoolDevice(thread_pool, n);
+    thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device();
 
     regularization_method = RegularizationMethod::L2;
 }
@@ -399,6 +392,10 @@ void LossIndex::back_propagate(const DataSetBatch& batch,
 
     calculate_layers_error_gradient(batch, forward_propagation, back_propagation);
 
+    // Assemble gradient
+
+    assemble_layers_error_gradient(back_propagation);
+
     // Loss
 
     back_propagation.loss = back_propagation.error;
@@ -407,20 +404,141 @@ void LossIndex::back_propagate(const DataSetBatch& batch,
 
     if(regularization_method != RegularizationMethod::NoRegularization)
     {
-        const type regularization = calculate_regularization(back_propagation.parameters);
+        const Tensor<type, 1>& parameters = neural_network_pointer->has_parameters_arena()
+                ? neural_network_pointer->get_parameters_arena()
+                : back_propagation.parameters;
+
+        const type regularization = calculate_regularization(parameters);
 
         back_propagation.regularization = regularization;
 
         back_propagation.loss += regularization_weight * regularization;
 
-        calculate_regularization_gradient(back_propagation.parameters, back_propagation.regularization_gradient);
+        calculate_regularization_gradient(parameters, back_propagation.regularization_gradient);
 
         back_propagation.gradient.device(*thread_pool_device) += regularization_weight * back_propagation.regularization_gradient;
     }
+}
 
-    // Assemble gradient
 
-    assemble_layers_error_gradient(back_propagation);
+/// Back-propagates the shards of a batch concurrently and reduces them into the back-propagation of the whole batch.
+/// Each shard is forward propagated, and its error and gradient are scaled by its weight.
+/// The shards are then added in pairs with strides 1, 2, 4..., always in the same order.
+/// The regularization is added once, at the parameters of the whole batch back-propagation.
+/// @param sharded_back_propagation Shards of the batch, with their own buffers.
+/// @param back_propagation Back-propagation of the whole batch, which receives the error, loss and gradient.
+
+void LossIndex::back_propagate(LossIndexShardedBackPropagation& sharded_back_propagation,
+                               LossIndexBackPropagation& back_propagation) const
+{
+    const Index shards_number = sharded_back_propagation.get_shards_number();
+
+    vector<exception_ptr> exceptions(static_cast<size_t>(shards_number), nullptr);
+
+    #pragma omp parallel for schedule(dynamic)
+
+    for(Index i = 0; i < shards_number; i++)
+    {
+        try
+        {
+            const DataSetBatch& batch = *sharded_back_propagation.batches(i);
+
+            NeuralNetworkForwardPropagation& forward_propagation = *sharded_back_propagation.forward_propagations(i);
+
+            LossIndexBackPropagation& shard_back_propagation = *sharded_back_propagation.back_propagations(i);
+
+            bool switch_train = true;
+
+            neural_network_pointer->forward_propagate(batch, forward_propagation, switch_train);
+
+            calculate_errors(batch, forward_propagation, shard_back_propagation);
+
+            calculate_error(batch, forward_propagation, shard_back_propagation);
+
+            calculate_layers_delta(batch, forward_propagation, shard_back_propagation);
+
+            calculate_layers_error_gradient(batch, forward_propagation, shard_back_propagation);
+
+            assemble_layers_error_gradient(shard_back_propagation);
+
+            const type shard_weight = sharded_back_propagation.shards_weights(i);
+
+            shard_back_propagation.error *= shard_weight;
+
+            shard_back_propagation.gradient = shard_back_propagation.gradient*shard_weight;
+        }
+        catch(...)
+        {
+            exceptions[static_cast<size_t>(i)] = current_exception();
+        }
+    }
+
+    for(Index i = 0; i < shards_number; i++)
+    {
+        if(exceptions[static_cast<size_t>(i)] != nullptr) rethrow_exception(exceptions[static_cast<size_t>(i)]);
+    }
+
+    // Tree reduction
+
+    for(Index stride = 1; stride < shards_number; stride *= 2)
+    {
+        #pragma omp parallel for
+
+        for(Index i = 0; i < shards_number - stride; i += 2*stride)
+        {
+            LossIndexBackPropagation& left_back_propagation = *sharded_back_propagation.back_propagations(i);
+            const LossIndexBackPropagation& right_back_propagation = *sharded_back_propagation.back_propagations(i + stride);
+
+            left_back_propagation.error += right_back_propagation.error;
+
+            left_back_propagation.gradient += right_back_propagation.gradient;
+        }
+    }
+
+    const LossIndexBackPropagation& first_back_propagation = *sharded_back_propagation.back_propagations(0);
+
+    back_propagation.error = first_back_propagation.error;
+
+    back_propagation.gradient.device(*thread_pool_device) = first_back_propagation.gradient;
+
+    // Loss
+
+    back_propagation.loss = back_propagation.error;
+
+    // Regularization
+
+    if(regularization_method != RegularizationMethod::NoRegularization)
+    {
+        const Tensor<type, 1>& parameters = neural_network_pointer->has_parameters_arena()
+                ? neural_network_pointer->get_parameters_arena()
+                : back_propagation.parameters;
+
+        const type regularization = calculate_regularization(parameters);
+
+        back_propagation.regularization = regularization;
+
+        back_propagation.loss += regularization_weight * regularization;
+
+        calculate_regularization_gradient(parameters, back_propagation.regularization_gradient);
+
+        back_propagation.gradient.device(*thread_pool_device) += regularization_weight * back_propagation.regularization_gradient;
+    }
+}
+
+
+/// Returns the factor that converts the sum of the errors of a given number of samples into the error term.
+/// Error terms that are sums over the samples implement it, so that a batch can be split into shards
+/// whose errors and gradients are added with weights.
+
+type LossIndex::calculate_error_coefficient(const Index&) const
+{
+    ostringstream buffer;
+
+    buffer << "OpenNN Exception: LossIndex class.\n"
+           << "type calculate_error_coefficient(const Index&) const method.\n"
+           << "Error coefficient is not available for " << get_error_type() << ".\n";
+
+    throw invalid_argument(buffer.str());
 }
 
 
@@ -428,6 +546,17 @@ void LossIndex::back_propagate(const DataSetBatch& batch,
 /// It is used for optimization of parameters during training.
 /// Returns a second-order terms loss structure, which contains the values and the Hessian of the error terms function.
 
+/// Returns the factor that converts a sum of squared errors over a given number of samples into the error term.
+/// The gradient and the hessian of the error are twice this factor times the Jacobian products.
+/// It allows the Levenberg-Marquardt algorithm to accumulate those products over chunks of samples.
+/// It is the same coefficient as that of calculate_error_coefficient().
+
+type LossIndex::calculate_error_coefficient_lm(const Index& samples_number) const
+{
+    return calculate_error_coefficient(samples_number);
+}
+
+
 void LossIndex::back_propagate_lm(const DataSetBatch& batch,
                                   NeuralNetworkForwardPropagation& forward_propagation,
                                   LossIndexBackPropagationLM& loss_index_back_propagation_lm) const
@@ -801,9 +930,18 @@ void LossIndex::calculate_layers_error_gradient(const DataSetBatch& batch,
     const Tensor<Index, 1> trainable_layers_parameters_number
             = neural_network_pointer->get_trainable_layers_parameters_numbers();
 
-    trainable_layers_pointers(0)->calculate_error_gradient(batch.inputs_data,
-                                                           forward_propagation.layers(first_trainable_layers_index),
-                                                           back_propagation.neural_network.layers(0));
+    if(batch.sparse_inputs)
+    {
+        static_cast<PerceptronLayer*>(trainable_layers_pointers(0))->calculate_error_gradient(batch.inputs_sparse,
+                                                                                             forward_propagation.layers(first_trainable_layers_index),
+                                                                                             back_propagation.neural_network.layers(0));
+    }
+    else
+    {
+        trainable_layers_pointers(0)->calculate_error_gradient(batch.inputs_data,
+                                                               forward_propagation.layers(first_trainable_layers_index),
+                                                               back_propagation.neural_network.layers(0));
+    }
 
     for(Index i = 1; i < trainable_layers_number; i++)
     {
@@ -1016,6 +1154,143 @@ LossIndexBackPropagation::~LossIndexBackPropagation()
 }
 
 
+/// Splits a batch into a number of shards and allocates the buffers of each shard.
+/// The shards have contiguous samples, and their sizes differ in one sample at most.
+/// The batches of the shards are filled here, so they must be set again if the data set changes.
+/// Neural networks with recurrent, long short-term memory or batch normalization layers cannot be sharded,
+/// because those layers depend on the whole batch or keep their states.
+/// @param new_shards_number Number of shards. It is reduced to the number of samples if it is greater.
+/// @param samples_indices Indices of the samples in the batch.
+/// @param new_loss_index_pointer Loss index whose error term is added over the samples.
+
+void LossIndexShardedBackPropagation::set(const Index& new_shards_number,
+                                          const Tensor<Index, 1>& samples_indices,
+                                          LossIndex* new_loss_index_pointer)
+{
+    clear();
+
+    loss_index_pointer = new_loss_index_pointer;
+
+    NeuralNetwork* neural_network_pointer = loss_index_pointer->get_neural_network_pointer();
+
+    DataSet* data_set_pointer = loss_index_pointer->get_data_set_pointer();
+
+    batch_samples_number = samples_indices.size();
+
+    if(new_shards_number < 1 || batch_samples_number == 0)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: LossIndexShardedBackPropagation structure.\n"
+               << "void set(const Index&, const Tensor<Index, 1>&, LossIndex*) method.\n"
+               << "Number of shards (" << new_shards_number << ") and number of samples (" << batch_samples_number << ") must be greater than 0.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    bool has_batch_normalization_layer = false;
+
+    const Tensor<Layer*, 1> layers_pointers = neural_network_pointer->get_layers_pointers();
+
+    for(Index i = 0; i < layers_pointers.size(); i++)
+    {
+        if(layers_pointers(i)->get_type() == Layer::Type::BatchNormalization) has_batch_normalization_layer = true;
+    }
+
+    if(neural_network_pointer->has_recurrent_layer()
+    || neural_network_pointer->has_long_short_term_memory_layer()
+    || has_batch_normalization_layer)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: LossIndexShardedBackPropagation structure.\n"
+               << "void set(const Index&, const Tensor<Index, 1>&, LossIndex*) method.\n"
+               << "Neural network cannot have recurrent, long short-term memory or batch normalization layers.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    const Index shards_number = min(new_shards_number, batch_samples_number);
+
+    const type batch_error_coefficient = loss_index_pointer->calculate_error_coefficient(batch_samples_number);
+
+    const Tensor<Index, 1> input_variables_indices = data_set_pointer->get_input_variables_indices();
+    const Tensor<Index, 1> target_variables_indices = data_set_pointer->get_target_variables_indices();
+
+    batches.resize(shards_number);
+    forward_propagations.resize(shards_number);
+    back_propagations.resize(shards_number);
+    shards_weights.resize(shards_number);
+
+    batches.setConstant(nullptr);
+    forward_propagations.setConstant(nullptr);
+    back_propagations.setConstant(nullptr);
+
+    Index first_sample = 0;
+
+    for(Index i = 0; i < shards_number; i++)
+    {
+        const Index shard_samples_number = batch_samples_number/shards_number + (i < batch_samples_number%shards_number ? 1 : 0);
+
+        Tensor<Index, 1> shard_samples_indices(shard_samples_number);
+
+        copy(samples_indices.data() + first_sample,
+             samples_indices.data() + first_sample + shard_samples_number,
+             shard_samples_indices.data());
+
+        batches(i) = new DataSetBatch(shard_samples_number, data_set_pointer);
+
+        batches(i)->fill(shard_samples_indices, input_variables_indices, target_variables_indices);
+
+        forward_propagations(i) = new NeuralNetworkForwardPropagation(shard_samples_number, neural_network_pointer);
+
+        back_propagations(i) = new LossIndexBackPropagation(shard_samples_number, loss_index_pointer);
+
+        shards_weights(i) = batch_error_coefficient/loss_index_pointer->calculate_error_coefficient(shard_samples_number);
+
+        first_sample += shard_samples_number;
+    }
+}
+
+
+/// Deletes the buffers of all the shards.
+
+void LossIndexShardedBackPropagation::clear()
+{
+    for(Index i = 0; i < batches.size(); i++)
+    {
+        delete batches(i);
+
+        if(forward_propagations(i) != nullptr)
+        {
+            for(Index j = 0; j < forward_propagations(i)->layers.size(); j++)
+            {
+                delete forward_propagations(i)->layers(j);
+            }
+
+            delete forward_propagations(i);
+        }
+
+        if(back_propagations(i) != nullptr)
+        {
+            for(Index j = 0; j < back_propagations(i)->neural_network.layers.size(); j++)
+            {
+                delete back_propagations(i)->neural_network.layers(j);
+            }
+
+            delete back_propagations(i);
+        }
+    }
+
+    batches.resize(0);
+    forward_propagations.resize(0);
+    back_propagations.resize(0);
+    shards_weights.resize(0);
+
+    batch_samples_number = 0;
+}
+
+
 Tensor<type, 1> LossIndex::calculate_numerical_differentiation_gradient()
 {
     const Index samples_number = data_set_pointer->get_training_samples_number();
@@ -21,6 +21,7 @@
 // OpenNN includes
 
 #include "config.h"
+#include "thread_runtime.h"
 
 #include "data_set.h"
 #include "neural_network.h"
@@ -30,6 +31,7 @@ namespace opennn
 
 struct LossIndexBackPropagation;
 struct LossIndexBackPropagationLM;
+struct LossIndexShardedBackPropagation;
 
 /// This abstract class represents the concept of loss index composed of an error term and a regularization term.
 
@@ -185,6 +187,11 @@ public:
                        NeuralNetworkForwardPropagation&,
                        LossIndexBackPropagation&) const;
 
+   void back_propagate(LossIndexShardedBackPropagation&,
+                       LossIndexBackPropagation&) const;
+
+   virtual type calculate_error_coefficient(const Index&) const;
+
    // Back propagation LM
 
    void calculate_errors_lm(const DataSetBatch&,
@@ -217,6 +224,8 @@ public:
    virtual void calculate_error_hessian_lm(const DataSetBatch&,
                                            LossIndexBackPropagationLM&) const {}
 
+   type calculate_error_coefficient_lm(const Index&) const;
+
    void back_propagate_lm(const DataSetBatch&,
                           NeuralNetworkForwardPropagation&,
                           LossIndexBackPropagationLM&) const;
@@ -248,7 +257,6 @@ public:
 
 protected:
 
-   ThreadPool* thread_pool = nullptr;
 
    ThreadPoolDevice* thread_pool_device = nullptr;
 
@@ -331,6 +339,22 @@ struct LossIndexBackPropagation
         gradient.resize(parameters_number);
 
         regularization_gradient.resize(parameters_number);
+
+        // With a parameters arena, the layers also write their derivatives directly into the gradient
+
+        if(neural_network_pointer->has_parameters_arena())
+        {
+            const Tensor<Index, 1> trainable_layers_parameters_numbers = neural_network_pointer->get_trainable_layers_parameters_numbers();
+
+            Index index = 0;
+
+            for(Index i = 0; i < neural_network.layers.size(); i++)
+            {
+                neural_network.layers(i)->bind_gradient(gradient.data() + index);
+
+                index += trainable_layers_parameters_numbers(i);
+            }
+        }
     }
 
 
@@ -375,6 +399,59 @@ struct LossIndexBackPropagation
 };
 
 
+/// This structure splits a batch into shards of contiguous samples, each one with its own batch,
+/// forward propagation and back-propagation buffers.
+/// The shards are back-propagated concurrently, and their errors and gradients are added
+/// with a fixed tree reduction, so that the result does not depend on the threads scheduling.
+
+struct LossIndexShardedBackPropagation
+{
+    /// Default constructor.
+
+    explicit LossIndexShardedBackPropagation() {}
+
+    explicit LossIndexShardedBackPropagation(const Index& new_shards_number,
+                                             const Tensor<Index, 1>& new_samples_indices,
+                                             LossIndex* new_loss_index_pointer)
+    {
+        set(new_shards_number, new_samples_indices, new_loss_index_pointer);
+    }
+
+    /// Destructor.
+
+    virtual ~LossIndexShardedBackPropagation()
+    {
+        clear();
+    }
+
+    LossIndexShardedBackPropagation(const LossIndexShardedBackPropagation&) = delete;
+    LossIndexShardedBackPropagation& operator=(const LossIndexShardedBackPropagation&) = delete;
+
+    void set(const Index&, const Tensor<Index, 1>&, LossIndex*);
+
+    void clear();
+
+    Index get_shards_number() const
+    {
+        return batches.size();
+    }
+
+    Index batch_samples_number = 0;
+
+    LossIndex* loss_index_pointer = nullptr;
+
+    Tensor<DataSetBatch*, 1> batches;
+
+    Tensor<NeuralNetworkForwardPropagation*, 1> forward_propagations;
+
+    Tensor<LossIndexBackPropagation*, 1> back_propagations;
+
+    /// Factors that convert the error and the gradient of each shard into its part of the whole batch error and gradient.
+
+    Tensor<type, 1> shards_weights;
+};
+
+
 /// A loss index composed of several terms, this structure represent the First Order for this function.
 
 /// This structure contains second-order information about the loss function (loss, gradient and Hessian).
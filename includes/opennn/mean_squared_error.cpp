@@ -197,6 +197,15 @@ void MeanSquaredError::calculate_error_hessian_lm(const DataSetBatch& batch,
 }
 
 
+/// Returns the coefficient of the mean squared error for a given number of samples.
+/// @param samples_number Number of samples in the sum of squared errors.
+
+type MeanSquaredError::calculate_error_coefficient(const Index& samples_number) const
+{
+    return type(1)/static_cast<type>(samples_number);
+}
+
+
 /// Returns a string with the name of the mean squared error loss type, "MEAN_SQUARED_ERROR".
 
 string MeanSquaredError::get_error_type() const
@@ -8,9 +8,30 @@
 
 #include "neural_network.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 namespace opennn
 {
 
+/// Signature at the beginning of the binary model files.
+
+static const char binary_model_signature[8] = {'O', 'P', 'E', 'N', 'N', 'N', 'B', 'M'};
+
+/// Version of the binary model format.
+
+static const uint32_t binary_model_version = 1;
+
+/// Size of the fixed header of the binary model files: signature, version, type size,
+/// description size, parameters number and parameters offset.
+
+static const uint64_t binary_model_header_size = 40;
+
+
 /// Default constructor.
 /// It creates an empty neural network object.
 /// It also initializes all pointers in the object to nullptr.
@@ -94,11 +115,17 @@ NeuralNetwork::NeuralNetwork(const Tensor<Layer*, 1>& new_layers_pointers)
 NeuralNetwork::~NeuralNetwork()
 {
     delete_layers();
+
+    delete inference_context;
 }
 
 
 void NeuralNetwork::delete_layers()
 {
+    if(inference_context != nullptr) inference_context->clear();
+
+    parameters_arena.resize(0);
+
     const Index layers_number = get_layers_number();
 
     for(Index i = 0;  i < layers_number; i++)
@@ -342,6 +369,17 @@ bool NeuralNetwork::has_probabilistic_layer() const
 }
 
 
+/// Returns true if the first trainable layer can take sparse inputs, which is the case of the perceptron layer,
+/// and false otherwise.
+
+bool NeuralNetwork::has_sparse_inputs_layer() const
+{
+    if(get_trainable_layers_number() == 0) return false;
+
+    return layers_pointers(get_first_trainable_layer_index())->get_type() == Layer::Type::Perceptron;
+}
+
+
 /// Returns true if the neural network object is empty,
 /// and false otherwise.
 
@@ -735,6 +773,15 @@ const bool& NeuralNetwork::get_display() const
 }
 
 
+/// Returns true if the neural network stores its synaptic weights for inference in half precision (IEEE fp16),
+/// and false if it uses single precision.
+
+const bool& NeuralNetwork::get_half_precision() const
+{
+    return half_precision;
+}
+
+
 /// This method deletes all the pointers in the neural network.
 /// It also sets the rest of the members to their default values.
 
@@ -1105,6 +1152,8 @@ void NeuralNetwork::set_box_plot_maximum(const type& new_box_plot_maximum)
 void NeuralNetwork::set_default()
 {
     display = true;
+
+    half_precision = false;
 }
 
 
@@ -1271,6 +1320,8 @@ Index NeuralNetwork::get_parameters_number() const
 
 Tensor<type, 1> NeuralNetwork::get_parameters() const
 {
+    if(has_parameters_arena()) return parameters_arena;
+
     const Index parameters_number = get_parameters_number();
 
     Tensor<type, 1> parameters(parameters_number);
@@ -1313,6 +1364,75 @@ Tensor<Index, 1> NeuralNetwork::get_trainable_layers_parameters_numbers() const
     return trainable_layers_parameters_number;
 }
 
+
+/// Returns true if all the trainable layers view their parameters in the arena of this neural network.
+/// This stops being true if a layer is resized or the layers are replaced.
+
+bool NeuralNetwork::has_parameters_arena() const
+{
+    if(parameters_arena.size() == 0) return false;
+
+    const Tensor<Layer*, 1> trainable_layers_pointers = get_trainable_layers_pointers();
+
+    Index index = 0;
+
+    for(Index i = 0; i < trainable_layers_pointers.size(); i++)
+    {
+        if(trainable_layers_pointers(i)->get_parameters_data() != parameters_arena.data() + index) return false;
+
+        index += trainable_layers_pointers(i)->get_parameters_number();
+    }
+
+    return index == parameters_arena.size();
+}
+
+
+/// Returns the contiguous vector which the trainable layers view as their parameters.
+/// Writing into it changes the parameters of the neural network without further copies.
+
+Tensor<type, 1>& NeuralNetwork::get_parameters_arena()
+{
+    return parameters_arena;
+}
+
+
+/// Makes all the trainable layers view their parameters in one contiguous vector owned by the neural network,
+/// so that get_parameters and set_parameters do not need to gather and scatter them layer by layer.
+/// The arena is only created if every trainable layer supports it.
+/// @param new_parameters_arena True to create the arena, false to give the layers their own memory back.
+
+void NeuralNetwork::set_parameters_arena(const bool& new_parameters_arena)
+{
+    const Tensor<Layer*, 1> trainable_layers_pointers = get_trainable_layers_pointers();
+
+    const Index trainable_layers_number = trainable_layers_pointers.size();
+
+    for(Index i = 0; i < trainable_layers_number; i++)
+    {
+        trainable_layers_pointers(i)->unbind_parameters();
+    }
+
+    parameters_arena.resize(0);
+
+    if(!new_parameters_arena || trainable_layers_number == 0) return;
+
+    for(Index i = 0; i < trainable_layers_number; i++)
+    {
+        if(!trainable_layers_pointers(i)->can_bind_parameters()) return;
+    }
+
+    parameters_arena.resize(get_parameters_number());
+
+    Index index = 0;
+
+    for(Index i = 0; i < trainable_layers_number; i++)
+    {
+        trainable_layers_pointers(i)->bind_parameters(parameters_arena.data() + index);
+
+        index += trainable_layers_pointers(i)->get_parameters_number();
+    }
+}
+
 BoxPlot NeuralNetwork::get_auto_associative_distances_box_plot() const
 {
     return auto_associative_distances_box_plot;
@@ -1441,6 +1561,27 @@ void NeuralNetwork::set_parameters(Tensor<type, 1>& new_parameters) const
 
 #endif
 
+    // The layers already view these parameters, which have changed in place
+
+    if(new_parameters.data() == parameters_arena.data() && has_parameters_arena())
+    {
+        for(Index i = 0; i < get_layers_number(); i++)
+        {
+            if(layers_pointers(i)->get_type() == Layer::Type::Perceptron)
+            {
+                static_cast<PerceptronLayer*>(layers_pointers(i))->dequantize();
+                static_cast<PerceptronLayer*>(layers_pointers(i))->set_half_precision(false);
+            }
+            else if(layers_pointers(i)->get_type() == Layer::Type::Probabilistic)
+            {
+                static_cast<ProbabilisticLayer*>(layers_pointers(i))->dequantize();
+                static_cast<ProbabilisticLayer*>(layers_pointers(i))->set_half_precision(false);
+            }
+        }
+
+        return;
+    }
+
     const Index trainable_layers_number = get_trainable_layers_number();
 
     const Tensor<Layer*, 1> trainable_layers_pointers = get_trainable_layers_pointers();
@@ -1469,6 +1610,35 @@ void NeuralNetwork::set_display(const bool& new_display)
 }
 
 
+/// Sets the storage precision of the neural network.
+/// In half precision, the perceptron and probabilistic layers compute their outputs in deployment
+/// from a copy of their synaptic weights in IEEE fp16, widened to single precision inside the combinations kernel,
+/// and binary model files store the parameters in fp16, which halves their size.
+/// The single precision parameters are kept as the master copy, so training is not affected,
+/// unless they are released by freeze_for_inference() or by loading a half precision binary model.
+/// Setting the parameters, which training does, drops the half precision copies, as they would be outdated.
+/// The training strategy refreshes them after training;
+/// otherwise, this method must be called again after the parameters change.
+/// @param new_half_precision True for half precision, false for single precision.
+
+void NeuralNetwork::set_half_precision(const bool& new_half_precision)
+{
+    half_precision = new_half_precision;
+
+    for(Index i = 0; i < get_layers_number(); i++)
+    {
+        if(layers_pointers(i)->get_type() == Layer::Type::Perceptron)
+        {
+            static_cast<PerceptronLayer*>(layers_pointers(i))->set_half_precision(half_precision);
+        }
+        else if(layers_pointers(i)->get_type() == Layer::Type::Probabilistic)
+        {
+            static_cast<ProbabilisticLayer*>(layers_pointers(i))->set_half_precision(half_precision);
+        }
+    }
+}
+
+
 void NeuralNetwork::set_distances_box_plot(BoxPlot& new_auto_associative_distances_box_plot)
 {
     auto_associative_distances_box_plot = new_auto_associative_distances_box_plot;
@@ -1741,6 +1911,24 @@ void NeuralNetwork::set_parameters_random() const
 }
 
 
+/// Seeds the random engines of all the layers from a single seed.
+/// Each layer gets its own seed, so that layers do not share random sequences.
+/// Call set_parameters_random() afterwards to draw new initial parameters.
+/// @param new_random_seed Seed for the whole neural network.
+
+void NeuralNetwork::set_random_seed(const unsigned& new_random_seed)
+{
+    mt19937 seeds_engine(new_random_seed);
+
+    const Index layers_number = get_layers_number();
+
+    for(Index i = 0; i < layers_number; i++)
+    {
+        layers_pointers(i)->set_random_seed(static_cast<unsigned>(seeds_engine()));
+    }
+}
+
+
 /// Returns the norm of the vector of parameters.
 
 type NeuralNetwork::calculate_parameters_norm() const
@@ -1794,7 +1982,15 @@ void NeuralNetwork::forward_propagate(const DataSetBatch& batch,
     const Index first_trainable_layer_index = get_first_trainable_layer_index();
     const Index last_trainable_layer_index = get_last_trainable_layer_index();
 
-    layers_pointers(first_trainable_layer_index)->forward_propagate(batch.inputs_data, batch.inputs_dimensions, forward_propagation.layers(first_trainable_layer_index), switch_train);
+    if(batch.sparse_inputs)
+    {
+        static_cast<PerceptronLayer*>(layers_pointers(first_trainable_layer_index))
+                ->forward_propagate(batch.inputs_sparse, forward_propagation.layers(first_trainable_layer_index), switch_train);
+    }
+    else
+    {
+        layers_pointers(first_trainable_layer_index)->forward_propagate(batch.inputs_data, batch.inputs_dimensions, forward_propagation.layers(first_trainable_layer_index), switch_train);
+    }
 
     for(Index i = first_trainable_layer_index + 1; i <= last_trainable_layer_index; i++)
     {
@@ -1893,26 +2089,13 @@ Tensor<type, 2> NeuralNetwork::calculate_outputs(type* inputs_data, Tensor<Index
 
     if(inputs_rank == 2)
     {
-        DataSetBatch data_set_batch;
-
-        Tensor<type, 2> inputs = TensorMap<Tensor<type, 2>>(inputs_data, inputs_dimensions(0), inputs_dimensions(1));
-
-        data_set_batch.set_inputs(inputs);
+        if(get_layers_number() == 0) return Tensor<type, 2>();
 
-        const Index batch_size = inputs.dimension(0);
-
-        NeuralNetworkForwardPropagation neural_network_forward_propagation(batch_size, this);
-
-        forward_propagate_deploy(data_set_batch, neural_network_forward_propagation);
-
-        const Index layers_number = get_layers_number();
+        Tensor<type, 2> outputs(inputs_dimensions(0), get_outputs_number());
 
-        if(layers_number == 0) return Tensor<type, 2>();
+        calculate_outputs(inputs_data, inputs_dimensions, outputs.data(), get_inference_context());
 
-        type* outputs_data = neural_network_forward_propagation.layers(layers_number - 1)->outputs_data;
-        const Tensor<Index, 1> outputs_dimensions = neural_network_forward_propagation.layers(layers_number - 1)->outputs_dimensions;
-
-        return TensorMap<Tensor<type,2>>(outputs_data, outputs_dimensions(0), outputs_dimensions(1));
+        return outputs;
     }
     else
     {
@@ -2098,27 +2281,516 @@ Tensor<type, 2> NeuralNetwork::calculate_outputs(Tensor<type, 2>& inputs)
     }
 */
 
-    DataSetBatch data_set_batch;
+    if(get_layers_number() == 0) return Tensor<type, 2>();
+
+    const Tensor<Index, 1> inputs_dimensions = get_dimensions(inputs);
+
+    Tensor<type, 2> outputs(inputs.dimension(0), get_outputs_number());
+
+    calculate_outputs(inputs.data(), inputs_dimensions, outputs.data(), get_inference_context());
+
+    return outputs;
+}
+
+
+/// Calculates the outputs of the neural network for a batch of inputs, reusing the buffers of an inference context.
+/// No intermediate copies are made: the last layer writes directly into the given outputs buffer.
+/// @param inputs_data Pointer to the inputs, with one row per sample.
+/// @param inputs_dimensions Dimensions of the inputs. Only rank 2 is supported.
+/// @param outputs_data Pointer to a buffer of size samples number times outputs number.
+/// @param context Inference context created for this neural network.
+
+void NeuralNetwork::calculate_outputs(type* inputs_data,
+                                      const Tensor<Index, 1>& inputs_dimensions,
+                                      type* outputs_data,
+                                      NeuralNetworkInferenceContext& context) const
+{
+    if(inputs_dimensions.size() != 2)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void calculate_outputs(type*, const Tensor<Index, 1>&, type*, NeuralNetworkInferenceContext&) const method.\n"
+               << "Inputs rank must be 2.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    if(context.neural_network_pointer != this)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void calculate_outputs(type*, const Tensor<Index, 1>&, type*, NeuralNetworkInferenceContext&) const method.\n"
+               << "Inference context belongs to another neural network.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    const Index layers_number = get_layers_number();
+
+    if(layers_number == 0)
+    {
+        copy(inputs_data, inputs_data + inputs_dimensions(0)*inputs_dimensions(1), outputs_data);
+
+        return;
+    }
+
+    NeuralNetworkForwardPropagation& forward_propagation = context.get_forward_propagation(inputs_dimensions(0));
+
+    DataSetBatch batch;
+
+    batch.inputs_data = inputs_data;
+    batch.inputs_dimensions = inputs_dimensions;
+
+    LayerForwardPropagation* last_layer_forward_propagation = forward_propagation.layers(layers_number - 1);
+
+    // Trailing bounding layers clamp in place the outputs of the layer before them
+
+    Index first_output_layer_index = layers_number - 1;
+
+    while(first_output_layer_index > 0 && layers_pointers(first_output_layer_index)->get_type() == Layer::Type::Bounding)
+    {
+        first_output_layer_index--;
+    }
+
+    const Layer::Type first_output_layer_type = layers_pointers(first_output_layer_index)->get_type();
+
+    // Layers whose outputs live in an owned tensor do not write through outputs_data
+
+    if(first_output_layer_type == Layer::Type::Flatten
+    || first_output_layer_type == Layer::Type::Convolutional
+    || first_output_layer_type == Layer::Type::Pooling)
+    {
+        forward_propagate_deploy(batch, forward_propagation);
+
+        const Tensor<Index, 0> outputs_size = last_layer_forward_propagation->outputs_dimensions.prod();
+
+        copy(last_layer_forward_propagation->outputs_data,
+             last_layer_forward_propagation->outputs_data + outputs_size(0),
+             outputs_data);
+
+        return;
+    }
+
+    const Index output_layers_number = layers_number - first_output_layer_index;
+
+    Tensor<type*, 1> buffers_outputs_data(output_layers_number);
+
+    for(Index i = 0; i < output_layers_number; i++)
+    {
+        buffers_outputs_data(i) = forward_propagation.layers(first_output_layer_index + i)->outputs_data;
+
+        forward_propagation.layers(first_output_layer_index + i)->outputs_data = outputs_data;
+    }
+
+    try
+    {
+        forward_propagate_deploy(batch, forward_propagation);
+    }
+    catch(...)
+    {
+        for(Index i = 0; i < output_layers_number; i++)
+        {
+            forward_propagation.layers(first_output_layer_index + i)->outputs_data = buffers_outputs_data(i);
+        }
+
+        throw;
+    }
+
+    for(Index i = 0; i < output_layers_number; i++)
+    {
+        forward_propagation.layers(first_output_layer_index + i)->outputs_data = buffers_outputs_data(i);
+    }
+}
+
+
+/// Returns the inference context used by calculate_outputs.
+/// It is created the first time it is needed and lives as long as the neural network.
+
+NeuralNetworkInferenceContext& NeuralNetwork::get_inference_context()
+{
+    if(inference_context == nullptr)
+    {
+        inference_context = new NeuralNetworkInferenceContext(this);
+    }
+
+    return *inference_context;
+}
+
+
+/// Folds an affine transformation of the inputs of a perceptron or probabilistic layer into its parameters.
+/// The layer then gives for the raw inputs the same combinations as before for the transformed inputs.
+/// @param layer_pointer Pointer to the layer.
+/// @param slopes Slope of the transformation of each input.
+/// @param intercepts Intercept of the transformation of each input.
+
+template<class T>
+static void fold_inputs_transformation(T* layer_pointer, const Tensor<type, 1>& slopes, const Tensor<type, 1>& intercepts)
+{
+    Tensor<type, 2> synaptic_weights = layer_pointer->get_synaptic_weights();
+    Tensor<type, 2> biases = layer_pointer->get_biases();
+
+    const Index inputs_number = synaptic_weights.dimension(0);
+    const Index neurons_number = synaptic_weights.dimension(1);
+
+    for(Index j = 0; j < neurons_number; j++)
+    {
+        for(Index i = 0; i < inputs_number; i++)
+        {
+            biases.data()[j] += intercepts(i)*synaptic_weights(i,j);
+
+            synaptic_weights(i,j) *= slopes(i);
+        }
+    }
+
+    layer_pointer->set_synaptic_weights(synaptic_weights);
+    layer_pointer->set_biases(biases);
+}
+
+
+/// Prepares the neural network for deployment by removing the layers that only apply fixed affine transformations.
+/// An affine scaling layer at the beginning is folded into the synaptic weights and biases of the next
+/// perceptron or probabilistic layer.
+/// An affine unscaling layer after a linear perceptron layer is folded into the parameters of that layer.
+/// A remaining bounding layer clamps the outputs in place in calculate_outputs.
+/// The outputs of the neural network do not change, but the layers and parameters do,
+/// so this should be called only when training is finished.
+/// Layers that cannot be folded, such as logarithmic scalers, are kept.
+/// In half precision, the single precision synaptic weights are then released.
+
+void NeuralNetwork::freeze_for_inference()
+{
+    // The folding needs the single precision synaptic weights, which might have been released by a previous call
+
+    for(Index i = 0; i < get_layers_number(); i++)
+    {
+        if(layers_pointers(i)->get_type() == Layer::Type::Perceptron)
+        {
+            static_cast<PerceptronLayer*>(layers_pointers(i))->restore_synaptic_weights();
+        }
+        else if(layers_pointers(i)->get_type() == Layer::Type::Probabilistic)
+        {
+            static_cast<ProbabilisticLayer*>(layers_pointers(i))->restore_synaptic_weights();
+        }
+    }
+
+    fold_affine_layers();
+
+    if(half_precision)
+    {
+        set_half_precision(true);
+
+        release_synaptic_weights();
+    }
+}
+
+
+/// Releases the single precision synaptic weights of the perceptron and probabilistic layers in half precision,
+/// which then only keep the half precision copies, for neural networks which are only used for inference.
+/// This halves the memory of the synaptic weights.
+/// They are restored from the half precision copies when they are needed again, for instance by training.
+
+void NeuralNetwork::release_synaptic_weights()
+{
+    for(Index i = 0; i < get_layers_number(); i++)
+    {
+        if(layers_pointers(i)->get_type() == Layer::Type::Perceptron)
+        {
+            static_cast<PerceptronLayer*>(layers_pointers(i))->release_synaptic_weights();
+        }
+        else if(layers_pointers(i)->get_type() == Layer::Type::Probabilistic)
+        {
+            static_cast<ProbabilisticLayer*>(layers_pointers(i))->release_synaptic_weights();
+        }
+    }
+}
+
+
+/// Folds the affine scaling and unscaling layers into the next and previous perceptron or probabilistic layers,
+/// and removes them. See freeze_for_inference().
 
-    data_set_batch.set_inputs(inputs);
+void NeuralNetwork::fold_affine_layers()
+{
+    if(get_layers_number() < 2) return;
+
+    Tensor<type, 1> slopes;
+    Tensor<type, 1> intercepts;
 
-    const Index batch_size = inputs.dimension(0);
+    Tensor<bool, 1> folded_layers(get_layers_number());
+    folded_layers.setConstant(false);
 
-    NeuralNetworkForwardPropagation neural_network_forward_propagation(batch_size, this);
+    // Scaling layer
+
+    if(layers_pointers(0)->get_type() == Layer::Type::Scaling)
+    {
+        const ScalingLayer* scaling_layer_pointer = static_cast<ScalingLayer*>(layers_pointers(0));
 
-    forward_propagate_deploy(data_set_batch, neural_network_forward_propagation);
+        const Layer::Type next_layer_type = layers_pointers(1)->get_type();
+
+        if(scaling_layer_pointer->is_affine()
+        && (next_layer_type == Layer::Type::Perceptron || next_layer_type == Layer::Type::Probabilistic))
+        {
+            scaling_layer_pointer->get_affine_coefficients(slopes, intercepts);
+
+            if(next_layer_type == Layer::Type::Perceptron)
+            {
+                fold_inputs_transformation(static_cast<PerceptronLayer*>(layers_pointers(1)), slopes, intercepts);
+            }
+            else
+            {
+                fold_inputs_transformation(static_cast<ProbabilisticLayer*>(layers_pointers(1)), slopes, intercepts);
+            }
+
+            folded_layers(0) = true;
+        }
+    }
+
+    // Unscaling layer
+
+    for(Index i = 1; i < get_layers_number(); i++)
+    {
+        if(layers_pointers(i)->get_type() != Layer::Type::Unscaling) continue;
+
+        const UnscalingLayer* unscaling_layer_pointer = static_cast<UnscalingLayer*>(layers_pointers(i));
+
+        if(layers_pointers(i-1)->get_type() != Layer::Type::Perceptron || !unscaling_layer_pointer->is_affine()) break;
+
+        PerceptronLayer* perceptron_layer_pointer = static_cast<PerceptronLayer*>(layers_pointers(i-1));
+
+        if(perceptron_layer_pointer->get_activation_function() != PerceptronLayer::ActivationFunction::Linear) break;
+
+        unscaling_layer_pointer->get_affine_coefficients(slopes, intercepts);
+
+        Tensor<type, 2> synaptic_weights = perceptron_layer_pointer->get_synaptic_weights();
+        Tensor<type, 2> biases = perceptron_layer_pointer->get_biases();
+
+        for(Index j = 0; j < synaptic_weights.dimension(1); j++)
+        {
+            synaptic_weights.chip(j, 1) = synaptic_weights.chip(j, 1)*slopes(j);
+
+            biases.data()[j] = slopes(j)*biases.data()[j] + intercepts(j);
+        }
+
+        perceptron_layer_pointer->set_synaptic_weights(synaptic_weights);
+        perceptron_layer_pointer->set_biases(biases);
+
+        folded_layers(i) = true;
+
+        break;
+    }
+
+    // Remove folded layers
+
+    const Tensor<Index, 0> folded_layers_number = folded_layers.cast<Index>().sum();
+
+    if(folded_layers_number(0) == 0) return;
+
+    Tensor<Layer*, 1> new_layers_pointers(get_layers_number() - folded_layers_number(0));
+
+    Index index = 0;
+
+    for(Index i = 0; i < get_layers_number(); i++)
+    {
+        if(folded_layers(i))
+        {
+            delete layers_pointers(i);
+        }
+        else
+        {
+            new_layers_pointers(index) = layers_pointers(i);
+            index++;
+        }
+    }
+
+    if(inference_context != nullptr) inference_context->clear();
+
+    set_layers_pointers(new_layers_pointers);
+}
+
+
+
+/// Quantizes the perceptron and probabilistic layers to 8 bits for inference (post-training quantization).
+/// The synaptic weights are quantized per neuron.
+/// The range of the inputs of each layer is calibrated with a sample of the training samples of the data set.
+/// The accuracy of the quantized neural network is then measured against the floating point one
+/// on the testing samples, or on the selection or training samples if there are no testing samples.
+/// Training and the floating point parameters are not affected, and the quantization is saved with the neural network.
+/// Setting the parameters, which training does, drops the quantization, as it would be outdated.
+/// This should be called when training is finished, and after freeze_for_inference() if that is used.
+/// @param data_set Data set with the calibration and evaluation samples.
+/// @param calibration_samples_number Maximum number of training samples used for calibration.
+
+QuantizationResults NeuralNetwork::quantize(DataSet& data_set, const Index& calibration_samples_number)
+{
+    QuantizationResults quantization_results;
 
     const Index layers_number = get_layers_number();
 
-    if(layers_number == 0) return Tensor<type, 2>();
+    if(layers_number == 0) return quantization_results;
+
+    dequantize();
 
-    type* outputs_data = neural_network_forward_propagation.layers(layers_number - 1)->outputs_data;
-    const Tensor<Index, 1> outputs_dimensions = neural_network_forward_propagation.layers(layers_number - 1)->outputs_dimensions;
+    // Calibration
 
-    return TensorMap<Tensor<type,2>>(outputs_data, outputs_dimensions(0), outputs_dimensions(1));
+    const Tensor<Index, 1> training_samples_indices = data_set.get_training_samples_indices();
+
+    const Index calibration_size = min(calibration_samples_number, training_samples_indices.size());
+
+    if(calibration_size == 0)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "QuantizationResults quantize(DataSet&, const Index&) method.\n"
+               << "Number of calibration samples is zero.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    const Tensor<Index, 1> calibration_samples_indices = training_samples_indices.slice(Eigen::array<Index, 1>({0}),
+                                                                                       Eigen::array<Index, 1>({calibration_size}));
+
+    Tensor<type, 2> calibration_inputs = data_set.get_input_data(calibration_samples_indices);
+
+    DataSetBatch calibration_batch;
+
+    calibration_batch.set_inputs(calibration_inputs);
+
+    NeuralNetworkForwardPropagation forward_propagation(calibration_size, this);
+
+    forward_propagate_deploy(calibration_batch, forward_propagation);
+
+    Tensor<type, 1> inputs_maximums(layers_number);
+    inputs_maximums.setZero();
+
+    for(Index i = 0; i < layers_number; i++)
+    {
+        const Layer::Type layer_type = layers_pointers(i)->get_type();
+
+        if(layer_type != Layer::Type::Perceptron && layer_type != Layer::Type::Probabilistic) continue;
+
+        const type* inputs_data = i == 0 ? calibration_batch.inputs_data : forward_propagation.layers(i-1)->outputs_data;
+
+        const Tensor<Index, 1> inputs_dimensions = i == 0
+                ? calibration_batch.inputs_dimensions
+                : forward_propagation.layers(i-1)->outputs_dimensions;
+
+        const Index inputs_size = inputs_dimensions(0)*inputs_dimensions(1);
+
+        const Tensor<type, 0> maximum = TensorMap<const Tensor<type, 1>>(inputs_data, inputs_size).abs().maximum();
+
+        inputs_maximums(i) = maximum(0);
+    }
+
+    for(Index i = 0; i < layers_number; i++)
+    {
+        delete forward_propagation.layers(i);
+    }
+
+    // Evaluation
+
+    Tensor<Index, 1> evaluation_samples_indices = data_set.get_testing_samples_indices();
+
+    if(evaluation_samples_indices.size() == 0) evaluation_samples_indices = data_set.get_selection_samples_indices();
+
+    if(evaluation_samples_indices.size() == 0) evaluation_samples_indices = calibration_samples_indices;
+
+    Tensor<type, 2> evaluation_inputs = data_set.get_input_data(evaluation_samples_indices);
+
+    const Tensor<type, 2> outputs = calculate_outputs(evaluation_inputs);
+
+    // Quantization
+
+    for(Index i = 0; i < layers_number; i++)
+    {
+        if(layers_pointers(i)->get_type() == Layer::Type::Perceptron)
+        {
+            static_cast<PerceptronLayer*>(layers_pointers(i))->quantize(inputs_maximums(i));
+
+            quantization_results.quantized_layers_number++;
+        }
+        else if(layers_pointers(i)->get_type() == Layer::Type::Probabilistic)
+        {
+            static_cast<ProbabilisticLayer*>(layers_pointers(i))->quantize(inputs_maximums(i));
+
+            quantization_results.quantized_layers_number++;
+        }
+    }
+
+    const Tensor<type, 2> quantized_outputs = calculate_outputs(evaluation_inputs);
+
+    // Accuracy
+
+    const Index evaluation_size = outputs.dimension(0);
+    const Index outputs_number = outputs.dimension(1);
+
+    const Tensor<type, 2> absolute_errors = (quantized_outputs - outputs).abs();
+
+    const Tensor<type, 0> maximum_absolute_error = absolute_errors.maximum();
+    const Tensor<type, 0> mean_absolute_error = absolute_errors.mean();
+
+    quantization_results.calibration_samples_number = calibration_size;
+    quantization_results.evaluation_samples_number = evaluation_size;
+    quantization_results.maximum_absolute_error = maximum_absolute_error(0);
+    quantization_results.mean_absolute_error = mean_absolute_error(0);
+
+    if(has_probabilistic_layer() && evaluation_size > 0)
+    {
+        const type decision_threshold = get_probabilistic_layer_pointer()->get_decision_threshold();
+
+        Index agreements_number = 0;
+
+        for(Index i = 0; i < evaluation_size; i++)
+        {
+            if(outputs_number == 1)
+            {
+                if((outputs(i, 0) >= decision_threshold) == (quantized_outputs(i, 0) >= decision_threshold))
+                {
+                    agreements_number++;
+                }
+
+                continue;
+            }
+
+            Index maximal_index = 0;
+            Index quantized_maximal_index = 0;
+
+            for(Index j = 1; j < outputs_number; j++)
+            {
+                if(outputs(i, j) > outputs(i, maximal_index)) maximal_index = j;
+                if(quantized_outputs(i, j) > quantized_outputs(i, quantized_maximal_index)) quantized_maximal_index = j;
+            }
+
+            if(maximal_index == quantized_maximal_index) agreements_number++;
+        }
+
+        quantization_results.agreement_rate = type(agreements_number)/type(evaluation_size);
+    }
+
+    if(display) quantization_results.print();
+
+    return quantization_results;
 }
 
 
+/// Goes back to floating point inference in all the perceptron and probabilistic layers.
+
+void NeuralNetwork::dequantize()
+{
+    for(Index i = 0; i < get_layers_number(); i++)
+    {
+        if(layers_pointers(i)->get_type() == Layer::Type::Perceptron)
+        {
+            static_cast<PerceptronLayer*>(layers_pointers(i))->dequantize();
+        }
+        else if(layers_pointers(i)->get_type() == Layer::Type::Probabilistic)
+        {
+            static_cast<ProbabilisticLayer*>(layers_pointers(i))->dequantize();
+        }
+    }
+}
+
 Tensor<type, 2> NeuralNetwork::calculate_scaled_outputs(type* scaled_inputs_data, Tensor<Index, 1>& inputs_dimensions)
 {
 
@@ -2564,6 +3236,16 @@ Tensor<string, 2> NeuralNetwork::get_probabilistic_layer_information() const
 /// See the OpenNN manual for more information about the format of this document.
 
 void NeuralNetwork::write_XML(tinyxml2::XMLPrinter& file_stream) const
+{
+    write_XML(file_stream, true);
+}
+
+
+/// Serializes the neural network object into an XML document of the TinyXML library.
+/// The binary model files write the parameters apart, so their description leaves the parameters elements of the layers empty.
+/// @param write_parameters True to write the values of the layers parameters, false otherwise.
+
+void NeuralNetwork::write_XML(tinyxml2::XMLPrinter& file_stream, const bool& write_parameters) const
 {
     ostringstream buffer;
 
@@ -2626,7 +3308,7 @@ void NeuralNetwork::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     for(Index i = 0; i < layers_pointers.size(); i++)
     {
-        layers_pointers[i]->write_XML(file_stream);
+        layers_pointers[i]->write_XML(file_stream, write_parameters);
     }
 
     // Layers (end tag)
@@ -2667,6 +3349,17 @@ void NeuralNetwork::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     file_stream.CloseElement();
 
+    // Half precision
+
+    if(half_precision)
+    {
+        file_stream.OpenElement("HalfPrecision");
+
+        file_stream.PushText("1");
+
+        file_stream.CloseElement();
+    }
+
     // ******************** Distances histogram XML ******************* //
 
     if(get_project_type() == NeuralNetwork::ProjectType::AutoAssociation)
@@ -2921,6 +3614,13 @@ void NeuralNetwork::from_XML(const tinyxml2::XMLDocument& document)
         }
     }
 
+    // Half precision
+    {
+        const tinyxml2::XMLElement* element = root_element->FirstChildElement("HalfPrecision");
+
+        set_half_precision(element && element->GetText() && string(element->GetText()) != "0");
+    }
+
     if(get_project_type() == NeuralNetwork::ProjectType::AutoAssociation)
     {
         {
@@ -3718,6 +4418,22 @@ void NeuralNetwork::save_parameters(const string& file_name) const
 
 void NeuralNetwork::load(const string& file_name)
 {
+    ifstream signature_file(file_name.c_str(), ios::binary);
+
+    char signature[sizeof(binary_model_signature)];
+
+    if(signature_file.read(signature, sizeof(signature))
+    && memcmp(signature, binary_model_signature, sizeof(signature)) == 0)
+    {
+        signature_file.close();
+
+        load_binary(file_name);
+
+        return;
+    }
+
+    signature_file.close();
+
     set_default();
 
     tinyxml2::XMLDocument document;
@@ -3778,6 +4494,300 @@ void NeuralNetwork::load_parameters_binary(const string& file_name)
 }
 
 
+/// Saves the neural network to a binary model file.
+/// The file starts with a fixed header (signature, version, size of the parameters type,
+/// size of the description, number of parameters and offset of the parameters).
+/// The description is the XML of the network without the layers parameters,
+/// so it keeps the architecture, the scalers and the inputs and outputs names.
+/// The raw parameters follow, aligned to 64 bytes, in the order of get_parameters(),
+/// in single precision, or in half precision if the neural network is set to it.
+/// XML is still the interchange format; binary files are meant for fast saving and loading.
+/// @param file_name Name of the binary model file.
+
+void NeuralNetwork::save_binary(const string& file_name) const
+{
+    // The layers leave their parameters elements empty, so the parameters are not written as text
+
+    tinyxml2::XMLPrinter description_printer(nullptr, true);
+
+    write_XML(description_printer, false);
+
+    const Tensor<type, 1> parameters = get_parameters();
+
+    const uint32_t version = binary_model_version;
+    const uint32_t type_size = half_precision ? sizeof(half_float::half) : sizeof(type);
+    const uint64_t description_size = static_cast<uint64_t>(description_printer.CStrSize() - 1);
+    const uint64_t parameters_number = static_cast<uint64_t>(parameters.size());
+    const uint64_t parameters_offset = (binary_model_header_size + description_size + 63)/64*64;
+
+    std::ofstream file(file_name.c_str(), ios::binary);
+
+    if(!file.is_open())
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void save_binary(const string&) const method.\n"
+               << "Cannot open binary model file: " << file_name << "\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    file.write(binary_model_signature, sizeof(binary_model_signature));
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&type_size), sizeof(type_size));
+    file.write(reinterpret_cast<const char*>(&description_size), sizeof(description_size));
+    file.write(reinterpret_cast<const char*>(&parameters_number), sizeof(parameters_number));
+    file.write(reinterpret_cast<const char*>(&parameters_offset), sizeof(parameters_offset));
+
+    file.write(description_printer.CStr(), static_cast<streamsize>(description_size));
+
+    const string padding(static_cast<size_t>(parameters_offset - binary_model_header_size - description_size), '\0');
+
+    file.write(padding.data(), static_cast<streamsize>(padding.size()));
+
+    if(half_precision)
+    {
+        Tensor<half_float::half, 1> half_parameters(parameters.size());
+
+        for(Index i = 0; i < parameters.size(); i++) half_parameters(i) = half_float::half(parameters(i));
+
+        file.write(reinterpret_cast<const char*>(half_parameters.data()), static_cast<streamsize>(parameters_number*type_size));
+    }
+    else
+    {
+        file.write(reinterpret_cast<const char*>(parameters.data()), static_cast<streamsize>(parameters_number*type_size));
+    }
+
+    if(!file)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void save_binary(const string&) const method.\n"
+               << "Cannot write binary model file: " << file_name << "\n";
+
+        throw invalid_argument(buffer.str());
+    }
+}
+
+
+/// Loads the neural network from a binary model file written by save_binary.
+/// The file is memory mapped where the platform supports it,
+/// and the parameters are copied from the mapping straight into the layers.
+/// @param file_name Name of the binary model file.
+
+void NeuralNetwork::load_binary(const string& file_name)
+{
+#if defined(__unix__) || defined(__APPLE__)
+
+    const int file_descriptor = ::open(file_name.c_str(), O_RDONLY);
+
+    struct stat file_status;
+
+    if(file_descriptor < 0 || fstat(file_descriptor, &file_status) != 0 || file_status.st_size == 0)
+    {
+        if(file_descriptor >= 0) ::close(file_descriptor);
+
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void load_binary(const string&) method.\n"
+               << "Cannot open binary model file: " << file_name << "\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    const size_t file_size = static_cast<size_t>(file_status.st_size);
+
+    void* mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+
+    ::close(file_descriptor);
+
+    if(mapping == MAP_FAILED)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void load_binary(const string&) method.\n"
+               << "Cannot map binary model file: " << file_name << "\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    try
+    {
+        from_binary(static_cast<const char*>(mapping), file_size);
+    }
+    catch(...)
+    {
+        ::munmap(mapping, file_size);
+
+        throw;
+    }
+
+    ::munmap(mapping, file_size);
+
+#else
+
+    std::ifstream file(file_name.c_str(), ios::binary | ios::ate);
+
+    if(!file.is_open())
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void load_binary(const string&) method.\n"
+               << "Cannot open binary model file: " << file_name << "\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    const size_t file_size = static_cast<size_t>(file.tellg());
+
+    string file_data(file_size, '\0');
+
+    file.seekg(0);
+    file.read(&file_data[0], static_cast<streamsize>(file_size));
+
+    from_binary(file_data.data(), file_size);
+
+#endif
+}
+
+
+/// Sets the members of the neural network from a binary model held in memory.
+/// @param data Pointer to the beginning of the binary model, as written by save_binary.
+/// @param size Size of the binary model in bytes.
+
+void NeuralNetwork::from_binary(const char* data, const size_t& size)
+{
+    ostringstream buffer;
+
+    if(size < binary_model_header_size || memcmp(data, binary_model_signature, sizeof(binary_model_signature)) != 0)
+    {
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void from_binary(const char*, const size_t&) method.\n"
+               << "Data is not a binary model.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    uint32_t version;
+    uint32_t type_size;
+    uint64_t description_size;
+    uint64_t parameters_number;
+    uint64_t parameters_offset;
+
+    const char* header_data = data + sizeof(binary_model_signature);
+
+    memcpy(&version, header_data, sizeof(version));
+    memcpy(&type_size, header_data + 4, sizeof(type_size));
+    memcpy(&description_size, header_data + 8, sizeof(description_size));
+    memcpy(&parameters_number, header_data + 16, sizeof(parameters_number));
+    memcpy(&parameters_offset, header_data + 24, sizeof(parameters_offset));
+
+    if(version != binary_model_version || (type_size != sizeof(type) && type_size != sizeof(half_float::half)))
+    {
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void from_binary(const char*, const size_t&) method.\n"
+               << "Binary model version (" << version << ") or type size (" << type_size << ") not supported.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    if(description_size > size - binary_model_header_size
+    || parameters_offset < binary_model_header_size + description_size
+    || parameters_offset > size
+    || parameters_number > (size - parameters_offset)/type_size)
+    {
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void from_binary(const char*, const size_t&) method.\n"
+               << "Binary model is truncated.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    tinyxml2::XMLDocument document;
+
+    if(document.Parse(data + binary_model_header_size, static_cast<size_t>(description_size)))
+    {
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void from_binary(const char*, const size_t&) method.\n"
+               << "Cannot parse binary model description.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    set_default();
+
+    from_XML(document);
+
+    if(static_cast<uint64_t>(get_parameters_number()) != parameters_number)
+    {
+        buffer << "OpenNN Exception: NeuralNetwork class.\n"
+               << "void from_binary(const char*, const size_t&) method.\n"
+               << "Number of parameters (" << parameters_number << ") must be equal to "
+               << "number of parameters of the neural network (" << get_parameters_number() << ").\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    // The parameters are copied through the parameters arena, when the layers support it,
+    // so that the layers keep the quantization read from the description
+
+    const bool parameters_arena = has_parameters_arena();
+
+    if(!parameters_arena) set_parameters_arena(true);
+
+    Tensor<type, 1> parameters;
+
+    type* new_parameters_data;
+
+    if(has_parameters_arena())
+    {
+        new_parameters_data = get_parameters_arena().data();
+    }
+    else
+    {
+        parameters.resize(static_cast<Index>(parameters_number));
+
+        new_parameters_data = parameters.data();
+    }
+
+    if(type_size == sizeof(type))
+    {
+        const type* parameters_data = reinterpret_cast<const type*>(data + parameters_offset);
+
+        copy(parameters_data, parameters_data + parameters_number, new_parameters_data);
+    }
+    else
+    {
+        const half_float::half* parameters_data = reinterpret_cast<const half_float::half*>(data + parameters_offset);
+
+        for(uint64_t i = 0; i < parameters_number; i++) new_parameters_data[i] = static_cast<type>(parameters_data[i]);
+    }
+
+    if(!has_parameters_arena())
+    {
+        set_parameters(parameters);
+    }
+    else if(!parameters_arena)
+    {
+        set_parameters_arena(false);
+    }
+
+    if(half_precision)
+    {
+        set_half_precision(true);
+
+        // A binary model stored in half precision is meant for inference, so only the half precision synaptic weights are kept
+
+        if(type_size == sizeof(half_float::half)) release_synaptic_weights();
+    }
+}
+
+
 string NeuralNetwork::write_expression_autoassociation_distances(string& input_variables_names, string& output_variables_names) const
 {
     ostringstream buffer;
@@ -5952,6 +6962,135 @@ Layer* NeuralNetwork::get_last_trainable_layer_pointer() const
     return trainable_layers_pointers(trainable_layers_number-1);
 }
 
+
+/// Sets the neural network of this inference context and releases all its buffers.
+/// @param new_neural_network_pointer Pointer to the neural network.
+
+void NeuralNetworkInferenceContext::set(NeuralNetwork* new_neural_network_pointer)
+{
+    clear();
+
+    neural_network_pointer = new_neural_network_pointer;
+}
+
+
+/// Releases the forward propagation buffers of all batch sizes.
+
+void NeuralNetworkInferenceContext::clear()
+{
+    for(auto& forward_propagation : forward_propagations)
+    {
+        NeuralNetworkForwardPropagation* neural_network_forward_propagation = forward_propagation.second;
+
+        for(Index i = 0; i < neural_network_forward_propagation->layers.size(); i++)
+        {
+            delete neural_network_forward_propagation->layers(i);
+        }
+
+        delete neural_network_forward_propagation;
+    }
+
+    forward_propagations.clear();
+
+    layers_pointers.resize(0);
+    layers_sizes.resize(0);
+}
+
+
+/// Returns the number of batch sizes with allocated buffers.
+
+Index NeuralNetworkInferenceContext::get_batch_sizes_number() const
+{
+    return static_cast<Index>(forward_propagations.size());
+}
+
+
+/// Returns the forward propagation buffers for a batch size, allocating them if needed.
+/// All buffers are released first if the architecture of the neural network has changed.
+/// @param batch_samples_number Number of samples in the batch.
+
+NeuralNetworkForwardPropagation& NeuralNetworkInferenceContext::get_forward_propagation(const Index& batch_samples_number)
+{
+    if(!check_architecture())
+    {
+        clear();
+
+        get_architecture(layers_pointers, layers_sizes);
+    }
+
+    auto iterator = forward_propagations.find(batch_samples_number);
+
+    if(iterator != forward_propagations.end()) return *iterator->second;
+
+    NeuralNetworkForwardPropagation* forward_propagation
+            = new NeuralNetworkForwardPropagation(batch_samples_number, neural_network_pointer);
+
+    forward_propagations[batch_samples_number] = forward_propagation;
+
+    return *forward_propagation;
+}
+
+
+/// Gets the layers of the neural network and the inputs and neurons numbers of those layers that have them.
+
+void NeuralNetworkInferenceContext::get_architecture(Tensor<Layer*, 1>& new_layers_pointers, Tensor<Index, 1>& new_layers_sizes) const
+{
+    new_layers_pointers = neural_network_pointer->get_layers_pointers();
+
+    const Index layers_number = new_layers_pointers.size();
+
+    new_layers_sizes.resize(2*layers_number);
+    new_layers_sizes.setZero();
+
+    for(Index i = 0; i < layers_number; i++)
+    {
+        switch(new_layers_pointers(i)->get_type())
+        {
+        case Layer::Type::Perceptron:
+        case Layer::Type::Probabilistic:
+        case Layer::Type::Recurrent:
+        case Layer::Type::LongShortTermMemory:
+        case Layer::Type::Scaling:
+        case Layer::Type::Unscaling:
+        case Layer::Type::Bounding:
+        {
+            new_layers_sizes(2*i) = new_layers_pointers(i)->get_inputs_number();
+            new_layers_sizes(2*i+1) = new_layers_pointers(i)->get_neurons_number();
+        }
+        break;
+
+        default: break;
+        }
+    }
+}
+
+
+/// Returns true if the buffers were allocated for the current architecture of the neural network.
+
+bool NeuralNetworkInferenceContext::check_architecture() const
+{
+    if(forward_propagations.empty()) return false;
+
+    Tensor<Layer*, 1> current_layers_pointers;
+    Tensor<Index, 1> current_layers_sizes;
+
+    get_architecture(current_layers_pointers, current_layers_sizes);
+
+    if(current_layers_pointers.size() != layers_pointers.size()) return false;
+
+    for(Index i = 0; i < layers_pointers.size(); i++)
+    {
+        if(current_layers_pointers(i) != layers_pointers(i)) return false;
+    }
+
+    for(Index i = 0; i < layers_sizes.size(); i++)
+    {
+        if(current_layers_sizes(i) != layers_sizes(i)) return false;
+    }
+
+    return true;
+}
+
 }
 
 // OpenNN: Open Neural Networks Library.
@@ -17,6 +17,7 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <map>
 #include <errno.h>
 
 // OpenNN includes
@@ -42,6 +43,8 @@ namespace opennn
 {
     struct NeuralNetworkForwardPropagation;
     struct NeuralNetworkBackPropagation;
+    struct NeuralNetworkInferenceContext;
+    struct QuantizationResults;
 
 /// This class represents the concept of neural network in the OpenNN library.
 ///
@@ -91,6 +94,7 @@ public:
    bool has_probabilistic_layer() const;
    bool has_convolutional_layer() const;
    bool has_flatten_layer() const;
+   bool has_sparse_inputs_layer() const;
    bool is_empty() const;
 
    const Tensor<string, 1>& get_inputs_names() const;
@@ -126,6 +130,8 @@ public:
 
    const bool& get_display() const;
 
+   const bool& get_half_precision() const;
+
    // Set methods
 
    void set();
@@ -164,6 +170,8 @@ public:
 
    void set_display(const bool&);
 
+   void set_half_precision(const bool&);
+
    void set_distances_box_plot(BoxPlot&);
    void set_multivariate_distances_box_plot(Tensor<BoxPlot, 1>&);
    void set_variables_distances_names(const Tensor<string, 1>&);
@@ -203,6 +211,14 @@ public:
 
    Tensor<Index, 1> get_trainable_layers_parameters_numbers() const;
 
+   // Parameters arena
+
+   bool has_parameters_arena() const;
+
+   Tensor<type, 1>& get_parameters_arena();
+
+   void set_parameters_arena(const bool&);
+
    // AANN histogram
 
    BoxPlot get_auto_associative_distances_box_plot() const;
@@ -229,6 +245,8 @@ public:
 
    void set_parameters_random() const;
 
+   void set_random_seed(const unsigned&);
+
    // Parameters
 
    type calculate_parameters_norm() const;
@@ -241,6 +259,18 @@ public:
    Tensor<type, 2> calculate_unscaled_outputs(type*, Tensor<Index, 1>&);
    Tensor<type, 2> calculate_outputs(Tensor<type, 2>&);
 
+   void calculate_outputs(type*, const Tensor<Index, 1>&, type*, NeuralNetworkInferenceContext&) const;
+
+   NeuralNetworkInferenceContext& get_inference_context();
+
+   void freeze_for_inference();
+
+   void release_synaptic_weights();
+
+   QuantizationResults quantize(DataSet&, const Index& = 1000);
+
+   void dequantize();
+
    Tensor<type, 2> calculate_scaled_outputs(type*, Tensor<Index, 1>&);
 
    Tensor<type, 2> calculate_multivariate_distances(type* &, Tensor<Index,1>&, type* &, Tensor<Index,1>&);
@@ -271,6 +301,7 @@ public:
    void multivariate_box_plot_from_XML(const tinyxml2::XMLDocument&);
 
    virtual void write_XML(tinyxml2::XMLPrinter&) const;
+   void write_XML(tinyxml2::XMLPrinter&, const bool&) const;
    // virtual void read_XML( );
 
    void print() const;
@@ -280,6 +311,10 @@ public:
    virtual void load(const string&);
    void load_parameters_binary(const string&);
 
+   void save_binary(const string&) const;
+   void load_binary(const string&);
+   void from_binary(const char*, const size_t&);
+
    Tensor<string, 1> get_layers_names() const;
 
    // Expression methods
@@ -313,6 +348,8 @@ public:
 
 protected:
 
+   void fold_affine_layers();
+
    string name = "neural_network";
 
    NeuralNetwork::ProjectType project_type;
@@ -340,6 +377,18 @@ protected:
 
    bool display = true;
 
+   /// Storage of the synaptic weights for inference and of the parameters in binary model files.
+
+   bool half_precision = false;
+
+   /// Contiguous parameters of all trainable layers, when those layers view it.
+
+   Tensor<type, 1> parameters_arena;
+
+   /// Forward propagation buffers reused by calculate_outputs.
+
+   NeuralNetworkInferenceContext* inference_context = nullptr;
+
 #ifdef OPENNN_CUDA
     #include "../../opennn-cuda/opennn-cuda/neural_network_cuda.h"
 #endif
@@ -467,6 +516,109 @@ struct NeuralNetworkForwardPropagation
 };
 
 
+/// This structure keeps the forward propagation buffers of a neural network between inference calls.
+///
+/// Buffers are allocated once per batch size and reused afterwards.
+/// They are released automatically when the architecture of the neural network changes.
+/// A context must not be shared between threads, but several contexts can run on the same neural network.
+
+struct NeuralNetworkInferenceContext
+{
+    /// Default constructor.
+
+    NeuralNetworkInferenceContext() {}
+
+    explicit NeuralNetworkInferenceContext(NeuralNetwork* new_neural_network_pointer)
+    {
+        set(new_neural_network_pointer);
+    }
+
+    /// Destructor.
+
+    virtual ~NeuralNetworkInferenceContext()
+    {
+        clear();
+    }
+
+    NeuralNetworkInferenceContext(const NeuralNetworkInferenceContext&) = delete;
+    NeuralNetworkInferenceContext& operator=(const NeuralNetworkInferenceContext&) = delete;
+
+    void set(NeuralNetwork*);
+
+    void clear();
+
+    Index get_batch_sizes_number() const;
+
+    NeuralNetworkForwardPropagation& get_forward_propagation(const Index&);
+
+    NeuralNetwork* neural_network_pointer = nullptr;
+
+    /// Forward propagation buffers for each batch size.
+
+    map<Index, NeuralNetworkForwardPropagation*> forward_propagations;
+
+    /// Layers and sizes for which the buffers were allocated.
+
+    Tensor<Layer*, 1> layers_pointers;
+
+    Tensor<Index, 1> layers_sizes;
+
+private:
+
+    void get_architecture(Tensor<Layer*, 1>&, Tensor<Index, 1>&) const;
+
+    bool check_architecture() const;
+};
+
+
+/// This structure contains the accuracy of a quantized neural network compared with the floating point one.
+
+struct QuantizationResults
+{
+    /// Default constructor.
+
+    explicit QuantizationResults() {}
+
+    /// Destructor.
+
+    virtual ~QuantizationResults() {}
+
+    void print() const
+    {
+        cout << "Quantization results" << endl;
+        cout << "Quantized layers number: " << quantized_layers_number << endl;
+        cout << "Calibration samples number: " << calibration_samples_number << endl;
+        cout << "Evaluation samples number: " << evaluation_samples_number << endl;
+        cout << "Maximum absolute error: " << maximum_absolute_error << endl;
+        cout << "Mean absolute error: " << mean_absolute_error << endl;
+
+        if(agreement_rate >= type(0))
+        {
+            cout << "Agreement rate: " << agreement_rate << endl;
+        }
+    }
+
+    /// Number of perceptron and probabilistic layers quantized.
+
+    Index quantized_layers_number = 0;
+
+    Index calibration_samples_number = 0;
+
+    Index evaluation_samples_number = 0;
+
+    /// Errors between the quantized and the floating point outputs.
+
+    type maximum_absolute_error = type(0);
+
+    type mean_absolute_error = type(0);
+
+    /// Fraction of samples with the same predicted class.
+    /// It is -1 if the neural network does not have a probabilistic layer.
+
+    type agreement_rate = type(-1);
+};
+
+
 struct NeuralNetworkBackPropagation
 {
     NeuralNetworkBackPropagation() {}
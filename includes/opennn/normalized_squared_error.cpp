@@ -451,6 +451,17 @@ void NormalizedSquaredError::calculate_error_hessian_lm(const DataSetBatch& batc
 }
 
 
+/// Returns the coefficient of the normalized squared error for a given number of samples.
+/// @param samples_number Number of samples in the sum of squared errors.
+
+type NormalizedSquaredError::calculate_error_coefficient(const Index& samples_number) const
+{
+    const Index total_samples_number = data_set_pointer->get_samples_number();
+
+    return type(1)/((static_cast<type>(samples_number)/static_cast<type>(total_samples_number))*normalization_coefficient);
+}
+
+
 /// Returns a string with the name of the normalized squared error loss type, "NORMALIZED_SQUARED_ERROR".
 
 string NormalizedSquaredError::get_error_type() const
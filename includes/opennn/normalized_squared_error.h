@@ -80,6 +80,8 @@ public:
                                NeuralNetworkForwardPropagation&,
                                LossIndexBackPropagation&) const final;
 
+   type calculate_error_coefficient(const Index&) const final;
+
     // Back propagation LM
 
    void calculate_error_lm(const DataSetBatch&,
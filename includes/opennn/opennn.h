@@ -78,6 +78,8 @@
 #include "region_based_object_detector.h"
 #include "json_to_xml.h"
 #include "text_analytics.h"
+#include "thread_runtime.h"
+#include "inference_server.h"
 #include "codification.h"
 
 #endif
@@ -381,6 +381,38 @@ bool is_numeric_string(const string& str)
 }
 
 
+/// Parses a whole string as a floating point number with the locale-independent std::from_chars.
+/// Returns false, leaving the value unchanged, if the string is not entirely a number or is out of range.
+/// Whenever it succeeds, the value is the same as the one returned by strtof.
+/// @param str String to be parsed.
+/// @param value Parsed number.
+
+bool parse_number(const string& str, float& value)
+{
+    const char* last = str.data() + str.size();
+
+    const from_chars_result result = from_chars(str.data(), last, value);
+
+    return result.ec == errc() && result.ptr == last;
+}
+
+
+/// Parses a whole string as a double precision number with the locale-independent std::from_chars.
+/// Returns false, leaving the value unchanged, if the string is not entirely a number or is out of range.
+/// Whenever it succeeds, the value is the same as the one returned by stod.
+/// @param str String to be parsed.
+/// @param value Parsed number.
+
+bool parse_number(const string& str, double& value)
+{
+    const char* last = str.data() + str.size();
+
+    const from_chars_result result = from_chars(str.data(), last, value);
+
+    return result.ec == errc() && result.ptr == last;
+}
+
+
 /// Returns true if given string vector is constant and false otherwise.
 /// @param str vector to be checked.
 ///
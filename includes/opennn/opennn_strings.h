@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <string>
 #include <string_view>
+#include <charconv>
 #include <cctype>
 #include <iomanip>
 
@@ -41,6 +42,8 @@ namespace opennn
     Tensor<Index, 1> count_unique(const Tensor<string,1>&);
 
     bool is_numeric_string(const string&);
+    bool parse_number(const string&, float&);
+    bool parse_number(const string&, double&);
     bool is_date_time_string(const string&);
     bool is_email(const string&);
     bool contains_number(const string&);
@@ -16,9 +16,7 @@ namespace opennn
 
 OptimizationAlgorithm::OptimizationAlgorithm()
 {
-    const int n = omp_get_max_threads();
-    thread_pool = new ThreadPool(n);
-    thread_pool_device = new ThreadPoolDevice(thread_pool, n);
+    thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device();
 
     set_default();
 }
@@ -30,9 +28,7 @@ OptimizationAlgorithm::OptimizationAlgorithm()
 OptimizationAlgorithm::OptimizationAlgorithm(LossIndex* new_loss_index_pointer)
     : loss_index_pointer(new_loss_index_pointer)
 {
-    const int n = omp_get_max_threads();
-    thread_pool = new ThreadPool(n);
-    thread_pool_device = new ThreadPoolDevice(thread_pool, n);
+    thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device();
 
     set_default();
 }
@@ -42,7 +38,6 @@ OptimizationAlgorithm::OptimizationAlgorithm(LossIndex* new_loss_index_pointer)
 
 OptimizationAlgorithm::~OptimizationAlgorithm()
 {
-    delete thread_pool;
     delete thread_pool_device;
 }
 
@@ -149,11 +144,9 @@ void OptimizationAlgorithm::set()
 
 void OptimizationAlgorithm::set_threads_number(const int& new_threads_number)
 {
-    if(thread_pool != nullptr) delete this->thread_pool;
     if(thread_pool_device != nullptr) delete this->thread_pool_device;
 
-    thread_pool = new ThreadPool(new_threads_number);
-    thread_pool_device = new ThreadPoolDevice(thread_pool, new_threads_number);
+    thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device(new_threads_number);
 }
 
 
@@ -236,6 +229,49 @@ void OptimizationAlgorithm::set_neural_network_file_name(const string& new_neura
     neural_network_file_name = new_neural_network_file_name;
 }
 
+
+/// Returns the number of epochs between calls to the evaluation callback.
+
+const Index& OptimizationAlgorithm::get_evaluation_period() const
+{
+    return evaluation_period;
+}
+
+
+/// Returns true if an evaluation callback has been set and will be called during training.
+
+bool OptimizationAlgorithm::has_evaluation_callback() const
+{
+    return evaluation_callback && evaluation_period > 0;
+}
+
+
+/// Sets a function which evaluates the neural network periodically during training.
+/// If the function returns false the training stops with the EvaluationRejection stopping condition,
+/// so that runs which will not meet the expectations do not pay for a full training.
+/// @param new_evaluation_callback Function receiving the current epoch and returning false to reject the run.
+/// @param new_evaluation_period Number of epochs between evaluations. Zero disables the evaluation.
+
+void OptimizationAlgorithm::set_evaluation_callback(const EvaluationCallback& new_evaluation_callback, const Index& new_evaluation_period)
+{
+    evaluation_callback = new_evaluation_callback;
+
+    evaluation_period = new_evaluation_period;
+}
+
+
+/// Returns true if the evaluation callback is due at the given epoch and rejects the training run.
+/// @param epoch Current epoch.
+
+bool OptimizationAlgorithm::check_evaluation_rejection(const Index& epoch) const
+{
+    if(!has_evaluation_callback()) return false;
+
+    if(epoch == 0 || epoch%evaluation_period != 0) return false;
+
+    return !evaluation_callback(epoch);
+}
+
 BoxPlot OptimizationAlgorithm::calculate_distances_box_plot(type* & new_inputs_data, Tensor<Index,1>& inputs_dimensions,
                                                             type* & new_outputs_data, Tensor<Index,1>& outputs_dimensions)
 {
@@ -456,6 +492,9 @@ string TrainingResults::write_stopping_condition() const
     case OptimizationAlgorithm::StoppingCondition::MaximumTime:
         return "Maximum training time";
 
+    case OptimizationAlgorithm::StoppingCondition::EvaluationRejection:
+        return "Evaluation rejection";
+
     default:
         return string();
     }
@@ -23,6 +23,7 @@
 // OpenNN includes
 
 #include "config.h"
+#include "thread_runtime.h"
 #include "tensor_utilities.h"
 #include "loss_index.h"
 
@@ -48,7 +49,12 @@ public:
     /// Enumeration of all possible conditions of stop for the algorithms.
 
     enum class StoppingCondition{MinimumLossDecrease, LossGoal,
-                           MaximumSelectionErrorIncreases, MaximumEpochsNumber, MaximumTime};
+                           MaximumSelectionErrorIncreases, MaximumEpochsNumber, MaximumTime, EvaluationRejection};
+
+    /// Periodic evaluation of the neural network during training.
+    /// It receives the current epoch and returns false to reject the run and stop the training.
+
+    using EvaluationCallback = function<bool(const Index&)>;
 
    // Get methods
 
@@ -70,6 +76,9 @@ public:
 
    const string& get_neural_network_file_name() const;
 
+   const Index& get_evaluation_period() const;
+   bool has_evaluation_callback() const;
+
    /// Writes the time from seconds in format HH:mm:ss.
 
    string write_time(const type&) const;
@@ -91,6 +100,8 @@ public:
    void set_save_period(const Index&);
    void set_neural_network_file_name(const string&);
 
+   void set_evaluation_callback(const EvaluationCallback&, const Index&);
+
    // Calculate distances for AANN histogram
 
    BoxPlot calculate_distances_box_plot(type* &, Tensor<Index,1>&, type* &, Tensor<Index,1>&);
@@ -99,6 +110,8 @@ public:
 
    virtual void check() const;
 
+   bool check_evaluation_rejection(const Index&) const;
+
    /// Trains a neural network which has a loss index associated. 
 
    virtual TrainingResults perform_training() = 0;
@@ -120,7 +133,6 @@ public:
 
 protected:
 
-   ThreadPool* thread_pool = nullptr;
    ThreadPoolDevice* thread_pool_device;
 
    /// Pointer to a loss index for a neural network object.
@@ -153,6 +165,14 @@ protected:
 
    string neural_network_file_name = "neural_network.xml";
 
+   /// Function called every evaluation period to decide whether the training run is worth continuing.
+
+   EvaluationCallback evaluation_callback;
+
+   /// Number of epochs between calls to the evaluation callback. Zero disables the evaluation.
+
+   Index evaluation_period = 0;
+
    /// Display messages to screen.
 
    bool display = true;
@@ -46,6 +46,8 @@ PerceptronLayer::PerceptronLayer(const Index& new_inputs_number, const Index& ne
 
 Index PerceptronLayer::get_inputs_number() const
 {
+    if(synaptic_weights_released) return half_synaptic_weights.dimension(0);
+
     return synaptic_weights.dimension(0);
 }
 
@@ -68,6 +70,8 @@ Index PerceptronLayer::get_biases_number() const
 
 Index PerceptronLayer::get_synaptic_weights_number() const
 {
+    if(synaptic_weights_released) return half_synaptic_weights.size();
+
     return synaptic_weights.size();
 }
 
@@ -76,7 +80,7 @@ Index PerceptronLayer::get_synaptic_weights_number() const
 
 Index PerceptronLayer::get_parameters_number() const
 {
-    return biases.size() + synaptic_weights.size();
+    return biases.size() + get_synaptic_weights_number();
 }
 
 
@@ -84,7 +88,7 @@ Index PerceptronLayer::get_parameters_number() const
 /// The format is a vector of real values.
 /// The size of this vector is the number of neurons in the layer.
 
-const Tensor<type, 2>& PerceptronLayer::get_biases() const
+const TensorMap<Tensor<type, 2>>& PerceptronLayer::get_biases() const
 {
     return biases;
 }
@@ -94,9 +98,21 @@ const Tensor<type, 2>& PerceptronLayer::get_biases() const
 /// The format is a matrix of real values.
 /// The number of rows is the number of neurons in the layer.
 /// The number of columns is the number of inputs to the layer.
+/// They are not available after release_synaptic_weights() until restore_synaptic_weights() is called.
 
-const Tensor<type, 2>& PerceptronLayer::get_synaptic_weights() const
+const TensorMap<Tensor<type, 2>>& PerceptronLayer::get_synaptic_weights() const
 {
+    if(synaptic_weights_released)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: PerceptronLayer class.\n"
+               << "const TensorMap<Tensor<type, 2>>& get_synaptic_weights() const method.\n"
+               << "Synaptic weights are released, call restore_synaptic_weights() or get_parameters().\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
     return synaptic_weights;
 }
 
@@ -140,15 +156,27 @@ Tensor<type, 2> PerceptronLayer::get_biases(const Tensor<type, 1>& parameters) c
 
 Tensor<type, 1> PerceptronLayer::get_parameters() const
 {
-    Tensor<type, 1> parameters(synaptic_weights.size() + biases.size());
+    Tensor<type, 1> parameters(get_parameters_number());
 
     copy(biases.data(),
          biases.data() + biases.size(),
          parameters.data());
 
-    copy(synaptic_weights.data(),
-         synaptic_weights.data() + synaptic_weights.size(),
-         parameters.data() + biases.size());
+    if(synaptic_weights_released)
+    {
+        // The synaptic weights are released, so they are widened from the half precision copy
+
+        for(Index i = 0; i < half_synaptic_weights.size(); i++)
+        {
+            parameters(biases.size() + i) = static_cast<type>(half_synaptic_weights(i));
+        }
+    }
+    else
+    {
+        copy(synaptic_weights.data(),
+             synaptic_weights.data() + synaptic_weights.size(),
+             parameters.data() + biases.size());
+    }
 
     return parameters;
 }
@@ -156,6 +184,8 @@ Tensor<type, 1> PerceptronLayer::get_parameters() const
 
 Tensor< TensorMap< Tensor<type, 1> >*, 1> PerceptronLayer::get_layer_parameters()
 {
+    restore_synaptic_weights();
+
     Tensor< TensorMap< Tensor<type, 1> >*, 1> layer_parameters(2);
 
     const Index inputs_number = get_inputs_number();
@@ -236,9 +266,7 @@ const bool& PerceptronLayer::get_display() const
 
 void PerceptronLayer::set()
 {
-    biases.resize(0, 0);
-
-    synaptic_weights.resize(0, 0);
+    set_parameters_dimensions(0, 0);
 
     inputs.resize(0,0);
 
@@ -256,9 +284,7 @@ void PerceptronLayer::set()
 void PerceptronLayer::set(const Index& new_inputs_number, const Index& new_neurons_number,
                           const PerceptronLayer::ActivationFunction& new_activation_function)
 {
-    biases.resize(1, new_neurons_number);
-
-    synaptic_weights.resize(new_inputs_number, new_neurons_number);
+    set_parameters_dimensions(new_inputs_number, new_neurons_number);
 
     set_parameters_random();
 
@@ -299,9 +325,7 @@ void PerceptronLayer::set_inputs_number(const Index& new_inputs_number)
 {
     const Index neurons_number = get_neurons_number();
 
-    biases.resize(1, neurons_number);
-
-    synaptic_weights.resize(new_inputs_number, neurons_number);
+    set_parameters_dimensions(new_inputs_number, neurons_number);
 }
 
 
@@ -313,9 +337,7 @@ void PerceptronLayer::set_neurons_number(const Index& new_neurons_number)
 {
     const Index inputs_number = get_inputs_number();
 
-    biases.resize(1, new_neurons_number);
-
-    synaptic_weights.resize(inputs_number, new_neurons_number);
+    set_parameters_dimensions(inputs_number, new_neurons_number);
 }
 
 
@@ -324,7 +346,12 @@ void PerceptronLayer::set_neurons_number(const Index& new_neurons_number)
 
 void PerceptronLayer::set_biases(const Tensor<type, 2>& new_biases)
 {
-    biases = new_biases;
+    if(new_biases.size() != biases.size())
+    {
+        resize_parameters(get_inputs_number(), new_biases.size());
+    }
+
+    copy(new_biases.data(), new_biases.data() + new_biases.size(), biases.data());
 }
 
 
@@ -336,7 +363,17 @@ void PerceptronLayer::set_biases(const Tensor<type, 2>& new_biases)
 
 void PerceptronLayer::set_synaptic_weights(const Tensor<type, 2>& new_synaptic_weights)
 {
+    restore_synaptic_weights();
+
+    if(new_synaptic_weights.dimension(0) != synaptic_weights.dimension(0)
+    || new_synaptic_weights.dimension(1) != synaptic_weights.dimension(1))
+    {
+        resize_parameters(new_synaptic_weights.dimension(0), new_synaptic_weights.dimension(1));
+    }
+
     synaptic_weights = new_synaptic_weights;
+
+    discard_synaptic_weights_copies();
 }
 
 
@@ -344,6 +381,8 @@ void PerceptronLayer::set_synaptic_weights(const Tensor<type, 2>& new_synaptic_w
 
 void PerceptronLayer::set_parameters(const Tensor<type, 1>& new_parameters, const Index& index)
 {   
+    restore_synaptic_weights();
+
     const Index biases_number = get_biases_number();
     const Index synaptic_weights_number = get_synaptic_weights_number();
 
@@ -354,6 +393,132 @@ void PerceptronLayer::set_parameters(const Tensor<type, 1>& new_parameters, cons
     copy( new_parameters.data() + biases_number+ index,
           new_parameters.data() + biases_number + synaptic_weights_number + index,
           synaptic_weights.data());
+
+    discard_synaptic_weights_copies();
+}
+
+
+/// Returns true, because the biases and synaptic weights can be viewed in an external buffer.
+
+bool PerceptronLayer::can_bind_parameters() const
+{
+    return true;
+}
+
+
+/// Makes the biases and synaptic weights view an external buffer, in the same order as get_parameters.
+/// The current values are copied into that buffer and the own memory of the layer is released.
+/// The buffer must outlive the binding.
+/// @param new_parameters_data Pointer to a buffer of get_parameters_number() values.
+
+void PerceptronLayer::bind_parameters(type* new_parameters_data)
+{
+    restore_synaptic_weights();
+
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    if(biases.data() != new_parameters_data)
+    {
+        copy(biases.data(), biases.data() + biases.size(), new_parameters_data);
+
+        copy(synaptic_weights.data(), synaptic_weights.data() + synaptic_weights.size(), new_parameters_data + biases.size());
+    }
+
+    set_parameters_pointers(new_parameters_data, inputs_number, neurons_number);
+
+    parameters_storage.resize(0);
+}
+
+
+/// Copies the biases and synaptic weights back into the own memory of the layer if they were bound to an external buffer.
+
+void PerceptronLayer::unbind_parameters()
+{
+    if(biases.data() == parameters_storage.data()) return;
+
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    const Tensor<type, 1> parameters = get_parameters();
+
+    set_parameters_dimensions(inputs_number, neurons_number);
+
+    copy(parameters.data(), parameters.data() + parameters.size(), parameters_storage.data());
+}
+
+
+/// Returns a pointer to the biases, which are followed by the synaptic weights.
+
+const type* PerceptronLayer::get_parameters_data() const
+{
+    return biases.data();
+}
+
+
+/// Allocates the own memory of the layer for new numbers of inputs and neurons.
+/// The biases and synaptic weights are not initialized.
+
+void PerceptronLayer::set_parameters_dimensions(const Index& new_inputs_number, const Index& new_neurons_number)
+{
+    parameters_storage.resize(new_neurons_number + new_inputs_number*new_neurons_number);
+
+    set_parameters_pointers(parameters_storage.data(), new_inputs_number, new_neurons_number);
+}
+
+
+/// Changes the numbers of inputs and neurons, keeping the biases and synaptic weights of the remaining inputs and neurons.
+/// The new biases and synaptic weights are set to zero.
+/// The dimensions cannot change while the parameters are bound to an external buffer, such as the parameters arena of the neural network,
+/// because the parameters of the next layers are stored right after them.
+
+void PerceptronLayer::resize_parameters(const Index& new_inputs_number, const Index& new_neurons_number)
+{
+    if(biases.data() != parameters_storage.data())
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: PerceptronLayer class.\n"
+               << "void resize_parameters(const Index&, const Index&) method.\n"
+               << "Parameters dimensions cannot change while they are bound to an external buffer.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    restore_synaptic_weights();
+
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    const Tensor<type, 2> old_biases = biases;
+    const Tensor<type, 2> old_synaptic_weights = synaptic_weights;
+
+    set_parameters_dimensions(new_inputs_number, new_neurons_number);
+
+    parameters_storage.setZero();
+
+    const Index kept_inputs_number = min(inputs_number, new_inputs_number);
+    const Index kept_neurons_number = min(neurons_number, new_neurons_number);
+
+    for(Index j = 0; j < kept_neurons_number; j++)
+    {
+        biases(0, j) = old_biases(0, j);
+
+        for(Index i = 0; i < kept_inputs_number; i++)
+        {
+            synaptic_weights(i, j) = old_synaptic_weights(i, j);
+        }
+    }
+}
+
+
+void PerceptronLayer::set_parameters_pointers(type* new_parameters_data, const Index& new_inputs_number, const Index& new_neurons_number)
+{
+    new (&biases) TensorMap<Tensor<type, 2>>(new_parameters_data, 1, new_neurons_number);
+
+    new (&synaptic_weights) TensorMap<Tensor<type, 2>>(new_parameters_data + new_neurons_number, new_inputs_number, new_neurons_number);
+
+    synaptic_weights_released = false;
 }
 
 
@@ -454,7 +619,11 @@ void PerceptronLayer::set_biases_constant(const type& value)
 
 void PerceptronLayer::set_synaptic_weights_constant(const type& value)
 {
+    restore_synaptic_weights();
+
     synaptic_weights.setConstant(value);
+
+    discard_synaptic_weights_copies();
 }
 
 
@@ -463,9 +632,13 @@ void PerceptronLayer::set_synaptic_weights_constant(const type& value)
 
 void PerceptronLayer::set_parameters_constant(const type& value)
 {
+    restore_synaptic_weights();
+
     biases.setConstant(value);
 
     synaptic_weights.setConstant(value);
+
+    discard_synaptic_weights_copies();
 }
 
 
@@ -474,28 +647,32 @@ void PerceptronLayer::set_parameters_constant(const type& value)
 
 void PerceptronLayer::set_parameters_random()
 {
+    restore_synaptic_weights();
+
     const type minimum = type(-0.2);
     const type maximum = type(0.2);
 
     for(Index i = 0; i < biases.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
         biases(i) = minimum + (maximum - minimum)*random;
     }
 
     for(Index i = 0; i < synaptic_weights.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
         synaptic_weights(i) = minimum + (maximum - minimum)*random;
     }
+
+    discard_synaptic_weights_copies();
 }
 
 
 void PerceptronLayer::calculate_combinations(const Tensor<type, 2>& inputs,
-                                             const Tensor<type, 2>& biases,
-                                             const Tensor<type, 2>& synaptic_weights,
+                                             const TensorMap<Tensor<type, 2>>& biases,
+                                             const TensorMap<Tensor<type, 2>>& synaptic_weights,
                                              type* combinations_data) const
 {
 #ifdef OPENNN_DEBUG
@@ -506,19 +683,12 @@ void PerceptronLayer::calculate_combinations(const Tensor<type, 2>& inputs,
     check_dimensions(synaptic_weights, get_inputs_number(), get_neurons_number(), LOG);
 #endif
 
-    const Index batch_samples_number = inputs.dimension(0);
-    const Index biases_number = get_neurons_number();
-
-    TensorMap<Tensor<type, 2>> combinations(combinations_data, batch_samples_number, biases_number);
-
-//    TensorMap<Tensor<type,2>>inputs(inputs_data,inputs_dimension(0),inputs_dimension(1));
-
-    for (Index i = 0; i < biases_number; i++)
-    {
-        fill_n(combinations_data + i*batch_samples_number, batch_samples_number, biases(i));
-    }
-
-    combinations.device(*thread_pool_device) += inputs.contract(synaptic_weights, A_B);
+    calculate_fused_combinations(inputs.data(), inputs.dimension(0), inputs.dimension(1),
+                                 synaptic_weights.data(), synaptic_weights.dimension(1),
+                                 biases.data(),
+                                 combinations_data,
+                                 combinations_data,
+                                 nullptr);
 }
 
 
@@ -685,6 +855,165 @@ void PerceptronLayer::calculate_activations_derivatives(type* combinations, cons
 }
 
 
+/// Returns the element-wise form of the activation function of this layer, to be fused with the combinations,
+/// or nullptr if the activation function has no fused form.
+
+Layer::FusedActivation PerceptronLayer::get_fused_activation() const
+{
+    switch(activation_function)
+    {
+    case ActivationFunction::Linear: return linear_fused;
+
+    case ActivationFunction::Logistic: return logistic_fused;
+
+    case ActivationFunction::HyperbolicTangent: return hyperbolic_tangent_fused;
+
+    case ActivationFunction::RectifiedLinear: return rectified_linear_fused;
+
+    default: return nullptr;
+    }
+}
+
+
+/// Returns true if the layer computes its outputs in deployment with 8 bits synaptic weights and inputs.
+
+bool PerceptronLayer::is_quantized() const
+{
+    return inputs_scale > type(0)
+        && quantized_synaptic_weights.dimension(0) == get_inputs_number()
+        && quantized_synaptic_weights.dimension(1) == get_neurons_number();
+}
+
+
+/// Quantizes the layer for inference (post-training quantization).
+/// The synaptic weights are quantized to 8 bits with one scale per neuron,
+/// and the inputs are quantized with a single scale given by their calibrated range.
+/// Training still uses the floating point parameters, which are kept.
+/// Setting the parameters drops the quantization, as it would be outdated, so the layer must then be quantized again.
+/// @param inputs_maximum Maximum absolute value of the inputs of the layer in a calibration sample.
+
+void PerceptronLayer::quantize(const type& inputs_maximum)
+{
+    restore_synaptic_weights();
+
+    inputs_scale = inputs_maximum > type(0) ? inputs_maximum/type(127) : type(1);
+
+    quantize_synaptic_weights(synaptic_weights.data(), get_inputs_number(), get_neurons_number(),
+                              quantized_synaptic_weights,
+                              synaptic_weights_scales);
+}
+
+
+/// Goes back to floating point inference.
+
+void PerceptronLayer::dequantize()
+{
+    inputs_scale = type(0);
+
+    quantized_synaptic_weights.resize(0, 0);
+    synaptic_weights_scales.resize(0);
+}
+
+
+/// Returns true if the layer computes its outputs in deployment with the half precision copy of the synaptic weights.
+
+bool PerceptronLayer::is_half_precision() const
+{
+    return half_synaptic_weights.dimension(0) == get_inputs_number()
+        && half_synaptic_weights.dimension(1) == get_neurons_number()
+        && half_synaptic_weights.size() != 0;
+}
+
+
+/// Sets the storage of the synaptic weights for inference.
+/// In half precision, the synaptic weights are copied to IEEE fp16 and widened to single precision inside the combinations kernel.
+/// The single precision parameters are the master copy, which training updates,
+/// so the half precision copy must be set again if the parameters change.
+/// @param new_half_precision True to store the synaptic weights in half precision, false to go back to single precision.
+
+void PerceptronLayer::set_half_precision(const bool& new_half_precision)
+{
+    if(!new_half_precision)
+    {
+        restore_synaptic_weights();
+
+        half_synaptic_weights.resize(0, 0);
+
+        return;
+    }
+
+    // The half precision copy is the only one after release_synaptic_weights(), and it is up to date
+
+    if(synaptic_weights_released) return;
+
+    half_synaptic_weights.resize(get_inputs_number(), get_neurons_number());
+
+    const type* synaptic_weights_data = synaptic_weights.data();
+
+    for(Index i = 0; i < half_synaptic_weights.size(); i++)
+    {
+        half_synaptic_weights(i) = half_float::half(synaptic_weights_data[i]);
+    }
+}
+
+
+/// Releases the single precision synaptic weights of a layer in half precision, which then only keeps the half precision copy.
+/// This halves the memory of the synaptic weights of layers which are only used for inference.
+/// The single precision synaptic weights are restored from the half precision copy when they are needed again,
+/// for instance by training or by the parameters setters.
+/// Nothing is released if the layer is not in half precision or if its parameters are bound to an external buffer.
+
+void PerceptronLayer::release_synaptic_weights()
+{
+    if(!is_half_precision() || synaptic_weights_released || biases.data() != parameters_storage.data()) return;
+
+    const Index neurons_number = get_neurons_number();
+
+    const Tensor<type, 1> biases_storage = parameters_storage.slice(Eigen::array<Index, 1>({0}), Eigen::array<Index, 1>({neurons_number}));
+
+    parameters_storage = biases_storage;
+
+    new (&biases) TensorMap<Tensor<type, 2>>(parameters_storage.data(), 1, neurons_number);
+
+    new (&synaptic_weights) TensorMap<Tensor<type, 2>>(nullptr, 0, 0);
+
+    synaptic_weights_released = true;
+}
+
+
+/// Restores the single precision synaptic weights from the half precision copy if they were released.
+/// The restored synaptic weights have the precision of the half precision copy.
+
+void PerceptronLayer::restore_synaptic_weights()
+{
+    if(!synaptic_weights_released) return;
+
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    const Tensor<type, 1> biases_storage = parameters_storage;
+
+    set_parameters_dimensions(inputs_number, neurons_number);
+
+    copy(biases_storage.data(), biases_storage.data() + neurons_number, biases.data());
+
+    for(Index i = 0; i < synaptic_weights.size(); i++)
+    {
+        synaptic_weights(i) = static_cast<type>(half_synaptic_weights(i));
+    }
+}
+
+
+/// Drops the quantized and half precision copies of the synaptic weights, which are outdated once the synaptic weights change.
+
+void PerceptronLayer::discard_synaptic_weights_copies()
+{
+    dequantize();
+
+    half_synaptic_weights.resize(0, 0);
+}
+
+
 //void PerceptronLayer::calculate_outputs(type* inputs_data, const Tensor<Index, 1>& inputs_dimensions,
 //                                        type* outputs_data, const Tensor<Index, 1>& outputs_dimensions)
 //{
@@ -723,12 +1052,85 @@ void PerceptronLayer::forward_propagate(type* inputs_data,
 
 #endif
 
+    // Training needs the single precision synaptic weights, which are restored once if they were released.
+    // The shards of a batch can be forward propagated at the same time, so the restoration is a critical section.
+
+    if(switch_train)
+    {
+        #pragma omp critical(restore_synaptic_weights)
+        restore_synaptic_weights();
+    }
+
     PerceptronLayerForwardPropagation* perceptron_layer_forward_propagation
             = static_cast<PerceptronLayerForwardPropagation*>(forward_propagation);
 
-    const TensorMap<Tensor<type, 2>> inputs(inputs_data, inputs_dimensions(0), inputs_dimensions(1));
     type* combinations_data = perceptron_layer_forward_propagation->get_combinations_data();
 
+    const FusedActivation fused_activation = get_fused_activation();
+
+    if(!switch_train && is_quantized())
+    {
+        Tensor<int8_t, 2>& quantized_inputs = perceptron_layer_forward_propagation->quantized_inputs;
+
+        if(quantized_inputs.size() != inputs_dimensions(0)*inputs_dimensions(1))
+        {
+            quantized_inputs.resize(inputs_dimensions(1), inputs_dimensions(0));
+        }
+
+        calculate_quantized_combinations(inputs_data, inputs_dimensions(0), inputs_dimensions(1),
+                                         quantized_synaptic_weights.data(), synaptic_weights_scales.data(), get_neurons_number(),
+                                         inputs_scale,
+                                         biases.data(),
+                                         quantized_inputs.data(),
+                                         combinations_data,
+                                         perceptron_layer_forward_propagation->outputs_data,
+                                         fused_activation);
+
+        if(fused_activation == nullptr)
+        {
+            calculate_activations(combinations_data,
+                                  get_dimensions(perceptron_layer_forward_propagation->combinations),
+                                  perceptron_layer_forward_propagation->outputs_data,
+                                  perceptron_layer_forward_propagation->outputs_dimensions);
+        }
+
+        return;
+    }
+
+    if(!switch_train && is_half_precision())
+    {
+        calculate_half_combinations(inputs_data, inputs_dimensions(0), inputs_dimensions(1),
+                                    half_synaptic_weights.data(), get_neurons_number(),
+                                    biases.data(),
+                                    combinations_data,
+                                    perceptron_layer_forward_propagation->outputs_data,
+                                    fused_activation);
+
+        if(fused_activation == nullptr)
+        {
+            calculate_activations(combinations_data,
+                                  get_dimensions(perceptron_layer_forward_propagation->combinations),
+                                  perceptron_layer_forward_propagation->outputs_data,
+                                  perceptron_layer_forward_propagation->outputs_dimensions);
+        }
+
+        return;
+    }
+
+    if(fused_activation != nullptr)
+    {
+        calculate_fused_combinations(inputs_data, inputs_dimensions(0), inputs_dimensions(1),
+                                     synaptic_weights.data(), get_neurons_number(),
+                                     biases.data(),
+                                     combinations_data,
+                                     perceptron_layer_forward_propagation->outputs_data,
+                                     switch_train ? perceptron_layer_forward_propagation->activations_derivatives.data() : nullptr,
+                                     fused_activation);
+        return;
+    }
+
+    const TensorMap<Tensor<type, 2>> inputs(inputs_data, inputs_dimensions(0), inputs_dimensions(1));
+
     calculate_combinations(inputs,
                            biases,
                            synaptic_weights,
@@ -794,6 +1196,19 @@ void PerceptronLayer::forward_propagate(type* inputs_data,
 
     const Tensor<Index, 1> derivatives_dimensions = get_dimensions(perceptron_layer_forward_propagation->activations_derivatives);
 
+    const FusedActivation fused_activation = get_fused_activation();
+
+    if(fused_activation != nullptr)
+    {
+        calculate_fused_combinations(inputs_data, inputs_dimensions(0), inputs_dimensions(1),
+                                     potential_synaptic_weights.data(), neurons_number,
+                                     potential_biases.data(),
+                                     perceptron_layer_forward_propagation->get_combinations_data(),
+                                     perceptron_layer_forward_propagation->outputs_data,
+                                     perceptron_layer_forward_propagation->activations_derivatives.data(),
+                                     fused_activation);
+        return;
+    }
 
     calculate_combinations(inputs,
                            potential_biases,
@@ -810,6 +1225,66 @@ void PerceptronLayer::forward_propagate(type* inputs_data,
 }
 
 
+/// Forward propagates sparse inputs, such as word bags, through the layer.
+/// The combinations are computed with a sparse times dense product, which only multiplies the non zero inputs.
+/// @param inputs Inputs of the batch in compressed sparse row format.
+
+void PerceptronLayer::forward_propagate(const SparseMatrix<type, RowMajor, Index>& inputs,
+                                        LayerForwardPropagation* forward_propagation,
+                                        bool& switch_train)
+{
+#ifdef OPENNN_DEBUG
+    if(inputs.cols() != get_inputs_number())
+    {
+        ostringstream buffer;
+        buffer << "OpenNN Exception: PerceptronLayer class.\n"
+               << "void forward_propagate(const SparseMatrix<type, RowMajor, Index>&, LayerForwardPropagation*, bool&) method.\n"
+               << "Inputs columns number must be equal to " << get_inputs_number() << ", (" << inputs.cols() << ").\n";
+        throw invalid_argument(buffer.str());
+    }
+#endif
+
+    // The sparse product needs the single precision synaptic weights, which are restored once if they were released
+
+    #pragma omp critical(restore_synaptic_weights)
+    restore_synaptic_weights();
+
+    PerceptronLayerForwardPropagation* perceptron_layer_forward_propagation
+            = static_cast<PerceptronLayerForwardPropagation*>(forward_propagation);
+
+    const Index neurons_number = get_neurons_number();
+
+    const Map<const Matrix<type, Dynamic, Dynamic>> synaptic_weights_matrix(synaptic_weights.data(), get_inputs_number(), neurons_number);
+    const Map<const Matrix<type, 1, Dynamic>> biases_row(biases.data(), neurons_number);
+
+    Map<Matrix<type, Dynamic, Dynamic>> combinations(perceptron_layer_forward_propagation->get_combinations_data(), inputs.rows(), neurons_number);
+
+    combinations.noalias() = inputs*synaptic_weights_matrix;
+
+    combinations.rowwise() += biases_row;
+
+    const Tensor<Index, 1> combinations_dimensions = get_dimensions(perceptron_layer_forward_propagation->combinations);
+    const Tensor<Index, 1> activations_derivatives_dimensions = get_dimensions(perceptron_layer_forward_propagation->activations_derivatives);
+
+    if(switch_train)
+    {
+        calculate_activations_derivatives(perceptron_layer_forward_propagation->combinations.data(),
+                                          combinations_dimensions,
+                                          perceptron_layer_forward_propagation->outputs_data,
+                                          perceptron_layer_forward_propagation->outputs_dimensions,
+                                          perceptron_layer_forward_propagation->activations_derivatives.data(),
+                                          activations_derivatives_dimensions);
+    }
+    else
+    {
+        calculate_activations(perceptron_layer_forward_propagation->combinations.data(),
+                              combinations_dimensions,
+                              perceptron_layer_forward_propagation->outputs_data,
+                              perceptron_layer_forward_propagation->outputs_dimensions);
+    }
+}
+
+
 void PerceptronLayer::calculate_hidden_delta(LayerForwardPropagation* next_layer_forward_propagation,
                                              LayerBackPropagation* next_layer_back_propagation,
                                              LayerBackPropagation* layer_back_propagation) const
@@ -855,7 +1330,7 @@ void PerceptronLayer::calculate_hidden_delta(PerceptronLayerForwardPropagation*
                                              PerceptronLayerBackPropagation* next_back_propagation,
                                              PerceptronLayerBackPropagation* back_propagation) const
 {
-    const Tensor<type, 2>& next_synaptic_weights = static_cast<PerceptronLayer*>(next_back_propagation->layer_pointer)->get_synaptic_weights();
+    const TensorMap<Tensor<type, 2>>& next_synaptic_weights = static_cast<PerceptronLayer*>(next_back_propagation->layer_pointer)->get_synaptic_weights();
 
     const TensorMap<Tensor<type, 2>> next_deltas(next_back_propagation->deltas_data, next_back_propagation->deltas_dimensions(0), next_back_propagation->deltas_dimensions(1));;
 
@@ -927,7 +1402,7 @@ void PerceptronLayer::calculate_hidden_delta(ProbabilisticLayerForwardPropagatio
 
     const ProbabilisticLayer* probabilistic_layer_pointer = static_cast<ProbabilisticLayer*>(next_back_propagation->layer_pointer);
 
-    const Tensor<type, 2>& next_synaptic_weights = probabilistic_layer_pointer->get_synaptic_weights();
+    const TensorMap<Tensor<type, 2>>& next_synaptic_weights = probabilistic_layer_pointer->get_synaptic_weights();
 
     const Index next_neurons_number = probabilistic_layer_pointer->get_biases_number();
 
@@ -1069,7 +1544,7 @@ void PerceptronLayer::calculate_hidden_delta_lm(PerceptronLayerForwardPropagatio
                                                            PerceptronLayerBackPropagationLM* next_back_propagation,
                                                            PerceptronLayerBackPropagationLM* back_propagation) const
 {
-    const Tensor<type, 2>& next_synaptic_weights = static_cast<PerceptronLayer*>(next_back_propagation->layer_pointer)->get_synaptic_weights();
+    const TensorMap<Tensor<type, 2>>& next_synaptic_weights = static_cast<PerceptronLayer*>(next_back_propagation->layer_pointer)->get_synaptic_weights();
 
     back_propagation->deltas.device(*thread_pool_device) =
             (next_back_propagation->deltas*next_forward_propagation->activations_derivatives.reshape(Eigen::array<Index,2> {{next_forward_propagation->activations_derivatives.dimension(0),next_forward_propagation->activations_derivatives.dimension(1)}}))
@@ -1083,7 +1558,7 @@ void PerceptronLayer::calculate_hidden_delta_lm(ProbabilisticLayerForwardPropaga
 {           
     const ProbabilisticLayer* probabilistic_layer_pointer = static_cast<ProbabilisticLayer*>(next_back_propagation->layer_pointer);
 
-    const Tensor<type, 2>& next_synaptic_weights = probabilistic_layer_pointer->get_synaptic_weights();
+    const TensorMap<Tensor<type, 2>>& next_synaptic_weights = probabilistic_layer_pointer->get_synaptic_weights();
 
     if(probabilistic_layer_pointer->get_activation_function() == ProbabilisticLayer::ActivationFunction::Softmax)
     {
@@ -1270,6 +1745,40 @@ void PerceptronLayer::calculate_error_gradient(type* inputs_data,
 }
 
 
+/// Calculates the error gradient of the layer for sparse inputs.
+/// The synaptic weights derivatives are computed with a sparse transposed times dense product.
+/// @param inputs Inputs of the batch in compressed sparse row format.
+
+void PerceptronLayer::calculate_error_gradient(const SparseMatrix<type, RowMajor, Index>& inputs,
+                                               LayerForwardPropagation* forward_propagation,
+                                               LayerBackPropagation* back_propagation) const
+{
+    const PerceptronLayerForwardPropagation* perceptron_layer_forward_propagation =
+            static_cast<PerceptronLayerForwardPropagation*>(forward_propagation);
+
+    PerceptronLayerBackPropagation* perceptron_layer_back_propagation =
+            static_cast<PerceptronLayerBackPropagation*>(back_propagation);
+
+    const Index neurons_number = get_neurons_number();
+
+    const TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
+
+    Tensor<type, 2> deltas_times_activations_derivatives(deltas.dimension(0), deltas.dimension(1));
+
+    deltas_times_activations_derivatives.device(*thread_pool_device) = deltas * perceptron_layer_forward_propagation->activations_derivatives;
+
+    perceptron_layer_back_propagation->biases_derivatives.device(*thread_pool_device) =
+            deltas_times_activations_derivatives.sum(Eigen::array<Index, 1>({0}));
+
+    const Map<const Matrix<type, Dynamic, Dynamic>> deltas_matrix(deltas_times_activations_derivatives.data(), inputs.rows(), neurons_number);
+
+    Map<Matrix<type, Dynamic, Dynamic>> synaptic_weights_derivatives(perceptron_layer_back_propagation->synaptic_weights_derivatives.data(),
+                                                                      get_inputs_number(), neurons_number);
+
+    synaptic_weights_derivatives.noalias() = inputs.transpose()*deltas_matrix;
+}
+
+
 void PerceptronLayer::insert_gradient(LayerBackPropagation* back_propagation,
                                       const Index& index,
                                       Tensor<type, 1>& gradient) const
@@ -1280,6 +1789,10 @@ void PerceptronLayer::insert_gradient(LayerBackPropagation* back_propagation,
     const Index biases_number = get_biases_number();
     const Index synaptic_weights_number = get_synaptic_weights_number();
 
+    // Nothing to copy if the gradient is written directly into its final place
+
+    if(perceptron_layer_back_propagation->biases_derivatives.data() == gradient.data() + index) return;
+
     copy(perceptron_layer_back_propagation->biases_derivatives.data(),
          perceptron_layer_back_propagation->biases_derivatives.data() + biases_number,
          gradient.data() + index);
@@ -1303,9 +1816,13 @@ string PerceptronLayer::write_expression(const Tensor<string, 1>& inputs_names,
 
     ostringstream buffer;
 
+    // The synaptic weights are taken from the parameters, as they might be released
+
+    const Tensor<type, 2> synaptic_weights_values = get_synaptic_weights(get_parameters());
+
     for(Index j = 0; j < outputs_names.size(); j++)
     {
-        const Tensor<type, 1> synaptic_weights_column =  synaptic_weights.chip(j,1);
+        const Tensor<type, 1> synaptic_weights_column =  synaptic_weights_values.chip(j,1);
 
         buffer << outputs_names[j] << " = " << write_activation_function_expression() << "( " << biases(0,j) << " +";
 
@@ -1429,10 +1946,34 @@ void PerceptronLayer::from_XML(const tinyxml2::XMLDocument& document)
 
         set_parameters(to_type_vector(parameters_string, ' '));
     }
+
+    // Quantization
+
+    const tinyxml2::XMLElement* quantization_element = perceptron_layer_element->FirstChildElement("Quantization");
+
+    if(quantization_element)
+    {
+        quantized_synaptic_weights.resize(get_inputs_number(), get_neurons_number());
+
+        quantization_from_XML(quantization_element, inputs_scale, synaptic_weights_scales, quantized_synaptic_weights);
+    }
+    else
+    {
+        dequantize();
+    }
 }
 
 
 void PerceptronLayer::write_XML(tinyxml2::XMLPrinter& file_stream) const
+{
+    write_XML(file_stream, true);
+}
+
+
+/// Serializes the perceptron layer, leaving the parameters element empty if the parameters are written apart.
+/// @param write_parameters True to write the values of the parameters, false otherwise.
+
+void PerceptronLayer::write_XML(tinyxml2::XMLPrinter& file_stream, const bool& write_parameters) const
 {
     ostringstream buffer;
 
@@ -1480,22 +2021,32 @@ void PerceptronLayer::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     file_stream.OpenElement("Parameters");
 
-    buffer.str("");
+    if(write_parameters)
+    {
+        buffer.str("");
 
-    const Tensor<type, 1> parameters = get_parameters();
-    const Index parameters_size = parameters.size();
+        const Tensor<type, 1> parameters = get_parameters();
+        const Index parameters_size = parameters.size();
 
-    for(Index i = 0; i < parameters_size; i++)
-    {
-        buffer << parameters(i);
+        for(Index i = 0; i < parameters_size; i++)
+        {
+            buffer << parameters(i);
 
-        if(i != (parameters_size-1)) buffer << " ";
-    }
+            if(i != (parameters_size-1)) buffer << " ";
+        }
 
-    file_stream.PushText(buffer.str().c_str());
+        file_stream.PushText(buffer.str().c_str());
+    }
 
     file_stream.CloseElement();
 
+    // Quantization
+
+    if(is_quantized())
+    {
+        write_quantization_XML(file_stream, inputs_scale, synaptic_weights_scales, quantized_synaptic_weights);
+    }
+
     // Peceptron layer (end tag)
 
     file_stream.CloseElement();
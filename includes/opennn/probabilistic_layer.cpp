@@ -38,6 +38,8 @@ ProbabilisticLayer::ProbabilisticLayer(const Index& new_inputs_number, const Ind
 
 Index ProbabilisticLayer::get_inputs_number() const
 {
+    if(synaptic_weights_released) return half_synaptic_weights.dimension(0);
+
     return synaptic_weights.dimension(0);
 }
 
@@ -58,6 +60,8 @@ Index ProbabilisticLayer::get_biases_number() const
 
 Index ProbabilisticLayer::get_synaptic_weights_number() const
 {
+    if(synaptic_weights_released) return half_synaptic_weights.size();
+
     return synaptic_weights.size();
 }
 
@@ -158,16 +162,28 @@ const bool& ProbabilisticLayer::get_display() const
 
 /// Returns the biases of the layer.
 
-const Tensor<type, 2>& ProbabilisticLayer::get_biases() const
+const TensorMap<Tensor<type, 2>>& ProbabilisticLayer::get_biases() const
 {
     return biases;
 }
 
 
 /// Returns the synaptic weights of the layer.
+/// They are not available after release_synaptic_weights() until restore_synaptic_weights() is called.
 
-const Tensor<type, 2>& ProbabilisticLayer::get_synaptic_weights() const
+const TensorMap<Tensor<type, 2>>& ProbabilisticLayer::get_synaptic_weights() const
 {
+    if(synaptic_weights_released)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: ProbabilisticLayer class.\n"
+               << "const TensorMap<Tensor<type, 2>>& get_synaptic_weights() const method.\n"
+               << "Synaptic weights are released, call restore_synaptic_weights() or get_parameters().\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
     return synaptic_weights;
 }
 
@@ -204,7 +220,7 @@ Tensor<type, 2> ProbabilisticLayer::get_synaptic_weights(Tensor<type, 1>& parame
 
 Index ProbabilisticLayer::get_parameters_number() const
 {
-    return biases.size() + synaptic_weights.size();
+    return biases.size() + get_synaptic_weights_number();
 }
 
 
@@ -214,15 +230,27 @@ Index ProbabilisticLayer::get_parameters_number() const
 
 Tensor<type, 1> ProbabilisticLayer::get_parameters() const
 {
-    Tensor<type, 1> parameters(synaptic_weights.size() + biases.size());
+    Tensor<type, 1> parameters(get_parameters_number());
 
     copy(biases.data(),
          biases.data() + biases.size(),
          parameters.data());
 
-    copy(synaptic_weights.data(),
-         synaptic_weights.data() + synaptic_weights.size(),
-         parameters.data() + biases.size());
+    if(synaptic_weights_released)
+    {
+        // The synaptic weights are released, so they are widened from the half precision copy
+
+        for(Index i = 0; i < half_synaptic_weights.size(); i++)
+        {
+            parameters(biases.size() + i) = static_cast<type>(half_synaptic_weights(i));
+        }
+    }
+    else
+    {
+        copy(synaptic_weights.data(),
+             synaptic_weights.data() + synaptic_weights.size(),
+             parameters.data() + biases.size());
+    }
 
     return parameters;
 }
@@ -230,6 +258,8 @@ Tensor<type, 1> ProbabilisticLayer::get_parameters() const
 
 Tensor< TensorMap< Tensor<type, 1>>*, 1> ProbabilisticLayer::get_layer_parameters()
 {
+    restore_synaptic_weights();
+
     Tensor< TensorMap< Tensor<type, 1> >*, 1> layer_parameters(2);
 
     const Index inputs_number = get_inputs_number();
@@ -242,14 +272,149 @@ Tensor< TensorMap< Tensor<type, 1>>*, 1> ProbabilisticLayer::get_layer_parameter
 }
 
 
+/// Returns true if the layer computes its outputs in deployment with 8 bits synaptic weights and inputs.
+
+bool ProbabilisticLayer::is_quantized() const
+{
+    return inputs_scale > type(0)
+        && quantized_synaptic_weights.dimension(0) == get_inputs_number()
+        && quantized_synaptic_weights.dimension(1) == get_neurons_number();
+}
+
+
+/// Quantizes the layer for inference, with 8 bits synaptic weights per neuron and 8 bits inputs.
+/// The floating point parameters are kept for training.
+/// Setting the parameters drops the quantization, as it would be outdated, so the layer must then be quantized again.
+/// @param inputs_maximum Maximum absolute value of the inputs of the layer in a calibration sample.
+
+void ProbabilisticLayer::quantize(const type& inputs_maximum)
+{
+    restore_synaptic_weights();
+
+    inputs_scale = inputs_maximum > type(0) ? inputs_maximum/type(127) : type(1);
+
+    quantize_synaptic_weights(synaptic_weights.data(), get_inputs_number(), get_neurons_number(),
+                              quantized_synaptic_weights,
+                              synaptic_weights_scales);
+}
+
+
+/// Goes back to floating point inference.
+
+void ProbabilisticLayer::dequantize()
+{
+    inputs_scale = type(0);
+
+    quantized_synaptic_weights.resize(0, 0);
+    synaptic_weights_scales.resize(0);
+}
+
+
+/// Returns true if the layer computes its outputs in deployment with the half precision copy of the synaptic weights.
+
+bool ProbabilisticLayer::is_half_precision() const
+{
+    return half_synaptic_weights.dimension(0) == get_inputs_number()
+        && half_synaptic_weights.dimension(1) == get_neurons_number()
+        && half_synaptic_weights.size() != 0;
+}
+
+
+/// Sets the storage of the synaptic weights for inference.
+/// In half precision, the synaptic weights are copied to IEEE fp16 and widened to single precision inside the combinations kernel.
+/// The single precision parameters are the master copy, which training updates,
+/// so the half precision copy must be set again if the parameters change.
+/// @param new_half_precision True to store the synaptic weights in half precision, false to go back to single precision.
+
+void ProbabilisticLayer::set_half_precision(const bool& new_half_precision)
+{
+    if(!new_half_precision)
+    {
+        restore_synaptic_weights();
+
+        half_synaptic_weights.resize(0, 0);
+
+        return;
+    }
+
+    // The half precision copy is the only one after release_synaptic_weights(), and it is up to date
+
+    if(synaptic_weights_released) return;
+
+    half_synaptic_weights.resize(get_inputs_number(), get_neurons_number());
+
+    const type* synaptic_weights_data = synaptic_weights.data();
+
+    for(Index i = 0; i < half_synaptic_weights.size(); i++)
+    {
+        half_synaptic_weights(i) = half_float::half(synaptic_weights_data[i]);
+    }
+}
+
+
+/// Releases the single precision synaptic weights of a layer in half precision, which then only keeps the half precision copy.
+/// This halves the memory of the synaptic weights of layers which are only used for inference.
+/// The single precision synaptic weights are restored from the half precision copy when they are needed again,
+/// for instance by training or by the parameters setters.
+/// Nothing is released if the layer is not in half precision or if its parameters are bound to an external buffer.
+
+void ProbabilisticLayer::release_synaptic_weights()
+{
+    if(!is_half_precision() || synaptic_weights_released || biases.data() != parameters_storage.data()) return;
+
+    const Index neurons_number = get_neurons_number();
+
+    const Tensor<type, 1> biases_storage = parameters_storage.slice(Eigen::array<Index, 1>({0}), Eigen::array<Index, 1>({neurons_number}));
+
+    parameters_storage = biases_storage;
+
+    new (&biases) TensorMap<Tensor<type, 2>>(parameters_storage.data(), 1, neurons_number);
+
+    new (&synaptic_weights) TensorMap<Tensor<type, 2>>(nullptr, 0, 0);
+
+    synaptic_weights_released = true;
+}
+
+
+/// Restores the single precision synaptic weights from the half precision copy if they were released.
+/// The restored synaptic weights have the precision of the half precision copy.
+
+void ProbabilisticLayer::restore_synaptic_weights()
+{
+    if(!synaptic_weights_released) return;
+
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    const Tensor<type, 1> biases_storage = parameters_storage;
+
+    set_parameters_dimensions(inputs_number, neurons_number);
+
+    copy(biases_storage.data(), biases_storage.data() + neurons_number, biases.data());
+
+    for(Index i = 0; i < synaptic_weights.size(); i++)
+    {
+        synaptic_weights(i) = static_cast<type>(half_synaptic_weights(i));
+    }
+}
+
+
+/// Drops the quantized and half precision copies of the synaptic weights, which are outdated once the synaptic weights change.
+
+void ProbabilisticLayer::discard_synaptic_weights_copies()
+{
+    dequantize();
+
+    half_synaptic_weights.resize(0, 0);
+}
+
+
 /// Sets a probabilistic layer with zero probabilistic neurons.
 /// It also sets the rest of the members to their default values.
 
 void ProbabilisticLayer::set()
 {
-    biases.resize(0, 0);
-
-    synaptic_weights.resize(0,0);
+    set_parameters_dimensions(0, 0);
 
     set_default();
 }
@@ -261,9 +426,7 @@ void ProbabilisticLayer::set()
 
 void ProbabilisticLayer::set(const Index& new_inputs_number, const Index& new_neurons_number)
 {
-    biases.resize(1, new_neurons_number);
-
-    synaptic_weights.resize(new_inputs_number, new_neurons_number);
+    set_parameters_dimensions(new_inputs_number, new_neurons_number);
 
     set_parameters_random();
 
@@ -290,9 +453,7 @@ void ProbabilisticLayer::set_inputs_number(const Index& new_inputs_number)
 {
     const Index neurons_number = get_neurons_number();
 
-    biases.resize(1, neurons_number);
-
-    synaptic_weights.resize(new_inputs_number, neurons_number);
+    set_parameters_dimensions(new_inputs_number, neurons_number);
 }
 
 
@@ -300,26 +461,41 @@ void ProbabilisticLayer::set_neurons_number(const Index& new_neurons_number)
 {
     const Index inputs_number = get_inputs_number();
 
-    biases.resize(1, new_neurons_number);
-
-    synaptic_weights.resize(inputs_number, new_neurons_number);
+    set_parameters_dimensions(inputs_number, new_neurons_number);
 }
 
 
 void ProbabilisticLayer::set_biases(const Tensor<type, 2>& new_biases)
 {
-    biases = new_biases;
+    if(new_biases.size() != biases.size())
+    {
+        resize_parameters(get_inputs_number(), new_biases.size());
+    }
+
+    copy(new_biases.data(), new_biases.data() + new_biases.size(), biases.data());
 }
 
 
 void ProbabilisticLayer::set_synaptic_weights(const Tensor<type, 2>& new_synaptic_weights)
 {
+    restore_synaptic_weights();
+
+    if(new_synaptic_weights.dimension(0) != synaptic_weights.dimension(0)
+    || new_synaptic_weights.dimension(1) != synaptic_weights.dimension(1))
+    {
+        resize_parameters(new_synaptic_weights.dimension(0), new_synaptic_weights.dimension(1));
+    }
+
     synaptic_weights = new_synaptic_weights;
+
+    discard_synaptic_weights_copies();
 }
 
 
 void ProbabilisticLayer::set_parameters(const Tensor<type, 1>& new_parameters, const Index& index)
 {
+    restore_synaptic_weights();
+
     const Index biases_number = biases.size();
     const Index synaptic_weights_number = synaptic_weights.size();
 
@@ -330,6 +506,131 @@ void ProbabilisticLayer::set_parameters(const Tensor<type, 1>& new_parameters, c
     copy(new_parameters.data() + biases_number + index,
          new_parameters.data() + biases_number + index + synaptic_weights_number,
          synaptic_weights.data());
+
+    discard_synaptic_weights_copies();
+}
+
+
+/// Returns true, because the biases and synaptic weights can be viewed in an external buffer.
+
+bool ProbabilisticLayer::can_bind_parameters() const
+{
+    return true;
+}
+
+
+/// Makes the biases and synaptic weights view an external buffer, in the same order as get_parameters.
+/// The current values are copied into that buffer and the own memory of the layer is released.
+/// @param new_parameters_data Pointer to a buffer of get_parameters_number() values.
+
+void ProbabilisticLayer::bind_parameters(type* new_parameters_data)
+{
+    restore_synaptic_weights();
+
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    if(biases.data() != new_parameters_data)
+    {
+        copy(biases.data(), biases.data() + biases.size(), new_parameters_data);
+
+        copy(synaptic_weights.data(), synaptic_weights.data() + synaptic_weights.size(), new_parameters_data + biases.size());
+    }
+
+    set_parameters_pointers(new_parameters_data, inputs_number, neurons_number);
+
+    parameters_storage.resize(0);
+}
+
+
+/// Copies the biases and synaptic weights back into the own memory of the layer if they were bound to an external buffer.
+
+void ProbabilisticLayer::unbind_parameters()
+{
+    if(biases.data() == parameters_storage.data()) return;
+
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    const Tensor<type, 1> parameters = get_parameters();
+
+    set_parameters_dimensions(inputs_number, neurons_number);
+
+    copy(parameters.data(), parameters.data() + parameters.size(), parameters_storage.data());
+}
+
+
+/// Returns a pointer to the biases, which are followed by the synaptic weights.
+
+const type* ProbabilisticLayer::get_parameters_data() const
+{
+    return biases.data();
+}
+
+
+/// Allocates the own memory of the layer for new numbers of inputs and neurons.
+/// The biases and synaptic weights are not initialized.
+
+void ProbabilisticLayer::set_parameters_dimensions(const Index& new_inputs_number, const Index& new_neurons_number)
+{
+    parameters_storage.resize(new_neurons_number + new_inputs_number*new_neurons_number);
+
+    set_parameters_pointers(parameters_storage.data(), new_inputs_number, new_neurons_number);
+}
+
+
+/// Changes the numbers of inputs and neurons, keeping the biases and synaptic weights of the remaining inputs and neurons.
+/// The new biases and synaptic weights are set to zero.
+/// The dimensions cannot change while the parameters are bound to an external buffer, such as the parameters arena of the neural network,
+/// because the parameters of the next layers are stored right after them.
+
+void ProbabilisticLayer::resize_parameters(const Index& new_inputs_number, const Index& new_neurons_number)
+{
+    if(biases.data() != parameters_storage.data())
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: ProbabilisticLayer class.\n"
+               << "void resize_parameters(const Index&, const Index&) method.\n"
+               << "Parameters dimensions cannot change while they are bound to an external buffer.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    restore_synaptic_weights();
+
+    const Index inputs_number = get_inputs_number();
+    const Index neurons_number = get_neurons_number();
+
+    const Tensor<type, 2> old_biases = biases;
+    const Tensor<type, 2> old_synaptic_weights = synaptic_weights;
+
+    set_parameters_dimensions(new_inputs_number, new_neurons_number);
+
+    parameters_storage.setZero();
+
+    const Index kept_inputs_number = min(inputs_number, new_inputs_number);
+    const Index kept_neurons_number = min(neurons_number, new_neurons_number);
+
+    for(Index j = 0; j < kept_neurons_number; j++)
+    {
+        biases(0, j) = old_biases(0, j);
+
+        for(Index i = 0; i < kept_inputs_number; i++)
+        {
+            synaptic_weights(i, j) = old_synaptic_weights(i, j);
+        }
+    }
+}
+
+
+void ProbabilisticLayer::set_parameters_pointers(type* new_parameters_data, const Index& new_inputs_number, const Index& new_neurons_number)
+{
+    new (&biases) TensorMap<Tensor<type, 2>>(new_parameters_data, 1, new_neurons_number);
+
+    new (&synaptic_weights) TensorMap<Tensor<type, 2>>(new_parameters_data + new_neurons_number, new_inputs_number, new_neurons_number);
+
+    synaptic_weights_released = false;
 }
 
 
@@ -516,13 +817,24 @@ void ProbabilisticLayer::set_biases_constant(const type& value)
 
 void ProbabilisticLayer::set_synaptic_weights_constant(const type& value)
 {
+    restore_synaptic_weights();
+
     synaptic_weights.setConstant(value);
+
+    discard_synaptic_weights_copies();
 }
 
 
 void ProbabilisticLayer::set_synaptic_weights_constant_Glorot()
 {
-    synaptic_weights.setRandom();
+    restore_synaptic_weights();
+
+    for(Index i = 0; i < synaptic_weights.size(); i++)
+    {
+        synaptic_weights(i) = calculate_random_uniform();
+    }
+
+    discard_synaptic_weights_copies();
 }
 
 
@@ -531,9 +843,13 @@ void ProbabilisticLayer::set_synaptic_weights_constant_Glorot()
 
 void ProbabilisticLayer::set_parameters_constant(const type& value)
 {
+    restore_synaptic_weights();
+
     biases.setConstant(value);
 
     synaptic_weights.setConstant(value);
+
+    discard_synaptic_weights_copies();
 }
 
 
@@ -542,27 +858,33 @@ void ProbabilisticLayer::set_parameters_constant(const type& value)
 
 void ProbabilisticLayer::set_parameters_random()
 {
+    restore_synaptic_weights();
+
     const type minimum = type(-0.2);
     const type maximum = type(0.2);
 
     for(Index i = 0; i < biases.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
         biases(i) = minimum + (maximum - minimum)*random;
     }
 
     for(Index i = 0; i < synaptic_weights.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
         synaptic_weights(i) = minimum + (maximum - minimum)*random;
     }
+
+    discard_synaptic_weights_copies();
 }
 
 
 void ProbabilisticLayer::insert_parameters(const Tensor<type, 1>& parameters, const Index& )
 {
+    restore_synaptic_weights();
+
     const Index biases_number = get_biases_number();
     const Index synaptic_weights_number = get_synaptic_weights_number();
 
@@ -573,12 +895,14 @@ void ProbabilisticLayer::insert_parameters(const Tensor<type, 1>& parameters, co
     copy(parameters.data() + biases_number,
          parameters.data() + biases_number + synaptic_weights_number,
          synaptic_weights.data());
+
+    discard_synaptic_weights_copies();
 }
 
 
 void ProbabilisticLayer::calculate_combinations(type* inputs_data, const Tensor<Index, 1>& inputs_dimensions,
-                                            const Tensor<type, 2>& biases,
-                                            const Tensor<type, 2>& synaptic_weights,
+                                            const TensorMap<Tensor<type, 2>>& biases,
+                                            const TensorMap<Tensor<type, 2>>& synaptic_weights,
                                             type* outputs_data, const Tensor<Index, 1> &outputs_dimensions) const
 {
     const Index batch_samples_number = inputs_dimensions(0);
@@ -596,17 +920,12 @@ void ProbabilisticLayer::calculate_combinations(type* inputs_data, const Tensor<
         throw invalid_argument(buffer.str());
     }
 
-    const TensorMap<Tensor<type, 2>> inputs(inputs_data, inputs_dimensions(0), inputs_dimensions(1));
-    TensorMap<Tensor<type, 2>> combinations(outputs_data, batch_samples_number, biases_number);
-
-    Tensor<type, 2> biases_matrix(batch_samples_number, biases_number);
-
-    for(Index i = 0; i < biases_number; i++)
-    {
-        fill_n(biases_matrix.data() + i*batch_samples_number, batch_samples_number, biases(i));
-    }
-
-    combinations.device(*thread_pool_device) = biases_matrix + inputs.contract(synaptic_weights, A_B);
+    calculate_fused_combinations(inputs_data, batch_samples_number, inputs_dimensions(1),
+                                 synaptic_weights.data(), biases_number,
+                                 biases.data(),
+                                 outputs_data,
+                                 outputs_data,
+                                 nullptr);
 }
 
 
@@ -737,6 +1056,15 @@ void ProbabilisticLayer::forward_propagate(type* inputs_data,
     }
 #endif
 
+    // Training needs the single precision synaptic weights, which are restored once if they were released.
+    // The shards of a batch can be forward propagated at the same time, so the restoration is a critical section.
+
+    if(switch_train)
+    {
+        #pragma omp critical(restore_synaptic_weights)
+        restore_synaptic_weights();
+    }
+
     ProbabilisticLayerForwardPropagation* perceptron_layer_forward_propagation
             = static_cast<ProbabilisticLayerForwardPropagation*>(forward_propagation);
 
@@ -744,6 +1072,75 @@ void ProbabilisticLayer::forward_propagate(type* inputs_data,
     const Tensor<Index, 1> activations_dimensions = perceptron_layer_forward_propagation->outputs_dimensions;
     const Tensor<Index, 1> derivatives_dimensions = get_dimensions(perceptron_layer_forward_propagation->activations_derivatives);
 
+    if(!switch_train && is_quantized())
+    {
+        Tensor<int8_t, 2>& quantized_inputs = perceptron_layer_forward_propagation->quantized_inputs;
+
+        if(quantized_inputs.size() != inputs_dimensions(0)*inputs_dimensions(1))
+        {
+            quantized_inputs.resize(inputs_dimensions(1), inputs_dimensions(0));
+        }
+
+        const FusedActivation fused_activation
+                = activation_function == ActivationFunction::Logistic ? logistic_fused : nullptr;
+
+        calculate_quantized_combinations(inputs_data, inputs_dimensions(0), inputs_dimensions(1),
+                                         quantized_synaptic_weights.data(), synaptic_weights_scales.data(), get_neurons_number(),
+                                         inputs_scale,
+                                         biases.data(),
+                                         quantized_inputs.data(),
+                                         perceptron_layer_forward_propagation->combinations.data(),
+                                         perceptron_layer_forward_propagation->outputs_data,
+                                         fused_activation);
+
+        if(fused_activation == nullptr)
+        {
+            calculate_activations(perceptron_layer_forward_propagation->combinations.data(),
+                                  combinations_dimensions,
+                                  perceptron_layer_forward_propagation->outputs_data,
+                                  activations_dimensions);
+        }
+
+        return;
+    }
+
+    if(!switch_train && is_half_precision())
+    {
+        const FusedActivation fused_activation
+                = activation_function == ActivationFunction::Logistic ? logistic_fused : nullptr;
+
+        calculate_half_combinations(inputs_data, inputs_dimensions(0), inputs_dimensions(1),
+                                    half_synaptic_weights.data(), get_neurons_number(),
+                                    biases.data(),
+                                    perceptron_layer_forward_propagation->combinations.data(),
+                                    perceptron_layer_forward_propagation->outputs_data,
+                                    fused_activation);
+
+        if(fused_activation == nullptr)
+        {
+            calculate_activations(perceptron_layer_forward_propagation->combinations.data(),
+                                  combinations_dimensions,
+                                  perceptron_layer_forward_propagation->outputs_data,
+                                  activations_dimensions);
+        }
+
+        return;
+    }
+
+    // The logistic activation is element-wise, so it is fused with the combinations
+
+    if(activation_function == ActivationFunction::Logistic)
+    {
+        calculate_fused_combinations(inputs_data, inputs_dimensions(0), inputs_dimensions(1),
+                                     synaptic_weights.data(), get_neurons_number(),
+                                     biases.data(),
+                                     perceptron_layer_forward_propagation->combinations.data(),
+                                     perceptron_layer_forward_propagation->outputs_data,
+                                     switch_train ? perceptron_layer_forward_propagation->activations_derivatives.data() : nullptr,
+                                     logistic_fused);
+        return;
+    }
+
     calculate_combinations(inputs_data,
                            inputs_dimensions,
                            biases,
@@ -897,6 +1294,10 @@ void ProbabilisticLayer::insert_gradient(LayerBackPropagation* back_propagation,
     const ProbabilisticLayerBackPropagation* probabilistic_layer_back_propagation =
             static_cast<ProbabilisticLayerBackPropagation*>(back_propagation);
 
+    // Nothing to copy if the gradient is written directly into its final place
+
+    if(probabilistic_layer_back_propagation->biases_derivatives.data() == gradient.data() + index) return;
+
     copy(probabilistic_layer_back_propagation->biases_derivatives.data(),
          probabilistic_layer_back_propagation->biases_derivatives.data() + biases_number,
          gradient.data() + index);
@@ -998,6 +1399,15 @@ void ProbabilisticLayer::insert_squared_errors_Jacobian_lm(LayerBackPropagationL
 /// See the OpenNN manual for more information about the format of this document.
 
 void ProbabilisticLayer::write_XML(tinyxml2::XMLPrinter& file_stream) const
+{
+    write_XML(file_stream, true);
+}
+
+
+/// Serializes the probabilistic layer, leaving the parameters element empty if the parameters are written apart.
+/// @param write_parameters True to write the values of the parameters, false otherwise.
+
+void ProbabilisticLayer::write_XML(tinyxml2::XMLPrinter& file_stream, const bool& write_parameters) const
 {
     ostringstream buffer;
 
@@ -1039,19 +1449,22 @@ void ProbabilisticLayer::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     file_stream.OpenElement("Parameters");
 
-    buffer.str("");
+    if(write_parameters)
+    {
+        buffer.str("");
 
-    const Tensor<type, 1> parameters = get_parameters();
-    const Index parameters_size = parameters.size();
+        const Tensor<type, 1> parameters = get_parameters();
+        const Index parameters_size = parameters.size();
 
-    for(Index i = 0; i < parameters_size; i++)
-    {
-        buffer << parameters(i);
+        for(Index i = 0; i < parameters_size; i++)
+        {
+            buffer << parameters(i);
 
-        if(i != (parameters_size-1)) buffer << " ";
-    }
+            if(i != (parameters_size-1)) buffer << " ";
+        }
 
-    file_stream.PushText(buffer.str().c_str());
+        file_stream.PushText(buffer.str().c_str());
+    }
 
     file_stream.CloseElement();
 
@@ -1066,6 +1479,13 @@ void ProbabilisticLayer::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     file_stream.CloseElement();
 
+    // Quantization
+
+    if(is_quantized())
+    {
+        write_quantization_XML(file_stream, inputs_scale, synaptic_weights_scales, quantized_synaptic_weights);
+    }
+
     // Probabilistic layer (end tag)
 
     file_stream.CloseElement();
@@ -1172,6 +1592,21 @@ void ProbabilisticLayer::from_XML(const tinyxml2::XMLDocument& document)
         set_parameters(to_type_vector(parameters_string, ' '));
     }
 
+    // Quantization
+
+    const tinyxml2::XMLElement* quantization_element = probabilistic_layer_element->FirstChildElement("Quantization");
+
+    if(quantization_element)
+    {
+        quantized_synaptic_weights.resize(get_inputs_number(), get_neurons_number());
+
+        quantization_from_XML(quantization_element, inputs_scale, synaptic_weights_scales, quantized_synaptic_weights);
+    }
+    else
+    {
+        dequantize();
+    }
+
     // Decision threshold
 
     const tinyxml2::XMLElement* decision_threshold_element = probabilistic_layer_element->FirstChildElement("DecisionThreshold");
@@ -1302,13 +1737,19 @@ string ProbabilisticLayer::write_combinations(const Tensor<string, 1>& inputs_na
     const Index inputs_number = get_inputs_number();
     const Index neurons_number = get_neurons_number();
 
+    // The synaptic weights are taken from the parameters, as they might be released
+
+    const Tensor<type, 1> parameters = get_parameters();
+
+    const TensorMap<const Tensor<type, 2>> synaptic_weights_values(parameters.data() + neurons_number, inputs_number, neurons_number);
+
     for(Index i = 0; i < neurons_number; i++)
     {
         buffer << "probabilistic_layer_combinations_" << to_string(i) << " = " << biases(i);
 
         for(Index j = 0; j < inputs_number; j++)
         {
-            buffer << " +" << synaptic_weights(j, i) << "*" << inputs_names(j) << "";
+            buffer << " +" << synaptic_weights_values(j, i) << "*" << inputs_names(j) << "";
         }
 
         buffer << " " << endl;
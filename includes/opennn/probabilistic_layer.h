@@ -17,6 +17,7 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <new>
 
 // OpenNN includes
 
@@ -57,6 +58,11 @@ public:
 
    explicit ProbabilisticLayer(const Index&, const Index&);
 
+   /// The biases and synaptic weights map the parameters storage or the network parameters buffer, which a copy would share.
+
+   ProbabilisticLayer(const ProbabilisticLayer&) = delete;
+   ProbabilisticLayer& operator=(const ProbabilisticLayer&) = delete;
+
    // Enumerations
 
    /// Enumeration of the available methods for interpreting variables as probabilities.
@@ -94,6 +100,11 @@ public:
    void set_parameters(const Tensor<type, 1>&, const Index& index=0) final;
    void set_decision_threshold(const type&);
 
+   bool can_bind_parameters() const final;
+   void bind_parameters(type*) final;
+   void unbind_parameters() final;
+   const type* get_parameters_data() const final;
+
    void set_activation_function(const ActivationFunction&);
    void set_activation_function(const string&);
 
@@ -101,8 +112,8 @@ public:
 
    // Parameters
 
-   const Tensor<type, 2>& get_biases() const;
-   const Tensor<type, 2>& get_synaptic_weights() const;
+   const TensorMap<Tensor<type, 2>>& get_biases() const;
+   const TensorMap<Tensor<type, 2>>& get_synaptic_weights() const;
 
    Tensor<type, 2> get_biases(Tensor<type, 1>&) const;
    Tensor<type, 2> get_synaptic_weights(Tensor<type, 1>&) const;   
@@ -112,6 +123,22 @@ public:
 
    Tensor< TensorMap< Tensor<type, 1>>*, 1> get_layer_parameters() final;
 
+   // Quantization
+
+   bool is_quantized() const;
+
+   void quantize(const type&);
+   void dequantize();
+
+   // Half precision
+
+   bool is_half_precision() const;
+
+   void set_half_precision(const bool&);
+
+   void release_synaptic_weights();
+   void restore_synaptic_weights();
+
    // Display messages
 
    void set_display(const bool&);
@@ -131,8 +158,8 @@ public:
    // Combinations
 
    void calculate_combinations(type*, const Tensor<Index,1>&,
-                               const Tensor<type, 2>&,
-                               const Tensor<type, 2>&,
+                               const TensorMap<Tensor<type, 2>>&,
+                               const TensorMap<Tensor<type, 2>>&,
                                type*, const Tensor<Index,1>&) const;
 
    // Activations
@@ -190,18 +217,31 @@ public:
    void from_XML(const tinyxml2::XMLDocument&) final;
 
    void write_XML(tinyxml2::XMLPrinter&) const final;
+   void write_XML(tinyxml2::XMLPrinter&, const bool&) const final;
 
 
 protected:
 
+   void set_parameters_dimensions(const Index&, const Index&);
+
+   void resize_parameters(const Index&, const Index&);
+
+   void discard_synaptic_weights_copies();
+
+   void set_parameters_pointers(type*, const Index&, const Index&);
+
+   /// Memory of the biases and synaptic weights when they are not bound to an external buffer.
+
+   Tensor<type, 1> parameters_storage;
+
    /// Bias is a neuron parameter that is summed with the neuron's weighted inputs
    /// and passed through the neuron's trabsfer function to generate the neuron's output.
 
-   Tensor<type, 2> biases;
+   TensorMap<Tensor<type, 2>> biases = TensorMap<Tensor<type, 2>>(nullptr, 0, 0);
 
    /// This matrix contains conection strengths from a layer's inputs to its neurons.
 
-   Tensor<type, 2> synaptic_weights;
+   TensorMap<Tensor<type, 2>> synaptic_weights = TensorMap<Tensor<type, 2>>(nullptr, 0, 0);
 
    /// Activation function variable.
 
@@ -209,6 +249,26 @@ protected:
 
    type decision_threshold;
 
+   /// Synaptic weights quantized to 8 bits for inference, with one scale per neuron.
+
+   Tensor<int8_t, 2> quantized_synaptic_weights;
+
+   Tensor<type, 1> synaptic_weights_scales;
+
+   /// Scale of the inputs in quantized inference. It is zero if the layer is not quantized.
+
+   type inputs_scale = type(0);
+
+   /// Synaptic weights stored in half precision for inference. It is empty in single precision.
+   /// After release_synaptic_weights(), it is the only copy of the synaptic weights.
+
+   Tensor<half_float::half, 2> half_synaptic_weights;
+
+   /// True after release_synaptic_weights(), when the single precision synaptic weights are empty
+   /// and the half precision copy holds them.
+
+   bool synaptic_weights_released = false;
+
    /// Display messages to screen.
 
    bool display = true;
@@ -285,6 +345,10 @@ struct ProbabilisticLayerForwardPropagation : LayerForwardPropagation
 
     Tensor<type, 2> combinations;
     Tensor<type, 3> activations_derivatives;
+
+    /// Inputs quantized to 8 bits, sample by sample. Only used by quantized layers.
+
+    Tensor<int8_t, 2> quantized_inputs;
 };
 
 
@@ -368,15 +432,36 @@ struct ProbabilisticLayerBackPropagation : LayerBackPropagation
         //delete deltas_data;
         deltas_data = (type*)malloc( static_cast<size_t>(batch_samples_number*neurons_number*sizeof(type)));
 
-        biases_derivatives.resize(neurons_number);
+        gradient_storage.resize(neurons_number + inputs_number*neurons_number);
 
-        synaptic_weights_derivatives.resize(inputs_number, neurons_number);
+        set_gradient_pointers(gradient_storage.data());
 
         delta_row.resize(neurons_number);
 
         error_combinations_derivatives.resize(batch_samples_number, neurons_number);
     }
 
+
+    bool bind_gradient(type* new_gradient_data) final
+    {
+        set_gradient_pointers(new_gradient_data);
+
+        gradient_storage.resize(0);
+
+        return true;
+    }
+
+
+    void set_gradient_pointers(type* new_gradient_data)
+    {
+        const Index neurons_number = layer_pointer->get_neurons_number();
+        const Index inputs_number = layer_pointer->get_inputs_number();
+
+        new (&biases_derivatives) TensorMap<Tensor<type, 1>>(new_gradient_data, neurons_number);
+
+        new (&synaptic_weights_derivatives) TensorMap<Tensor<type, 2>>(new_gradient_data + neurons_number, inputs_number, neurons_number);
+    }
+
     Tensor< TensorMap< Tensor<type, 1> >*, 1> get_layer_gradient()
     {
         Tensor< TensorMap< Tensor<type, 1> >*, 1> layer_gradient(2);
@@ -406,8 +491,10 @@ struct ProbabilisticLayerBackPropagation : LayerBackPropagation
 
     Tensor<type, 2> error_combinations_derivatives;
 
-    Tensor<type, 2> synaptic_weights_derivatives;
-    Tensor<type, 1> biases_derivatives;
+    Tensor<type, 1> gradient_storage;
+
+    TensorMap<Tensor<type, 2>> synaptic_weights_derivatives = TensorMap<Tensor<type, 2>>(nullptr, 0, 0);
+    TensorMap<Tensor<type, 1>> biases_derivatives = TensorMap<Tensor<type, 1>>(nullptr, 0);
 };
 
 }
@@ -72,6 +72,9 @@ string QuasiNewtonMethod::write_inverse_hessian_approximation_method() const
     case InverseHessianApproximationMethod::BFGS:
         return "BFGS";
 
+    case InverseHessianApproximationMethod::LBFGS:
+        return "LBFGS";
+
     default:
         ostringstream buffer;
 
@@ -84,6 +87,14 @@ string QuasiNewtonMethod::write_inverse_hessian_approximation_method() const
 }
 
 
+/// Returns the number of (s, y) pairs stored by the limited memory BFGS method.
+
+const Index& QuasiNewtonMethod::get_limited_memory_size() const
+{
+    return limited_memory_size;
+}
+
+
 const Index& QuasiNewtonMethod::get_epochs_number() const
 {
     return epochs_number;
@@ -131,6 +142,14 @@ const type& QuasiNewtonMethod::get_maximum_time() const
 }
 
 
+/// Returns the number of shards of the training batch whose gradients are calculated concurrently.
+
+const Index& QuasiNewtonMethod::get_shards_number() const
+{
+    return shards_number;
+}
+
+
 /// Sets a pointer to a loss index object to be associated with the quasi-Newton method object.
 /// It also sets that loss index to the learning rate algorithm.
 /// @param new_loss_index_pointer Pointer to a loss index object.
@@ -158,6 +177,7 @@ void QuasiNewtonMethod::set_inverse_hessian_approximation_method(
 /// <ul>
 /// <li> "DFP"
 /// <li> "BFGS"
+/// <li> "LBFGS"
 /// </ul>
 /// @param new_inverse_hessian_approximation_method_name Name of inverse hessian approximation method.
 
@@ -171,6 +191,10 @@ void QuasiNewtonMethod::set_inverse_hessian_approximation_method(const string& n
     {
         inverse_hessian_approximation_method = InverseHessianApproximationMethod::BFGS;
     }
+    else if(new_inverse_hessian_approximation_method_name == "LBFGS")
+    {
+        inverse_hessian_approximation_method = InverseHessianApproximationMethod::LBFGS;
+    }
     else
     {
         ostringstream buffer;
@@ -184,6 +208,26 @@ void QuasiNewtonMethod::set_inverse_hessian_approximation_method(const string& n
 }
 
 
+/// Sets the number of (s, y) pairs stored by the limited memory BFGS method.
+/// @param new_limited_memory_size History size, typically between 3 and 20.
+
+void QuasiNewtonMethod::set_limited_memory_size(const Index& new_limited_memory_size)
+{
+    if(new_limited_memory_size < 1)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: QuasiNewtonMethod class.\n"
+               << "void set_limited_memory_size(const Index&) method.\n"
+               << "Limited memory size must be greater than 0.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    limited_memory_size = new_limited_memory_size;
+}
+
+
 /// Sets a new display value.
 /// If it is set to true messages from this class are displayed on the screen;
 /// if it is set to false messages from this class are not displayed on the screen.
@@ -199,6 +243,8 @@ void QuasiNewtonMethod::set_default()
 {
     inverse_hessian_approximation_method = InverseHessianApproximationMethod::BFGS;
 
+    limited_memory_size = 10;
+
     learning_rate_algorithm.set_default();
 
     // Stopping criteria
@@ -210,6 +256,8 @@ void QuasiNewtonMethod::set_default()
     maximum_epochs_number = 1000;
     maximum_time = type(3600.0);
 
+    shards_number = 1;
+
     // UTILITIES
 
     display = true;
@@ -280,6 +328,30 @@ void QuasiNewtonMethod::set_maximum_time(const type& new_maximum_time)
 }
 
 
+/// Sets the number of shards of the training batch whose gradients are calculated concurrently.
+/// Each shard has its own batch, forward propagation and back-propagation,
+/// and the shards gradients are added into the training gradient.
+/// This only gives the same results as the whole batch for error terms that are sums over the samples,
+/// and it is not available for recurrent, long short-term memory or batch normalization layers.
+/// @param new_shards_number Number of shards. If it is one the whole training batch is back-propagated at once.
+
+void QuasiNewtonMethod::set_shards_number(const Index& new_shards_number)
+{
+    if(new_shards_number < 1)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: QuasiNewtonMethod class.\n"
+               << "void set_shards_number(const Index&) method.\n"
+               << "Number of shards must be greater than 0.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    shards_number = new_shards_number;
+}
+
+
 void QuasiNewtonMethod::initialize_inverse_hessian_approximation(QuasiNewtonMehtodData& optimization_data) const
 {
     optimization_data.inverse_hessian.setZero();
@@ -323,6 +395,118 @@ void QuasiNewtonMethod::calculate_inverse_hessian_approximation(QuasiNewtonMehto
 }
 
 
+/// Stores the last parameters and gradient differences in the limited memory BFGS history.
+/// Pairs with a non positive curvature are discarded, so that the approximation stays positive definite.
+/// When the history is full the oldest pair is overwritten.
+
+void QuasiNewtonMethod::update_LBFGS_history(QuasiNewtonMehtodData& optimization_data) const
+{
+    const Index parameters_number = optimization_data.parameters_difference.size();
+    const Index history_capacity = optimization_data.rho_history.size();
+
+    Tensor<type, 0> parameters_dot_gradient;
+
+    parameters_dot_gradient.device(*thread_pool_device)
+            = optimization_data.parameters_difference.contract(optimization_data.gradient_difference, AT_B);
+
+    if(parameters_dot_gradient(0) <= numeric_limits<type>::epsilon()) return;
+
+    Index index;
+
+    if(optimization_data.history_size < history_capacity)
+    {
+        index = (optimization_data.history_start + optimization_data.history_size)%history_capacity;
+
+        optimization_data.history_size++;
+    }
+    else
+    {
+        index = optimization_data.history_start;
+
+        optimization_data.history_start = (optimization_data.history_start + 1)%history_capacity;
+    }
+
+    TensorMap<Tensor<type, 1>> parameters_difference(optimization_data.parameters_differences_history.data() + index*parameters_number, parameters_number);
+    TensorMap<Tensor<type, 1>> gradient_difference(optimization_data.gradient_differences_history.data() + index*parameters_number, parameters_number);
+
+    parameters_difference = optimization_data.parameters_difference;
+    gradient_difference = optimization_data.gradient_difference;
+
+    optimization_data.rho_history(index) = type(1)/parameters_dot_gradient(0);
+}
+
+
+/// Calculates the limited memory BFGS training direction with the two-loop recursion.
+/// It only uses the stored (s, y) pairs, so it takes O(mP) time and memory instead of O(P^2).
+/// @param gradient Gradient at the current point.
+
+void QuasiNewtonMethod::calculate_LBFGS_training_direction(const Tensor<type, 1>& gradient,
+                                                           QuasiNewtonMehtodData& optimization_data) const
+{
+    const Index parameters_number = gradient.size();
+    const Index history_capacity = optimization_data.rho_history.size();
+    const Index history_size = optimization_data.history_size;
+
+    Tensor<type, 1>& direction = optimization_data.training_direction;
+
+    direction.device(*thread_pool_device) = gradient;
+
+    if(history_size == 0)
+    {
+        direction.device(*thread_pool_device) = -direction;
+        return;
+    }
+
+    Tensor<type, 0> product;
+
+    // First loop, from newest to oldest pair
+
+    for(Index i = history_size-1; i >= 0; i--)
+    {
+        const Index index = (optimization_data.history_start + i)%history_capacity;
+
+        const TensorMap<Tensor<type, 1>> parameters_difference(optimization_data.parameters_differences_history.data() + index*parameters_number, parameters_number);
+        const TensorMap<Tensor<type, 1>> gradient_difference(optimization_data.gradient_differences_history.data() + index*parameters_number, parameters_number);
+
+        product.device(*thread_pool_device) = parameters_difference.contract(direction, AT_B);
+
+        optimization_data.alpha(i) = optimization_data.rho_history(index)*product(0);
+
+        direction.device(*thread_pool_device) -= gradient_difference*optimization_data.alpha(i);
+    }
+
+    // Initial inverse hessian scaling from the newest pair
+
+    const Index newest_index = (optimization_data.history_start + history_size - 1)%history_capacity;
+
+    const TensorMap<Tensor<type, 1>> newest_gradient_difference(optimization_data.gradient_differences_history.data() + newest_index*parameters_number, parameters_number);
+
+    product.device(*thread_pool_device) = newest_gradient_difference.contract(newest_gradient_difference, AT_B);
+
+    const type gamma = type(1)/(optimization_data.rho_history(newest_index)*product(0));
+
+    direction.device(*thread_pool_device) = direction*gamma;
+
+    // Second loop, from oldest to newest pair
+
+    for(Index i = 0; i < history_size; i++)
+    {
+        const Index index = (optimization_data.history_start + i)%history_capacity;
+
+        const TensorMap<Tensor<type, 1>> parameters_difference(optimization_data.parameters_differences_history.data() + index*parameters_number, parameters_number);
+        const TensorMap<Tensor<type, 1>> gradient_difference(optimization_data.gradient_differences_history.data() + index*parameters_number, parameters_number);
+
+        product.device(*thread_pool_device) = gradient_difference.contract(direction, AT_B);
+
+        const type beta = optimization_data.rho_history(index)*product(0);
+
+        direction.device(*thread_pool_device) += parameters_difference*(optimization_data.alpha(i) - beta);
+    }
+
+    direction.device(*thread_pool_device) = -direction;
+}
+
+
 Tensor<type, 2> QuasiNewtonMethod::kronecker_product(Tensor<type, 1>& left_matrix, Tensor<type, 1>& right_matrix) const
 {
     // Transform Tensors into Dense matrix
@@ -491,19 +675,37 @@ void QuasiNewtonMethod::update_parameters(
 
     // Get training direction
 
-    if(optimization_data.epoch == 0
-    || is_zero(optimization_data.parameters_difference)
-    || is_zero(optimization_data.gradient_difference))
+    if(inverse_hessian_approximation_method == InverseHessianApproximationMethod::LBFGS)
     {
-        initialize_inverse_hessian_approximation(optimization_data);
+        if(optimization_data.epoch == 0)
+        {
+            optimization_data.history_size = 0;
+            optimization_data.history_start = 0;
+        }
+        else if(!is_zero(optimization_data.parameters_difference)
+             && !is_zero(optimization_data.gradient_difference))
+        {
+            update_LBFGS_history(optimization_data);
+        }
+
+        calculate_LBFGS_training_direction(back_propagation.gradient, optimization_data);
     }
     else
     {
-        calculate_inverse_hessian_approximation(optimization_data);
-    }
+        if(optimization_data.epoch == 0
+        || is_zero(optimization_data.parameters_difference)
+        || is_zero(optimization_data.gradient_difference))
+        {
+            initialize_inverse_hessian_approximation(optimization_data);
+        }
+        else
+        {
+            calculate_inverse_hessian_approximation(optimization_data);
+        }
 
-    optimization_data.training_direction.device(*thread_pool_device)
-            = -optimization_data.inverse_hessian.contract(back_propagation.gradient, A_B);
+        optimization_data.training_direction.device(*thread_pool_device)
+                = -optimization_data.inverse_hessian.contract(back_propagation.gradient, A_B);
+    }
 
     optimization_data.training_slope.device(*thread_pool_device)
             = back_propagation.gradient.contract(optimization_data.training_direction, AT_B);
@@ -566,7 +768,10 @@ void QuasiNewtonMethod::update_parameters(
 
     optimization_data.old_gradient = back_propagation.gradient;
 
-    optimization_data.old_inverse_hessian = optimization_data.inverse_hessian;
+    if(inverse_hessian_approximation_method != InverseHessianApproximationMethod::LBFGS)
+    {
+        optimization_data.old_inverse_hessian = optimization_data.inverse_hessian;
+    }
 
     optimization_data.old_learning_rate = optimization_data.learning_rate;
 
@@ -669,6 +874,13 @@ TrainingResults QuasiNewtonMethod::perform_training()
     LossIndexBackPropagation training_back_propagation(training_samples_number, loss_index_pointer);
     LossIndexBackPropagation selection_back_propagation(selection_samples_number, loss_index_pointer);
 
+    LossIndexShardedBackPropagation training_sharded_back_propagation;
+
+    if(shards_number > 1)
+    {
+        training_sharded_back_propagation.set(shards_number, training_samples_indices, loss_index_pointer);
+    }
+
     // Optimization algorithm
 
     bool stop_training = false;
@@ -694,13 +906,18 @@ TrainingResults QuasiNewtonMethod::perform_training()
 
         optimization_data.epoch = epoch;
 
-        // Neural network
+        // Neural network and loss index
 
-        neural_network_pointer->forward_propagate(training_batch, training_forward_propagation, switch_train);
-
-        // Loss index
+        if(shards_number > 1)
+        {
+            loss_index_pointer->back_propagate(training_sharded_back_propagation, training_back_propagation);
+        }
+        else
+        {
+            neural_network_pointer->forward_propagate(training_batch, training_forward_propagation, switch_train);
 
-        loss_index_pointer->back_propagate(training_batch, training_forward_propagation, training_back_propagation);
+            loss_index_pointer->back_propagate(training_batch, training_forward_propagation, training_back_propagation);
+        }
 
         results.training_error_history(epoch) = training_back_propagation.error;
 
@@ -782,6 +999,15 @@ TrainingResults QuasiNewtonMethod::perform_training()
             results.stopping_condition = OptimizationAlgorithm::StoppingCondition::MaximumTime;
         }
 
+        if(!stop_training && check_evaluation_rejection(epoch))
+        {
+            if(display) cout << "Epoch " << epoch << endl << "Training run rejected by the evaluation callback." << endl;
+
+            stop_training = true;
+
+            results.stopping_condition = StoppingCondition::EvaluationRejection;
+        }
+
         if(stop_training)
         {
             results.loss = training_back_propagation.loss;
@@ -867,6 +1093,17 @@ void QuasiNewtonMethod::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     file_stream.CloseElement();
 
+    // Limited memory size
+
+    file_stream.OpenElement("LimitedMemorySize");
+
+    buffer.str("");
+    buffer << limited_memory_size;
+
+    file_stream.PushText(buffer.str().c_str());
+
+    file_stream.CloseElement();
+
     // Learning rate algorithm
 
     learning_rate_algorithm.write_XML(file_stream);
@@ -926,6 +1163,17 @@ void QuasiNewtonMethod::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     file_stream.CloseElement();
 
+    // Shards number
+
+    file_stream.OpenElement("ShardsNumber");
+
+    buffer.str("");
+    buffer << shards_number;
+
+    file_stream.PushText(buffer.str().c_str());
+
+    file_stream.CloseElement();
+
     // Hardware use
 
     file_stream.OpenElement("HardwareUse");
@@ -945,7 +1193,7 @@ void QuasiNewtonMethod::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
 Tensor<string, 2> QuasiNewtonMethod::to_string_matrix() const
 {
-    Tensor<string, 2> labels_values(8, 2);
+    Tensor<string, 2> labels_values(9, 2);
 
     // Inverse hessian approximation method
 
@@ -987,6 +1235,11 @@ Tensor<string, 2> QuasiNewtonMethod::to_string_matrix() const
     labels_values(7,0) = "Maximum time";
     labels_values(7,1) = write_time(maximum_time);
 
+    // Limited memory size
+
+    labels_values(8,0) = "Limited memory size";
+    labels_values(8,1) = to_string(limited_memory_size);
+
     return labels_values;
 }
 
@@ -1025,6 +1278,25 @@ void QuasiNewtonMethod::from_XML(const tinyxml2::XMLDocument& document)
         }
     }
 
+    // Limited memory size
+    {
+        const tinyxml2::XMLElement* element = root_element->FirstChildElement("LimitedMemorySize");
+
+        if(element)
+        {
+            const Index new_limited_memory_size = static_cast<Index>(atoi(element->GetText()));
+
+            try
+            {
+                set_limited_memory_size(new_limited_memory_size);
+            }
+            catch(const invalid_argument& e)
+            {
+                cerr << e.what() << endl;
+            }
+        }
+    }
+
     // Learning rate algorithm
     {
         const tinyxml2::XMLElement* element = root_element->FirstChildElement("LearningRateAlgorithm");
@@ -1137,6 +1409,25 @@ void QuasiNewtonMethod::from_XML(const tinyxml2::XMLDocument& document)
         }
     }
 
+    // Shards number
+    {
+        const tinyxml2::XMLElement* element = root_element->FirstChildElement("ShardsNumber");
+
+        if(element)
+        {
+            const Index new_shards_number = static_cast<Index>(atoi(element->GetText()));
+
+            try
+            {
+                set_shards_number(new_shards_number);
+            }
+            catch(const invalid_argument& e)
+            {
+                cerr << e.what() << endl;
+            }
+        }
+    }
+
     // Hardware use
     {
         const tinyxml2::XMLElement* element = root_element->FirstChildElement("HardwareUse");
@@ -56,8 +56,9 @@ public:
    // Enumerations
 
    /// Enumeration of the available training operators for obtaining the approximation to the inverse hessian.
+   /// LBFGS does not store the inverse hessian, but only the last (s, y) pairs.
 
-   enum class InverseHessianApproximationMethod{DFP, BFGS};
+   enum class InverseHessianApproximationMethod{DFP, BFGS, LBFGS};
 
    // Constructors
 
@@ -73,6 +74,8 @@ public:
    const InverseHessianApproximationMethod& get_inverse_hessian_approximation_method() const;
    string write_inverse_hessian_approximation_method() const;
 
+   const Index& get_limited_memory_size() const;
+
    const Index& get_epochs_number() const;
 
    // Stopping criteria
@@ -85,6 +88,8 @@ public:
    const Index& get_maximum_epochs_number() const;
    const type& get_maximum_time() const;
 
+   const Index& get_shards_number() const;
+
    // Set methods
 
    void set_loss_index_pointer(LossIndex*) override;
@@ -92,6 +97,8 @@ public:
    void set_inverse_hessian_approximation_method(const InverseHessianApproximationMethod&);
    void set_inverse_hessian_approximation_method(const string&);
 
+   void set_limited_memory_size(const Index&);
+
    void set_display(const bool&) final;
 
    void set_default() final;
@@ -106,6 +113,8 @@ public:
    void set_maximum_epochs_number(const Index&);
    void set_maximum_time(const type&);
 
+   void set_shards_number(const Index&);
+
    // Training methods
 
    void calculate_DFP_inverse_hessian(QuasiNewtonMehtodData&) const;
@@ -115,6 +124,9 @@ public:
    void initialize_inverse_hessian_approximation(QuasiNewtonMehtodData&) const;
    void calculate_inverse_hessian_approximation(QuasiNewtonMehtodData&) const;
 
+   void update_LBFGS_history(QuasiNewtonMehtodData&) const;
+   void calculate_LBFGS_training_direction(const Tensor<type, 1>&, QuasiNewtonMehtodData&) const;
+
    Tensor<type, 2> kronecker_product(Tensor<type, 2>&, Tensor<type, 2>&) const;
    Tensor<type, 2> kronecker_product(Tensor<type, 1>&, Tensor<type, 1>&) const;
 
@@ -143,6 +155,10 @@ private:
 
    InverseHessianApproximationMethod inverse_hessian_approximation_method;
 
+   /// Number of (s, y) pairs kept by the limited memory BFGS method.
+
+   Index limited_memory_size = 10;
+
    type first_learning_rate = static_cast<type>(0.01);
 
    // Stopping criteria
@@ -167,6 +183,11 @@ private:
    /// Maximum training time. It is a stopping criterion.
 
    type maximum_time;
+
+   /// Number of shards of the training batch whose gradients are calculated concurrently.
+   /// If it is one the whole training batch is back-propagated at once.
+
+   Index shards_number = 1;
 };
 
 
@@ -211,17 +232,34 @@ struct QuasiNewtonMehtodData : public OptimizationAlgorithmData
 
         gradient_difference.resize(parameters_number);
 
-        inverse_hessian.resize(parameters_number, parameters_number);
-        inverse_hessian.setZero();
+        if(quasi_newton_method_pointer->get_inverse_hessian_approximation_method()
+        == QuasiNewtonMethod::InverseHessianApproximationMethod::LBFGS)
+        {
+            const Index limited_memory_size = quasi_newton_method_pointer->get_limited_memory_size();
 
-        old_inverse_hessian.resize(parameters_number, parameters_number);
-        old_inverse_hessian.setZero();
+            parameters_differences_history.resize(parameters_number, limited_memory_size);
+            gradient_differences_history.resize(parameters_number, limited_memory_size);
+
+            rho_history.resize(limited_memory_size);
+            alpha.resize(limited_memory_size);
+
+            history_size = 0;
+            history_start = 0;
+        }
+        else
+        {
+            inverse_hessian.resize(parameters_number, parameters_number);
+            inverse_hessian.setZero();
+
+            old_inverse_hessian.resize(parameters_number, parameters_number);
+            old_inverse_hessian.setZero();
+
+            old_inverse_hessian_dot_gradient_difference.resize(parameters_number);
+        }
 
         // Optimization algorithm data
 
         training_direction.resize(parameters_number);
-
-        old_inverse_hessian_dot_gradient_difference.resize(parameters_number);
     }
 
     virtual void print() const
@@ -256,6 +294,17 @@ struct QuasiNewtonMehtodData : public OptimizationAlgorithmData
 
     Tensor<type, 1> old_inverse_hessian_dot_gradient_difference;
 
+    // Limited memory BFGS data, one (s, y) pair per column in a circular buffer
+
+    Tensor<type, 2> parameters_differences_history;
+    Tensor<type, 2> gradient_differences_history;
+
+    Tensor<type, 1> rho_history;
+    Tensor<type, 1> alpha;
+
+    Index history_size = 0;
+    Index history_start = 0;
+
     // Optimization algorithm data
 
     Index epoch = 0;
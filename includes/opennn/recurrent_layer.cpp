@@ -541,7 +541,10 @@ void RecurrentLayer::set_recurrent_weights_constant(const type& value)
 
 void RecurrentLayer::set_input_weights_random()
 {
-    input_weights.setRandom();
+    for(Index i = 0; i < input_weights.size(); i++)
+    {
+        input_weights(i) = calculate_random_uniform();
+    }
 }
 
 
@@ -549,7 +552,10 @@ void RecurrentLayer::set_input_weights_random()
 
 void RecurrentLayer::set_recurrent_weights_random()
 {
-    recurrent_weights.setRandom();
+    for(Index i = 0; i < recurrent_weights.size(); i++)
+    {
+        recurrent_weights(i) = calculate_random_uniform();
+    }
 }
 
 
@@ -580,7 +586,7 @@ void RecurrentLayer::set_parameters_random()
 
     for(Index i = 0; i < biases.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
         biases(i) = minimum + (maximum - minimum)*random;
     }
@@ -589,7 +595,7 @@ void RecurrentLayer::set_parameters_random()
 
     for(Index i = 0; i < input_weights.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
         input_weights(i) = minimum + (maximum - minimum)*random;
     }
@@ -598,7 +604,7 @@ void RecurrentLayer::set_parameters_random()
 
     for(Index i = 0; i < recurrent_weights.size(); i++)
     {
-        const type random = static_cast<type>(rand()/(RAND_MAX+1.0));
+        const type random = calculate_random_uniform();
 
         recurrent_weights(i) = minimum + (maximum - minimum)*random;
     }
@@ -1001,7 +1007,7 @@ void RecurrentLayer::calculate_hidden_delta(PerceptronLayerForwardPropagation* n
                                             PerceptronLayerBackPropagation* next_back_propagation,
                                             RecurrentLayerBackPropagation* back_propagation) const
 {
-    const Tensor<type, 2>& next_synaptic_weights
+    const TensorMap<Tensor<type, 2>>& next_synaptic_weights
             = static_cast<PerceptronLayer*>(next_back_propagation->layer_pointer)->get_synaptic_weights();
 
     const TensorMap<Tensor<type, 2>> next_deltas(next_back_propagation->deltas_data, next_back_propagation->deltas_dimensions(0), next_back_propagation->deltas_dimensions(1));;
@@ -1018,7 +1024,7 @@ void RecurrentLayer::calculate_hidden_delta(ProbabilisticLayerForwardPropagation
 {
     const ProbabilisticLayer* probabilistic_layer_pointer = static_cast<ProbabilisticLayer*>(next_back_propagation->layer_pointer);
 
-    const Tensor<type, 2>& next_synaptic_weights = probabilistic_layer_pointer->get_synaptic_weights();
+    const TensorMap<Tensor<type, 2>>& next_synaptic_weights = probabilistic_layer_pointer->get_synaptic_weights();
 
     const TensorMap<Tensor<type, 2>> next_deltas(next_back_propagation->deltas_data, next_back_propagation->deltas_dimensions(0), next_back_propagation->deltas_dimensions(1));;
     TensorMap<Tensor<type, 2>> deltas(back_propagation->deltas_data, back_propagation->deltas_dimensions(0), back_propagation->deltas_dimensions(1));
@@ -1479,6 +1485,15 @@ void RecurrentLayer::from_XML(const tinyxml2::XMLDocument& document)
 
 
 void RecurrentLayer::write_XML(tinyxml2::XMLPrinter& file_stream) const
+{
+    write_XML(file_stream, true);
+}
+
+
+/// Serializes the recurrent layer, leaving the parameters element empty if the parameters are written apart.
+/// @param write_parameters True to write the values of the parameters, false otherwise.
+
+void RecurrentLayer::write_XML(tinyxml2::XMLPrinter& file_stream, const bool& write_parameters) const
 
 {
     ostringstream buffer;
@@ -1521,19 +1536,22 @@ void RecurrentLayer::write_XML(tinyxml2::XMLPrinter& file_stream) const
 
     file_stream.OpenElement("Parameters");
 
-    buffer.str("");
+    if(write_parameters)
+    {
+        buffer.str("");
 
-    const Tensor<type, 1> parameters = get_parameters();
-    const Index parameters_size = parameters.size();
+        const Tensor<type, 1> parameters = get_parameters();
+        const Index parameters_size = parameters.size();
 
-    for(Index i = 0; i < parameters_size; i++)
-    {
-        buffer << parameters(i);
+        for(Index i = 0; i < parameters_size; i++)
+        {
+            buffer << parameters(i);
 
-        if(i != (parameters_size-1)) buffer << " ";
-    }
+            if(i != (parameters_size-1)) buffer << " ";
+        }
 
-    file_stream.PushText(buffer.str().c_str());
+        file_stream.PushText(buffer.str().c_str());
+    }
 
     file_stream.CloseElement();
 
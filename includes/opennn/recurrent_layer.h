@@ -215,6 +215,7 @@ public:
    void from_XML(const tinyxml2::XMLDocument&) final;
 
    void write_XML(tinyxml2::XMLPrinter&) const final;
+   void write_XML(tinyxml2::XMLPrinter&, const bool&) const final;
 
 protected:
 
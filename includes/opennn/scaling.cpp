@@ -11,7 +11,7 @@
 namespace opennn
 {
 
-void scale_minimum_maximum_binary(Tensor<type, 2>& matrix,
+void scale_minimum_maximum_binary(TensorMap<Tensor<type, 2>>& matrix,
                                   const type& value_1,
                                   const type& value_2,
                                   const Index& column_index)
@@ -39,12 +39,20 @@ void scale_minimum_maximum_binary(Tensor<type, 2>& matrix,
 }
 
 
+void scale_minimum_maximum_binary(Tensor<type, 2>& matrix, const type& value_1, const type& value_2, const Index& column_index)
+{
+    TensorMap<Tensor<type, 2>> matrix_map(matrix.data(), matrix.dimension(0), matrix.dimension(1));
+
+    scale_minimum_maximum_binary(matrix_map, value_1, value_2, column_index);
+}
+
+
 /// Scales the given input variables with given mean and standard deviation values.
 /// It updates the input variable of the matrix matrix.
 /// @param column_descriptives vector of descriptives structures for the input variables.
 /// @param column_index Index of the input to be scaled.
 
-void scale_mean_standard_deviation(Tensor<type, 2>& matrix,
+void scale_mean_standard_deviation(TensorMap<Tensor<type, 2>>& matrix,
                                    const Index& column_index,
                                    const Descriptives& column_descriptives)
 {
@@ -63,12 +71,20 @@ void scale_mean_standard_deviation(Tensor<type, 2>& matrix,
 }
 
 
+void scale_mean_standard_deviation(Tensor<type, 2>& matrix, const Index& column_index, const Descriptives& column_descriptives)
+{
+    TensorMap<Tensor<type, 2>> matrix_map(matrix.data(), matrix.dimension(0), matrix.dimension(1));
+
+    scale_mean_standard_deviation(matrix_map, column_index, column_descriptives);
+}
+
+
 /// Scales the given input variables with given standard deviation values.
 /// It updates the input variable of the matrix matrix.
 /// @param inputs_statistics vector of descriptives structures for the input variables.
 /// @param column_index Index of the input to be scaled.
 
-void scale_standard_deviation(Tensor<type, 2>& matrix,
+void scale_standard_deviation(TensorMap<Tensor<type, 2>>& matrix,
                                      const Index& column_index,
                                      const Descriptives& column_descriptives)
 {
@@ -79,12 +95,20 @@ void scale_standard_deviation(Tensor<type, 2>& matrix,
 }
 
 
+void scale_standard_deviation(Tensor<type, 2>& matrix, const Index& column_index, const Descriptives& column_descriptives)
+{
+    TensorMap<Tensor<type, 2>> matrix_map(matrix.data(), matrix.dimension(0), matrix.dimension(1));
+
+    scale_standard_deviation(matrix_map, column_index, column_descriptives);
+}
+
+
 /// Scales the given input variable with given minimum and maximum values.
 /// It updates the input variables of the matrix matrix.
 /// @param column_descriptives vector with the descriptives of the input variable.
 /// @param column_index Index of the input to be scaled.
 
-void scale_minimum_maximum(Tensor<type, 2>& matrix,
+void scale_minimum_maximum(TensorMap<Tensor<type, 2>>& matrix,
                            const Index& column_index,
                            const Descriptives& column_descriptives,
                            const type& min_range, const type& max_range)
@@ -103,6 +127,14 @@ void scale_minimum_maximum(Tensor<type, 2>& matrix,
     }
 }
 
+
+void scale_minimum_maximum(Tensor<type, 2>& matrix, const Index& column_index, const Descriptives& column_descriptives, const type& min_range, const type& max_range)
+{
+    TensorMap<Tensor<type, 2>> matrix_map(matrix.data(), matrix.dimension(0), matrix.dimension(1));
+
+    scale_minimum_maximum(matrix_map, column_index, column_descriptives, min_range, max_range);
+}
+
 Tensor<type, 1> scale_minimum_maximum(const Tensor<type, 1>& x)
 {
     const Tensor<type, 0> minimum = x.minimum();
@@ -156,7 +188,7 @@ Tensor<type, 2> scale_minimum_maximum(const Tensor<type, 2>& x)
     return scaled_x;
 }
 
-void scale_logarithmic(Tensor<type, 2>& matrix, const Index& column_index)
+void scale_logarithmic(TensorMap<Tensor<type, 2>>& matrix, const Index& column_index)
 {
     type min_value = numeric_limits<type>::max();
 
@@ -191,12 +223,20 @@ void scale_logarithmic(Tensor<type, 2>& matrix, const Index& column_index)
 }
 
 
+void scale_logarithmic(Tensor<type, 2>& matrix, const Index& column_index)
+{
+    TensorMap<Tensor<type, 2>> matrix_map(matrix.data(), matrix.dimension(0), matrix.dimension(1));
+
+    scale_logarithmic(matrix_map, column_index);
+}
+
+
 /// Unscales the given input variable with given minimum and maximum values.
 /// It updates the input variables of the matrix matrix.
 /// @param column_descriptives vector with the descriptives of the input variable.
 /// @param column_index Index of the input to be scaled.
 
-void unscale_minimum_maximum(Tensor<type, 2>& matrix,
+void unscale_minimum_maximum(TensorMap<Tensor<type, 2>>& matrix,
                              const Index& column_index,
                              const Descriptives& column_descriptives,
                              const type& min_range, const type& max_range)
@@ -216,12 +256,20 @@ void unscale_minimum_maximum(Tensor<type, 2>& matrix,
 }
 
 
+void unscale_minimum_maximum(Tensor<type, 2>& matrix, const Index& column_index, const Descriptives& column_descriptives, const type& min_range, const type& max_range)
+{
+    TensorMap<Tensor<type, 2>> matrix_map(matrix.data(), matrix.dimension(0), matrix.dimension(1));
+
+    unscale_minimum_maximum(matrix_map, column_index, column_descriptives, min_range, max_range);
+}
+
+
 /// Uncales the given input variables with given mean and standard deviation values.
 /// It updates the input variable of the matrix matrix.
 /// @param column_descriptives vector of descriptives structures for the input variables.
 /// @param column_index Index of the input to be scaled.
 
-void unscale_mean_standard_deviation(Tensor<type, 2>& matrix, const Index& column_index, const Descriptives& column_descriptives)
+void unscale_mean_standard_deviation(TensorMap<Tensor<type, 2>>& matrix, const Index& column_index, const Descriptives& column_descriptives)
 {
     const type slope = abs(column_descriptives.standard_deviation) < static_cast<type>(1e-3)
             ? type(1)
@@ -238,12 +286,20 @@ void unscale_mean_standard_deviation(Tensor<type, 2>& matrix, const Index& colum
 }
 
 
+void unscale_mean_standard_deviation(Tensor<type, 2>& matrix, const Index& column_index, const Descriptives& column_descriptives)
+{
+    TensorMap<Tensor<type, 2>> matrix_map(matrix.data(), matrix.dimension(0), matrix.dimension(1));
+
+    unscale_mean_standard_deviation(matrix_map, column_index, column_descriptives);
+}
+
+
 /// Unscales the given input variables with given standard deviation values.
 /// It updates the input variable of the matrix matrix.
 /// @param inputs_statistics vector of descriptives structures for the input variables.
 /// @param column_index Index of the input to be scaled.
 
-void unscale_standard_deviation(Tensor<type, 2>& matrix, const Index& column_index, const Descriptives& column_descriptives)
+void unscale_standard_deviation(TensorMap<Tensor<type, 2>>& matrix, const Index& column_index, const Descriptives& column_descriptives)
 {
     const type slope = abs(column_descriptives.mean) < static_cast<type>(1e-3)
             ? type(0)
@@ -260,18 +316,34 @@ void unscale_standard_deviation(Tensor<type, 2>& matrix, const Index& column_ind
 }
 
 
+void unscale_standard_deviation(Tensor<type, 2>& matrix, const Index& column_index, const Descriptives& column_descriptives)
+{
+    TensorMap<Tensor<type, 2>> matrix_map(matrix.data(), matrix.dimension(0), matrix.dimension(1));
+
+    unscale_standard_deviation(matrix_map, column_index, column_descriptives);
+}
+
+
 /// Unscales the given input variables with given logarithmic values.
 /// It updates the input variable of the matrix matrix.
 /// @param inputs_statistics vector of descriptives structures for the input variables.
 /// @param column_index Index of the input to be scaled.
 
-void unscale_logarithmic(Tensor<type, 2>& matrix, const Index& column_index)
+void unscale_logarithmic(TensorMap<Tensor<type, 2>>& matrix, const Index& column_index)
 {
     for(Index i = 0; i < matrix.dimension(0); i++)
     {
         matrix(i, column_index) = exp(matrix(i, column_index));
     }
 }
+
+
+void unscale_logarithmic(Tensor<type, 2>& matrix, const Index& column_index)
+{
+    TensorMap<Tensor<type, 2>> matrix_map(matrix.data(), matrix.dimension(0), matrix.dimension(1));
+
+    unscale_logarithmic(matrix_map, column_index);
+}
 }
 
 
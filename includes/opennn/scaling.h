@@ -39,11 +39,22 @@ namespace opennn
     void scale_logarithmic(Tensor<type, 2>&, const Index&);
     void scale_minimum_maximum_binary(Tensor<type, 2>&, const type&, const type&, const Index&);
 
+    void scale_mean_standard_deviation(TensorMap<Tensor<type, 2>>&, const Index&, const Descriptives&);
+    void scale_standard_deviation(TensorMap<Tensor<type, 2>>&, const Index&, const Descriptives&);
+    void scale_minimum_maximum(TensorMap<Tensor<type, 2>>&, const Index&, const Descriptives&, const type& = type(-1), const type& = type(1));
+    void scale_logarithmic(TensorMap<Tensor<type, 2>>&, const Index&);
+    void scale_minimum_maximum_binary(TensorMap<Tensor<type, 2>>&, const type&, const type&, const Index&);
+
     void unscale_minimum_maximum(Tensor<type, 2>&, const Index&, const Descriptives&, const type& = type(-1), const type& = type(1));
     void unscale_mean_standard_deviation(Tensor<type, 2>&, const Index&, const Descriptives&);
     void unscale_standard_deviation(Tensor<type, 2>&, const Index&, const Descriptives&);
     void unscale_logarithmic(Tensor<type, 2>&, const Index&);
 
+    void unscale_minimum_maximum(TensorMap<Tensor<type, 2>>&, const Index&, const Descriptives&, const type& = type(-1), const type& = type(1));
+    void unscale_mean_standard_deviation(TensorMap<Tensor<type, 2>>&, const Index&, const Descriptives&);
+    void unscale_standard_deviation(TensorMap<Tensor<type, 2>>&, const Index&, const Descriptives&);
+    void unscale_logarithmic(TensorMap<Tensor<type, 2>>&, const Index&);
+
 }
 
 #endif // STATISTICS_H
@@ -316,6 +316,74 @@ Tensor<string, 1> ScalingLayer::write_scalers_text() const
     return scaling_methods_strings;
 }
 
+/// Returns true if every scaler is an affine function of its input (no scaling, minimum-maximum,
+/// mean-standard deviation or standard deviation), and false if some input is scaled with a logarithm.
+
+bool ScalingLayer::is_affine() const
+{
+    for(Index i = 0; i < scalers.size(); i++)
+    {
+        if(scalers(i) == Scaler::Logarithm) return false;
+    }
+
+    return true;
+}
+
+
+/// Returns the slopes and intercepts such that each scaled input is slope*input + intercept,
+/// with the same rules as forward_propagate.
+/// Inputs with zero standard deviation are not scaled.
+/// @param slopes Slopes of the inputs.
+/// @param intercepts Intercepts of the inputs.
+
+void ScalingLayer::get_affine_coefficients(Tensor<type, 1>& slopes, Tensor<type, 1>& intercepts) const
+{
+    const Index neurons_number = get_neurons_number();
+
+    slopes.resize(neurons_number);
+    intercepts.resize(neurons_number);
+
+    slopes.setConstant(type(1));
+    intercepts.setZero();
+
+    for(Index i = 0; i < neurons_number; i++)
+    {
+        if(abs(descriptives(i).standard_deviation) < type(NUMERIC_LIMITS_MIN)) continue;
+
+        switch(scalers(i))
+        {
+        case Scaler::NoScaling:
+            break;
+
+        case Scaler::MinimumMaximum:
+            slopes(i) = (max_range-min_range)/(descriptives(i).maximum-descriptives(i).minimum);
+            intercepts(i) = (min_range*descriptives(i).maximum-max_range*descriptives(i).minimum)/(descriptives(i).maximum-descriptives(i).minimum);
+            break;
+
+        case Scaler::MeanStandardDeviation:
+            slopes(i) = static_cast<type>(1)/descriptives(i).standard_deviation;
+            intercepts(i) = -descriptives(i).mean/descriptives(i).standard_deviation;
+            break;
+
+        case Scaler::StandardDeviation:
+            slopes(i) = static_cast<type>(1/descriptives(i).standard_deviation);
+            break;
+
+        default:
+        {
+            ostringstream buffer;
+
+            buffer << "OpenNN Exception: ScalingLayer class.\n"
+                   << "void get_affine_coefficients(Tensor<type, 1>&, Tensor<type, 1>&) const method.\n"
+                   << "Scaler of input " << i << " is not affine.\n";
+
+            throw invalid_argument(buffer.str());
+        }
+        }
+    }
+}
+
+
 // const bool& get_display() const method
 
 /// Returns true if messages from this class are displayed on the screen, or false if messages
@@ -77,6 +77,10 @@ public:
    Tensor<string, 1> write_scalers() const;
    Tensor<string, 1> write_scalers_text() const;
 
+   bool is_affine() const;
+
+   void get_affine_coefficients(Tensor<type, 1>&, Tensor<type, 1>&) const;
+
    // Display messages
 
    const bool& get_display() const;
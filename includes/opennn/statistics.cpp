@@ -757,7 +757,7 @@ Index maximum(const Tensor<Index, 1>& vector)
 /// @param rows_indices Indices of the rows for which the maximums are to be computed.
 /// @param columns_indices Indices of the columns for which the maximums are to be computed.
 
-Tensor<type, 1> columns_maximums(const Tensor<type, 2>& matrix,
+Tensor<type, 1> columns_maximums(const TensorMap<Tensor<type, 2>>& matrix,
                                  const Tensor<Index, 1>& rows_indices,
                                  const Tensor<Index, 1>& columns_indices)
 {
@@ -824,6 +824,14 @@ Tensor<type, 1> columns_maximums(const Tensor<type, 2>& matrix,
 }
 
 
+Tensor<type, 1> columns_maximums(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& rows_indices, const Tensor<Index, 1>& columns_indices)
+{
+    const TensorMap<Tensor<type, 2>> matrix_map(const_cast<type*>(matrix.data()), matrix.dimension(0), matrix.dimension(1));
+
+    return columns_maximums(matrix_map, rows_indices, columns_indices);
+}
+
+
 /// Returns the mean of the subvector defined by a start and end elements.
 /// @param vector Vector to be evaluated.
 /// @param begin Start element.
@@ -1835,7 +1843,7 @@ Tensor<Histogram, 1> histograms(const Tensor<type, 2>& matrix, const Index& bins
 /// The size of that vector is equal to the number of columns in this matrix.
 /// @param matrix Used matrix.
 
-Tensor<Descriptives, 1> descriptives(const Tensor<type, 2>& matrix)
+Tensor<Descriptives, 1> descriptives(const TensorMap<Tensor<type, 2>>& matrix)
 {
     const Index rows_number = matrix.dimension(0);
     const Index columns_number = matrix.dimension(1);
@@ -1873,13 +1881,21 @@ Tensor<Descriptives, 1> descriptives(const Tensor<type, 2>& matrix)
 }
 
 
+Tensor<Descriptives, 1> descriptives(const Tensor<type, 2>& matrix)
+{
+    const TensorMap<Tensor<type, 2>> matrix_map(const_cast<type*>(matrix.data()), matrix.dimension(0), matrix.dimension(1));
+
+    return descriptives(matrix_map);
+}
+
+
 /// Returns the basic descriptives of given columns for given rows.
 /// The format is a vector of descriptives structures.
 /// The size of that vector is equal to the number of given columns.
 /// @param row_indices Indices of the rows for which the descriptives are to be computed.
 /// @param columns_indices Indices of the columns for which the descriptives are to be computed.
 
-Tensor<Descriptives, 1> descriptives(const Tensor<type, 2>& matrix,
+Tensor<Descriptives, 1> descriptives(const TensorMap<Tensor<type, 2>>& matrix,
                                      const Tensor<Index, 1>& row_indices,
                                      const Tensor<Index, 1>& columns_indices)
 {
@@ -1967,6 +1983,14 @@ Tensor<Descriptives, 1> descriptives(const Tensor<type, 2>& matrix,
 }
 
 
+Tensor<Descriptives, 1> descriptives(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& row_indices, const Tensor<Index, 1>& columns_indices)
+{
+    const TensorMap<Tensor<type, 2>> matrix_map(const_cast<type*>(matrix.data()), matrix.dimension(0), matrix.dimension(1));
+
+    return descriptives(matrix_map, row_indices, columns_indices);
+}
+
+
 /// Returns the minimums values of given columns.
 /// The format is a vector of type values.
 /// The size of that vector is equal to the number of given columns.
@@ -1974,7 +1998,7 @@ Tensor<Descriptives, 1> descriptives(const Tensor<type, 2>& matrix,
 /// @param rows_indices Indices of the rows for which the minimums are to be computed.
 /// @param columns_indices Indices of the columns for which the minimums are to be computed.
 
-Tensor<type, 1> columns_minimums(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& rows_indices, const Tensor<Index, 1>& columns_indices)
+Tensor<type, 1> columns_minimums(const TensorMap<Tensor<type, 2>>& matrix, const Tensor<Index, 1>& rows_indices, const Tensor<Index, 1>& columns_indices)
 {
     const Index rows_number = matrix.dimension(0);
     const Index columns_number = matrix.dimension(1);
@@ -2039,6 +2063,14 @@ Tensor<type, 1> columns_minimums(const Tensor<type, 2>& matrix, const Tensor<Ind
 }
 
 
+Tensor<type, 1> columns_minimums(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& rows_indices, const Tensor<Index, 1>& columns_indices)
+{
+    const TensorMap<Tensor<type, 2>> matrix_map(const_cast<type*>(matrix.data()), matrix.dimension(0), matrix.dimension(1));
+
+    return columns_minimums(matrix_map, rows_indices, columns_indices);
+}
+
+
 /// Returns the maximums values of given columns.
 /// The format is a vector of type values.
 /// The size of that vector is equal to the number of given columns.
@@ -2275,7 +2307,7 @@ Tensor<type, 1> mean(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& colu
 /// @param row_indices Indices of rows.
 /// @param columns_indices Indices of columns.
 
-Tensor<type, 1> mean(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& row_indices, const Tensor<Index, 1>& columns_indices)
+Tensor<type, 1> mean(const TensorMap<Tensor<type, 2>>& matrix, const Tensor<Index, 1>& row_indices, const Tensor<Index, 1>& columns_indices)
 {
     const Index row_indices_size = row_indices.size();
     const Index columns_indices_size = columns_indices.size();
@@ -2393,6 +2425,14 @@ Tensor<type, 1> mean(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& row_
 }
 
 
+Tensor<type, 1> mean(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& row_indices, const Tensor<Index, 1>& columns_indices)
+{
+    const TensorMap<Tensor<type, 2>> matrix_map(const_cast<type*>(matrix.data()), matrix.dimension(0), matrix.dimension(1));
+
+    return mean(matrix_map, row_indices, columns_indices);
+}
+
+
 /// Returns a vector with the mean values of all the matrix columns.
 /// The size is equal to the number of columns in the matrix.
 
@@ -2619,7 +2659,7 @@ Tensor<type, 1> median(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& co
 /// @param row_indices Indices of rows.
 /// @param columns_indices Indices of columns.
 
-Tensor<type, 1> median(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& row_indices, const Tensor<Index, 1>& columns_indices)
+Tensor<type, 1> median(const TensorMap<Tensor<type, 2>>& matrix, const Tensor<Index, 1>& row_indices, const Tensor<Index, 1>& columns_indices)
 {
 
     const Index row_indices_size = row_indices.size();
@@ -2737,6 +2777,14 @@ Tensor<type, 1> median(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& ro
 }
 
 
+Tensor<type, 1> median(const Tensor<type, 2>& matrix, const Tensor<Index, 1>& row_indices, const Tensor<Index, 1>& columns_indices)
+{
+    const TensorMap<Tensor<type, 2>> matrix_map(const_cast<type*>(matrix.data()), matrix.dimension(0), matrix.dimension(1));
+
+    return median(matrix_map, row_indices, columns_indices);
+}
+
+
 /// Calculates the distance between the empirical distribution of the vector and the
 /// normal distribution.
 /// @param vector Vector to be evaluated.
@@ -208,6 +208,7 @@ struct Histogram
      Index minimum(const Tensor<Index, 1>&);
      type minimum(const Tensor<type, 2>&);
      Tensor<type, 1> columns_minimums(const Tensor<type, 2>&, const Tensor<Index, 1>& = Tensor<Index, 1>(), const Tensor<Index, 1>& = Tensor<Index, 1>());
+     Tensor<type, 1> columns_minimums(const TensorMap<Tensor<type, 2>>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&);
 
      // Maximum
 
@@ -216,6 +217,7 @@ struct Histogram
      Index maximum(const Tensor<Index, 1>&);
      type maximum(const Tensor<type, 2>&);
      Tensor<type, 1> columns_maximums(const Tensor<type, 2>&, const Tensor<Index, 1>& = Tensor<Index, 1>(), const Tensor<Index, 1>& = Tensor<Index, 1>());
+     Tensor<type, 1> columns_maximums(const TensorMap<Tensor<type, 2>>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&);
 
      // Range
      type range(const Tensor<type, 1>&);
@@ -227,6 +229,7 @@ struct Histogram
      Tensor<type, 1> mean(const Tensor<type, 2>&);
      Tensor<type, 1> mean(const Tensor<type, 2>&, const Tensor<Index, 1>&);
      Tensor<type, 1> mean(const Tensor<type, 2>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&);
+     Tensor<type, 1> mean(const TensorMap<Tensor<type, 2>>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&);
 
      // Median
      type median(const Tensor<type, 1>&);
@@ -234,6 +237,7 @@ struct Histogram
      Tensor<type, 1> median(const Tensor<type, 2>&);
      Tensor<type, 1> median(const Tensor<type, 2>&, const Tensor<Index, 1>&);
      Tensor<type, 1> median(const Tensor<type, 2>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&);
+     Tensor<type, 1> median(const TensorMap<Tensor<type, 2>>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&);
 
      // Variance
      type variance(const Tensor<type, 1>&);
@@ -264,6 +268,8 @@ struct Histogram
      // Descriptives matrix
      Tensor<Descriptives, 1> descriptives(const Tensor<type, 2>&);
      Tensor<Descriptives, 1> descriptives(const Tensor<type, 2>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&);
+     Tensor<Descriptives, 1> descriptives(const TensorMap<Tensor<type, 2>>&);
+     Tensor<Descriptives, 1> descriptives(const TensorMap<Tensor<type, 2>>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&);
 
      // Histograms
      Histogram histogram(const Tensor<type, 1>&, const Index&  = 10);
@@ -120,6 +120,24 @@ Index StochasticGradientDescent::get_batch_samples_number() const
 }
 
 
+/// Returns the number of batches filled ahead while the current one is propagated.
+
+const Index& StochasticGradientDescent::get_batch_prefetch_depth() const
+{
+    return batch_prefetch_depth;
+}
+
+
+/// Sets the number of batches filled ahead in a background thread while the current one is propagated.
+/// A value lower than 2 fills every batch synchronously. Default 2.
+/// @param new_batch_prefetch_depth New queue depth.
+
+void StochasticGradientDescent::set_batch_prefetch_depth(const Index& new_batch_prefetch_depth)
+{
+    batch_prefetch_depth = new_batch_prefetch_depth;
+}
+
+
 /// Set the initial value for the learning rate. If dacay is not active learning rate will be constant
 /// otherwise learning rate will decay over each update.
 /// @param new_initial_learning_rate initial learning rate value.
@@ -276,6 +294,14 @@ void StochasticGradientDescent::update_parameters(LossIndexBackPropagation& back
 {
     const type learning_rate = initial_learning_rate/(type(1) + type(optimization_data.iteration)*initial_decay);
 
+    // With a parameters arena the layers see the update in place
+
+    NeuralNetwork* neural_network_pointer = back_propagation.loss_index_pointer->get_neural_network_pointer();
+
+    Tensor<type, 1>& parameters = neural_network_pointer->has_parameters_arena()
+            ? neural_network_pointer->get_parameters_arena()
+            : back_propagation.parameters;
+
     optimization_data.parameters_increment.device(*thread_pool_device) = back_propagation.gradient*(-learning_rate);
 
     if(momentum > type(0))
@@ -284,16 +310,16 @@ void StochasticGradientDescent::update_parameters(LossIndexBackPropagation& back
 
         if(!nesterov)
         {
-            back_propagation.parameters.device(*thread_pool_device) += optimization_data.parameters_increment;
+            parameters.device(*thread_pool_device) += optimization_data.parameters_increment;
         }
         else
         {
-            back_propagation.parameters.device(*thread_pool_device) += optimization_data.parameters_increment*momentum - back_propagation.gradient*learning_rate;;
+            parameters.device(*thread_pool_device) += optimization_data.parameters_increment*momentum - back_propagation.gradient*learning_rate;;
         }
     }
     else
     {
-        back_propagation.parameters.device(*thread_pool_device) += optimization_data.parameters_increment;
+        parameters.device(*thread_pool_device) += optimization_data.parameters_increment;
     }
 
     optimization_data.last_parameters_increment = optimization_data.parameters_increment;
@@ -302,7 +328,7 @@ void StochasticGradientDescent::update_parameters(LossIndexBackPropagation& back
 
     // Update parameters
 
-    back_propagation.loss_index_pointer->get_neural_network_pointer()->set_parameters(back_propagation.parameters);
+    neural_network_pointer->set_parameters(parameters);
 }
 
 
@@ -356,8 +382,8 @@ TrainingResults StochasticGradientDescent::perform_training()
     const Tensor<Descriptives, 1> input_variables_descriptives = data_set_pointer->scale_input_variables();
     Tensor<Descriptives, 1> target_variables_descriptives;
 
-    DataSetBatch batch_training(batch_size_training, data_set_pointer);
-    DataSetBatch batch_selection(batch_size_selection, data_set_pointer);
+    DataSetBatchPrefetcher training_batches_prefetcher(batch_size_training, data_set_pointer, batch_prefetch_depth);
+    DataSetBatchPrefetcher selection_batches_prefetcher(batch_size_selection, data_set_pointer, batch_prefetch_depth);
 
     const Index training_batches_number = training_samples_number/batch_size_training;
     const Index selection_batches_number = selection_samples_number/batch_size_selection;
@@ -372,6 +398,11 @@ TrainingResults StochasticGradientDescent::perform_training()
     neural_network_pointer->set_inputs_names(inputs_names);
     neural_network_pointer->set_outputs_names(targets_names);
 
+    // Mostly zero inputs, such as word bags, are carried as sparse batches to the first perceptron layer
+
+    training_batches_prefetcher.set_sparse_inputs(neural_network_pointer->has_sparse_inputs_layer());
+    selection_batches_prefetcher.set_sparse_inputs(neural_network_pointer->has_sparse_inputs_layer());
+
     if(neural_network_pointer->has_scaling_layer())
     {
         ScalingLayer* scaling_layer_pointer = neural_network_pointer->get_scaling_layer_pointer();
@@ -415,7 +446,9 @@ TrainingResults StochasticGradientDescent::perform_training()
     time(&beginning_time);
     type elapsed_time = type(0);
 
-    bool shuffle = false;
+    // In streaming mode the batches are shuffled by windows of consecutive samples
+
+    bool shuffle = data_set_pointer->get_streaming();
 
     if(neural_network_pointer->has_long_short_term_memory_layer()
     || neural_network_pointer->has_recurrent_layer())
@@ -431,6 +464,8 @@ TrainingResults StochasticGradientDescent::perform_training()
 
         const Index batches_number = training_batches.dimension(0);
 
+        training_batches_prefetcher.start(training_batches, input_variables_indices, target_variables_indices);
+
         training_loss = type(0);
         training_error = type(0);
 
@@ -442,7 +477,7 @@ TrainingResults StochasticGradientDescent::perform_training()
 
             // Data set
 
-            batch_training.fill(training_batches.chip(iteration, 0), input_variables_indices, target_variables_indices);
+            DataSetBatch& batch_training = training_batches_prefetcher.next();
 
             // Neural network
 
@@ -472,13 +507,15 @@ TrainingResults StochasticGradientDescent::perform_training()
         {
             selection_batches = data_set_pointer->get_batches(selection_samples_indices, batch_size_selection, shuffle);
 
+            selection_batches_prefetcher.start(selection_batches, input_variables_indices, target_variables_indices);
+
             selection_error = type(0);
 
             for(Index iteration = 0; iteration < selection_batches_number; iteration++)
             {
                 // Data set
 
-                batch_selection.fill(selection_batches.chip(iteration,0), input_variables_indices, target_variables_indices);
+                DataSetBatch& batch_selection = selection_batches_prefetcher.next();
 
                 // Neural network
 
@@ -550,6 +587,15 @@ TrainingResults StochasticGradientDescent::perform_training()
             results.stopping_condition = StoppingCondition::MaximumSelectionErrorIncreases;
         }
 
+        if(!stop_training && check_evaluation_rejection(epoch))
+        {
+            if(display) cout << "Epoch " << epoch << endl << "Training run rejected by the evaluation callback." << endl;
+
+            stop_training = true;
+
+            results.stopping_condition = StoppingCondition::EvaluationRejection;
+        }
+
         if(stop_training)
         {
             results.loss = training_back_propagation.loss;
@@ -74,10 +74,14 @@ public:
        batch_samples_number = new_batch_samples_number;
    }
 
+   void set_batch_prefetch_depth(const Index&);
+
    // Get methods
 
    Index get_batch_samples_number() const;
 
+   const Index& get_batch_prefetch_depth() const;
+
    //Training operators
 
    void set_initial_learning_rate(const type&);
@@ -132,6 +136,10 @@ private:
 
    Index batch_samples_number = 1000;
 
+   /// Number of batches filled ahead in a background thread. Lower than 2 fills them synchronously.
+
+   Index batch_prefetch_depth = 2;
+
    // Stopping criteria
 
    /// Goal value for the loss. It is a stopping criterion.
@@ -174,6 +174,14 @@ void SumSquaredError::calculate_error_hessian_lm(const DataSetBatch&,
 }
 
 
+/// Returns the coefficient of the sum squared error, which does not depend on the number of samples.
+
+type SumSquaredError::calculate_error_coefficient(const Index&) const
+{
+    return type(1);
+}
+
+
 /// Returns a string with the name of the sum squared error loss type, "SUM_SQUARED_ERROR".
 
 string SumSquaredError::get_error_type() const
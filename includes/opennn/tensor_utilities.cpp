@@ -893,7 +893,41 @@ Tensor<type, 1> perform_Householder_QR_decomposition(const Tensor<type, 2>& A, c
 }
 
 
-void fill_submatrix(const Tensor<type, 2>& matrix,
+/// Solves the system (A + damping*I)x = b by means of a Cholesky decomposition of the symmetric matrix A.
+/// The factorization is done in place on the lower triangle of A, and A is restored from its strict upper
+/// triangle afterwards, so the same storage can be factorized again with other damping values.
+/// Returns false if the damped matrix is not positive definite.
+
+bool perform_damped_Cholesky_decomposition(Tensor<type, 2>& A, const type& damping, const Tensor<type, 1>& b, Tensor<type, 1>& x)
+{
+    const Index n = A.dimension(0);
+
+    Map<Matrix<type, Dynamic, Dynamic>> A_eigen(A.data(), n, n);
+    const Map<const Matrix<type, Dynamic, 1>> b_eigen(b.data(), n);
+    Map<Matrix<type, Dynamic, 1>> x_eigen(x.data(), n);
+
+    const Matrix<type, Dynamic, 1> diagonal = A_eigen.diagonal();
+
+    A_eigen.diagonal().array() += damping;
+
+    LLT<Ref<Matrix<type, Dynamic, Dynamic>>, Lower> llt(A_eigen);
+
+    const bool success = llt.info() == Success;
+
+    if(success) x_eigen = llt.solve(b_eigen);
+
+    #pragma omp parallel for
+    for(Index j = 0; j < n; j++)
+        for(Index i = j+1; i < n; i++)
+            A_eigen(i,j) = A_eigen(j,i);
+
+    A_eigen.diagonal() = diagonal;
+
+    return success;
+}
+
+
+void fill_submatrix(const TensorMap<Tensor<type, 2>>& matrix,
                     const Tensor<Index, 1>& rows_indices,
                     const Tensor<Index, 1>& columns_indices,
                     type* submatrix_pointer)
@@ -922,6 +956,17 @@ void fill_submatrix(const Tensor<type, 2>& matrix,
     }
 }
 
+
+void fill_submatrix(const Tensor<type, 2>& matrix,
+                    const Tensor<Index, 1>& rows_indices,
+                    const Tensor<Index, 1>& columns_indices,
+                    type* submatrix_pointer)
+{
+    const TensorMap<Tensor<type, 2>> matrix_map(const_cast<type*>(matrix.data()), matrix.dimension(0), matrix.dimension(1));
+
+    fill_submatrix(matrix_map, rows_indices, columns_indices, submatrix_pointer);
+}
+
 //void fill_submatrix(const Tensor<type, 2>& matrix,
 //    const Tensor<Index, 1>& rows_indices,
 //    const Tensor<Index, 1>& columns_indices,
@@ -948,7 +993,7 @@ Index count_NAN(const Tensor<type, 1>& x)
 }
 
 
-Index count_NAN(const Tensor<type, 2>& x)
+Index count_NAN(const TensorMap<Tensor<type, 2>>& x)
 {
     const Index rows_number = x.dimension(0);
     const Index columns_number = x.dimension(1);
@@ -969,6 +1014,14 @@ Index count_NAN(const Tensor<type, 2>& x)
 }
 
 
+Index count_NAN(const Tensor<type, 2>& x)
+{
+    const TensorMap<Tensor<type, 2>> x_map(const_cast<type*>(x.data()), x.dimension(0), x.dimension(1));
+
+    return count_NAN(x_map);
+}
+
+
 bool has_NAN(const Tensor<type, 1>& x)
 {
     for(Index i = 0; i < x.size(); i++)
@@ -102,11 +102,15 @@ void sum_diagonal(Tensor<type, 2>&, const type&);
 
 Tensor<type, 1> perform_Householder_QR_decomposition(const Tensor<type, 2>&, const Tensor<type, 1>&);
 
+bool perform_damped_Cholesky_decomposition(Tensor<type, 2>&, const type&, const Tensor<type, 1>&, Tensor<type, 1>&);
+
 void fill_submatrix(const Tensor<type, 2>&, const Tensor<Index, 1>& rows_indices, const Tensor<Index, 1>&, type*);
+void fill_submatrix(const TensorMap<Tensor<type, 2>>&, const Tensor<Index, 1>& rows_indices, const Tensor<Index, 1>&, type*);
 void fill_submatrix(const Tensor<type, 2>&, const Tensor<Index, 1>&, const Tensor<Index, 1>&, Tensor<type, 2>&);
 
 Index count_NAN(const Tensor<type, 1>&);
 Index count_NAN(const Tensor<type, 2>&);
+Index count_NAN(const TensorMap<Tensor<type, 2>>&);
 
 bool has_NAN(const Tensor<type, 1>&);
 bool has_NAN(Tensor<type, 2>&);
@@ -22,6 +22,7 @@
 // OpenNN includes
 
 #include "config.h"
+#include "thread_runtime.h"
 
 #include "correlations.h"
 #include "data_set.h"
@@ -336,7 +337,6 @@ public:
 
 private: 
 
-   ThreadPool* thread_pool = nullptr;
    ThreadPoolDevice* thread_pool_device = nullptr;
 
    /// Pointer to the neural network object to be tested. 
@@ -0,0 +1,276 @@
+//   OpenNN: Open Neural Networks Library
+//   www.opennn.net
+//
+//   T H R E A D   R U N T I M E   C L A S S
+//
+//   Artificial Intelligence Techniques SL
+//   artelnics@artelnics.com
+
+#include "thread_runtime.h"
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#elif defined(_WIN32)
+    #include <windows.h>
+#endif
+
+namespace opennn
+{
+
+/// Pins the calling thread to one CPU.
+/// It does nothing in the platforms without thread affinity support.
+/// @param cpu Index of the CPU.
+
+static void pin_current_thread(const int& cpu)
+{
+#if defined(__linux__)
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+
+#elif defined(_WIN32)
+
+    SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu);
+
+#endif
+}
+
+
+/// Returns the CPUs on which the process is allowed to run, in increasing order.
+/// They are all the CPUs of the machine in the platforms without thread affinity support.
+
+static vector<int> get_process_cpus()
+{
+    vector<int> cpus;
+
+#if defined(__linux__)
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+
+    if(sched_getaffinity(0, sizeof(cpu_set_t), &cpu_set) == 0)
+    {
+        for(int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if(CPU_ISSET(cpu, &cpu_set)) cpus.push_back(cpu);
+        }
+    }
+
+#elif defined(_WIN32)
+
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+
+    if(GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+    {
+        for(int cpu = 0; cpu < static_cast<int>(8*sizeof(DWORD_PTR)); cpu++)
+        {
+            if(process_mask & (static_cast<DWORD_PTR>(1) << cpu)) cpus.push_back(cpu);
+        }
+    }
+
+#endif
+
+    if(cpus.empty())
+    {
+        const int cpus_number = max(1, static_cast<int>(thread::hardware_concurrency()));
+
+        for(int cpu = 0; cpu < cpus_number; cpu++) cpus.push_back(cpu);
+    }
+
+    return cpus;
+}
+
+
+/// Creates a worker thread of the shared pool.
+/// If pinning is enabled, the threads are pinned to consecutive CPUs of the affinity mask of the process,
+/// so that they stay within the CPUs given by taskset or by a control group.
+/// @param function Worker loop of the thread.
+
+PinnedThreadEnvironment::EnvThread* PinnedThreadEnvironment::CreateThread(std::function<void()> function)
+{
+    if(!pin_threads) return new EnvThread(std::move(function));
+
+    const vector<int> cpus = get_process_cpus();
+
+    const int cpu = cpus[static_cast<size_t>(next_cpu)%cpus.size()];
+
+    next_cpu++;
+
+    return new EnvThread([cpu, function]()
+    {
+        pin_current_thread(cpu);
+
+        function();
+    });
+}
+
+
+/// Default constructor.
+/// The shared pool has as many threads as OpenMP uses by default.
+/// It is not created until the first thread pool device is requested.
+
+ThreadRuntime::ThreadRuntime()
+{
+    threads_number = max(1, omp_get_max_threads());
+}
+
+
+/// Returns the thread runtime of the process.
+
+ThreadRuntime& ThreadRuntime::get_instance()
+{
+    static ThreadRuntime thread_runtime;
+
+    return thread_runtime;
+}
+
+
+/// Returns the number of threads of the shared pool.
+
+int ThreadRuntime::get_threads_number() const
+{
+    lock_guard<mutex> lock(runtime_mutex);
+
+    return threads_number;
+}
+
+
+/// Returns true if the threads of the shared pool are pinned to CPUs, and false otherwise.
+
+bool ThreadRuntime::get_pin_threads() const
+{
+    lock_guard<mutex> lock(runtime_mutex);
+
+    return pin_threads;
+}
+
+
+/// Returns true if the shared pool has already been created, and false otherwise.
+
+bool ThreadRuntime::is_started() const
+{
+    lock_guard<mutex> lock(runtime_mutex);
+
+    return thread_pool != nullptr;
+}
+
+
+/// Returns the shared thread pool, creating it on first use.
+
+ThreadPoolInterface* ThreadRuntime::get_thread_pool()
+{
+    lock_guard<mutex> lock(runtime_mutex);
+
+    if(!thread_pool)
+    {
+        thread_pool.reset(new SharedThreadPool(threads_number, true, PinnedThreadEnvironment(pin_threads)));
+    }
+
+    return thread_pool.get();
+}
+
+
+/// Sets the number of threads of the shared pool.
+/// It must be called before any OpenNN object is created, because the pool cannot be resized once started.
+/// @param new_threads_number Number of threads of the shared pool.
+
+void ThreadRuntime::set_threads_number(const int& new_threads_number)
+{
+    lock_guard<mutex> lock(runtime_mutex);
+
+    if(new_threads_number < 1 || thread_pool)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: ThreadRuntime class.\n"
+               << "void set_threads_number(const int&) method.\n"
+               << (thread_pool ? "Thread pool is already started.\n" : "Number of threads must be greater than 0.\n");
+
+        throw invalid_argument(buffer.str());
+    }
+
+    threads_number = new_threads_number;
+}
+
+
+/// Sets whether the threads of the shared pool are pinned to consecutive CPUs among those the process may run on.
+/// It must be called before any OpenNN object is created.
+/// The threads of OpenMP are bound with the OMP_PROC_BIND and OMP_PLACES environment variables.
+/// @param new_pin_threads True to pin the threads.
+
+void ThreadRuntime::set_pin_threads(const bool& new_pin_threads)
+{
+    lock_guard<mutex> lock(runtime_mutex);
+
+    if(thread_pool)
+    {
+        ostringstream buffer;
+
+        buffer << "OpenNN Exception: ThreadRuntime class.\n"
+               << "void set_pin_threads(const bool&) method.\n"
+               << "Thread pool is already started.\n";
+
+        throw invalid_argument(buffer.str());
+    }
+
+    pin_threads = new_pin_threads;
+}
+
+
+/// Sets the thread budget of the calling thread.
+/// OpenMP parallel regions started afterwards from this thread use at most that number of threads.
+/// Each training job running in its own thread should set its budget, as well as the threads number of its objects.
+/// @param new_threads_number Number of threads of the budget. Zero or less means all the threads of the pool.
+
+void ThreadRuntime::set_thread_budget(const int& new_threads_number)
+{
+    omp_set_num_threads(get_budget_threads_number(new_threads_number));
+}
+
+
+/// Returns the number of threads of a budget, which is at least one and at most the number of threads of the pool.
+/// @param new_threads_number Number of threads requested. Zero or less means all the threads of the pool.
+
+int ThreadRuntime::get_budget_threads_number(const int& new_threads_number) const
+{
+    const int pool_threads_number = get_threads_number();
+
+    if(new_threads_number <= 0) return pool_threads_number;
+
+    return min(new_threads_number, pool_threads_number);
+}
+
+
+/// Returns a new thread pool device over the shared pool.
+/// The caller owns the device, but not the pool.
+/// @param new_threads_number Thread budget of the device. Zero or less means all the threads of the pool.
+
+ThreadPoolDevice* ThreadRuntime::new_thread_pool_device(const int& new_threads_number)
+{
+    return new ThreadPoolDevice(get_thread_pool(), get_budget_threads_number(new_threads_number));
+}
+
+}
+
+
+// OpenNN: Open Neural Networks Library.
+// Copyright(C) 2005-2022 Artificial Intelligence Techniques, SL.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
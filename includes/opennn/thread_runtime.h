@@ -0,0 +1,127 @@
+//   OpenNN: Open Neural Networks Library
+//   www.opennn.net
+//
+//   T H R E A D   R U N T I M E   C L A S S   H E A D E R
+//
+//   Artificial Intelligence Techniques SL
+//   artelnics@artelnics.com
+
+#ifndef THREADRUNTIME_H
+#define THREADRUNTIME_H
+
+// System includes
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// OpenNN includes
+
+#include "config.h"
+
+namespace opennn
+{
+
+/// Thread environment of the shared thread pool.
+/// It works as the standard Eigen environment, but it can pin every worker thread to one CPU.
+
+struct PinnedThreadEnvironment : public StlThreadEnvironment
+{
+    explicit PinnedThreadEnvironment(const bool& new_pin_threads = false) : pin_threads(new_pin_threads) {}
+
+    EnvThread* CreateThread(std::function<void()> function);
+
+    bool pin_threads = false;
+
+    int next_cpu = 0;
+};
+
+
+using SharedThreadPool = ThreadPoolTempl<PinnedThreadEnvironment>;
+
+
+/// This class owns the single thread pool that is shared by all the OpenNN objects of the process.
+/// Layers, loss indices, optimization algorithms, data sets and testing analyses do not create thread pools,
+/// but thread pool devices over the shared pool. The number of threads of a device is the budget of that object:
+/// its tensor expressions are split in that number of blocks, and all the blocks of all the objects run on the same threads.
+/// OpenMP parallel regions follow the budget set for the calling thread with set_thread_budget().
+
+class ThreadRuntime
+{
+
+public:
+
+    static ThreadRuntime& get_instance();
+
+    // Get methods
+
+    int get_threads_number() const;
+
+    bool get_pin_threads() const;
+
+    bool is_started() const;
+
+    ThreadPoolInterface* get_thread_pool();
+
+    // Set methods
+
+    void set_threads_number(const int&);
+
+    void set_pin_threads(const bool&);
+
+    void set_thread_budget(const int&);
+
+    // Thread budget methods
+
+    int get_budget_threads_number(const int&) const;
+
+    ThreadPoolDevice* new_thread_pool_device(const int& = 0);
+
+private:
+
+    explicit ThreadRuntime();
+
+    ThreadRuntime(const ThreadRuntime&) = delete;
+
+    ThreadRuntime& operator=(const ThreadRuntime&) = delete;
+
+    mutable mutex runtime_mutex;
+
+    /// Shared thread pool, created on first use.
+
+    unique_ptr<SharedThreadPool> thread_pool;
+
+    /// Number of threads of the shared pool.
+
+    int threads_number = 1;
+
+    /// True if the threads of the shared pool are pinned to CPUs.
+
+    bool pin_threads = false;
+};
+
+}
+
+#endif
+
+
+// OpenNN: Open Neural Networks Library.
+// Copyright(C) 2005-2022 Artificial Intelligence Techniques, SL.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
@@ -544,6 +544,25 @@ void TrainingStrategy::set_threads_number(const int& new_threads_number)
 }
 
 
+/// Seeds the random engines of the neural network and the data set from a single seed.
+/// This makes initial parameters, random samples splitting and batches shuffling reproducible,
+/// and independent from other training strategies running at the same time.
+/// The neural network parameters must be initialized again with set_parameters_random() to use the new seed.
+/// @param new_random_seed Seed for the training run.
+
+void TrainingStrategy::set_random_seed(const unsigned& new_random_seed)
+{
+    mt19937 seeds_engine(new_random_seed);
+
+    const unsigned neural_network_seed = static_cast<unsigned>(seeds_engine());
+    const unsigned data_set_seed = static_cast<unsigned>(seeds_engine());
+
+    if(neural_network_pointer != nullptr) neural_network_pointer->set_random_seed(neural_network_seed);
+
+    if(data_set_pointer != nullptr) data_set_pointer->set_random_seed(data_set_seed);
+}
+
+
 void TrainingStrategy::set_data_set_pointer(DataSet* new_data_set_pointer)
 {
     data_set_pointer = new_data_set_pointer;
@@ -693,6 +712,22 @@ void TrainingStrategy::set_maximum_time(const type&  maximum_time)
 }
 
 
+/// Sets the function which evaluates the neural network periodically during training, for all the optimization algorithms.
+/// @param new_evaluation_callback Function receiving the current epoch and returning false to reject the run.
+/// @param new_evaluation_period Number of epochs between evaluations. Zero disables the evaluation.
+
+void TrainingStrategy::set_evaluation_callback(const OptimizationAlgorithm::EvaluationCallback& new_evaluation_callback,
+                                               const Index& new_evaluation_period)
+{
+    gradient_descent.set_evaluation_callback(new_evaluation_callback, new_evaluation_period);
+    conjugate_gradient.set_evaluation_callback(new_evaluation_callback, new_evaluation_period);
+    stochastic_gradient_descent.set_evaluation_callback(new_evaluation_callback, new_evaluation_period);
+    adaptive_moment_estimation.set_evaluation_callback(new_evaluation_callback, new_evaluation_period);
+    quasi_Newton_method.set_evaluation_callback(new_evaluation_callback, new_evaluation_period);
+    Levenberg_Marquardt_algorithm.set_evaluation_callback(new_evaluation_callback, new_evaluation_period);
+}
+
+
 /// Sets the members of the training strategy object to their default values:
 /// <ul>
 /// <li> Display: true.
@@ -725,53 +760,67 @@ TrainingResults TrainingStrategy::perform_training()
 //        throw invalid_argument(buffer.str());
 //    }
 
+    TrainingResults training_results(0);
+
     switch(optimization_method)
     {
         case OptimizationMethod::GRADIENT_DESCENT:
         {
             gradient_descent.set_display(display);
 
-            return gradient_descent.perform_training();
+            training_results = gradient_descent.perform_training();
         }
+        break;
 
         case OptimizationMethod::CONJUGATE_GRADIENT:
         {
             conjugate_gradient.set_display(display);
 
-            return conjugate_gradient.perform_training();
+            training_results = conjugate_gradient.perform_training();
         }
+        break;
 
         case OptimizationMethod::QUASI_NEWTON_METHOD:
         {
             quasi_Newton_method.set_display(display);
 
-            return quasi_Newton_method.perform_training();
+            training_results = quasi_Newton_method.perform_training();
         }
+        break;
 
         case OptimizationMethod::LEVENBERG_MARQUARDT_ALGORITHM:
         {
             Levenberg_Marquardt_algorithm.set_display(display);
 
-            return Levenberg_Marquardt_algorithm.perform_training();
+            training_results = Levenberg_Marquardt_algorithm.perform_training();
         }
+        break;
 
         case OptimizationMethod::STOCHASTIC_GRADIENT_DESCENT:
         {
             stochastic_gradient_descent.set_display(display);
 
-            return stochastic_gradient_descent.perform_training();
+            training_results = stochastic_gradient_descent.perform_training();
         }
+        break;
 
         case OptimizationMethod::ADAPTIVE_MOMENT_ESTIMATION:
         {
             adaptive_moment_estimation.set_display(display);
 
-            return adaptive_moment_estimation.perform_training();
+            training_results = adaptive_moment_estimation.perform_training();
         }
+        break;
 
         default:
-            return TrainingResults(0);
+            break;
     }
+
+    // The optimizers update the single precision parameters, so the half precision copies are refreshed
+
+    if(neural_network_pointer->get_half_precision()) neural_network_pointer->set_half_precision(true);
+
+    return training_results;
 }
 
 
@@ -134,6 +134,8 @@ public:
 
     void set_threads_number(const int&);
 
+    void set_random_seed(const unsigned&);
+
     void set_data_set_pointer(DataSet*);
     void set_neural_network_pointer(NeuralNetwork*);
 
@@ -159,6 +161,8 @@ public:
 
     void set_maximum_time(const type&);
 
+    void set_evaluation_callback(const OptimizationAlgorithm::EvaluationCallback&, const Index&);
+
     // Training methods
 
     TrainingResults perform_training();
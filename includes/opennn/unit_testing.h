@@ -90,9 +90,7 @@ protected:
 
    bool display = true;
 
-   const int n = omp_get_max_threads();
-   ThreadPool* thread_pool = new ThreadPool(n);
-   ThreadPoolDevice* thread_pool_device = new ThreadPoolDevice(thread_pool, n);
+   ThreadPoolDevice* thread_pool_device = ThreadRuntime::get_instance().new_thread_pool_device();
 
 };
 
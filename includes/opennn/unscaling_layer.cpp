@@ -272,6 +272,73 @@ Tensor<string, 1> UnscalingLayer::write_unscaling_method_text() const
 }
 
 
+/// Returns true if every scaler is an affine function of its input, and false if some output is unscaled with an exponential.
+
+bool UnscalingLayer::is_affine() const
+{
+    for(Index i = 0; i < scalers.size(); i++)
+    {
+        if(scalers(i) == Scaler::Logarithm) return false;
+    }
+
+    return true;
+}
+
+
+/// Returns the slopes and intercepts such that each unscaled output is slope*input + intercept,
+/// with the same rules as forward_propagate.
+/// Outputs with zero standard deviation are not unscaled.
+/// @param slopes Slopes of the outputs.
+/// @param intercepts Intercepts of the outputs.
+
+void UnscalingLayer::get_affine_coefficients(Tensor<type, 1>& slopes, Tensor<type, 1>& intercepts) const
+{
+    const Index neurons_number = get_neurons_number();
+
+    slopes.resize(neurons_number);
+    intercepts.resize(neurons_number);
+
+    slopes.setConstant(type(1));
+    intercepts.setZero();
+
+    for(Index i = 0; i < neurons_number; i++)
+    {
+        if(abs(descriptives(i).standard_deviation) < type(NUMERIC_LIMITS_MIN)) continue;
+
+        switch(scalers(i))
+        {
+        case Scaler::NoScaling:
+            break;
+
+        case Scaler::MinimumMaximum:
+            slopes(i) = (descriptives(i).maximum-descriptives(i).minimum)/(max_range-min_range);
+            intercepts(i) = -(min_range*descriptives(i).maximum-max_range*descriptives(i).minimum)/(max_range-min_range);
+            break;
+
+        case Scaler::MeanStandardDeviation:
+            slopes(i) = descriptives(i).standard_deviation;
+            intercepts(i) = descriptives(i).mean;
+            break;
+
+        case Scaler::StandardDeviation:
+            slopes(i) = descriptives(i).standard_deviation;
+            break;
+
+        default:
+        {
+            ostringstream buffer;
+
+            buffer << "OpenNN Exception: UnscalingLayer class.\n"
+                   << "void get_affine_coefficients(Tensor<type, 1>&, Tensor<type, 1>&) const method.\n"
+                   << "Scaler of output " << i << " is not affine.\n";
+
+            throw invalid_argument(buffer.str());
+        }
+        }
+    }
+}
+
+
 /// Returns true if messages from this class are displayed on the screen, or false if messages
 /// from this class are not displayed on the screen.
 
@@ -63,6 +63,10 @@ public:
    Tensor<string, 1> write_unscaling_methods() const;
    Tensor<string, 1> write_unscaling_method_text() const;
 
+   bool is_affine() const;
+
+   void get_affine_coefficients(Tensor<type, 1>&, Tensor<type, 1>&) const;
+
    const bool& get_display() const;
 
    // Set methods
@@ -357,6 +357,17 @@ void WeightedSquaredError::calculate_error_hessian_lm(const DataSetBatch& batch,
 }
 
 
+/// Returns the coefficient of the weighted squared error for a given number of samples.
+/// @param samples_number Number of samples in the weighted sum of squared errors.
+
+type WeightedSquaredError::calculate_error_coefficient(const Index& samples_number) const
+{
+    const Index total_samples_number = data_set_pointer->get_samples_number();
+
+    return type(1)/((static_cast<type>(samples_number)/static_cast<type>(total_samples_number))*normalization_coefficient);
+}
+
+
 /// Returns a string with the name of the weighted squared error loss type, "WEIGHTED_SQUARED_ERROR".
 
 string WeightedSquaredError::get_error_type() const
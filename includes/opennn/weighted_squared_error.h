@@ -83,6 +83,8 @@ public:
                                NeuralNetworkForwardPropagation&,
                                LossIndexBackPropagation&) const final;
 
+   type calculate_error_coefficient(const Index&) const final;
+
    // Back propagation LM
 
    void calculate_squared_errors_lm(const DataSetBatch&,
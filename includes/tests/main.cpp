@@ -0,0 +1,38 @@
+//   OpenNN: Open Neural Networks Library
+//   www.opennn.net
+//
+//   T E S T S   A P P L I C A T I O N
+//
+//   Artificial Intelligence Techniques SL
+//   artelnics@artelnics.com
+
+#include "sparse_inputs_test.h"
+
+int main()
+{
+    cout << "OpenNN. Tests application.\n";
+
+    SparseInputsTest sparse_inputs_test;
+
+    sparse_inputs_test.print_results();
+
+    return sparse_inputs_test.get_tests_failed_count() == 0 ? 0 : 1;
+}
+
+
+// OpenNN: Open Neural Networks Library.
+// Copyright(C) 2005-2022 Artificial Intelligence Techniques, SL.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
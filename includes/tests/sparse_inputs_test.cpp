@@ -0,0 +1,281 @@
+//   OpenNN: Open Neural Networks Library
+//   www.opennn.net
+//
+//   S P A R S E   I N P U T S   T E S T   C L A S S
+//
+//   Artificial Intelligence Techniques SL
+//   artelnics@artelnics.com
+
+#include "sparse_inputs_test.h"
+
+
+SparseInputsTest::SparseInputsTest() : UnitTesting()
+{
+}
+
+
+SparseInputsTest::~SparseInputsTest()
+{
+}
+
+
+void SparseInputsTest::test_fill_sparse_inputs()
+{
+    cout << "test_fill_sparse_inputs\n";
+
+    DataSet data_set;
+
+    set_data_set(data_set, calculate_word_bags());
+
+    const Tensor<Index, 1> input_variables_indices = data_set.get_input_variables_indices();
+    const Tensor<Index, 1> target_variables_indices = data_set.get_target_variables_indices();
+
+    Tensor<Index, 1> samples_indices(batch_samples_number);
+
+    for(Index i = 0; i < batch_samples_number; i++) samples_indices(i) = (7*i)%samples_number;
+
+    DataSetBatch dense_batch(batch_samples_number, &data_set);
+    DataSetBatch sparse_batch(batch_samples_number, &data_set);
+
+    sparse_batch.set_sparse_inputs(true);
+
+    dense_batch.fill(samples_indices, input_variables_indices, target_variables_indices);
+    sparse_batch.fill(samples_indices, input_variables_indices, target_variables_indices);
+
+    assert_true(sparse_batch.sparse_inputs, LOG);
+    assert_true(sparse_batch.inputs_sparse.rows() == batch_samples_number, LOG);
+    assert_true(sparse_batch.inputs_sparse.cols() == words_number, LOG);
+
+    const Map<const Matrix<type, Dynamic, Dynamic>> dense_inputs(dense_batch.inputs_data, batch_samples_number, words_number);
+
+    const Matrix<type, Dynamic, Dynamic> sparse_inputs = sparse_batch.inputs_sparse.toDense();
+
+    assert_true(sparse_inputs == dense_inputs, LOG);
+
+    Index nonzeros_number = 0;
+
+    for(Index i = 0; i < dense_inputs.size(); i++)
+    {
+        if(dense_inputs(i) != type(0)) nonzeros_number++;
+    }
+
+    assert_true(sparse_batch.inputs_sparse.nonZeros() == nonzeros_number, LOG);
+}
+
+
+void SparseInputsTest::test_back_propagate()
+{
+    cout << "test_back_propagate\n";
+
+    DataSet data_set;
+
+    set_data_set(data_set, calculate_word_bags());
+
+    NeuralNetwork neural_network(NeuralNetwork::ProjectType::Classification, {words_number, 8, 1});
+
+    neural_network.set_random_seed(3);
+    neural_network.set_parameters_random();
+
+    assert_true(neural_network.has_sparse_inputs_layer(), LOG);
+
+    CrossEntropyError cross_entropy_error(&neural_network, &data_set);
+
+    const Tensor<Index, 1> input_variables_indices = data_set.get_input_variables_indices();
+    const Tensor<Index, 1> target_variables_indices = data_set.get_target_variables_indices();
+
+    Tensor<Index, 1> samples_indices(batch_samples_number);
+
+    for(Index i = 0; i < batch_samples_number; i++) samples_indices(i) = (3*i)%samples_number;
+
+    DataSetBatch dense_batch(batch_samples_number, &data_set);
+    DataSetBatch sparse_batch(batch_samples_number, &data_set);
+
+    sparse_batch.set_sparse_inputs(true);
+
+    dense_batch.fill(samples_indices, input_variables_indices, target_variables_indices);
+    sparse_batch.fill(samples_indices, input_variables_indices, target_variables_indices);
+
+    bool switch_train = true;
+
+    NeuralNetworkForwardPropagation dense_forward_propagation(batch_samples_number, &neural_network);
+    LossIndexBackPropagation dense_back_propagation(batch_samples_number, &cross_entropy_error);
+
+    neural_network.forward_propagate(dense_batch, dense_forward_propagation, switch_train);
+    cross_entropy_error.back_propagate(dense_batch, dense_forward_propagation, dense_back_propagation);
+
+    NeuralNetworkForwardPropagation sparse_forward_propagation(batch_samples_number, &neural_network);
+    LossIndexBackPropagation sparse_back_propagation(batch_samples_number, &cross_entropy_error);
+
+    neural_network.forward_propagate(sparse_batch, sparse_forward_propagation, switch_train);
+    cross_entropy_error.back_propagate(sparse_batch, sparse_forward_propagation, sparse_back_propagation);
+
+    assert_true(abs(dense_back_propagation.error - sparse_back_propagation.error) < type(1.0e-5), LOG);
+
+    const Tensor<type, 0> gradient_difference = (dense_back_propagation.gradient - sparse_back_propagation.gradient).abs().maximum();
+
+    assert_true(gradient_difference() < type(1.0e-5), LOG);
+}
+
+
+void SparseInputsTest::test_perform_training()
+{
+    cout << "test_perform_training\n";
+
+    const Tensor<type, 2> word_bags = calculate_word_bags();
+
+    Tensor<type, 1> training_errors(2);
+
+    for(Index i = 0; i < 2; i++)
+    {
+        const bool sparse_inputs = (i == 1);
+
+        // Every data set takes its own copy, as training scales the data in place
+
+        DataSet data_set;
+
+        set_data_set(data_set, word_bags);
+
+        data_set.set_sparse_inputs(sparse_inputs);
+
+        NeuralNetwork neural_network(NeuralNetwork::ProjectType::Classification, {words_number, 8, 1});
+
+        TrainingStrategy training_strategy(&neural_network, &data_set);
+
+        training_strategy.set_random_seed(7);
+        neural_network.set_parameters_random();
+
+        training_strategy.set_loss_method(TrainingStrategy::LossMethod::CROSS_ENTROPY_ERROR);
+        training_strategy.set_optimization_method(TrainingStrategy::OptimizationMethod::ADAPTIVE_MOMENT_ESTIMATION);
+
+        AdaptiveMomentEstimation* adaptive_moment_estimation = training_strategy.get_adaptive_moment_estimation_pointer();
+
+        adaptive_moment_estimation->set_maximum_epochs_number(5);
+        adaptive_moment_estimation->set_batch_samples_number(batch_samples_number);
+
+        training_strategy.set_display(false);
+
+        TrainingResults training_results = training_strategy.perform_training();
+
+        training_errors(i) = training_results.get_training_error();
+    }
+
+    assert_true(isfinite(training_errors(1)), LOG);
+    assert_true(abs(training_errors(0) - training_errors(1)) < type(1.0e-3), LOG);
+}
+
+
+void SparseInputsTest::test_to_XML()
+{
+    cout << "test_to_XML\n";
+
+    DataSet data_set;
+
+    set_data_set(data_set, calculate_word_bags());
+
+    tinyxml2::XMLPrinter printer;
+
+    data_set.write_XML(printer);
+
+    tinyxml2::XMLDocument data_set_document;
+
+    data_set_document.Parse(printer.CStr());
+
+    DataSet loaded_data_set;
+
+    loaded_data_set.set_display(false);
+
+    loaded_data_set.from_XML(data_set_document);
+
+    assert_true(loaded_data_set.get_sparse_inputs(), LOG);
+}
+
+
+void SparseInputsTest::run_test_case()
+{
+    cout << "Running sparse inputs test case...\n";
+
+    // Batch methods
+
+    test_fill_sparse_inputs();
+
+    // Back propagation methods
+
+    test_back_propagate();
+
+    // Training methods
+
+    test_perform_training();
+
+    // Serialization methods
+
+    test_to_XML();
+
+    cout << "End of sparse inputs test case.\n\n";
+}
+
+
+/// Returns word bags with about one word in ten present in each sample, and a binary target in the last column.
+
+Tensor<type, 2> SparseInputsTest::calculate_word_bags() const
+{
+    Tensor<type, 2> word_bags(samples_number, words_number + 1);
+    word_bags.setZero();
+
+    mt19937 random_engine(1);
+
+    for(Index i = 0; i < samples_number; i++)
+    {
+        for(Index k = 0; k < words_number/10; k++)
+        {
+            word_bags(i, Index(random_engine()%words_number)) = type(1 + random_engine()%3);
+        }
+
+        word_bags(i, words_number) = (word_bags(i, 0) + word_bags(i, 1) + word_bags(i, 2) > type(0)) ? type(1) : type(0);
+    }
+
+    return word_bags;
+}
+
+
+/// Sets a data set in sparse inputs mode, with the words as inputs scaled by their standard deviation, which keeps the zeros.
+
+void SparseInputsTest::set_data_set(DataSet& data_set, const Tensor<type, 2>& word_bags) const
+{
+    data_set.set(word_bags);
+
+    data_set.set_display(false);
+
+    Tensor<Index, 1> input_columns_indices(words_number);
+
+    for(Index j = 0; j < words_number; j++) input_columns_indices(j) = j;
+
+    Tensor<Index, 1> target_columns_indices(1);
+    target_columns_indices.setConstant(words_number);
+
+    data_set.set_input_target_columns(input_columns_indices, target_columns_indices);
+
+    data_set.set_columns_scalers(Scaler::StandardDeviation);
+
+    data_set.set_random_seed(3);
+    data_set.split_samples_random(type(0.8), type(0.2), type(0));
+
+    data_set.set_sparse_inputs(true);
+}
+
+
+// OpenNN: Open Neural Networks Library.
+// Copyright(C) 2005-2022 Artificial Intelligence Techniques, SL.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
@@ -0,0 +1,76 @@
+//   OpenNN: Open Neural Networks Library
+//   www.opennn.net
+//
+//   S P A R S E   I N P U T S   T E S T   C L A S S   H E A D E R
+//
+//   Artificial Intelligence Techniques SL
+//   artelnics@artelnics.com
+
+#ifndef SPARSEINPUTSTEST_H
+#define SPARSEINPUTSTEST_H
+
+// Unit testing includes
+
+#include "../opennn/unit_testing.h"
+
+class SparseInputsTest : public UnitTesting
+{
+
+public:
+
+    explicit SparseInputsTest();
+
+    virtual ~SparseInputsTest();
+
+    // Batch methods
+
+    void test_fill_sparse_inputs();
+
+    // Back propagation methods
+
+    void test_back_propagate();
+
+    // Training methods
+
+    void test_perform_training();
+
+    // Serialization methods
+
+    void test_to_XML();
+
+    // Unit testing methods
+
+    void run_test_case();
+
+private:
+
+    Tensor<type, 2> calculate_word_bags() const;
+
+    void set_data_set(DataSet&, const Tensor<type, 2>&) const;
+
+    Index samples_number = 400;
+
+    Index words_number = 300;
+
+    Index batch_samples_number = 64;
+};
+
+#endif
+
+
+// OpenNN: Open Neural Networks Library.
+// Copyright(C) 2005-2022 Artificial Intelligence Techniques, SL.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
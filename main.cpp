@@ -2,6 +2,9 @@
 
 int main()
 {
+	// All the training jobs share one OpenNN thread pool, which must be configured before any OpenNN object is created
+	ThreadRuntime::get_instance().set_pin_threads(true);
+
 	DataManager dm("data");
 
 	dm.StartTraining(MODEL_DESTINATION::MD_CANCER_DATA, "test_004",
@@ -20,7 +23,7 @@ int main()
 			TrainingStrategy::OptimizationMethod::GRADIENT_DESCENT,
 			TrainingStrategy::OptimizationMethod::CONJUGATE_GRADIENT,
 			TrainingStrategy::OptimizationMethod::QUASI_NEWTON_METHOD,
-			/*TrainingStrategy::OptimizationMethod::LEVENBERG_MARQUARDT_ALGORITHM,*/
+			TrainingStrategy::OptimizationMethod::LEVENBERG_MARQUARDT_ALGORITHM,
 			TrainingStrategy::OptimizationMethod::STOCHASTIC_GRADIENT_DESCENT,
 			TrainingStrategy::OptimizationMethod::ADAPTIVE_MOMENT_ESTIMATION
 		},